@@ -0,0 +1,34 @@
+/**
+* @file benchmarks/allocation_counter.h
+* @brief Counting of heap allocations made by benchmarks.
+* @copyright (c) 2026 Avast Software, licensed under the MIT license
+*/
+
+#pragma once
+
+#include <cstddef>
+
+namespace yaramod {
+namespace benchmarks {
+
+/**
+ * Number of allocations and allocated bytes passed through the global operator new
+ * since the start of the process. Deallocations are not subtracted.
+ */
+struct AllocationStats
+{
+	std::size_t count;
+	std::size_t bytes;
+
+	AllocationStats operator-(const AllocationStats& other) const { return {count - other.count, bytes - other.bytes}; }
+};
+
+AllocationStats allocationStats();
+
+/**
+ * Returns the peak resident set size of the whole process in bytes, or 0 if it is not available.
+ */
+std::size_t peakResidentSetSize();
+
+} // namespace benchmarks
+} // namespace yaramod
@@ -0,0 +1,62 @@
+/**
+* @file benchmarks/builder_benchmarks.cpp
+* @brief Benchmarks of building rulesets.
+* @copyright (c) 2026 Avast Software, licensed under the MIT license
+*/
+
+#include <benchmark/benchmark.h>
+
+#include "yaramod/builder/yara_expression_builder.h"
+#include "yaramod/builder/yara_file_builder.h"
+#include "yaramod/builder/yara_hex_string_builder.h"
+#include "yaramod/builder/yara_rule_builder.h"
+
+namespace yaramod {
+namespace benchmarks {
+
+namespace {
+
+std::unique_ptr<Rule> buildRule(std::size_t index)
+{
+	auto condition = conjunction({
+		stringRef("$s01"),
+		paren(disjunction({matchAt("$h01", intVal(index % 4096)), id("pe").access("number_of_sections") > intVal(index % 5)})),
+		id("pe").access("imports").call({stringVal("kernel32.dll"), stringVal("CreateFileA")})
+	});
+
+	return YaraRuleBuilder()
+		.withName("rule_" + std::to_string(index))
+		.withTag("tag" + std::to_string(index % 10))
+		.withStringMeta("author", "yaramod")
+		.withPlainString("$s01", "text_" + std::to_string(index))
+		.withHexString("$h01", YaraHexStringBuilder(std::vector<std::uint8_t>{0x4D, 0x5A, static_cast<std::uint8_t>(index)})
+			.add(wildcard(), jumpRange(2, 4), alt(YaraHexStringBuilder(0xAA), YaraHexStringBuilder(0xBB)))
+			.get())
+		.withRegexp("$r01", "ab[cd]+" + std::to_string(index), "i")
+		.withCondition(condition.get())
+		.get();
+}
+
+} // namespace
+
+/**
+ * Building of a ruleset using the builders, either with or without checking it by parsing its text.
+ */
+static void BuildRuleset(benchmark::State& state, bool recheck)
+{
+	for (auto _ : state)
+	{
+		YaraFileBuilder builder;
+		builder.withModule("pe");
+		for (std::int64_t i = 0; i < state.range(0); ++i)
+			builder.withRule(buildRule(i));
+		auto file = builder.get(recheck);
+		benchmark::DoNotOptimize(file);
+	}
+	state.counters["rules"] = benchmark::Counter(static_cast<double>(state.iterations() * state.range(0)), benchmark::Counter::kIsRate);
+}
+BENCHMARK_CAPTURE(BuildRuleset, Unchecked, false)->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BuildRuleset, Rechecked, true)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+} // namespace benchmarks
+} // namespace yaramod
@@ -0,0 +1,22 @@
+/**
+* @file benchmarks/main.cpp
+* @brief Entry point of the benchmarks.
+* @copyright (c) 2026 Avast Software, licensed under the MIT license
+*/
+
+#include <benchmark/benchmark.h>
+
+#include "yaramod/yaramod.h"
+
+int main(int argc, char** argv)
+{
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+
+	// Stored in the context of JSON output so the results of different versions can be told apart
+	benchmark::AddCustomContext("yaramod_version", YARAMOD_VERSION);
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,131 @@
+/**
+* @file benchmarks/module_pool_benchmarks.cpp
+* @brief Benchmarks of ModulePool construction and module initialization.
+* @copyright (c) 2026 Avast Software, licensed under the MIT license
+*/
+
+#include <fstream>
+#include <sstream>
+
+#include <benchmark/benchmark.h>
+
+#include "yaramod/types/modules/module_pool.h"
+
+namespace yaramod {
+namespace benchmarks {
+
+namespace {
+
+std::string readModuleJson(const std::string& fileName)
+{
+	std::ifstream input(std::string{YARAMOD_MODULES_DIR} + "/" + fileName + ".json");
+	std::stringstream content;
+	content << input.rdbuf();
+	return content.str();
+}
+
+} // namespace
+
+/**
+ * Construction of ModulePool which initializes all known modules right away.
+ * Built-in modules are constructed from their compiled specifications.
+ */
+static void ModulePoolConstructionEager(benchmark::State& state)
+{
+	for (auto _ : state)
+	{
+		ModulePool modules(Features::AllCurrent, "");
+		benchmark::DoNotOptimize(modules);
+	}
+}
+BENCHMARK(ModulePoolConstructionEager)->Unit(benchmark::kMillisecond);
+
+/**
+ * Construction of ModulePool which only registers the known modules.
+ */
+static void ModulePoolConstructionLazy(benchmark::State& state)
+{
+	for (auto _ : state)
+	{
+		ModulePool modules(Features::AllCurrent, "", true);
+		benchmark::DoNotOptimize(modules);
+	}
+}
+BENCHMARK(ModulePoolConstructionLazy)->Unit(benchmark::kMillisecond);
+
+/**
+ * Initialization of a single module on its first import. This is the startup
+ * cost of a lazy module pool for ruleset which imports only this module.
+ */
+static void ModuleInitialization(benchmark::State& state, const std::string& name)
+{
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		ModulePool modules(Features::AllCurrent, "", true);
+		state.ResumeTiming();
+
+		benchmark::DoNotOptimize(modules.load(name));
+	}
+}
+BENCHMARK_CAPTURE(ModuleInitialization, console, std::string{"console"})->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(ModuleInitialization, cuckoo, std::string{"cuckoo"})->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(ModuleInitialization, dex, std::string{"dex"})->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(ModuleInitialization, dotnet, std::string{"dotnet"})->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(ModuleInitialization, elf, std::string{"elf"})->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(ModuleInitialization, hash, std::string{"hash"})->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(ModuleInitialization, macho, std::string{"macho"})->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(ModuleInitialization, magic, std::string{"magic"})->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(ModuleInitialization, math, std::string{"math"})->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(ModuleInitialization, pe, std::string{"pe"})->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(ModuleInitialization, string, std::string{"string"})->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(ModuleInitialization, time, std::string{"time"})->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(ModuleInitialization, vt, std::string{"vt"})->Unit(benchmark::kMicrosecond);
+
+/**
+ * Initialization of all built-in modules from their JSON specifications.
+ * This is how ModulePoolConstructionEager worked before the specifications were compiled.
+ */
+static void AllModulesInitializationFromJson(benchmark::State& state)
+{
+	const std::vector<std::pair<std::string, std::string>> modules = {
+		{"console", "module_console"}, {"cuckoo", "module_cuckoo"}, {"dex", "module_dex"},
+		{"dotnet", "module_dotnet"}, {"elf", "module_elf"}, {"hash", "module_hash"},
+		{"macho", "module_macho"}, {"magic", "module_magic"}, {"math", "module_math"},
+		{"pe", "module_pe"}, {"string", "module_string"}, {"time", "module_time"}, {"vt", "module_vt"}
+	};
+
+	std::vector<std::pair<std::string, std::string>> contents;
+	for (const auto& [name, fileName] : modules)
+		contents.emplace_back(name, readModuleJson(fileName));
+
+	for (auto _ : state)
+	{
+		for (const auto& [name, json] : contents)
+		{
+			Module module(ModuleContent(name, std::string{json}));
+			module.initialize();
+			benchmark::DoNotOptimize(module);
+		}
+	}
+}
+BENCHMARK(AllModulesInitializationFromJson)->Unit(benchmark::kMillisecond);
+
+/**
+ * Initialization of a single module from its JSON specification.
+ */
+static void ModuleInitializationFromJson(benchmark::State& state, const std::string& name)
+{
+	auto json = readModuleJson("module_" + name);
+	for (auto _ : state)
+	{
+		Module module(ModuleContent(name, std::string{json}));
+		module.initialize();
+		benchmark::DoNotOptimize(module);
+	}
+}
+BENCHMARK_CAPTURE(ModuleInitializationFromJson, pe, std::string{"pe"})->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(ModuleInitializationFromJson, vt, std::string{"vt"})->Unit(benchmark::kMicrosecond);
+
+} // namespace benchmarks
+} // namespace yaramod
@@ -0,0 +1,461 @@
+/**
+* @file benchmarks/parser_benchmarks.cpp
+* @brief Benchmarks of parsing rulesets from different inputs.
+* @copyright (c) 2026 Avast Software, licensed under the MIT license
+*/
+
+#include <fstream>
+#include <sstream>
+
+#include <benchmark/benchmark.h>
+
+#include "allocation_counter.h"
+#include "ruleset_generator.h"
+#include "yaramod/parser/parser_driver.h"
+#include "yaramod/utils/filesystem.h"
+#include "yaramod/yaramod.h"
+
+namespace yaramod {
+namespace benchmarks {
+
+namespace {
+
+std::string generateRuleset(std::size_t rulesCount, const std::string& rulePrefix = "rule_")
+{
+	std::ostringstream ruleset;
+	ruleset << "import \"pe\"\n\n";
+	for (std::size_t i = 0; i < rulesCount; ++i)
+	{
+		ruleset << "rule " << rulePrefix << i << " : tag" << i % 10 << "\n{\n"
+			<< "\tmeta:\n\t\tauthor = \"yaramod\"\n\t\tversion = " << i << "\n"
+			<< "\tstrings:\n"
+			<< "\t\t$s01 = \"text_" << i << "\" ascii wide\n"
+			<< "\t\t$h01 = { 4D 5A [2-4] ?? 0" << i % 10 << " ( AA | BB ) }\n"
+			<< "\t\t$r01 = /ab[cd]+" << i << "/i\n"
+			<< "\tcondition:\n"
+			<< "\t\tpe.number_of_sections > " << i % 5 << " and all of ($s*) and ($h01 or #r01 > 2)\n"
+			<< "}\n\n";
+	}
+	return ruleset.str();
+}
+
+std::string writeRuleset(const std::string& ruleset, const std::string& fileName = "yaramod_benchmark_ruleset.yar")
+{
+	auto filePath = (fs::temp_directory_path() / fileName).string();
+	std::ofstream(filePath, std::ios::binary) << ruleset;
+	return filePath;
+}
+
+} // namespace
+
+/**
+ * Matching of tokens in the default tokenizer state, which is used for conditions, either using
+ * the scanner of the state or RE2. Tokens which can't be matched in the default state are skipped.
+ */
+static void TokenMatching(benchmark::State& state, bool useScanner)
+{
+	auto ruleset = generateRuleset(100);
+	ParserDriver driver;
+	const auto* defaultState = driver.getParserDefinition()->get_tokenizer_definition()->get_state_info("@default");
+
+	std::size_t tokens = 0;
+	for (auto _ : state)
+	{
+		re2::StringPiece input{ruleset.data(), ruleset.size()};
+		while (!input.empty())
+		{
+			auto match = useScanner ? defaultState->match(input) : defaultState->match_with_regexps(input);
+			input.remove_prefix(match && match.value().length > 0 ? match.value().length : 1);
+			++tokens;
+		}
+	}
+	state.counters["tokens"] = benchmark::Counter(static_cast<double>(tokens), benchmark::Counter::kIsRate);
+	state.SetBytesProcessed(state.iterations() * ruleset.size());
+}
+BENCHMARK_CAPTURE(TokenMatching, Scanner, true)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(TokenMatching, Regexps, false)->Unit(benchmark::kMillisecond);
+
+/**
+ * Parsing of a ruleset reporting the number of tokens per second.
+ */
+static void ParseRulesetTokens(benchmark::State& state)
+{
+	auto ruleset = generateRuleset(state.range(0));
+	ParserDriver driver;
+	std::size_t tokens = 0;
+	for (auto _ : state)
+	{
+		driver.parse(std::string_view{ruleset});
+		tokens += driver.getParsedFile().getTokenStream()->size();
+	}
+	state.counters["tokens"] = benchmark::Counter(static_cast<double>(tokens), benchmark::Counter::kIsRate);
+}
+BENCHMARK(ParseRulesetTokens)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Parsing of a ruleset followed by the traversal of all its tokens. Reports heap allocations
+ * and allocated bytes per token of the whole parsing, not only of the token storage.
+ * The ruleset is either parsed from memory or from a file, which gives tokens a file path.
+ */
+static void ParseRulesetTokenMemory(benchmark::State& state, bool fromFile)
+{
+	auto ruleset = generateRuleset(1000);
+	auto filePath = writeRuleset(ruleset, "yaramod_benchmark_ruleset_with_quite_a_long_name.yar");
+	ParserDriver driver;
+	std::size_t tokens = 0;
+	auto before = allocationStats();
+	for (auto _ : state)
+	{
+		if (fromFile)
+			driver.parse(filePath);
+		else
+			driver.parse(std::string_view{ruleset});
+		std::size_t sum = 0;
+		for (const auto& token : driver.getParsedFile().getTokenStream()->getTokens())
+			sum += static_cast<std::size_t>(token.getType());
+		benchmark::DoNotOptimize(sum);
+		tokens += driver.getParsedFile().getTokenStream()->size();
+	}
+	auto allocations = allocationStats() - before;
+	state.counters["tokens"] = benchmark::Counter(static_cast<double>(tokens), benchmark::Counter::kIsRate);
+	state.counters["allocs/token"] = static_cast<double>(allocations.count) / static_cast<double>(tokens);
+	state.counters["bytes/token"] = static_cast<double>(allocations.bytes) / static_cast<double>(tokens);
+	fs::remove(filePath);
+}
+BENCHMARK_CAPTURE(ParseRulesetTokenMemory, String, false)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(ParseRulesetTokenMemory, File, true)->Unit(benchmark::kMillisecond);
+
+/**
+ * Parsing of a ruleset reporting how many token literals were interned in the literal pool
+ * of the parsed file, how many distinct strings it holds and how many bytes of heap memory
+ * it saved by not duplicating them.
+ */
+static void ParseRulesetInternedLiterals(benchmark::State& state)
+{
+	auto ruleset = generateRuleset(state.range(0));
+	ParserDriver driver;
+	for (auto _ : state)
+	{
+		driver.parse(std::string_view{ruleset});
+		benchmark::DoNotOptimize(driver.getParsedFile());
+	}
+	const auto& pool = driver.getParsedFile().getLiteralPool();
+	state.counters["interned"] = static_cast<double>(pool.getInternedCount());
+	state.counters["strings"] = static_cast<double>(pool.getStringsCount());
+	state.counters["saved_bytes"] = static_cast<double>(pool.getSavedBytes());
+}
+BENCHMARK(ParseRulesetInternedLiterals)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Parsing of a large ruleset reporting the peak resident set size of the process. The peak
+ * includes everything the benchmark process did before, so run this benchmark alone using
+ * --benchmark_filter to compare the memory between builds.
+ */
+static void ParseLargeRuleset(benchmark::State& state)
+{
+	auto ruleset = generateRuleset(state.range(0));
+	ParserDriver driver;
+	for (auto _ : state)
+	{
+		driver.parse(std::string_view{ruleset});
+		benchmark::DoNotOptimize(driver.getParsedFile());
+	}
+	state.counters["peak_rss_mb"] = static_cast<double>(peakResidentSetSize()) / (1024 * 1024);
+	state.SetBytesProcessed(state.iterations() * ruleset.size());
+}
+BENCHMARK(ParseLargeRuleset)->Arg(20000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Parsing of the same large ruleset rule by rule, dropping every rule right after it is parsed.
+ * Run this benchmark alone using --benchmark_filter to compare its peak resident set size
+ * with ParseLargeRuleset.
+ */
+static void ParseLargeRulesetStreamed(benchmark::State& state)
+{
+	auto ruleset = generateRuleset(state.range(0));
+	ParserDriver driver;
+	std::size_t rules = 0;
+	for (auto _ : state)
+	{
+		driver.parse(std::string_view{ruleset}, [&](std::unique_ptr<Rule>&& rule, const YaraFile&) {
+			benchmark::DoNotOptimize(rule);
+			++rules;
+		});
+	}
+	state.counters["peak_rss_mb"] = static_cast<double>(peakResidentSetSize()) / (1024 * 1024);
+	state.counters["rules"] = benchmark::Counter(static_cast<double>(rules), benchmark::Counter::kAvgIterations);
+	state.SetBytesProcessed(state.iterations() * ruleset.size());
+}
+BENCHMARK(ParseLargeRulesetStreamed)->Arg(20000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Parsing of a ruleset again after the condition of the rule in its middle is edited,
+ * either only the edited rule or the whole ruleset. The edit is undone in every other
+ * iteration so every iteration parses a real change.
+ */
+static void ReparseEditedRule(benchmark::State& state, bool incremental)
+{
+	auto ruleset = generateRuleset(state.range(0));
+	auto position = ruleset.find("> ", ruleset.find("rule rule_" + std::to_string(state.range(0) / 2) + " ")) + 1;
+	auto edited = ruleset;
+	edited.insert(position, "=");
+	const std::vector<InputChange> toEdited = {{position, 1}}, toOriginal = {{position, 0}}, unknown;
+
+	ParserDriver driver;
+	driver.parse(std::string_view{ruleset});
+	auto file = std::move(driver.getParsedFile());
+	bool isEdited = false;
+	std::size_t incrementalCount = 0;
+	for (auto _ : state)
+	{
+		isEdited = !isEdited;
+		auto result = driver.reparse(file, isEdited ? edited : ruleset, incremental ? (isEdited ? toEdited : toOriginal) : unknown);
+		if (result == ReparseResult::Incremental)
+			++incrementalCount;
+	}
+	state.counters["incremental"] = benchmark::Counter(static_cast<double>(incrementalCount), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK_CAPTURE(ReparseEditedRule, Incremental, true)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(ReparseEditedRule, Full, false)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Parsing of a ruleset with or without profiling, which shows the overhead of measuring the phases.
+ */
+static void ParseRulesetProfiled(benchmark::State& state, bool profiling)
+{
+	auto ruleset = generateRuleset(state.range(0));
+	ParserDriver driver;
+	driver.setProfiling(profiling);
+	for (auto _ : state)
+	{
+		driver.parse(std::string_view{ruleset});
+		benchmark::DoNotOptimize(driver.getParsedFile());
+	}
+	if (profiling)
+	{
+		const auto& profile = driver.getProfile();
+		auto total = static_cast<double>(profile.getTotalTime().count());
+		state.counters["tokenizing_%"] = 100.0 * static_cast<double>(profile.getTime(ParserPhase::Tokenizing).count()) / total;
+		state.counters["actions_%"] = 100.0 * static_cast<double>(profile.getTime(ParserPhase::Actions).count()) / total;
+		state.counters["symbols_%"] = 100.0 * static_cast<double>(profile.getTime(ParserPhase::SymbolLookup).count()) / total;
+	}
+	state.SetBytesProcessed(state.iterations() * ruleset.size());
+}
+BENCHMARK_CAPTURE(ParseRulesetProfiled, Disabled, false)->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(ParseRulesetProfiled, Enabled, true)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Parsing of a ruleset read from std::istream, which is copied into the parser.
+ */
+static void ParseRulesetFromStream(benchmark::State& state)
+{
+	auto ruleset = generateRuleset(state.range(0));
+	ParserDriver driver;
+	for (auto _ : state)
+	{
+		std::istringstream input(ruleset);
+		driver.parse(input);
+		benchmark::DoNotOptimize(driver.getParsedFile());
+	}
+	state.SetBytesProcessed(state.iterations() * ruleset.size());
+}
+BENCHMARK(ParseRulesetFromStream)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Parsing of a ruleset from std::string_view, which is tokenized in place.
+ */
+static void ParseRulesetFromStringView(benchmark::State& state)
+{
+	auto ruleset = generateRuleset(state.range(0));
+	ParserDriver driver;
+	for (auto _ : state)
+	{
+		driver.parse(std::string_view{ruleset});
+		benchmark::DoNotOptimize(driver.getParsedFile());
+	}
+	state.SetBytesProcessed(state.iterations() * ruleset.size());
+}
+BENCHMARK(ParseRulesetFromStringView)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Parsing of a ruleset from the file which is mapped into memory.
+ */
+static void ParseRulesetFromFile(benchmark::State& state)
+{
+	auto ruleset = generateRuleset(state.range(0));
+	auto filePath = writeRuleset(ruleset);
+	ParserDriver driver;
+	for (auto _ : state)
+	{
+		driver.parse(filePath);
+		benchmark::DoNotOptimize(driver.getParsedFile());
+	}
+	state.SetBytesProcessed(state.iterations() * ruleset.size());
+	fs::remove(filePath);
+}
+BENCHMARK(ParseRulesetFromFile)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Parsing of entrypoints which include the same common file, with or without the include cache.
+ */
+static void ParseEntrypointsWithCommonInclude(benchmark::State& state, bool cached)
+{
+	auto common = generateRuleset(state.range(0));
+	auto commonPath = writeRuleset(common, "yaramod_benchmark_common.yar");
+	auto entrypointPath = writeRuleset("include \"yaramod_benchmark_common.yar\"\n\nrule main_rule { condition: rule_0 }\n", "yaramod_benchmark_entrypoint.yar");
+
+	ParserDriver driver;
+	if (cached)
+		driver.setIncludeCache(std::make_shared<MemoryIncludeCache>());
+	for (auto _ : state)
+	{
+		driver.parse(entrypointPath);
+		benchmark::DoNotOptimize(driver.getParsedFile());
+	}
+	state.counters["entrypoints"] = benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+
+	fs::remove(commonPath);
+	fs::remove(entrypointPath);
+}
+BENCHMARK_CAPTURE(ParseEntrypointsWithCommonInclude, Uncached, false)->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(ParseEntrypointsWithCommonInclude, Cached, true)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Validation of a ruleset where every hundredth rule has an error, which are all collected
+ * in a single pass with error recovery.
+ */
+static void ValidateRulesetWithErrors(benchmark::State& state)
+{
+	auto ruleset = generateRuleset(state.range(0));
+	for (std::size_t pos = 0, i = 0; (pos = ruleset.find("\tcondition:\n", pos)) != std::string::npos; ++pos, ++i)
+	{
+		if (i % 100 == 0)
+			ruleset.insert(pos + 13, "\t\tunknown_rule and\n");
+	}
+
+	ParserDriver driver;
+	driver.setErrorRecovery(true);
+	for (auto _ : state)
+	{
+		driver.parse(std::string_view{ruleset});
+		benchmark::DoNotOptimize(driver.getParsedFile());
+	}
+	state.counters["errors"] = static_cast<double>(driver.getErrors().size());
+	state.counters["rules"] = benchmark::Counter(static_cast<double>(state.iterations() * state.range(0)), benchmark::Counter::kIsRate);
+	state.SetBytesProcessed(state.iterations() * ruleset.size());
+}
+BENCHMARK(ValidateRulesetWithErrors)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Parsing of a file which includes many small files, with given number of threads prefetching the includes.
+ * Files are in the page cache so this shows the overhead of prefetching rather than the saved waiting for the storage.
+ */
+static void ParseManyIncludes(benchmark::State& state)
+{
+	std::vector<std::string> filePaths;
+	std::string entrypoint;
+	for (int i = 0; i < 100; ++i)
+	{
+		auto fileName = "yaramod_benchmark_include_" + std::to_string(i) + ".yar";
+		filePaths.push_back(writeRuleset(generateRuleset(10, "rule_" + std::to_string(i) + "_"), fileName));
+		entrypoint += "include \"" + fileName + "\"\n";
+	}
+	filePaths.push_back(writeRuleset(entrypoint, "yaramod_benchmark_entrypoint.yar"));
+
+	ParserDriver driver;
+	driver.setIncludePrefetchThreads(state.range(0));
+	for (auto _ : state)
+	{
+		driver.parse(filePaths.back());
+		benchmark::DoNotOptimize(driver.getParsedFile());
+	}
+	state.counters["includes"] = benchmark::Counter(static_cast<double>(state.iterations() * (filePaths.size() - 1)), benchmark::Counter::kIsRate);
+
+	for (const auto& filePath : filePaths)
+		fs::remove(filePath);
+}
+BENCHMARK(ParseManyIncludes)->Arg(0)->Arg(1)->Arg(4)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+/**
+ * Parsing of independent files by Yaramod::parseFiles with given number of threads.
+ * Compare the rate of files between the numbers of threads to see how parsing scales.
+ */
+static void ParseFilesConcurrently(benchmark::State& state)
+{
+	std::vector<std::string> filePaths;
+	auto ruleset = generateRuleset(100);
+	for (int i = 0; i < 64; ++i)
+		filePaths.push_back(writeRuleset(ruleset, "yaramod_benchmark_ruleset_" + std::to_string(i) + ".yar"));
+
+	Yaramod yaramod;
+	for (auto _ : state)
+	{
+		auto results = yaramod.parseFiles(filePaths, state.range(0));
+		benchmark::DoNotOptimize(results);
+	}
+	state.counters["files"] = benchmark::Counter(static_cast<double>(state.iterations() * filePaths.size()), benchmark::Counter::kIsRate);
+	state.SetBytesProcessed(state.iterations() * filePaths.size() * ruleset.size());
+
+	for (const auto& filePath : filePaths)
+		fs::remove(filePath);
+}
+BENCHMARK(ParseFilesConcurrently)->DenseRange(1, 4)->Arg(8)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+/**
+ * Parsing of generated rulesets of different shapes, each stressing a different part of the parser.
+ * Rules are split into files of the shape, all included from the first one.
+ */
+static void ParseGeneratedRuleset(benchmark::State& state, RulesetShape shape)
+{
+	shape.rules = state.range(0);
+	auto filePaths = RulesetGenerator().generateFiles(shape, fs::temp_directory_path().string(), "yaramod_benchmark_generated");
+	std::size_t bytes = 0;
+	for (const auto& filePath : filePaths)
+		bytes += fs::file_size(filePath);
+
+	ParserDriver driver;
+	for (auto _ : state)
+	{
+		driver.parse(filePaths.front());
+		benchmark::DoNotOptimize(driver.getParsedFile());
+	}
+	state.counters["rules"] = benchmark::Counter(static_cast<double>(state.iterations() * shape.rules), benchmark::Counter::kIsRate);
+	state.SetBytesProcessed(state.iterations() * bytes);
+
+	for (const auto& filePath : filePaths)
+		fs::remove(filePath);
+}
+BENCHMARK_CAPTURE(ParseGeneratedRuleset, ManyRules, RulesetShape{})->Arg(10000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(ParseGeneratedRuleset, DeepConditions, RulesetShape{0, 64, 0, 0, 0})->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(ParseGeneratedRuleset, BigHexStrings, RulesetShape{0, 0, 1024, 0, 0})->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(ParseGeneratedRuleset, Regexps, RulesetShape{0, 0, 0, 16, 0})->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(ParseGeneratedRuleset, ModuleTerms, RulesetShape{0, 0, 0, 0, 16})->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(ParseGeneratedRuleset, Includes, RulesetShape{0, 2, 16, 1, 1, 100})->Arg(1000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Parsing and destruction of a ruleset with deep conditions, with expressions allocated
+ * either on the heap or in the arena of the parsed file. Reports heap allocations per rule.
+ */
+static void ParseDeepConditions(benchmark::State& state, bool arenaAllocation)
+{
+	auto ruleset = RulesetGenerator().generate(RulesetShape{static_cast<std::size_t>(state.range(0)), 64, 0, 0, 4});
+	ParserDriver driver;
+	driver.setArenaAllocation(arenaAllocation);
+	auto before = allocationStats();
+	for (auto _ : state)
+	{
+		driver.parse(std::string_view{ruleset});
+		auto file = std::move(driver.getParsedFile());
+		benchmark::DoNotOptimize(file);
+	}
+	auto allocations = allocationStats() - before;
+	auto rules = static_cast<double>(state.iterations() * state.range(0));
+	state.counters["allocs/rule"] = static_cast<double>(allocations.count) / rules;
+	state.counters["rules"] = benchmark::Counter(rules, benchmark::Counter::kIsRate);
+	state.SetBytesProcessed(state.iterations() * ruleset.size());
+}
+BENCHMARK_CAPTURE(ParseDeepConditions, Heap, false)->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(ParseDeepConditions, Arena, true)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+} // namespace benchmarks
+} // namespace yaramod
@@ -0,0 +1,125 @@
+/**
+* @file benchmarks/parser_driver_benchmarks.cpp
+* @brief Benchmarks of ParserDriver construction.
+* @copyright (c) 2026 Avast Software, licensed under the MIT license
+*/
+
+#include <sstream>
+
+#include <benchmark/benchmark.h>
+
+#include "yaramod/parser/parser_driver.h"
+#include "yaramod/parser/parsing_table_cache.h"
+
+namespace yaramod {
+namespace benchmarks {
+
+/**
+ * Construction of ParserDriver which has to compute LALR parsing table from scratch.
+ * This is how every ParserDriver was constructed before the parsing tables got cached.
+ * The module pool is shared so that only the construction of the parser is measured.
+ *
+ * Note that when YARAMOD_PARSER_TABLE_CACHE is set, the table is loaded from the disk instead.
+ */
+static void ParserDriverConstructionWithoutCachedTable(benchmark::State& state)
+{
+	auto modules = std::make_shared<ModulePool>(Features::AllCurrent, "");
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		ParserDriver::clearSharedParserDefinitions();
+		ParsingTableCache::instance().clear();
+		state.ResumeTiming();
+
+		ParserDriver driver(Features::AllCurrent, modules);
+		benchmark::DoNotOptimize(driver);
+	}
+}
+BENCHMARK(ParserDriverConstructionWithoutCachedTable)->Unit(benchmark::kMillisecond);
+
+/**
+ * Construction of ParserDriver which loads already computed parsing table
+ * but still has to build its own grammar and compile regular expressions of tokens.
+ */
+static void ParserDriverConstructionWithCachedTable(benchmark::State& state)
+{
+	auto modules = std::make_shared<ModulePool>(Features::AllCurrent, "");
+	ParserDriver warmup(Features::AllCurrent, modules);
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		ParserDriver::clearSharedParserDefinitions();
+		state.ResumeTiming();
+
+		ParserDriver driver(Features::AllCurrent, modules);
+		benchmark::DoNotOptimize(driver);
+	}
+}
+BENCHMARK(ParserDriverConstructionWithCachedTable)->Unit(benchmark::kMillisecond);
+
+/**
+ * Construction of ParserDriver which shares the grammar and the parsing table
+ * with already existing driver. This is the default when more drivers are created.
+ */
+static void ParserDriverConstructionWithSharedDefinition(benchmark::State& state)
+{
+	auto modules = std::make_shared<ModulePool>(Features::AllCurrent, "");
+	ParserDriver warmup(Features::AllCurrent, modules);
+	for (auto _ : state)
+	{
+		ParserDriver driver(Features::AllCurrent, modules);
+		benchmark::DoNotOptimize(driver);
+	}
+}
+BENCHMARK(ParserDriverConstructionWithSharedDefinition)->Unit(benchmark::kMillisecond);
+
+/**
+ * Construction of ParserDriver which uses the module pool shared by the whole process.
+ */
+static void ParserDriverConstructionWithModules(benchmark::State& state)
+{
+	ParserDriver warmup(Features::AllCurrent);
+	for (auto _ : state)
+	{
+		ParserDriver driver(Features::AllCurrent);
+		benchmark::DoNotOptimize(driver);
+	}
+}
+BENCHMARK(ParserDriverConstructionWithModules)->Unit(benchmark::kMillisecond);
+
+/**
+ * Parsing of a ruleset importing the largest modules by a driver with its own module pool,
+ * so the symbol trees of the modules are built again for every driver.
+ */
+static void ParserDriverImportWithPrivatePool(benchmark::State& state)
+{
+	ParserDriver warmup(Features::AllCurrent);
+	for (auto _ : state)
+	{
+		ParserDriver driver(Features::AllCurrent, std::make_shared<ModulePool>(Features::AllCurrent, ""));
+		std::istringstream input("import \"pe\"\nimport \"vt\"\nrule abc { condition: pe.is_dll() }");
+		driver.parse(input);
+		benchmark::DoNotOptimize(driver);
+	}
+}
+BENCHMARK(ParserDriverImportWithPrivatePool)->Unit(benchmark::kMillisecond);
+
+/**
+ * Parsing of a ruleset importing the largest modules by a driver using the shared module pool,
+ * so the symbol trees of the modules are built only once for the whole process.
+ */
+static void ParserDriverImportWithSharedPool(benchmark::State& state)
+{
+	ParserDriver warmup(Features::AllCurrent);
+	for (auto _ : state)
+	{
+		ParserDriver driver(Features::AllCurrent);
+		std::istringstream input("import \"pe\"\nimport \"vt\"\nrule abc { condition: pe.is_dll() }");
+		driver.parse(input);
+		benchmark::DoNotOptimize(driver);
+	}
+}
+BENCHMARK(ParserDriverImportWithSharedPool)->Unit(benchmark::kMillisecond);
+
+} // namespace benchmarks
+} // namespace yaramod
@@ -0,0 +1,205 @@
+/**
+* @file benchmarks/ruleset_generator.cpp
+* @brief Deterministic generator of synthetic rulesets.
+* @copyright (c) 2026 Avast Software, licensed under the MIT license
+*/
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+
+#include "ruleset_generator.h"
+#include "yaramod/utils/filesystem.h"
+
+namespace yaramod {
+namespace benchmarks {
+
+/**
+ * Constructor.
+ *
+ * @param seed Seed of the generated values.
+ */
+RulesetGenerator::RulesetGenerator(std::uint32_t seed) : _random(seed)
+{
+}
+
+/**
+ * Generates the ruleset as a single file. Files of the shape are ignored.
+ *
+ * @param shape Shape of the ruleset.
+ *
+ * @return Text of the ruleset.
+ */
+std::string RulesetGenerator::generate(const RulesetShape& shape)
+{
+	return _generateRules(shape, 0, shape.rules);
+}
+
+/**
+ * Generates the ruleset split into files of the shape and writes them into the directory.
+ * The first file includes all the other files before its own rules so the rules can refer
+ * to the rules of the files included before.
+ *
+ * @param shape Shape of the ruleset.
+ * @param directory Directory to write the files to.
+ * @param prefix Prefix of the names of the files.
+ *
+ * @return Paths to the written files, the first one is the file which includes the others.
+ */
+std::vector<std::string> RulesetGenerator::generateFiles(const RulesetShape& shape, const std::string& directory, const std::string& prefix)
+{
+	auto files = std::max<std::size_t>(shape.files, 1);
+	std::vector<std::string> filePaths;
+	std::string includes;
+	for (std::size_t i = 0; i < files; ++i)
+	{
+		auto fileName = prefix + "_" + std::to_string(i) + ".yar";
+		filePaths.push_back((fs::path(directory) / fileName).string());
+		if (i > 0)
+			includes += "include \"" + fileName + "\"\n";
+	}
+
+	// Included files get the first parts of the rules so the entrypoint gets the last one
+	for (std::size_t i = 0; i < files; ++i)
+	{
+		auto part = (i + files - 1) % files;
+		auto rules = _generateRules(shape, part * shape.rules / files, (part + 1) * shape.rules / files);
+		std::ofstream(filePaths[i], std::ios::binary) << (i == 0 ? includes + "\n" + rules : rules);
+	}
+
+	return filePaths;
+}
+
+std::string RulesetGenerator::_generateRules(const RulesetShape& shape, std::size_t first, std::size_t last)
+{
+	std::ostringstream out;
+	if (shape.moduleTerms > 0)
+		out << "import \"math\"\nimport \"pe\"\n\n";
+
+	for (std::size_t i = first; i < last; ++i)
+		_generateRule(out, shape, i);
+	return out.str();
+}
+
+void RulesetGenerator::_generateRule(std::ostringstream& out, const RulesetShape& shape, std::size_t index)
+{
+	out << (index % 7 == 0 ? "private " : "") << "rule rule_" << index << " : tag" << index % 10 << "\n{\n"
+		<< "\tmeta:\n"
+		<< "\t\tauthor = \"yaramod\"\n"
+		<< "\t\tversion = " << index << "\n"
+		<< "\tstrings:\n"
+		<< "\t\t$s0 = \"text_" << index << "_" << _next(100000) << "\" ascii wide\n";
+
+	if (shape.hexStringLength > 0)
+	{
+		out << "\t\t$h0 = {" << std::hex << std::uppercase << std::setfill('0');
+		// Hex string has to end with a byte
+		for (std::size_t i = 0; i < shape.hexStringLength; ++i)
+		{
+			auto last = i + 1 == shape.hexStringLength;
+			if (i % 11 == 10)
+				out << " [1-" << std::dec << 2 + _next(6) << std::hex << "]";
+			if (i % 13 == 12 && !last)
+				out << " ( " << std::setw(2) << _next(256) << " | " << std::setw(2) << _next(256) << " )";
+			else if (i % 7 == 6 && !last)
+				out << " ??";
+			else
+				out << " " << std::setw(2) << _next(256);
+		}
+		out << std::dec << std::nouppercase << " }\n";
+	}
+
+	static const char* regexpParts[] = {"ab[cd]+", "(foo|bar)", "[0-9]{2,8}", "\\x4d\\x5a", "[^\\s]*", "baz?", "\\d+\\.\\d+"};
+	for (std::size_t i = 0; i < shape.regexps; ++i)
+	{
+		out << "\t\t$r" << i << " = /";
+		for (int part = 0; part < 3; ++part)
+			out << regexpParts[_next(static_cast<std::uint32_t>(std::size(regexpParts)))];
+		out << "_" << index << "/" << (i % 2 == 0 ? "i" : "s") << "\n";
+	}
+
+	out << "\tcondition:\n\t\t";
+	_generateCondition(out, shape, index);
+	out << "\n}\n\n";
+}
+
+/**
+ * Generates condition with the terms nested in parentheses to the depth of the shape,
+ * followed by the terms using modules.
+ */
+void RulesetGenerator::_generateCondition(std::ostringstream& out, const RulesetShape& shape, std::size_t index)
+{
+	for (std::size_t i = 0; i < shape.conditionDepth; ++i)
+	{
+		_generateTerm(out, shape, index, i);
+		out << (i % 2 == 0 ? " and (" : " or (");
+	}
+	_generateTerm(out, shape, index, shape.conditionDepth);
+	out << std::string(shape.conditionDepth, ')');
+
+	for (std::size_t i = 0; i < shape.moduleTerms; ++i)
+	{
+		out << " and ";
+		switch ((index + i) % 5)
+		{
+			case 0:
+				out << "pe.number_of_sections > " << _next(8);
+				break;
+			case 1:
+				out << "pe.imports(\"kernel32.dll\", \"CreateFileA\")";
+				break;
+			case 2:
+				out << "math.entropy(0, filesize) >= " << 5 + _next(3);
+				break;
+			case 3:
+				out << "for any i in (0 .. pe.number_of_sections - 1) : ( pe.sections[i].name == \".text\" )";
+				break;
+			default:
+				out << "not pe.is_dll()";
+				break;
+		}
+	}
+}
+
+void RulesetGenerator::_generateTerm(std::ostringstream& out, const RulesetShape& shape, std::size_t index, std::size_t term)
+{
+	switch ((index + term) % 6)
+	{
+		case 0:
+			out << "$s0";
+			break;
+		case 1:
+			if (shape.hexStringLength > 0)
+				out << "#h0 > " << _next(4);
+			else
+				out << "$s0 at " << _next(4096);
+			break;
+		case 2:
+			if (shape.regexps > 0)
+				out << "$r" << _next(static_cast<std::uint32_t>(shape.regexps)) << " in (0 .. filesize)";
+			else
+				out << "filesize < " << 1 + _next(1024) << "KB";
+			break;
+		case 3:
+			if (index > 0)
+				out << "rule_" << _next(static_cast<std::uint32_t>(index));
+			else
+				out << "true";
+			break;
+		case 4:
+			out << "filesize < " << 1 + _next(1024) << "KB";
+			break;
+		default:
+			out << "for any of ($s*) : ( $ at " << _next(4096) << " )";
+			break;
+	}
+}
+
+std::uint32_t RulesetGenerator::_next(std::uint32_t bound)
+{
+	return static_cast<std::uint32_t>(_random() % bound);
+}
+
+} // namespace benchmarks
+} // namespace yaramod
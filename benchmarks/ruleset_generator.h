@@ -0,0 +1,61 @@
+/**
+* @file benchmarks/ruleset_generator.h
+* @brief Deterministic generator of synthetic rulesets.
+* @copyright (c) 2026 Avast Software, licensed under the MIT license
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace yaramod {
+namespace benchmarks {
+
+/**
+ * Shape of a generated ruleset. Every rule has the same structure, only the values
+ * in it differ, so the cost of parsing grows linearly with the number of rules.
+ */
+struct RulesetShape
+{
+	std::size_t rules = 1000; ///< Number of rules
+	std::size_t conditionDepth = 2; ///< Number of nested parenthesized boolean operations in every condition
+	std::size_t hexStringLength = 16; ///< Number of bytes of the hex string of every rule, 0 for no hex string
+	std::size_t regexps = 1; ///< Number of regular expressions of every rule
+	std::size_t moduleTerms = 1; ///< Number of terms using modules in every condition
+	std::size_t files = 1; ///< Number of files the rules are split into, all but the first one are included from it
+};
+
+/**
+ * Generator of synthetic rulesets of the given shape. The same seed always
+ * generates the same rulesets on every platform.
+ */
+class RulesetGenerator
+{
+public:
+	/// @name Constructors
+	/// @{
+	explicit RulesetGenerator(std::uint32_t seed = 1);
+	/// @}
+
+	/// @name Generation
+	/// @{
+	std::string generate(const RulesetShape& shape);
+	std::vector<std::string> generateFiles(const RulesetShape& shape, const std::string& directory, const std::string& prefix);
+	/// @}
+
+private:
+	std::string _generateRules(const RulesetShape& shape, std::size_t first, std::size_t last);
+	void _generateRule(std::ostringstream& out, const RulesetShape& shape, std::size_t index);
+	void _generateCondition(std::ostringstream& out, const RulesetShape& shape, std::size_t index);
+	void _generateTerm(std::ostringstream& out, const RulesetShape& shape, std::size_t index, std::size_t term);
+	std::uint32_t _next(std::uint32_t bound);
+
+	std::mt19937 _random; ///< Source of the values, distributions are not used because they differ between platforms
+};
+
+} // namespace benchmarks
+} // namespace yaramod
@@ -0,0 +1,94 @@
+/**
+* @file benchmarks/token_stream_benchmarks.cpp
+* @brief Benchmarks of storage of tokens.
+* @copyright (c) 2026 Avast Software, licensed under the MIT license
+*/
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "allocation_counter.h"
+#include "yaramod/types/token.h"
+
+namespace yaramod {
+namespace benchmarks {
+
+namespace {
+
+constexpr std::size_t TokensCount = 100000;
+
+/**
+ * Fills the list with tokens the same way parser does. Each token is accompanied by an unrelated
+ * allocation, like a string or an expression of the AST, which scatters the tokens in memory
+ * unless they are allocated from their own pool.
+ */
+template <typename List>
+void fillTokens(List& tokens, std::vector<std::string>& unrelated)
+{
+	for (std::size_t i = 0; i < TokensCount; ++i)
+	{
+		if (i % 2 == 0)
+			tokens.emplace_back(TokenType::RULE_NAME, Literal("identifier_" + std::to_string(i)));
+		else
+			tokens.emplace_back(TokenType::INTEGER, Literal(static_cast<std::int64_t>(i)));
+		unrelated.emplace_back(32 + i % 64, 'x');
+	}
+}
+
+template <typename List>
+std::size_t traverseTokens(const List& tokens)
+{
+	std::size_t sum = 0;
+	for (const auto& token : tokens)
+		sum += static_cast<std::size_t>(token.getType()) + token.isInt();
+	return sum;
+}
+
+} // namespace
+
+/**
+ * Construction and destruction of the token list. Reports the number of heap allocations
+ * and allocated bytes per token including the unrelated allocations.
+ */
+template <typename List>
+static void TokenListConstruction(benchmark::State& state)
+{
+	auto before = allocationStats();
+	for (auto _ : state)
+	{
+		List tokens;
+		std::vector<std::string> unrelated;
+		unrelated.reserve(TokensCount);
+		fillTokens(tokens, unrelated);
+		benchmark::DoNotOptimize(tokens);
+	}
+	auto allocations = allocationStats() - before;
+	auto tokens = static_cast<double>(state.iterations() * TokensCount);
+	state.counters["allocs/token"] = static_cast<double>(allocations.count) / tokens;
+	state.counters["bytes/token"] = static_cast<double>(allocations.bytes) / tokens;
+	state.SetItemsProcessed(state.iterations() * TokensCount);
+}
+BENCHMARK_TEMPLATE(TokenListConstruction, std::list<Token>)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(TokenListConstruction, TokenList)->Unit(benchmark::kMillisecond);
+
+/**
+ * Traversal of already constructed token list.
+ */
+template <typename List>
+static void TokenListTraversal(benchmark::State& state)
+{
+	List tokens;
+	std::vector<std::string> unrelated;
+	fillTokens(tokens, unrelated);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(traverseTokens(tokens));
+	state.SetItemsProcessed(state.iterations() * TokensCount);
+}
+BENCHMARK_TEMPLATE(TokenListTraversal, std::list<Token>)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(TokenListTraversal, TokenList)->Unit(benchmark::kMicrosecond);
+
+} // namespace benchmarks
+} // namespace yaramod
@@ -0,0 +1,357 @@
+/**
+* @file benchmarks/yara_file_benchmarks.cpp
+* @brief Benchmarks of operations on parsed rulesets.
+* @copyright (c) 2026 Avast Software, licensed under the MIT license
+*/
+
+#include <sstream>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "allocation_counter.h"
+#include "ruleset_generator.h"
+#include "yaramod/parser/parser_driver.h"
+#include "yaramod/utils/modifying_visitor.h"
+#include "yaramod/utils/observing_visitor.h"
+#include "yaramod/utils/static_visitor.h"
+
+namespace yaramod {
+namespace benchmarks {
+
+namespace {
+
+/**
+ * Counts the boolean operations and identifiers in the observed expressions.
+ */
+class NodeCounter : public ObservingVisitor
+{
+public:
+	virtual VisitResult visit(AndExpression* expr) override
+	{
+		++nodes;
+		return ObservingVisitor::visit(expr);
+	}
+
+	virtual VisitResult visit(OrExpression* expr) override
+	{
+		++nodes;
+		return ObservingVisitor::visit(expr);
+	}
+
+	virtual VisitResult visit(IdExpression* expr) override
+	{
+		++nodes;
+		return ObservingVisitor::visit(expr);
+	}
+
+	std::size_t nodes = 0;
+};
+
+/**
+ * Counts the boolean operations and identifiers in the observed expressions without virtual dispatch.
+ */
+class StaticNodeCounter : public StaticObservingVisitor<StaticNodeCounter>
+{
+public:
+	using StaticObservingVisitor<StaticNodeCounter>::visit;
+
+	bool visit(AndExpression* expr)
+	{
+		++nodes;
+		return StaticObservingVisitor<StaticNodeCounter>::visit(expr);
+	}
+
+	bool visit(OrExpression* expr)
+	{
+		++nodes;
+		return StaticObservingVisitor<StaticNodeCounter>::visit(expr);
+	}
+
+	bool visit(IdExpression*)
+	{
+		++nodes;
+		return true;
+	}
+
+	std::size_t nodes = 0;
+};
+
+/**
+ * Collects the boolean operations, comparisons, identifiers and literals of the observed expressions.
+ */
+class NodeCollector : public ObservingVisitor
+{
+public:
+	virtual VisitResult visit(AndExpression* expr) override { return collect(expr); }
+	virtual VisitResult visit(OrExpression* expr) override { return collect(expr); }
+	virtual VisitResult visit(EqExpression* expr) override { return collect(expr); }
+	virtual VisitResult visit(LtExpression* expr) override { return collect(expr); }
+	virtual VisitResult visit(GtExpression* expr) override { return collect(expr); }
+	virtual VisitResult visit(IdExpression* expr) override { return collect(expr); }
+	virtual VisitResult visit(StructAccessExpression* expr) override { return collect(expr); }
+	virtual VisitResult visit(FunctionCallExpression* expr) override { return collect(expr); }
+	virtual VisitResult visit(IntLiteralExpression* expr) override { return collect(expr); }
+	virtual VisitResult visit(StringExpression* expr) override { return collect(expr); }
+
+	std::vector<Expression*> nodes;
+
+private:
+	template <typename T>
+	VisitResult collect(T* expr)
+	{
+		nodes.push_back(expr);
+		return ObservingVisitor::visit(expr);
+	}
+};
+
+/**
+ * Visits every node of the modified expressions without changing any of them.
+ */
+class IdentityModifier : public ModifyingVisitor
+{
+};
+
+/**
+ * Parses the generated ruleset with the shape which has the number of rules given by the benchmark.
+ */
+std::unique_ptr<ParserDriver> parseGenerated(benchmark::State& state, RulesetShape shape = {})
+{
+	shape.rules = state.range(0);
+	auto ruleset = RulesetGenerator().generate(shape);
+	auto driver = std::make_unique<ParserDriver>();
+	driver->parse(std::string_view{ruleset});
+	return driver;
+}
+
+/**
+ * Parses the rule with the condition made of a chain of `or` operations with the number of terms given by the benchmark.
+ */
+std::unique_ptr<ParserDriver> parseDeepChain(benchmark::State& state)
+{
+	std::string rule = "rule deep { condition: filesize == 0";
+	for (std::int64_t i = 1; i < state.range(0); ++i)
+		rule += " or filesize == " + std::to_string(i);
+	rule += " }";
+
+	auto driver = std::make_unique<ParserDriver>();
+	driver->parse(std::string_view{rule});
+	return driver;
+}
+
+} // namespace
+
+/**
+ * Printing of a parsed ruleset, either formatted or as it was parsed.
+ */
+static void GetText(benchmark::State& state, bool formatted)
+{
+	auto driver = parseGenerated(state);
+	const auto& file = driver->getParsedFile();
+	std::size_t bytes = 0;
+	for (auto _ : state)
+	{
+		auto text = formatted ? file.getTextFormatted() : file.getText();
+		bytes += text.size();
+		benchmark::DoNotOptimize(text);
+	}
+	state.SetBytesProcessed(bytes);
+}
+BENCHMARK_CAPTURE(GetText, Formatted, true)->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(GetText, Unformatted, false)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Writing of the formatted text of a parsed ruleset into a reused string or into a stream.
+ * Reports heap allocations made per written ruleset.
+ */
+static void WriteTextFormatted(benchmark::State& state, bool toStream)
+{
+	auto driver = parseGenerated(state);
+	const auto& file = driver->getParsedFile();
+	std::size_t bytes = 0;
+	std::string text;
+	file.writeTextFormatted(text);
+	auto before = allocationStats();
+	for (auto _ : state)
+	{
+		if (toStream)
+		{
+			std::ostringstream stream;
+			file.writeTextFormatted(stream);
+			bytes += static_cast<std::size_t>(stream.tellp());
+		}
+		else
+		{
+			text.clear();
+			file.writeTextFormatted(text);
+			bytes += text.size();
+			benchmark::DoNotOptimize(text);
+		}
+	}
+	auto allocations = allocationStats() - before;
+	state.SetBytesProcessed(bytes);
+	state.counters["allocs/iter"] = static_cast<double>(allocations.count) / static_cast<double>(state.iterations());
+}
+BENCHMARK_CAPTURE(WriteTextFormatted, String, false)->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(WriteTextFormatted, Stream, true)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Cloning of the conditions of all rules of a parsed ruleset into a new token stream.
+ */
+static void CloneConditions(benchmark::State& state)
+{
+	auto driver = parseGenerated(state, RulesetShape{0, 8});
+	const auto& rules = driver->getParsedFile().getRules();
+	for (auto _ : state)
+	{
+		auto tokenStream = std::make_shared<TokenStream>();
+		for (const auto& rule : rules)
+			benchmark::DoNotOptimize(rule->getCondition()->clone(tokenStream));
+	}
+	state.counters["rules"] = benchmark::Counter(static_cast<double>(state.iterations() * rules.size()), benchmark::Counter::kIsRate);
+}
+BENCHMARK(CloneConditions)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Traversal of the conditions of all rules of a parsed ruleset by an observing visitor.
+ */
+static void ObserveConditions(benchmark::State& state)
+{
+	auto driver = parseGenerated(state, RulesetShape{0, 8});
+	const auto& rules = driver->getParsedFile().getRules();
+	std::size_t nodes = 0;
+	for (auto _ : state)
+	{
+		NodeCounter counter;
+		for (const auto& rule : rules)
+			counter.observe(rule->getCondition());
+		nodes += counter.nodes;
+	}
+	state.counters["nodes"] = benchmark::Counter(static_cast<double>(nodes), benchmark::Counter::kIsRate);
+}
+BENCHMARK(ObserveConditions)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Traversal of the conditions of all rules of a parsed ruleset by a static observing visitor.
+ */
+static void ObserveConditionsStatically(benchmark::State& state)
+{
+	auto driver = parseGenerated(state, RulesetShape{0, 8});
+	const auto& rules = driver->getParsedFile().getRules();
+	std::size_t nodes = 0;
+	for (auto _ : state)
+	{
+		StaticNodeCounter counter;
+		for (const auto& rule : rules)
+			counter.observe(rule->getCondition());
+		nodes += counter.nodes;
+	}
+	state.counters["nodes"] = benchmark::Counter(static_cast<double>(nodes), benchmark::Counter::kIsRate);
+}
+BENCHMARK(ObserveConditionsStatically)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Traversal of the conditions of all rules of a parsed ruleset by a modifying visitor
+ * which keeps the conditions as they are.
+ */
+static void ModifyConditions(benchmark::State& state)
+{
+	auto driver = parseGenerated(state, RulesetShape{0, 8});
+	const auto& rules = driver->getParsedFile().getRules();
+	// Conditions are never deleted, the replacement only completes the usage of modify() as in the examples
+	Expression::Ptr whenDeleted = std::make_shared<BoolLiteralExpression>(false);
+	for (auto _ : state)
+	{
+		IdentityModifier modifier;
+		for (const auto& rule : rules)
+		{
+			auto condition = modifier.modify(rule->getCondition(), whenDeleted);
+			benchmark::DoNotOptimize(condition);
+		}
+	}
+	state.counters["rules"] = benchmark::Counter(static_cast<double>(state.iterations() * rules.size()), benchmark::Counter::kIsRate);
+}
+BENCHMARK(ModifyConditions)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Operations on the condition which is a chain of 100k `or` operations.
+ */
+static void DeepChainGetText(benchmark::State& state)
+{
+	auto driver = parseDeepChain(state);
+	const auto& condition = driver->getParsedFile().getRules()[0]->getCondition();
+	for (auto _ : state)
+		benchmark::DoNotOptimize(condition->getText());
+}
+BENCHMARK(DeepChainGetText)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+static void DeepChainClone(benchmark::State& state)
+{
+	auto driver = parseDeepChain(state);
+	const auto& condition = driver->getParsedFile().getRules()[0]->getCondition();
+	for (auto _ : state)
+		benchmark::DoNotOptimize(condition->clone(std::make_shared<TokenStream>()));
+}
+BENCHMARK(DeepChainClone)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+static void DeepChainObserve(benchmark::State& state)
+{
+	auto driver = parseDeepChain(state);
+	const auto& condition = driver->getParsedFile().getRules()[0]->getCondition();
+	for (auto _ : state)
+	{
+		StaticNodeCounter counter;
+		counter.observe(condition);
+		benchmark::DoNotOptimize(counter.nodes);
+	}
+}
+BENCHMARK(DeepChainObserve)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+static void DeepChainParseAndDestroy(benchmark::State& state)
+{
+	for (auto _ : state)
+		parseDeepChain(state);
+}
+BENCHMARK(DeepChainParseAndDestroy)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Casts of the nodes of the conditions of all rules of a parsed ruleset to the abstract
+ * and concrete expression classes, either by the kind of the expression or by RTTI.
+ */
+static void CastExpressions(benchmark::State& state, bool rtti)
+{
+	auto driver = parseGenerated(state, RulesetShape{0, 8});
+	NodeCollector collector;
+	for (const auto& rule : driver->getParsedFile().getRules())
+		collector.observe(rule->getCondition());
+
+	std::size_t matches = 0;
+	for (auto _ : state)
+	{
+		for (auto* node : collector.nodes)
+		{
+			if (rtti)
+			{
+				matches += dynamic_cast<BinaryOpExpression*>(node) != nullptr;
+				matches += dynamic_cast<IdExpression*>(node) != nullptr;
+				matches += dynamic_cast<FunctionCallExpression*>(node) != nullptr;
+				matches += dynamic_cast<LiteralExpression<std::uint64_t>*>(node) != nullptr;
+			}
+			else
+			{
+				matches += node->as<BinaryOpExpression>() != nullptr;
+				matches += node->as<IdExpression>() != nullptr;
+				matches += node->as<FunctionCallExpression>() != nullptr;
+				matches += node->as<LiteralExpression<std::uint64_t>>() != nullptr;
+			}
+		}
+		benchmark::ClobberMemory();
+	}
+	benchmark::DoNotOptimize(matches);
+	state.counters["casts"] = benchmark::Counter(static_cast<double>(state.iterations() * collector.nodes.size() * 4), benchmark::Counter::kIsRate);
+}
+BENCHMARK_CAPTURE(CastExpressions, Kind, false)->Arg(1000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(CastExpressions, RTTI, true)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+} // namespace benchmarks
+} // namespace yaramod
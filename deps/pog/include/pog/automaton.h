@@ -35,6 +35,22 @@ public:
 		return _states[index].get();
 	}
 
+	// Creates given number of states without any items or transitions. Used when the parsing table
+	// is loaded from its serialized form and the states are only needed as its indices.
+	void restore_states(std::size_t count)
+	{
+		clear();
+		_states.reserve(count);
+		for (std::size_t i = 0; i < count; ++i)
+			_states.push_back(std::make_unique<StateType>(static_cast<std::uint32_t>(i)));
+	}
+
+	void clear()
+	{
+		_states.clear();
+		_state_to_index.clear();
+	}
+
 	template <typename StateT>
 	std::pair<StateType*, bool> add_state(StateT&& state)
 	{
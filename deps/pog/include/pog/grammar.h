@@ -1,9 +1,13 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <unordered_set>
 #include <vector>
 
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
 #include <pog/rule.h>
 #include <pog/symbol.h>
 #include <pog/token.h>
@@ -87,9 +91,7 @@ public:
 
 	void set_start_symbol(const SymbolType* symbol)
 	{
-		auto start_rule = add_rule(_internal_start_symbol, std::vector<const SymbolType*>{symbol, _internal_end_of_input}, [](auto&& args) {
-			return std::move(args[0]);
-		});
+		auto start_rule = add_rule(_internal_start_symbol, std::vector<const SymbolType*>{symbol, _internal_end_of_input});
 		start_rule->set_start_rule(true);
 		_start_rule = start_rule;
 	}
@@ -104,13 +106,50 @@ public:
 		return _symbols.back().get();
 	}
 
-	template <typename CallbackT>
-	RuleType* add_rule(const SymbolType* lhs, const std::vector<const SymbolType*>& rhs, CallbackT&& action)
+	RuleType* add_rule(const SymbolType* lhs, const std::vector<const SymbolType*>& rhs)
 	{
-		_rules.push_back(std::make_unique<RuleType>(static_cast<std::uint32_t>(_rules.size()), lhs, rhs, std::forward<CallbackT>(action)));
+		_rules.push_back(std::make_unique<RuleType>(static_cast<std::uint32_t>(_rules.size()), lhs, rhs));
 		return _rules.back().get();
 	}
 
+	// Stable hash of all symbols and rules. Two grammars with the same fingerprint
+	// produce the same parsing table so it can be used to validate persisted tables.
+	std::uint64_t fingerprint() const
+	{
+		auto precedence_str = [](const Precedence& prec) {
+			return fmt::format("{}{}", prec.level, prec.assoc == Associativity::Left ? 'L' : 'R');
+		};
+
+		std::uint64_t result = fnv1a_hash("");
+		for (const auto& sym : _symbols)
+		{
+			result = fnv1a_hash(fmt::format("S{}:{}:{}:{};",
+				sym->get_index(),
+				sym->is_end() ? 'E' : (sym->is_nonterminal() ? 'N' : 'T'),
+				sym->get_name(),
+				sym->has_precedence() ? precedence_str(sym->get_precedence()) : "-"
+			), result);
+		}
+
+		for (const auto& rule : _rules)
+		{
+			std::vector<std::uint32_t> rhs(rule->get_rhs().size());
+			std::transform(rule->get_rhs().begin(), rule->get_rhs().end(), rhs.begin(), [](const auto* sym) {
+				return sym->get_index();
+			});
+			result = fnv1a_hash(fmt::format("R{}:{}:{}:{}:{}:{};",
+				rule->get_index(),
+				rule->get_lhs()->get_index(),
+				fmt::join(rhs.begin(), rhs.end(), ","),
+				rule->has_precedence() ? precedence_str(rule->get_precedence()) : "-",
+				rule->is_midrule() ? std::to_string(rule->get_midrule_size()) : "-",
+				rule->is_start_rule()
+			), result);
+		}
+
+		return result;
+	}
+
 	bool empty(const SymbolType* sym) const
 	{
 		std::unordered_set<const SymbolType*> visited_lhss;
@@ -93,11 +93,11 @@ private:
 	{
 		using namespace fmt;
 
-		if (_parser._report)
+		if (_parser._definition->get_report())
 			return std::string{};
 
-		std::vector<std::string> issues(_parser._report.number_of_issues());
-		std::transform(_parser._report.begin(), _parser._report.end(), issues.begin(), [](const auto& issue) {
+		std::vector<std::string> issues(_parser._definition->get_report().number_of_issues());
+		std::transform(_parser._definition->get_report().begin(), _parser._definition->get_report().end(), issues.begin(), [](const auto& issue) {
 			return fmt::format("<li><span>{}</span></li>", visit_with(issue,
 				[&](const ShiftReduceConflict<ValueT>& sr) { return sr.to_string("→", "ε"); },
 				[&](const ReduceReduceConflict<ValueT>& rr) { return rr.to_string("→", "ε"); }
@@ -121,8 +121,8 @@ private:
 	{
 		using namespace fmt;
 
-		auto terminal_symbols = _parser._grammar.get_terminal_symbols();
-		auto nonterminal_symbols = _parser._grammar.get_nonterminal_symbols();
+		auto terminal_symbols = _parser._definition->get_grammar()->get_terminal_symbols();
+		auto nonterminal_symbols = _parser._definition->get_grammar()->get_nonterminal_symbols();
 
 		std::vector<std::string> symbol_headers(terminal_symbols.size() + nonterminal_symbols.size());
 		std::transform(terminal_symbols.begin(), terminal_symbols.end(), symbol_headers.begin(), [](const auto& s) {
@@ -132,8 +132,8 @@ private:
 			return fmt::format("<th>{}</th>", s->get_name());
 		});
 
-		std::vector<std::string> rows(_parser._automaton.get_states().size());
-		for (const auto& state : _parser._automaton.get_states())
+		std::vector<std::string> rows(_parser._definition->get_automaton().get_states().size());
+		for (const auto& state : _parser._definition->get_automaton().get_states())
 		{
 			std::vector<std::string> row;
 			row.push_back(fmt::format(
@@ -143,7 +143,7 @@ private:
 			));
 			for (const auto& sym : terminal_symbols)
 			{
-				auto action = _parser._parsing_table.get_action(state.get(), sym);
+				auto action = _parser._definition->get_parsing_table().get_action(state.get(), sym);
 				if (!action)
 				{
 					row.push_back("<td></td>");
@@ -171,7 +171,7 @@ private:
 
 			for (const auto& sym : nonterminal_symbols)
 			{
-				auto go_to = _parser._parsing_table.get_transition(state.get(), sym);
+				auto go_to = _parser._definition->get_parsing_table().get_transition(state.get(), sym);
 				if (!go_to)
 				{
 					row.push_back("<td></td>");
@@ -235,7 +235,7 @@ private:
 			</div>)";
 
 		std::vector<std::string> states;
-		for (const auto& state : _parser._automaton.get_states())
+		for (const auto& state : _parser._definition->get_automaton().get_states())
 		{
 			std::vector<std::string> cols(state->size());
 			std::transform(state->begin(), state->end(), cols.begin(), [](const auto& item) {
@@ -273,7 +273,7 @@ private:
 					</button>
 				</div>
 			</div>)",
-			"automaton"_a = _parser._automaton.generate_graph()
+			"automaton"_a = _parser._definition->get_automaton().generate_graph()
 		);
 	}
 
@@ -2,6 +2,9 @@
 
 #include <cassert>
 #include <deque>
+#include <memory>
+#include <optional>
+#include <string_view>
 
 #include <fmt/format.h>
 
@@ -16,23 +19,15 @@
 #endif
 
 #include <pog/action.h>
-#include <pog/automaton.h>
 #include <pog/errors.h>
-#include <pog/grammar.h>
-#include <pog/parser_report.h>
-#include <pog/parsing_table.h>
+#include <pog/parser_definition.h>
+#include <pog/parser_listener.h>
 #include <pog/rule_builder.h>
 #include <pog/state.h>
 #include <pog/symbol.h>
 #include <pog/token_builder.h>
 #include <pog/tokenizer.h>
 
-#include <pog/operations/read.h>
-#include <pog/operations/follow.h>
-#include <pog/operations/lookahead.h>
-#include <pog/relations/includes.h>
-#include <pog/relations/lookback.h>
-
 namespace pog {
 
 template <typename ValueT>
@@ -62,9 +57,9 @@ public:
 	using TokenType = Token<ValueT>;
 	using TokenizerType = Tokenizer<ValueT>;
 
-	Parser() : _grammar(), _tokenizer(&_grammar), _automaton(&_grammar), _includes(&_automaton, &_grammar),
-		_lookback(&_automaton, &_grammar), _read_operation(&_automaton, &_grammar), _follow_operation(&_automaton, &_grammar, _includes, _read_operation),
-		_lookahead_operation(&_automaton, &_grammar, _lookback, _follow_operation), _parsing_table(&_automaton, &_grammar, _lookahead_operation)
+	using DefinitionType = ParserDefinition<ValueT>;
+
+	Parser() : _own_definition(std::make_shared<DefinitionType>()), _definition(), _tokenizer(), _rule_actions(), _listener(), _rule_builders(), _token_builders()
 	{
 		static_assert(std::is_default_constructible_v<ValueT>, "Value type needs to be default constructible");
 	}
@@ -72,44 +67,61 @@ public:
 	Parser(const Parser<ValueT>&) = delete;
 	Parser(Parser<ValueT>&&) noexcept = default;
 
-	const ParserReportType& prepare()
+	// Builds the grammar out of defined tokens and rules and calculates the parsing table. If serialized table
+	// is provided, it is loaded instead of calculation when it belongs to the same grammar.
+	const ParserReportType& prepare(std::optional<std::string_view> serialized_table = std::nullopt)
 	{
-		for (auto& tb : _token_builders)
-			tb.done();
-		for (auto& rb : _rule_builders)
-			rb.done();
-		_automaton.construct_states();
-		_includes.calculate();
-		_lookback.calculate();
-		_read_operation.calculate();
-		_follow_operation.calculate();
-		_lookahead_operation.calculate();
-		_parsing_table.calculate(_report);
-		_tokenizer.prepare();
-		return _report;
+		prepare_builders();
+		_own_definition->prepare(serialized_table);
+		return use_definition(std::move(_own_definition));
+	}
+
+	// Prepares the parser using the definition of other parser which has the same tokens and rules defined
+	// in the same order. The grammar and parsing table are shared and only actions of this parser are used.
+	const ParserReportType& prepare(const std::shared_ptr<const DefinitionType>& definition)
+	{
+		assert(definition->is_prepared() && "Shared parser definition needs to be prepared");
+		_own_definition.reset();
+		return use_definition(definition);
+	}
+
+	const std::shared_ptr<const DefinitionType>& get_definition() const
+	{
+		return _definition;
+	}
+
+	std::string serialize_parsing_table() const
+	{
+		return _definition->serialize_parsing_table();
+	}
+
+	bool is_parsing_table_loaded() const
+	{
+		return _definition->is_parsing_table_loaded();
 	}
 
 	TokenBuilderType& token(const std::string& pattern)
 	{
-		_token_builders.emplace_back(&_grammar, &_tokenizer, pattern);
+		_token_builders.emplace_back(_own_definition->get_grammar(), _own_definition->get_tokenizer_definition(), pattern);
 		return _token_builders.back();
 	}
 
 	TokenBuilderType& end_token()
 	{
-		_token_builders.emplace_back(&_grammar, &_tokenizer);
+		_token_builders.emplace_back(_own_definition->get_grammar(), _own_definition->get_tokenizer_definition());
 		return _token_builders.back();
 	}
 
 	RuleBuilderType& rule(const std::string& lhs)
 	{
-		_rule_builders.emplace_back(&_grammar, lhs);
+		_rule_builders.emplace_back(_own_definition->get_grammar(), lhs);
 		return _rule_builders.back();
 	}
 
 	void set_start_symbol(const std::string& name)
 	{
-		_grammar.set_start_symbol(_grammar.add_symbol(SymbolKind::Nonterminal, name));
+		auto* grammar = _own_definition->get_grammar();
+		grammar->set_start_symbol(grammar->add_symbol(SymbolKind::Nonterminal, name));
 	}
 
 	void enter_tokenizer_state(const std::string& state_name)
@@ -122,11 +134,27 @@ public:
 		_tokenizer.push_input_stream(input);
 	}
 
+	void push_input_stream(std::string_view input)
+	{
+		_tokenizer.push_input_stream(input);
+	}
+
 	void pop_input_stream()
 	{
 		_tokenizer.pop_input_stream();
 	}
 
+	std::optional<std::string_view> get_remaining_input(std::size_t index) const
+	{
+		return _tokenizer.get_remaining_input(index);
+	}
+
+	// Listener is not owned by the parser, nullptr turns the notifications off
+	void set_listener(ParserListener* listener)
+	{
+		_listener = listener;
+	}
+
 	void global_tokenizer_action(typename TokenizerType::CallbackType&& global_action)
 	{
 		_tokenizer.global_action(std::move(global_action));
@@ -134,25 +162,56 @@ public:
 
 	std::optional<ValueT> parse(std::istream& input)
 	{
-		_tokenizer.enter_state(std::string{decltype(_tokenizer)::DefaultState});
+		_tokenizer.clear_input_streams();
+		_tokenizer.push_input_stream(input);
+		return parse_input();
+	}
 
-		std::optional<TokenMatchType> token;
+	std::optional<ValueT> parse(std::string_view input)
+	{
 		_tokenizer.clear_input_streams();
 		_tokenizer.push_input_stream(input);
+		return parse_input();
+	}
+
+	std::string generate_automaton_graph()
+	{
+		return _definition->generate_automaton_graph();
+	}
+
+	std::string generate_includes_relation_graph()
+	{
+		return _definition->generate_includes_relation_graph();
+	}
+
+private:
+	std::optional<ValueT> parse_input()
+	{
+		const auto& automaton = _definition->get_automaton();
+		const auto& parsing_table = _definition->get_parsing_table();
+
+		_tokenizer.enter_state(std::string{decltype(_tokenizer)::DefaultState});
+
+		std::optional<TokenMatchType> token;
 
 		std::deque<std::pair<std::uint32_t, std::optional<ValueT>>> stack;
 		stack.emplace_back(0, std::nullopt);
 
+		std::vector<ValueT> action_arg;
+
 		while (!stack.empty())
 		{
 			// Check if we remember token from the last iteration because we did reduction
 			// so the token was not "consumed" from the input.
 			if (!token)
 			{
-				token = _tokenizer.next_token();
+				{
+					ParsingPhaseGuard guard(_listener, ParsingPhase::Tokenizing);
+					token = _tokenizer.next_token();
+				}
 				if (!token)
 				{
-					auto expected_symbols = _parsing_table.get_expected_symbols_from_state(_automaton.get_state(stack.back().first));
+					auto expected_symbols = parsing_table.get_expected_symbols_from_state(automaton.get_state(stack.back().first));
 					throw SyntaxError(expected_symbols);
 				}
 
@@ -164,10 +223,10 @@ public:
 			debug_parser("Top of the stack is state {}", stack.back().first);
 
 			const auto* next_symbol = token.value().symbol;
-			auto maybe_action = _parsing_table.get_action(_automaton.get_state(stack.back().first), next_symbol);
+			auto maybe_action = parsing_table.get_action(automaton.get_state(stack.back().first), next_symbol);
 			if (!maybe_action)
 			{
-				auto expected_symbols = _parsing_table.get_expected_symbols_from_state(_automaton.get_state(stack.back().first));
+				auto expected_symbols = parsing_table.get_expected_symbols_from_state(automaton.get_state(stack.back().first));
 				throw SyntaxError(next_symbol, expected_symbols);
 			}
 
@@ -181,33 +240,31 @@ public:
 				// Each symbol on right-hand side of the rule should have record on the stack
 				// We'll pop them out and put them in reverse order so user have them available
 				// left-to-right and not right-to-left.
-				std::vector<ValueT> action_arg;
-				action_arg.reserve(reduce.rule->get_number_of_required_arguments_for_action());
-				assert(stack.size() >= action_arg.capacity() && "Stack is too small");
+				// The vector is reused by all reductions so it doesn't need to be allocated every time
+				auto args_count = reduce.rule->get_number_of_required_arguments_for_action();
+				action_arg.clear();
+				assert(stack.size() >= args_count && "Stack is too small");
 
-				for (std::size_t i = 0; i < action_arg.capacity(); ++i)
+				for (std::size_t i = args_count; i > 0; --i)
 				{
-					// Notice how std::move() is only around optional itself and not the whole expressions
-					// We need to do this in order to perform move together with value_or()
-					// See: https://en.cppreference.com/w/cpp/utility/optional/value_or
-					// std::move(*this) is performed only when value_or() is called from r-value
-					//
-					// Also do not pop from stack here because midrule actions can still return us arguments back
-					action_arg.insert(action_arg.begin(), std::move(stack[stack.size() - i - 1].second).value_or(ValueT{}));
+					// Do not pop from stack here because midrule actions can still return us arguments back
+					auto& record = stack[stack.size() - i].second;
+					action_arg.push_back(record ? std::move(record).value() : ValueT{});
 				}
 
 				// What left on the stack now determines what state we get into now
 				// We use size of RHS to determine stack top because midrule actions might have only borrowed something from stack so the
 				// real stack top is not the actual top. Midrule actions have 0 RHS size even though they borrow items. Other rules
 				// have same size of RHS and what they take out of stack.
-				auto maybe_next_state = _parsing_table.get_transition(_automaton.get_state(stack[stack.size() - reduce.rule->get_rhs().size() - 1].first), reduce.rule->get_lhs());
+				auto maybe_next_state = parsing_table.get_transition(automaton.get_state(stack[stack.size() - reduce.rule->get_rhs().size() - 1].first), reduce.rule->get_lhs());
 				if (!maybe_next_state)
 				{
 					assert(false && "Reduction happened but corresponding GOTO table record is empty");
 					return std::nullopt;
 				}
 
-				auto action_result = reduce.rule->has_action() ? reduce.rule->perform_action(std::move(action_arg)) : ValueT{};
+				const auto& rule_action = _rule_actions[reduce.rule->get_index()];
+				auto action_result = perform_action(rule_action, std::move(action_arg));
 
 				// Midrule actions only borrowed arguments and it is returning them back
 				if (reduce.rule->is_midrule())
@@ -261,31 +318,71 @@ public:
 		return std::nullopt;
 	}
 
-	std::string generate_automaton_graph()
+	ValueT perform_action(const typename RuleType::CallbackType& rule_action, std::vector<ValueT>&& action_arg)
 	{
-		return _automaton.generate_graph();
+		ParsingPhaseGuard guard(_listener, ParsingPhase::Action);
+		return rule_action ? rule_action(std::move(action_arg)) : ValueT{};
 	}
 
-	std::string generate_includes_relation_graph()
+	void prepare_builders()
+	{
+		for (auto& tb : _token_builders)
+			tb.done();
+		for (auto& rb : _rule_builders)
+			rb.done();
+	}
+
+	// Actions are stored by the indices of tokens and rules. Builders create tokens and rules in the grammar
+	// in the order in which they were defined so the indices can be determined even when done() of the builders
+	// was never called because the definition comes from the other parser.
+	const ParserReportType& use_definition(std::shared_ptr<const DefinitionType> definition)
 	{
-		return _includes.generate_relation_graph();
+		_definition = std::move(definition);
+
+		const auto* grammar = _definition->get_grammar();
+		const auto* tokenizer_definition = _definition->get_tokenizer_definition();
+
+		std::vector<typename TokenType::CallbackType> token_actions(tokenizer_definition->get_tokens().size());
+		std::size_t token_index = 1; // 0 is always the end token
+		for (auto& tb : _token_builders)
+		{
+			auto action = tb.take_action();
+			auto index = tb.is_end_token() ? 0 : token_index++;
+			assert(index < token_actions.size() && "Token builders do not match the parser definition");
+			if (action)
+				token_actions[index] = std::move(action);
+		}
+		assert(token_index == token_actions.size() && "Token builders do not match the parser definition");
+
+		const auto* start_rule = grammar->get_start_rule();
+		_rule_actions.clear();
+		_rule_actions.resize(grammar->get_rules().size());
+		std::size_t rule_index = 0;
+		for (auto& rb : _rule_builders)
+		{
+			for (auto&& action : rb.take_actions())
+			{
+				if (start_rule && start_rule->get_index() == rule_index)
+					rule_index++;
+				assert(rule_index < _rule_actions.size() && "Rule builders do not match the parser definition");
+				_rule_actions[rule_index++] = std::move(action);
+			}
+		}
+
+		_tokenizer.prepare(grammar, tokenizer_definition, std::move(token_actions));
+		_token_builders.clear();
+		_rule_builders.clear();
+		return _definition->get_report();
 	}
 
-private:
-	Grammar<ValueT> _grammar;
+	std::shared_ptr<DefinitionType> _own_definition;
+	std::shared_ptr<const DefinitionType> _definition;
 	Tokenizer<ValueT> _tokenizer;
-	Automaton<ValueT> _automaton;
-	Includes<ValueT> _includes;
-	Lookback<ValueT> _lookback;
-	Read<ValueT> _read_operation;
-	Follow<ValueT> _follow_operation;
-	Lookahead<ValueT> _lookahead_operation;
-	ParsingTable<ValueT> _parsing_table;
+	std::vector<typename RuleType::CallbackType> _rule_actions;
+	ParserListener* _listener = nullptr;
 
 	std::vector<RuleBuilderType> _rule_builders;
 	std::vector<TokenBuilderType> _token_builders;
-
-	ParserReportType _report;
 };
 
 } // namespace pog
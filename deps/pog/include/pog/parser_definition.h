@@ -0,0 +1,124 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <pog/automaton.h>
+#include <pog/grammar.h>
+#include <pog/parser_report.h>
+#include <pog/parsing_table.h>
+#include <pog/tokenizer_definition.h>
+
+#include <pog/operations/read.h>
+#include <pog/operations/follow.h>
+#include <pog/operations/lookahead.h>
+#include <pog/relations/includes.h>
+#include <pog/relations/lookback.h>
+
+namespace pog {
+
+// Everything what parser needs that does not depend on the actions or on the parsed input - grammar, tokens
+// with their compiled regular expressions, LR automaton and parsing table. Once prepared, it is not modified
+// anymore and it can be shared by any number of parsers with the same grammar, also across threads.
+template <typename ValueT>
+class ParserDefinition
+{
+public:
+	using GrammarType = Grammar<ValueT>;
+	using ParserReportType = ParserReport<ValueT>;
+	using TokenizerDefinitionType = TokenizerDefinition<ValueT>;
+
+	ParserDefinition() : _grammar(), _tokenizer(), _automaton(&_grammar), _includes(&_automaton, &_grammar),
+		_lookback(&_automaton, &_grammar), _read_operation(&_automaton, &_grammar), _follow_operation(&_automaton, &_grammar, _includes, _read_operation),
+		_lookahead_operation(&_automaton, &_grammar, _lookback, _follow_operation), _parsing_table(&_automaton, &_grammar, _lookahead_operation),
+		_report(), _parsing_table_loaded(false), _prepared(false) {}
+
+	// Members keep pointers to each other
+	ParserDefinition(const ParserDefinition&) = delete;
+	ParserDefinition(ParserDefinition&&) = delete;
+
+	GrammarType* get_grammar() { return &_grammar; }
+	const GrammarType* get_grammar() const { return &_grammar; }
+	TokenizerDefinitionType* get_tokenizer_definition() { return &_tokenizer; }
+	const TokenizerDefinitionType* get_tokenizer_definition() const { return &_tokenizer; }
+	const Automaton<ValueT>& get_automaton() const { return _automaton; }
+	const ParsingTable<ValueT>& get_parsing_table() const { return _parsing_table; }
+	const ParserReportType& get_report() const { return _report; }
+
+	bool is_prepared() const { return _prepared; }
+	bool is_parsing_table_loaded() const { return _parsing_table_loaded; }
+
+	// Calculates the parsing table or loads it from its serialized form obtained from serialize_parsing_table().
+	// Construction of LALR automaton is skipped when the table is loaded, which is the most expensive part
+	// of the preparation. If the serialized table does not belong to the same grammar, it is ignored and
+	// the table is calculated from scratch.
+	const ParserReportType& prepare(std::optional<std::string_view> serialized_table = std::nullopt)
+	{
+		_parsing_table_loaded = serialized_table && load_parsing_table(serialized_table.value());
+		if (!_parsing_table_loaded)
+			calculate_parsing_table();
+		_tokenizer.prepare();
+		_prepared = true;
+		return _report;
+	}
+
+	std::string serialize_parsing_table() const
+	{
+		return _parsing_table.serialize();
+	}
+
+	std::string generate_automaton_graph() const
+	{
+		return _automaton.generate_graph();
+	}
+
+	std::string generate_includes_relation_graph() const
+	{
+		return _includes.generate_relation_graph();
+	}
+
+private:
+	void calculate_parsing_table()
+	{
+		_automaton.construct_states();
+		_includes.calculate();
+		_lookback.calculate();
+		_read_operation.calculate();
+		_follow_operation.calculate();
+		_lookahead_operation.calculate();
+		_parsing_table.calculate(_report);
+	}
+
+	bool load_parsing_table(std::string_view serialized_table)
+	{
+		auto states_count = _parsing_table.get_serialized_states_count(serialized_table);
+		if (!states_count)
+			return false;
+
+		_automaton.restore_states(states_count.value());
+		if (!_parsing_table.deserialize(serialized_table))
+		{
+			_automaton.clear();
+			return false;
+		}
+
+		return true;
+	}
+
+	GrammarType _grammar;
+	TokenizerDefinitionType _tokenizer;
+	Automaton<ValueT> _automaton;
+	Includes<ValueT> _includes;
+	Lookback<ValueT> _lookback;
+	Read<ValueT> _read_operation;
+	Follow<ValueT> _follow_operation;
+	Lookahead<ValueT> _lookahead_operation;
+	ParsingTable<ValueT> _parsing_table;
+
+	ParserReportType _report;
+	bool _parsing_table_loaded;
+	bool _prepared;
+};
+
+} // namespace pog
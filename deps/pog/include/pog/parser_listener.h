@@ -0,0 +1,45 @@
+#pragma once
+
+namespace pog {
+
+enum class ParsingPhase
+{
+	Tokenizing,
+	Action
+};
+
+// Receives notifications about phases of parsing, for example to measure how long they take.
+// Every enter() is paired with leave() of the same phase even if the phase ends with an exception.
+class ParserListener
+{
+public:
+	virtual ~ParserListener() = default;
+
+	virtual void enter(ParsingPhase phase) = 0;
+	virtual void leave(ParsingPhase phase) = 0;
+};
+
+class ParsingPhaseGuard
+{
+public:
+	ParsingPhaseGuard(ParserListener* listener, ParsingPhase phase) : _listener(listener), _phase(phase)
+	{
+		if (_listener)
+			_listener->enter(_phase);
+	}
+
+	ParsingPhaseGuard(const ParsingPhaseGuard&) = delete;
+	ParsingPhaseGuard& operator=(const ParsingPhaseGuard&) = delete;
+
+	~ParsingPhaseGuard()
+	{
+		if (_listener)
+			_listener->leave(_phase);
+	}
+
+private:
+	ParserListener* _listener;
+	ParsingPhase _phase;
+};
+
+} // namespace pog
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
 #include <unordered_map>
 
 #include <pog/action.h>
@@ -13,6 +18,7 @@
 #include <pog/symbol.h>
 #include <pog/types/state_and_rule.h>
 #include <pog/types/state_and_symbol.h>
+#include <pog/utils.h>
 
 namespace pog {
 
@@ -144,6 +150,160 @@ public:
 		return goto_itr->second;
 	}
 
+	// Serialized form of the table consists of header (magic, format version, grammar fingerprint, number of states)
+	// followed by action table records (state, symbol, action kind, target) and GOTO table records (state, symbol, target).
+	// All numbers are stored as 32-bit little-endian integers and records are sorted so the output is deterministic.
+	std::string serialize() const
+	{
+		std::vector<std::tuple<std::uint32_t, std::uint32_t, std::uint32_t, std::uint32_t>> actions;
+		actions.reserve(_action_table.size());
+		for (const auto& [ss, action] : _action_table)
+		{
+			auto [kind, target] = visit_with(action,
+				[](const ShiftActionType& shift) { return std::make_pair(ActionKind::Shift, shift.state->get_index()); },
+				[](const ReduceActionType& reduce) { return std::make_pair(ActionKind::Reduce, reduce.rule->get_index()); },
+				[](const Accept&) { return std::make_pair(ActionKind::Accept, std::uint32_t{0}); }
+			);
+			actions.emplace_back(ss.state->get_index(), ss.symbol->get_index(), static_cast<std::uint32_t>(kind), target);
+		}
+
+		std::vector<std::tuple<std::uint32_t, std::uint32_t, std::uint32_t>> gotos;
+		gotos.reserve(_goto_table.size());
+		for (const auto& [ss, dest_state] : _goto_table)
+			gotos.emplace_back(ss.state->get_index(), ss.symbol->get_index(), dest_state->get_index());
+
+		std::sort(actions.begin(), actions.end());
+		std::sort(gotos.begin(), gotos.end());
+
+		std::string result;
+		result.reserve(SerializedHeaderSize + 16 * actions.size() + 12 * gotos.size() + 8);
+		result.append(SerializedMagic);
+		write_uint32(result, SerializedVersion);
+		auto fingerprint = _grammar->fingerprint();
+		write_uint32(result, static_cast<std::uint32_t>(fingerprint));
+		write_uint32(result, static_cast<std::uint32_t>(fingerprint >> 32));
+		write_uint32(result, static_cast<std::uint32_t>(_automaton->get_states().size()));
+
+		write_uint32(result, static_cast<std::uint32_t>(actions.size()));
+		for (const auto& [state, symbol, kind, target] : actions)
+		{
+			write_uint32(result, state);
+			write_uint32(result, symbol);
+			write_uint32(result, kind);
+			write_uint32(result, target);
+		}
+
+		write_uint32(result, static_cast<std::uint32_t>(gotos.size()));
+		for (const auto& [state, symbol, target] : gotos)
+		{
+			write_uint32(result, state);
+			write_uint32(result, symbol);
+			write_uint32(result, target);
+		}
+
+		return result;
+	}
+
+	// Checks the header and the layout of serialized table against the current grammar and returns
+	// the number of automaton states the table refers to. Every state except the initial one is
+	// the target of some shift or GOTO record so the number of states is bounded by the number
+	// of records and corrupted headers never make the automaton allocate more states than that.
+	std::optional<std::size_t> get_serialized_states_count(std::string_view data) const
+	{
+		if (data.size() < SerializedHeaderSize || data.substr(0, SerializedMagic.size()) != SerializedMagic)
+			return std::nullopt;
+
+		data.remove_prefix(SerializedMagic.size());
+		if (read_uint32(data) != SerializedVersion)
+			return std::nullopt;
+
+		auto fingerprint = _grammar->fingerprint();
+		auto fingerprint_low = read_uint32(data);
+		auto fingerprint_high = read_uint32(data);
+		if (fingerprint_low != static_cast<std::uint32_t>(fingerprint) || fingerprint_high != static_cast<std::uint32_t>(fingerprint >> 32))
+			return std::nullopt;
+
+		auto states_count = read_uint32(data);
+		if (data.size() < 4)
+			return std::nullopt;
+		auto actions_count = read_uint32(data);
+		if (data.size() < 16 * static_cast<std::size_t>(actions_count) + 4)
+			return std::nullopt;
+		data.remove_prefix(16 * static_cast<std::size_t>(actions_count));
+		auto gotos_count = read_uint32(data);
+		if (data.size() != 12 * static_cast<std::size_t>(gotos_count))
+			return std::nullopt;
+
+		if (states_count > static_cast<std::size_t>(actions_count) + gotos_count + 1)
+			return std::nullopt;
+
+		return states_count;
+	}
+
+	// Fills the table from its serialized form. Automaton needs to already contain
+	// the number of states returned by get_serialized_states_count().
+	bool deserialize(std::string_view data)
+	{
+		clear();
+
+		auto states_count = get_serialized_states_count(data);
+		if (!states_count || states_count.value() != _automaton->get_states().size())
+			return false;
+
+		data.remove_prefix(SerializedHeaderSize);
+		const auto& symbols = _grammar->get_symbols();
+		const auto& rules = _grammar->get_rules();
+
+		if (data.size() < 4)
+			return false;
+		auto actions_count = read_uint32(data);
+		if (data.size() < 16 * static_cast<std::size_t>(actions_count))
+			return fail_deserialization();
+		for (std::uint32_t i = 0; i < actions_count; ++i)
+		{
+			auto state = read_uint32(data);
+			auto symbol = read_uint32(data);
+			auto kind = read_uint32(data);
+			auto target = read_uint32(data);
+			if (state >= states_count.value() || symbol >= symbols.size())
+				return fail_deserialization();
+
+			auto ss = StateAndSymbolType{_automaton->get_state(state), symbols[symbol].get()};
+			if (kind == static_cast<std::uint32_t>(ActionKind::Shift) && target < states_count.value())
+				_action_table.emplace(std::move(ss), ShiftActionType{_automaton->get_state(target)});
+			else if (kind == static_cast<std::uint32_t>(ActionKind::Reduce) && target < rules.size())
+				_action_table.emplace(std::move(ss), ReduceActionType{rules[target].get()});
+			else if (kind == static_cast<std::uint32_t>(ActionKind::Accept))
+				_action_table.emplace(std::move(ss), Accept{});
+			else
+				return fail_deserialization();
+		}
+
+		if (data.size() < 4)
+			return fail_deserialization();
+		auto gotos_count = read_uint32(data);
+		if (data.size() != 12 * static_cast<std::size_t>(gotos_count))
+			return fail_deserialization();
+		for (std::uint32_t i = 0; i < gotos_count; ++i)
+		{
+			auto state = read_uint32(data);
+			auto symbol = read_uint32(data);
+			auto target = read_uint32(data);
+			if (state >= states_count.value() || symbol >= symbols.size() || target >= states_count.value())
+				return fail_deserialization();
+
+			_goto_table.emplace(StateAndSymbolType{_automaton->get_state(state), symbols[symbol].get()}, _automaton->get_state(target));
+		}
+
+		return true;
+	}
+
+	void clear()
+	{
+		_action_table.clear();
+		_goto_table.clear();
+	}
+
 	std::vector<const SymbolType*> get_expected_symbols_from_state(const StateType* state) const
 	{
 		std::vector<const SymbolType*> result;
@@ -161,6 +321,38 @@ public:
 	}
 
 private:
+	enum class ActionKind : std::uint32_t
+	{
+		Shift,
+		Reduce,
+		Accept
+	};
+
+	static constexpr std::string_view SerializedMagic = "POGT";
+	static constexpr std::uint32_t SerializedVersion = 1;
+	static constexpr std::size_t SerializedHeaderSize = SerializedMagic.size() + 4 * sizeof(std::uint32_t);
+
+	static void write_uint32(std::string& output, std::uint32_t value)
+	{
+		for (std::size_t i = 0; i < sizeof(value); ++i)
+			output.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+	}
+
+	static std::uint32_t read_uint32(std::string_view& input)
+	{
+		std::uint32_t result = 0;
+		for (std::size_t i = 0; i < sizeof(result); ++i)
+			result |= static_cast<std::uint32_t>(static_cast<std::uint8_t>(input[i])) << (8 * i);
+		input.remove_prefix(sizeof(result));
+		return result;
+	}
+
+	bool fail_deserialization()
+	{
+		clear();
+		return false;
+	}
+
 	const AutomatonType* _automaton;
 	const GrammarType* _grammar;
 	std::unordered_map<StateAndSymbolType, ActionType> _action_table;
@@ -119,7 +119,7 @@ public:
 		}
 	}
 
-	std::string generate_relation_graph()
+	std::string generate_relation_graph() const
 	{
 		std::vector<std::string> states_str, edges_str;
 		for (const auto& [ss, dests] : Parent::_relation)
@@ -19,14 +19,12 @@ class Rule
 {
 public:
 	using SymbolType = Symbol<ValueT>;
+	// Actions are not part of the rule itself but they are owned by the parser so that
+	// the rule can be shared between multiple parsers, each with its own actions.
 	using CallbackType = std::function<ValueT(std::vector<ValueT>&&)>;
 
 	Rule(std::uint32_t index, const SymbolType* lhs, const std::vector<const SymbolType*>& rhs)
-		: _index(index), _lhs(lhs), _rhs(rhs), _action(), _midrule_size(std::nullopt), _start(false) {}
-
-	template <typename CallbackT>
-	Rule(std::uint32_t index, const SymbolType* lhs, const std::vector<const SymbolType*>& rhs, CallbackT&& action)
-		: _index(index), _lhs(lhs), _rhs(rhs), _action(std::forward<CallbackT>(action)), _midrule_size(std::nullopt), _start(false) {}
+		: _index(index), _lhs(lhs), _rhs(rhs), _midrule_size(std::nullopt), _start(false) {}
 
 	std::uint32_t get_index() const { return _index; }
 	const SymbolType* get_lhs() const { return _lhs; }
@@ -63,7 +61,6 @@ public:
 		return fmt::format("{} {} {}", _lhs->get_name(), arrow, fmt::join(rhs_strings.begin(), rhs_strings.end(), " "));
 	}
 
-	bool has_action() const { return static_cast<bool>(_action); }
 	bool is_start_rule() const { return _start; }
 
 	void set_start_rule(bool set) { _start = set; }
@@ -71,9 +68,6 @@ public:
 	bool is_midrule() const { return static_cast<bool>(_midrule_size); }
 	std::size_t get_midrule_size() const { return _midrule_size.value(); }
 
-	template <typename... Args>
-	ValueT perform_action(Args&&... args) const { return _action(std::forward<Args>(args)...); }
-
 	bool operator==(const Rule& rhs) const { return _index == rhs._index; }
 	bool operator!=(const Rule& rhs) const { return !(*this == rhs); }
 
@@ -81,7 +75,6 @@ private:
 	std::uint32_t _index;
 	const SymbolType* _lhs;
 	std::vector<const SymbolType*> _rhs;
-	CallbackType _action;
 	std::optional<Precedence> _precedence;
 	std::optional<std::size_t> _midrule_size;
 	bool _start;
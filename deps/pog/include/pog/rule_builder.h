@@ -68,14 +68,14 @@ public:
 					// Create rule to which midrule action can be assigned and set midrule size.
 					// Midrule size is number of symbols preceding the midrule symbol. It represents how many
 					// items from stack we need to borrow for action arguments.
-					auto rule = _grammar->add_rule(midsymbol, std::vector<const SymbolType*>{}, std::move(symbols_and_action.action));
+					auto rule = _grammar->add_rule(midsymbol, std::vector<const SymbolType*>{});
 					rule->set_midrule(rhs_symbols.size());
 					rhs_symbols.push_back(midsymbol);
 				}
 				// This is the last action so do not mark it as midrule
 				else
 				{
-					auto rule = _grammar->add_rule(lhs_symbol, rhs_symbols, std::move(symbols_and_action.action));
+					auto rule = _grammar->add_rule(lhs_symbol, rhs_symbols);
 					if (rule && rhs.precedence)
 					{
 						const auto& prec = rhs.precedence.value();
@@ -88,6 +88,19 @@ public:
 		}
 	}
 
+	// Returns actions of all rules in the same order in which done() adds the rules into the grammar.
+	// Actions are taken out even if done() was never called because the grammar was already built by other parser.
+	std::vector<typename RuleType::CallbackType> take_actions()
+	{
+		std::vector<typename RuleType::CallbackType> result;
+		for (auto&& rhs : _rhss)
+		{
+			for (auto&& symbols_and_action : rhs.symbols_and_action)
+				result.push_back(std::move(symbols_and_action.action));
+		}
+		return result;
+	}
+
 	template <typename... Args>
 	RuleBuilder& production(Args&&... args)
 	{
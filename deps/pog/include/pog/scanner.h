@@ -0,0 +1,678 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace pog {
+
+struct ScanResult
+{
+	enum class Status
+	{
+		Matched,
+		NoMatch,
+		Fallback
+	};
+
+	Status status;
+	std::size_t pattern;
+	std::size_t length;
+};
+
+// Scanner matches the input against all token patterns of a tokenizer state at once using a single DFA.
+// It finds the longest match and the pattern which produced it (the first one in case of a tie) in one
+// pass over the input. It understands only the subset of RE2 syntax commonly used for tokens and works
+// on bytes, so it reports fallback whenever the match would depend on a non-ASCII character which RE2
+// interprets as UTF-8. Scanner is immutable once built and can be shared between threads.
+//
+// The result is not always the same as the one of RE2. The DFA takes the longest match of each pattern
+// while RE2 takes the leftmost-first one, so for example pattern 'a|ab' matches 'ab' here but only 'a'
+// in RE2. Both agree for patterns whose alternatives and repetitions are ordered so that the leftmost-first
+// match is also the longest one. Tokens of the YARA grammar are such and yaramod tests compare both on them.
+class Scanner
+{
+public:
+	using ByteSet = std::bitset<256>;
+
+	static constexpr std::uint32_t DeadState = 0;
+	static constexpr std::uint32_t NoPattern = ~std::uint32_t{0};
+	static constexpr std::size_t MaxStates = 4096;
+	static constexpr std::size_t MaxRepetition = 1000;
+
+	// Returns nullptr if any of the patterns is not supported or the automaton would be too large.
+	static std::unique_ptr<Scanner> build(const std::vector<std::string>& patterns)
+	{
+		Nfa nfa;
+		auto start = nfa.add_state();
+		std::uint32_t end_of_input_pattern = NoPattern;
+		for (std::size_t i = 0; i < patterns.size(); ++i)
+		{
+			// Pattern consisting only of end of input anchor is used by the end token
+			if (patterns[i] == "$")
+			{
+				end_of_input_pattern = std::min(end_of_input_pattern, static_cast<std::uint32_t>(i));
+				continue;
+			}
+
+			auto node = PatternParser{patterns[i]}.parse();
+			if (!node)
+				return nullptr;
+
+			auto fragment = nfa.build(*node);
+			nfa.states[start].epsilon.push_back(fragment.first);
+			nfa.states[fragment.second].accept = static_cast<std::uint32_t>(i);
+		}
+
+		auto scanner = std::unique_ptr<Scanner>(new Scanner());
+		scanner->_end_of_input_pattern = end_of_input_pattern;
+		if (!scanner->build_dfa(nfa, start))
+			return nullptr;
+		return scanner;
+	}
+
+	ScanResult match(std::string_view input) const
+	{
+		ScanResult result{ScanResult::Status::NoMatch, NoPattern, 0};
+		auto state = _start_state;
+		if (_accepts[state] != NoPattern)
+			result = ScanResult{ScanResult::Status::Matched, _accepts[state], 0};
+		if (input.empty() && _end_of_input_pattern < result.pattern)
+			result = ScanResult{ScanResult::Status::Matched, _end_of_input_pattern, 0};
+
+		for (std::size_t i = 0; i < input.size(); ++i)
+		{
+			auto byte = static_cast<std::uint8_t>(input[i]);
+			state = _transitions[state * _classes_count + _byte_classes[byte]];
+			if (state == DeadState)
+				break;
+
+			// RE2 would consume the whole UTF-8 character here
+			if (byte >= 0x80)
+				return ScanResult{ScanResult::Status::Fallback, NoPattern, 0};
+
+			if (_accepts[state] != NoPattern)
+				result = ScanResult{ScanResult::Status::Matched, _accepts[state], i + 1};
+		}
+
+		return result;
+	}
+
+	std::size_t get_states_count() const { return _accepts.size(); }
+
+private:
+	struct Node
+	{
+		enum class Kind
+		{
+			Set,
+			Concat,
+			Alternation,
+			Repeat
+		};
+
+		Node(Kind k) : kind(k), set(), children(), min(0), max(0), unbounded(false) {}
+
+		Kind kind;
+		ByteSet set;
+		std::vector<std::unique_ptr<Node>> children;
+		std::size_t min;
+		std::size_t max;
+		bool unbounded;
+	};
+
+	// Parser of the RE2 syntax used in token patterns. Anything else makes the pattern unsupported.
+	class PatternParser
+	{
+	public:
+		PatternParser(std::string_view pattern) : _pattern(pattern), _pos(0) {}
+
+		std::unique_ptr<Node> parse()
+		{
+			auto node = parse_alternation();
+			if (!node || !at_end())
+				return nullptr;
+			return node;
+		}
+
+	private:
+		bool at_end() const { return _pos >= _pattern.size(); }
+		char peek() const { return _pattern[_pos]; }
+
+		std::unique_ptr<Node> parse_alternation()
+		{
+			auto node = parse_concatenation();
+			if (!node || at_end() || peek() != '|')
+				return node;
+
+			auto alternation = std::make_unique<Node>(Node::Kind::Alternation);
+			alternation->children.push_back(std::move(node));
+			while (!at_end() && peek() == '|')
+			{
+				++_pos;
+				auto next = parse_concatenation();
+				if (!next)
+					return nullptr;
+				alternation->children.push_back(std::move(next));
+			}
+			return alternation;
+		}
+
+		std::unique_ptr<Node> parse_concatenation()
+		{
+			auto concat = std::make_unique<Node>(Node::Kind::Concat);
+			while (!at_end() && peek() != '|' && peek() != ')')
+			{
+				auto atom = parse_atom();
+				if (!atom)
+					return nullptr;
+				atom = parse_repetitions(std::move(atom));
+				if (!atom)
+					return nullptr;
+				concat->children.push_back(std::move(atom));
+			}
+			return concat;
+		}
+
+		std::unique_ptr<Node> parse_repetitions(std::unique_ptr<Node> atom)
+		{
+			while (!at_end())
+			{
+				auto repeat = std::make_unique<Node>(Node::Kind::Repeat);
+				auto c = peek();
+				if (c == '*' || c == '+' || c == '?')
+				{
+					++_pos;
+					repeat->min = (c == '+') ? 1 : 0;
+					repeat->max = 1;
+					repeat->unbounded = (c != '?');
+				}
+				else if (c == '{')
+				{
+					// '{' which does not start a valid counted repetition is a literal
+					if (!parse_counted_repetition(*repeat))
+						return atom;
+				}
+				else
+					return atom;
+
+				// Non-greedy repetitions are not supported
+				if (!at_end() && peek() == '?')
+					return nullptr;
+
+				repeat->children.push_back(std::move(atom));
+				atom = std::move(repeat);
+			}
+			return atom;
+		}
+
+		bool parse_counted_repetition(Node& repeat)
+		{
+			auto pos = _pos + 1;
+			auto parse_number = [&](std::size_t& number) {
+				auto start = pos;
+				number = 0;
+				while (pos < _pattern.size() && _pattern[pos] >= '0' && _pattern[pos] <= '9' && number <= MaxRepetition)
+					number = number * 10 + (_pattern[pos++] - '0');
+				return pos != start;
+			};
+
+			std::size_t min = 0, max = 0;
+			if (!parse_number(min))
+				return false;
+
+			bool unbounded = false;
+			if (pos < _pattern.size() && _pattern[pos] == ',')
+			{
+				++pos;
+				if (!parse_number(max))
+					unbounded = true;
+			}
+			else
+				max = min;
+
+			if (pos >= _pattern.size() || _pattern[pos] != '}')
+				return false;
+
+			// Invalid or too large counts are left for RE2 to deal with
+			if (min > MaxRepetition || max > MaxRepetition || (!unbounded && max < min))
+				return false;
+
+			_pos = pos + 1;
+			repeat.min = min;
+			repeat.max = unbounded ? min : max;
+			repeat.unbounded = unbounded;
+			return true;
+		}
+
+		std::unique_ptr<Node> parse_atom()
+		{
+			auto c = peek();
+			if (c == '(')
+			{
+				++_pos;
+				if (!at_end() && peek() == '?')
+				{
+					if (_pattern.substr(_pos, 2) != "?:")
+						return nullptr;
+					_pos += 2;
+				}
+
+				auto node = parse_alternation();
+				if (!node || at_end() || peek() != ')')
+					return nullptr;
+				++_pos;
+				return node;
+			}
+
+			auto node = std::make_unique<Node>(Node::Kind::Set);
+			if (c == '[')
+			{
+				++_pos;
+				if (!parse_class(node->set))
+					return nullptr;
+			}
+			else if (c == '.')
+			{
+				++_pos;
+				node->set.set();
+				node->set.reset('\n');
+			}
+			else if (c == '\\')
+			{
+				++_pos;
+				if (!parse_escape(node->set))
+					return nullptr;
+			}
+			// Anchors, repetitions without operand and non-ASCII characters are not supported
+			else if (c == '^' || c == '$' || c == '*' || c == '+' || c == '?' || static_cast<std::uint8_t>(c) >= 0x80)
+				return nullptr;
+			else
+			{
+				++_pos;
+				node->set.set(static_cast<std::uint8_t>(c));
+			}
+			return node;
+		}
+
+		bool parse_class(ByteSet& set)
+		{
+			bool negated = false;
+			if (!at_end() && peek() == '^')
+			{
+				negated = true;
+				++_pos;
+			}
+
+			bool first = true;
+			while (!at_end() && (peek() != ']' || first))
+			{
+				first = false;
+
+				// POSIX classes like [:alpha:] are not supported
+				if (_pattern.substr(_pos, 2) == "[:")
+					return false;
+
+				ByteSet item;
+				std::optional<std::uint8_t> low;
+				if (!parse_class_item(item, low))
+					return false;
+
+				// Range of characters
+				if (low && _pos + 1 < _pattern.size() && peek() == '-' && _pattern[_pos + 1] != ']')
+				{
+					++_pos;
+					ByteSet high_item;
+					std::optional<std::uint8_t> high;
+					if (!parse_class_item(high_item, high) || !high || high.value() < low.value())
+						return false;
+					for (auto ch = static_cast<unsigned>(low.value()); ch <= high.value(); ++ch)
+						item.set(ch);
+				}
+
+				set |= item;
+			}
+
+			if (at_end())
+				return false;
+			++_pos;
+
+			if (negated)
+				set.flip();
+			return true;
+		}
+
+		// Single character of the class is also returned in 'ch' so it can be used in range.
+		bool parse_class_item(ByteSet& set, std::optional<std::uint8_t>& ch)
+		{
+			auto c = peek();
+			if (static_cast<std::uint8_t>(c) >= 0x80)
+				return false;
+
+			++_pos;
+			if (c != '\\')
+			{
+				set.set(static_cast<std::uint8_t>(c));
+				ch = static_cast<std::uint8_t>(c);
+				return true;
+			}
+
+			if (!parse_escape(set))
+				return false;
+			if (set.count() == 1)
+			{
+				for (std::size_t i = 0; i < set.size(); ++i)
+					if (set.test(i))
+						ch = static_cast<std::uint8_t>(i);
+			}
+			return true;
+		}
+
+		bool parse_escape(ByteSet& set)
+		{
+			if (at_end())
+				return false;
+
+			auto c = peek();
+			++_pos;
+			switch (c)
+			{
+				case 'd':
+				case 'D':
+					for (char ch = '0'; ch <= '9'; ++ch)
+						set.set(ch);
+					break;
+				case 'w':
+				case 'W':
+					for (char ch = '0'; ch <= '9'; ++ch)
+						set.set(ch);
+					for (char ch = 'a'; ch <= 'z'; ++ch)
+						set.set(ch);
+					for (char ch = 'A'; ch <= 'Z'; ++ch)
+						set.set(ch);
+					set.set('_');
+					break;
+				case 's':
+				case 'S':
+					for (char ch : {'\t', '\n', '\f', '\r', ' '})
+						set.set(ch);
+					break;
+				case 'n': set.set('\n'); return true;
+				case 't': set.set('\t'); return true;
+				case 'r': set.set('\r'); return true;
+				case 'f': set.set('\f'); return true;
+				case 'v': set.set('\v'); return true;
+				case 'a': set.set('\a'); return true;
+				case 'x':
+				{
+					auto hex = [](char h) -> int {
+						if (h >= '0' && h <= '9') return h - '0';
+						if (h >= 'a' && h <= 'f') return h - 'a' + 10;
+						if (h >= 'A' && h <= 'F') return h - 'A' + 10;
+						return -1;
+					};
+					if (_pattern.size() - _pos < 2)
+						return false;
+					auto high = hex(_pattern[_pos]), low = hex(_pattern[_pos + 1]);
+					// Only ASCII characters have the same meaning in UTF-8
+					if (high < 0 || low < 0 || high > 7)
+						return false;
+					_pos += 2;
+					set.set(static_cast<std::size_t>(high * 16 + low));
+					return true;
+				}
+				default:
+					// Escaped punctuation stands for itself, other escapes (\b, \A, \pN, ...) are not supported
+					if ((c >= '!' && c <= '/') || (c >= ':' && c <= '@') || (c >= '[' && c <= '`') || (c >= '{' && c <= '~'))
+					{
+						set.set(static_cast<std::uint8_t>(c));
+						return true;
+					}
+					return false;
+			}
+
+			if (c == 'D' || c == 'W' || c == 'S')
+				set.flip();
+			return true;
+		}
+
+		std::string_view _pattern;
+		std::size_t _pos;
+	};
+
+	struct NfaState
+	{
+		NfaState() : epsilon(), set(), next(0), has_transition(false), accept(NoPattern) {}
+
+		std::vector<std::uint32_t> epsilon;
+		ByteSet set;
+		std::uint32_t next;
+		bool has_transition;
+		std::uint32_t accept;
+	};
+
+	struct Nfa
+	{
+		std::uint32_t add_state()
+		{
+			states.emplace_back();
+			return static_cast<std::uint32_t>(states.size() - 1);
+		}
+
+		// Thompson's construction, returns start and end state of the fragment.
+		std::pair<std::uint32_t, std::uint32_t> build(const Node& node)
+		{
+			switch (node.kind)
+			{
+				case Node::Kind::Set:
+				{
+					auto start = add_state();
+					auto end = add_state();
+					states[start].set = node.set;
+					states[start].next = end;
+					states[start].has_transition = true;
+					return {start, end};
+				}
+				case Node::Kind::Concat:
+				{
+					auto start = add_state();
+					auto end = start;
+					for (const auto& child : node.children)
+					{
+						auto fragment = build(*child);
+						states[end].epsilon.push_back(fragment.first);
+						end = fragment.second;
+					}
+					return {start, end};
+				}
+				case Node::Kind::Alternation:
+				{
+					auto start = add_state();
+					auto end = add_state();
+					for (const auto& child : node.children)
+					{
+						auto fragment = build(*child);
+						states[start].epsilon.push_back(fragment.first);
+						states[fragment.second].epsilon.push_back(end);
+					}
+					return {start, end};
+				}
+				case Node::Kind::Repeat:
+				{
+					auto start = add_state();
+					auto end = start;
+					for (std::size_t i = 0; i < node.min; ++i)
+					{
+						auto fragment = build(*node.children[0]);
+						states[end].epsilon.push_back(fragment.first);
+						end = fragment.second;
+					}
+
+					if (node.unbounded)
+					{
+						auto fragment = build(*node.children[0]);
+						states[end].epsilon.push_back(fragment.first);
+						states[fragment.second].epsilon.push_back(fragment.first);
+						auto loop_end = add_state();
+						states[end].epsilon.push_back(loop_end);
+						states[fragment.second].epsilon.push_back(loop_end);
+						end = loop_end;
+					}
+					else
+					{
+						auto optional_end = add_state();
+						for (std::size_t i = node.min; i < node.max; ++i)
+						{
+							states[end].epsilon.push_back(optional_end);
+							auto fragment = build(*node.children[0]);
+							states[end].epsilon.push_back(fragment.first);
+							end = fragment.second;
+						}
+						states[end].epsilon.push_back(optional_end);
+						end = optional_end;
+					}
+					return {start, end};
+				}
+			}
+			return {0, 0};
+		}
+
+		void closure(std::vector<std::uint32_t>& set)
+		{
+			visited.resize(states.size(), 0);
+			++generation;
+
+			std::vector<std::uint32_t> stack;
+			stack.swap(set);
+			while (!stack.empty())
+			{
+				auto state = stack.back();
+				stack.pop_back();
+				if (visited[state] == generation)
+					continue;
+				visited[state] = generation;
+				set.push_back(state);
+				for (auto next : states[state].epsilon)
+					if (visited[next] != generation)
+						stack.push_back(next);
+			}
+			std::sort(set.begin(), set.end());
+		}
+
+		std::vector<NfaState> states;
+		std::vector<std::uint32_t> visited; // Generation in which the state was visited by closure
+		std::uint32_t generation = 0;
+	};
+
+	Scanner() = default;
+
+	bool build_dfa(Nfa& nfa, std::uint32_t start)
+	{
+		// Bytes which can't be distinguished by any transition share the same class. Partition
+		// of all bytes is refined by every distinct set of bytes used in transitions.
+		std::vector<ByteSet> sets;
+		std::unordered_map<ByteSet, std::size_t> set_indices;
+		std::vector<std::size_t> state_sets(nfa.states.size());
+		for (std::size_t i = 0; i < nfa.states.size(); ++i)
+			if (nfa.states[i].has_transition)
+			{
+				auto [itr, inserted] = set_indices.emplace(nfa.states[i].set, sets.size());
+				if (inserted)
+					sets.push_back(nfa.states[i].set);
+				state_sets[i] = itr->second;
+			}
+
+		_classes_count = 1;
+		for (const auto& set : sets)
+		{
+			std::map<std::pair<std::uint8_t, bool>, std::uint8_t> refined;
+			for (std::size_t byte = 0; byte < 256; ++byte)
+			{
+				auto key = std::make_pair(_byte_classes[byte], set.test(byte));
+				_byte_classes[byte] = refined.emplace(key, static_cast<std::uint8_t>(refined.size())).first->second;
+			}
+			_classes_count = refined.size();
+		}
+
+		// Classes of bytes accepted by each distinct set
+		std::vector<std::vector<std::uint8_t>> set_classes(sets.size());
+		for (std::size_t i = 0; i < sets.size(); ++i)
+		{
+			std::vector<bool> used(_classes_count, false);
+			for (std::size_t byte = 0; byte < 256; ++byte)
+				if (sets[i].test(byte) && !used[_byte_classes[byte]])
+				{
+					used[_byte_classes[byte]] = true;
+					set_classes[i].push_back(_byte_classes[byte]);
+				}
+		}
+
+		// Subset construction, state 0 is the dead state. DFA states are identified only by NFA states
+		// which have a transition or accept because the rest doesn't affect the behavior of automaton.
+		std::map<std::vector<std::uint32_t>, std::uint32_t> dfa_states;
+		std::vector<const std::vector<std::uint32_t>*> queue;
+		auto add_dfa_state = [&](std::vector<std::uint32_t>&& nfa_states) {
+			nfa.closure(nfa_states);
+			nfa_states.erase(std::remove_if(nfa_states.begin(), nfa_states.end(), [&](auto state) {
+				return !nfa.states[state].has_transition && nfa.states[state].accept == NoPattern;
+			}), nfa_states.end());
+
+			auto [itr, inserted] = dfa_states.emplace(std::move(nfa_states), static_cast<std::uint32_t>(_accepts.size()));
+			if (inserted)
+			{
+				auto accept = NoPattern;
+				for (auto state : itr->first)
+					accept = std::min(accept, nfa.states[state].accept);
+				_accepts.push_back(accept);
+				_transitions.resize(_transitions.size() + _classes_count, DeadState);
+				queue.push_back(&itr->first);
+			}
+			return itr->second;
+		};
+
+		add_dfa_state({});
+		_start_state = add_dfa_state({start});
+
+		std::vector<std::vector<std::uint32_t>> next(_classes_count);
+		for (std::size_t i = 1; i < queue.size(); ++i)
+		{
+			if (queue.size() > MaxStates)
+				return false;
+
+			for (auto state : *queue[i])
+				if (nfa.states[state].has_transition)
+					for (auto cls : set_classes[state_sets[state]])
+						next[cls].push_back(nfa.states[state].next);
+
+			for (std::size_t cls = 0; cls < _classes_count; ++cls)
+			{
+				if (next[cls].empty())
+					continue;
+
+				auto next_state = add_dfa_state(std::move(next[cls]));
+				next[cls].clear();
+				_transitions[i * _classes_count + cls] = next_state;
+			}
+		}
+
+		return true;
+	}
+
+	std::uint32_t _start_state = 0;
+	std::uint32_t _end_of_input_pattern = NoPattern;
+	std::size_t _classes_count = 0;
+	std::array<std::uint8_t, 256> _byte_classes = {};
+	std::vector<std::uint32_t> _transitions;
+	std::vector<std::uint32_t> _accepts;
+};
+
+} // namespace pog
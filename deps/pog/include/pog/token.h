@@ -16,6 +16,7 @@ class Token
 {
 public:
 	using SymbolType = Symbol<ValueT>;
+	// Actions are owned by the tokenizer of each parser, see Rule::CallbackType.
 	using CallbackType = std::function<ValueT(std::string_view)>;
 
 	template <typename StatesT>
@@ -23,7 +24,7 @@ public:
 
 	template <typename StatesT>
 	Token(std::uint32_t index, const std::string& pattern, StatesT&& active_in_states, const SymbolType* symbol)
-		: _index(index), _pattern(pattern), _symbol(symbol), _regexp(std::make_unique<re2::RE2>(_pattern)), _action(),
+		: _index(index), _pattern(pattern), _symbol(symbol), _regexp(std::make_unique<re2::RE2>(_pattern)),
 			_enter_state(), _active_in_states(std::forward<StatesT>(active_in_states)) {}
 
 	std::uint32_t get_index() const { return _index; }
@@ -32,21 +33,8 @@ public:
 	const re2::RE2* get_regexp() const { return _regexp.get(); }
 
 	bool has_symbol() const { return _symbol != nullptr; }
-	bool has_action() const { return static_cast<bool>(_action); }
 	bool has_transition_to_state() const { return static_cast<bool>(_enter_state); }
 
-	template <typename CallbackT>
-	void set_action(CallbackT&& action)
-	{
-		_action = std::forward<CallbackT>(action);
-	}
-
-	template <typename... Args>
-	ValueT perform_action(Args&&... args) const
-	{
-		return _action(std::forward<Args>(args)...);
-	}
-
 	void set_transition_to_state(const std::string& state)
 	{
 		_enter_state = state;
@@ -73,7 +61,6 @@ private:
 	std::string _pattern;
 	const SymbolType* _symbol;
 	std::unique_ptr<re2::RE2> _regexp;
-	CallbackType _action;
 	std::optional<std::string> _enter_state;
 	std::vector<std::string> _active_in_states;
 };
@@ -2,7 +2,7 @@
 
 #include <pog/grammar.h>
 #include <pog/token.h>
-#include <pog/tokenizer.h>
+#include <pog/tokenizer_definition.h>
 
 namespace pog {
 
@@ -13,21 +13,20 @@ public:
 	using GrammarType = Grammar<ValueT>;
 	using SymbolType = Symbol<ValueT>;
 	using TokenType = Token<ValueT>;
-	using TokenizerType = Tokenizer<ValueT>;
+	using TokenizerDefinitionType = TokenizerDefinition<ValueT>;
 
-	TokenBuilder(GrammarType* grammar, TokenizerType* tokenizer) : _grammar(grammar), _tokenizer(tokenizer), _pattern("$"),
-		_symbol_name(), _precedence(), _action(), _fullword(false), _end_token(true), _in_states{std::string{TokenizerType::DefaultState}}, _enter_state() {}
+	TokenBuilder(GrammarType* grammar, TokenizerDefinitionType* tokenizer) : _grammar(grammar), _tokenizer(tokenizer), _pattern("$"),
+		_symbol_name(), _precedence(), _action(), _fullword(false), _end_token(true), _in_states{std::string{TokenizerDefinitionType::DefaultState}}, _enter_state() {}
 
-	TokenBuilder(GrammarType* grammar, TokenizerType* tokenizer, const std::string& pattern) : _grammar(grammar), _tokenizer(tokenizer), _pattern(pattern),
-		_symbol_name(), _precedence(), _action(), _fullword(false), _end_token(false), _in_states{std::string{TokenizerType::DefaultState}}, _enter_state() {}
+	TokenBuilder(GrammarType* grammar, TokenizerDefinitionType* tokenizer, const std::string& pattern) : _grammar(grammar), _tokenizer(tokenizer), _pattern(pattern),
+		_symbol_name(), _precedence(), _action(), _fullword(false), _end_token(false), _in_states{std::string{TokenizerDefinitionType::DefaultState}}, _enter_state() {}
 
 	void done()
 	{
-		TokenType* token;
 		if (!_end_token)
 		{
 			auto* symbol = !_symbol_name.empty() ? _grammar->add_symbol(SymbolKind::Terminal, _symbol_name) : nullptr;
-			token = _tokenizer->add_token(_fullword ? fmt::format("{}(\\b|$)", _pattern) : _pattern, symbol, std::move(_in_states));
+			auto* token = _tokenizer->add_token(_fullword ? fmt::format("{}(\\b|$)", _pattern) : _pattern, symbol, std::move(_in_states));
 			if (symbol && _precedence)
 			{
 				const auto& prec = _precedence.value();
@@ -42,13 +41,21 @@ public:
 		}
 		else
 		{
-			token = _tokenizer->get_end_token();
+			auto* token = _tokenizer->get_end_token();
 			for (auto&& state : _in_states)
 				token->add_active_in_state(std::move(state));
 		}
+	}
 
-		if (_action)
-			token->set_action(std::move(_action));
+	bool is_end_token() const
+	{
+		return _end_token;
+	}
+
+	// Action is not stored in the token itself but it is taken by the tokenizer of the parser, see Rule::CallbackType.
+	typename TokenType::CallbackType take_action()
+	{
+		return std::move(_action);
 	}
 
 	TokenBuilder& symbol(const std::string& symbol_name)
@@ -97,7 +104,7 @@ public:
 
 private:
 	GrammarType* _grammar;
-	TokenizerType* _tokenizer;
+	TokenizerDefinitionType* _tokenizer;
 	std::string _description;
 	std::string _pattern;
 	std::string _symbol_name;
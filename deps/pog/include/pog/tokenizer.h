@@ -2,10 +2,11 @@
 
 #include <cassert>
 #include <memory>
+#include <optional>
+#include <string_view>
 #include <vector>
 
 #include <fmt/format.h>
-#include <re2/set.h>
 
 #ifdef POG_DEBUG
 #define POG_DEBUG_TOKENIZER 1
@@ -19,6 +20,7 @@
 
 #include <pog/grammar.h>
 #include <pog/token.h>
+#include <pog/tokenizer_definition.h>
 
 namespace pog {
 
@@ -39,6 +41,8 @@ struct TokenMatch
 	std::size_t match_length;
 };
 
+// Input is either owned by the stream (when read from std::istream) or only referenced
+// and then it must outlive the tokenization.
 struct InputStream
 {
 	std::unique_ptr<std::string> content;
@@ -46,68 +50,31 @@ struct InputStream
 	bool at_end;
 };
 
-template <typename ValueT>
-struct StateInfo
-{
-	std::string name;
-	std::unique_ptr<re2::RE2::Set> re_set;
-	std::vector<Token<ValueT>*> tokens;
-};
-
+// Tokenizer holds only the state of tokenization (input streams, current state and actions). Tokens
+// and their compiled regular expressions are in TokenizerDefinition which can be shared.
 template <typename ValueT>
 class Tokenizer
 {
 public:
 	using CallbackType = std::function<void(std::string_view)>;
 
-	static constexpr std::string_view DefaultState = "@default";
+	static constexpr std::string_view DefaultState = TokenizerDefinition<ValueT>::DefaultState;
 
 	using GrammarType = Grammar<ValueT>;
 	using StateInfoType = StateInfo<ValueT>;
 	using SymbolType = Symbol<ValueT>;
 	using TokenType = Token<ValueT>;
 	using TokenMatchType = TokenMatch<ValueT>;
+	using TokenizerDefinitionType = TokenizerDefinition<ValueT>;
 
-	Tokenizer(const GrammarType* grammar) : _grammar(grammar), _tokens(), _state_info(), _input_stack(), _current_state(nullptr), _global_action()
-	{
-		_current_state = get_or_make_state_info(std::string{DefaultState});
-		add_token("$", nullptr, std::vector<std::string>{std::string{DefaultState}});
-	}
-
-	void prepare()
-	{
-		std::string error;
-
-		for (const auto& token : _tokens)
-		{
-			for (const auto& state : token->get_active_in_states())
-			{
-				error.clear();
-				auto* state_info = get_or_make_state_info(state);
-				state_info->re_set->Add(token->get_pattern(), &error);
-				state_info->tokens.push_back(token.get());
-				assert(error.empty() && "Error when compiling token regexp");
-			}
-		}
-
-		for (auto&& [name, info] : _state_info)
-			info.re_set->Compile();
-	}
-
-	const std::vector<std::unique_ptr<TokenType>>& get_tokens() const
-	{
-		return _tokens;
-	}
-
-	TokenType* get_end_token() const
-	{
-		return _tokens[0].get();
-	}
+	Tokenizer() : _grammar(nullptr), _definition(nullptr), _token_actions(), _input_stack(), _current_state(nullptr), _global_action() {}
 
-	TokenType* add_token(const std::string& pattern, const SymbolType* symbol, const std::vector<std::string>& states)
+	void prepare(const GrammarType* grammar, const TokenizerDefinitionType* definition, std::vector<typename TokenType::CallbackType>&& token_actions)
 	{
-		_tokens.push_back(std::make_unique<TokenType>(static_cast<std::uint32_t>(_tokens.size()), pattern, states, symbol));
-		return _tokens.back().get();
+		_grammar = grammar;
+		_definition = definition;
+		_token_actions = std::move(token_actions);
+		_current_state = _definition->get_state_info(std::string{DefaultState});
 	}
 
 	void push_input_stream(std::istream& stream)
@@ -121,7 +88,12 @@ public:
 		}
 
 		_input_stack.emplace_back(InputStream{std::make_unique<std::string>(std::move(input)), re2::StringPiece{}, false});
-		_input_stack.back().stream = re2::StringPiece{_input_stack.back().content->c_str()};
+		_input_stack.back().stream = re2::StringPiece{_input_stack.back().content->data(), _input_stack.back().content->size()};
+	}
+
+	void push_input_stream(std::string_view input)
+	{
+		_input_stack.emplace_back(InputStream{nullptr, re2::StringPiece{input.data(), input.size()}, false});
 	}
 
 	void pop_input_stream()
@@ -134,6 +106,16 @@ public:
 		_input_stack.clear();
 	}
 
+	// Input which was not tokenized yet in the stream with the given index, the first pushed stream has index 0
+	std::optional<std::string_view> get_remaining_input(std::size_t index) const
+	{
+		if (index >= _input_stack.size())
+			return std::nullopt;
+
+		const auto& stream = _input_stack[index].stream;
+		return std::string_view{stream.data(), stream.size()};
+	}
+
 	void global_action(CallbackType&& global_action)
 	{
 		_global_action = std::move(global_action);
@@ -154,35 +136,17 @@ public:
 			auto& current_input = _input_stack.back();
 			if (!current_input.at_end)
 			{
-				// Matched patterns doesn't have to be sorted (used to be in older re2 versions) but we shouldn't count on that
-				std::vector<int> matched_patterns;
-				_current_state->re_set->Match(current_input.stream, &matched_patterns);
+				auto match = _current_state->match(current_input.stream);
 
 				// Haven't matched anything, tokenization failure, we will get into endless loop
-				if (matched_patterns.empty())
+				if (!match)
 				{
 					debug_tokenizer("Nothing matched on the current input");
 					return std::nullopt;
 				}
 
-				re2::StringPiece submatch;
-				const TokenType* best_match = nullptr;
-				int longest_match = -1;
-				for (auto pattern_index : matched_patterns)
-				{
-					_current_state->tokens[pattern_index]->get_regexp()->Match(current_input.stream, 0, current_input.stream.size(), re2::RE2::Anchor::ANCHOR_START, &submatch, 1);
-					if (longest_match < static_cast<int>(submatch.size()))
-					{
-						best_match = _current_state->tokens[pattern_index];
-						longest_match = static_cast<int>(submatch.size());
-					}
-					// In case of equal matches, index of tokens chooses which one is it (lower index has higher priority)
-					else if (longest_match == static_cast<int>(submatch.size()))
-					{
-						if (!best_match || static_cast<int>(best_match->get_index()) > pattern_index)
-							best_match = _current_state->tokens[pattern_index];
-					}
-				}
+				const TokenType* best_match = match.value().token;
+				auto longest_match = static_cast<int>(match.value().length);
 
 				if (current_input.stream.size() == 0)
 				{
@@ -204,8 +168,8 @@ public:
 					_global_action(token_str);
 
 				ValueT value{};
-				if (best_match->has_action())
-					value = best_match->perform_action(token_str);
+				if (const auto& action = _token_actions[best_match->get_index()]; action)
+					value = action(token_str);
 
 				if (!best_match->has_symbol())
 					continue;
@@ -224,37 +188,17 @@ public:
 
 	void enter_state(const std::string& state)
 	{
-		_current_state = get_state_info(state);
+		_current_state = _definition->get_state_info(state);
 		assert(_current_state && "Transition to unknown state in tokenizer");
 	}
 
 private:
-	StateInfoType* get_or_make_state_info(const std::string& name)
-	{
-		auto itr = _state_info.find(name);
-		if (itr == _state_info.end())
-			std::tie(itr, std::ignore) = _state_info.emplace(name, StateInfoType{
-				name,
-				std::make_unique<re2::RE2::Set>(re2::RE2::DefaultOptions, re2::RE2::Anchor::ANCHOR_START),
-				std::vector<TokenType*>{}
-			});
-		return &itr->second;
-	}
-
-	StateInfoType* get_state_info(const std::string& name)
-	{
-		auto itr = _state_info.find(name);
-		if (itr == _state_info.end())
-			return nullptr;
-		return &itr->second;
-	}
-
 	const GrammarType* _grammar;
-	std::vector<std::unique_ptr<TokenType>> _tokens;
+	const TokenizerDefinitionType* _definition;
+	std::vector<typename TokenType::CallbackType> _token_actions;
 
-	std::unordered_map<std::string, StateInfoType> _state_info;
 	std::vector<InputStream> _input_stack;
-	StateInfoType* _current_state;
+	const StateInfoType* _current_state;
 	CallbackType _global_action;
 };
 
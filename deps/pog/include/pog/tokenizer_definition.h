@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cassert>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <re2/set.h>
+
+#include <pog/scanner.h>
+#include <pog/token.h>
+
+namespace pog {
+
+template <typename ValueT>
+struct LongestMatch
+{
+	const Token<ValueT>* token;
+	std::size_t length;
+};
+
+template <typename ValueT>
+struct StateInfo
+{
+	using LongestMatchType = LongestMatch<ValueT>;
+
+	std::string name;
+	std::unique_ptr<re2::RE2::Set> re_set;
+	std::unique_ptr<Scanner> scanner;
+	std::vector<Token<ValueT>*> tokens;
+
+	// Finds the longest match of all tokens in this state. If more tokens match the same length,
+	// the one defined first is chosen. Returns std::nullopt if no token matched.
+	std::optional<LongestMatchType> match(const re2::StringPiece& input) const
+	{
+		if (scanner)
+		{
+			auto result = scanner->match(std::string_view{input.data(), input.size()});
+			if (result.status == ScanResult::Status::Matched)
+				return LongestMatchType{tokens[result.pattern], result.length};
+			else if (result.status == ScanResult::Status::NoMatch)
+				return std::nullopt;
+		}
+
+		return match_with_regexps(input);
+	}
+
+	// Same as match() but always uses RE2, which finds all candidate tokens first and then matches each of them.
+	std::optional<LongestMatchType> match_with_regexps(const re2::StringPiece& input) const
+	{
+		// Matched patterns doesn't have to be sorted (used to be in older re2 versions) but we shouldn't count on that
+		std::vector<int> matched_patterns;
+		re_set->Match(input, &matched_patterns);
+		if (matched_patterns.empty())
+			return std::nullopt;
+
+		re2::StringPiece submatch;
+		const Token<ValueT>* best_match = nullptr;
+		int longest_match = -1;
+		for (auto pattern_index : matched_patterns)
+		{
+			const auto* token = tokens[pattern_index];
+			token->get_regexp()->Match(input, 0, input.size(), re2::RE2::Anchor::ANCHOR_START, &submatch, 1);
+			// In case of equal matches, index of tokens chooses which one is it (lower index has higher priority)
+			if (longest_match < static_cast<int>(submatch.size())
+				|| (longest_match == static_cast<int>(submatch.size()) && best_match->get_index() > token->get_index()))
+			{
+				best_match = token;
+				longest_match = static_cast<int>(submatch.size());
+			}
+		}
+
+		return LongestMatchType{best_match, static_cast<std::size_t>(longest_match)};
+	}
+};
+
+// Tokens of the grammar together with compiled regular expressions for every tokenizer state.
+// It is immutable once prepared so it can be shared by tokenizers of multiple parsers, even when they
+// run in different threads, because matching of RE2 and RE2::Set is thread-safe.
+template <typename ValueT>
+class TokenizerDefinition
+{
+public:
+	static constexpr std::string_view DefaultState = "@default";
+
+	using StateInfoType = StateInfo<ValueT>;
+	using SymbolType = Symbol<ValueT>;
+	using TokenType = Token<ValueT>;
+
+	TokenizerDefinition() : _tokens(), _state_info()
+	{
+		get_or_make_state_info(std::string{DefaultState});
+		add_token("$", nullptr, std::vector<std::string>{std::string{DefaultState}});
+	}
+
+	TokenizerDefinition(const TokenizerDefinition&) = delete;
+	TokenizerDefinition(TokenizerDefinition&&) noexcept = default;
+
+	void prepare()
+	{
+		std::string error;
+
+		for (const auto& token : _tokens)
+		{
+			for (const auto& state : token->get_active_in_states())
+			{
+				error.clear();
+				auto* state_info = get_or_make_state_info(state);
+				state_info->re_set->Add(token->get_pattern(), &error);
+				state_info->tokens.push_back(token.get());
+				assert(error.empty() && "Error when compiling token regexp");
+			}
+		}
+
+		for (auto&& [name, info] : _state_info)
+		{
+			info.re_set->Compile();
+
+			// States with patterns which scanner doesn't support are matched only using RE2
+			std::vector<std::string> patterns;
+			for (const auto* token : info.tokens)
+				patterns.push_back(token->get_pattern());
+			info.scanner = Scanner::build(patterns);
+		}
+	}
+
+	const std::vector<std::unique_ptr<TokenType>>& get_tokens() const
+	{
+		return _tokens;
+	}
+
+	TokenType* get_end_token() const
+	{
+		return _tokens[0].get();
+	}
+
+	TokenType* add_token(const std::string& pattern, const SymbolType* symbol, const std::vector<std::string>& states)
+	{
+		_tokens.push_back(std::make_unique<TokenType>(static_cast<std::uint32_t>(_tokens.size()), pattern, states, symbol));
+		return _tokens.back().get();
+	}
+
+	const std::unordered_map<std::string, StateInfoType>& get_states() const
+	{
+		return _state_info;
+	}
+
+	const StateInfoType* get_state_info(const std::string& name) const
+	{
+		auto itr = _state_info.find(name);
+		if (itr == _state_info.end())
+			return nullptr;
+		return &itr->second;
+	}
+
+private:
+	StateInfoType* get_or_make_state_info(const std::string& name)
+	{
+		auto itr = _state_info.find(name);
+		if (itr == _state_info.end())
+			std::tie(itr, std::ignore) = _state_info.emplace(name, StateInfoType{
+				name,
+				std::make_unique<re2::RE2::Set>(re2::RE2::DefaultOptions, re2::RE2::Anchor::ANCHOR_START),
+				nullptr,
+				std::vector<TokenType*>{}
+			});
+		return &itr->second;
+	}
+
+	std::vector<std::unique_ptr<TokenType>> _tokens;
+	std::unordered_map<std::string, StateInfoType> _state_info;
+};
+
+} // namespace pog
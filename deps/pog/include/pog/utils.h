@@ -1,9 +1,11 @@
 #pragma once
 
+#include <cstdint>
 #include <ctime>
 #include <functional>
 #include <iomanip>
 #include <sstream>
+#include <string_view>
 #include <variant>
 #include <utility>
 
@@ -50,6 +52,18 @@ inline std::size_t hash_combine(const Rest&... rest)
 	return seed;
 }
 
+// 64-bit FNV-1a hash. Unlike std::hash, its value is stable across platforms
+// and standard library implementations so it can be persisted.
+inline std::uint64_t fnv1a_hash(std::string_view data, std::uint64_t seed = 0xcbf29ce484222325ULL)
+{
+	for (auto c : data)
+	{
+		seed ^= static_cast<std::uint8_t>(c);
+		seed *= 0x100000001b3ULL;
+	}
+	return seed;
+}
+
 template<class... Ts> struct overloaded : Ts... { using Ts::operator()...; };
 template<class... Ts> overloaded(Ts...) -> overloaded<Ts...>;
 
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <memory>
+#include <string_view>
 
 #include "yaramod/parser/location.h"
 #include "yaramod/types/token_stream.h"
@@ -21,22 +22,23 @@ namespace yaramod {
 class FileContext
 {
 public:
-	FileContext(std::istream* stream) : FileContext("[stream]", stream) {}
-	FileContext(const std::string& filePath, std::istream* stream) : _tokenStream(std::make_shared<TokenStream>()), _stream(stream), _location(filePath) {}
-	FileContext(const std::string& filePath, std::istream* stream, const std::shared_ptr<TokenStream>& tokenStream) : _tokenStream(tokenStream), _stream(stream), _location(filePath) {}
+	FileContext(std::string_view input) : FileContext("[stream]", input) {}
+	FileContext(const std::string& filePath, std::string_view input) : _tokenStream(std::make_shared<TokenStream>()), _input(input), _location(filePath) {}
+	FileContext(const std::string& filePath, std::string_view input, const std::shared_ptr<TokenStream>& tokenStream) : _tokenStream(tokenStream), _input(input), _location(filePath) {}
 	FileContext(const FileContext&) = delete;
 	FileContext(FileContext&&) noexcept = default;
 
 	bool isUnnamed() const { return _location.isUnnamed(); }
 
 	const std::shared_ptr<TokenStream>& getTokenStream() const { return _tokenStream; }
-	std::istream* getStream() const { return _stream; }
+	void setTokenStream(const std::shared_ptr<TokenStream>& tokenStream) { _tokenStream = tokenStream; }
+	std::string_view getInput() const { return _input; }
 	Location& getLocation() { return _location; }
 	const Location& getLocation() const { return _location; }
 
 private:
 	std::shared_ptr<TokenStream> _tokenStream;
-	std::istream* _stream;
+	std::string_view _input; ///< Content of the file, owned by the parser driver or its caller
 	Location _location;
 };
 
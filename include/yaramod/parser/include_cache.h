@@ -0,0 +1,110 @@
+/**
+ * @file src/parser/include_cache.h
+ * @brief Declaration of class IncludeCache.
+ * @copyright (c) 2026 Avast Software, licensed under the MIT license
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "yaramod/types/features.h"
+#include "yaramod/types/rule.h"
+#include "yaramod/types/token_stream.h"
+
+namespace yaramod {
+
+/**
+ * Hash of the content of an included file. The size of the content is kept
+ * along with the 128-bit hash and both have to match.
+ */
+struct ContentHash
+{
+	std::uint64_t size = 0; ///< Size of the content in bytes
+	std::uint64_t low = 0; ///< Lower half of the hash
+	std::uint64_t high = 0; ///< Upper half of the hash
+
+	bool operator==(const ContentHash& other) const { return size == other.size && low == other.low && high == other.high; }
+	bool operator!=(const ContentHash& other) const { return !(*this == other); }
+};
+
+/**
+ * Result of parsing of an included file which can be used in place of parsing
+ * the same file again. The cache keeps its own copy which is never modified and every
+ * file the include is used in gets a separate copy of the tokens and the rules (see clone()).
+ */
+struct ParsedInclude
+{
+	std::shared_ptr<ParsedInclude> clone() const;
+
+	Features features; ///< Features of the parser which parsed the include
+	std::shared_ptr<TokenStream> tokenStream; ///< Tokens of the included file
+	std::vector<std::shared_ptr<Rule>> rules; ///< Rules of the included file including the rules of its nested includes
+	std::vector<TokenIt> imports; ///< Imports of the included file and its nested includes
+	std::vector<std::pair<std::string, ContentHash>> includedFiles; ///< Absolute paths and content hashes of the nested includes
+	std::unordered_set<std::string> undefinedSymbols; ///< Names looked up in the file which were not defined at that point
+};
+
+/**
+ * Interface of the cache of parsed include files used by ParserDriver. Included files are
+ * identified by their absolute path and the hash of their content, so an include is reused
+ * only as long as the file doesn't change. Only includes which don't depend on the file
+ * they are included from are stored in the cache.
+ *
+ * Implementations have to be thread-safe if they are shared by drivers running
+ * in multiple threads.
+ */
+class IncludeCache
+{
+public:
+	/// @name Destructor
+	/// @{
+	virtual ~IncludeCache() = default;
+	/// @}
+
+	/// @name Cache manipulation
+	/// @{
+	virtual std::shared_ptr<const ParsedInclude> find(const std::string& filePath, const ContentHash& contentHash) = 0;
+	virtual void store(const std::string& filePath, const ContentHash& contentHash, const std::shared_ptr<const ParsedInclude>& include) = 0;
+	virtual void clear() = 0;
+	/// @}
+
+	/// @name Hashing
+	/// @{
+	static ContentHash hashContent(std::string_view content);
+	/// @}
+};
+
+/**
+ * Cache of parsed include files kept in memory. Only the most recent content
+ * of every file is kept.
+ */
+class MemoryIncludeCache : public IncludeCache
+{
+public:
+	/// @name Cache manipulation
+	/// @{
+	virtual std::shared_ptr<const ParsedInclude> find(const std::string& filePath, const ContentHash& contentHash) override;
+	virtual void store(const std::string& filePath, const ContentHash& contentHash, const std::shared_ptr<const ParsedInclude>& include) override;
+	virtual void clear() override;
+	/// @}
+
+	/// @name Getter methods
+	/// @{
+	std::size_t size() const;
+	/// @}
+
+private:
+	mutable std::mutex _mutex; ///< Guards access to the stored includes
+	std::unordered_map<std::string, std::pair<ContentHash, std::shared_ptr<const ParsedInclude>>> _includes; ///< Parsed includes with hashes of their content indexed by their paths
+};
+
+} // namespace yaramod
@@ -0,0 +1,96 @@
+/**
+ * @file src/parser/include_prefetcher.h
+ * @brief Declaration of class IncludePrefetcher.
+ * @copyright (c) 2026 Avast Software, licensed under the MIT license
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "yaramod/utils/mapped_file.h"
+
+namespace yaramod {
+
+/**
+ * Reads included files ahead of the parser on a pool of worker threads.
+ *
+ * Content of every file handed over to the prefetcher is scanned for include directives
+ * and the files they refer to are opened and read by the workers, together with the files
+ * they include. Once the parser reaches the include directive, it takes the already read
+ * file from the prefetcher. Files which were not found by the scan or which were already
+ * taken are opened by the parser itself, so the prefetcher never changes what is parsed.
+ */
+class IncludePrefetcher
+{
+public:
+	/// @name Constructors
+	/// @{
+	explicit IncludePrefetcher(std::size_t threads);
+	IncludePrefetcher(const IncludePrefetcher&) = delete;
+	IncludePrefetcher(IncludePrefetcher&&) = delete;
+	/// @}
+
+	/// @name Destructor
+	/// @{
+	~IncludePrefetcher();
+	/// @}
+
+	/// @name Assignment
+	/// @{
+	IncludePrefetcher& operator=(const IncludePrefetcher&) = delete;
+	IncludePrefetcher& operator=(IncludePrefetcher&&) = delete;
+	/// @}
+
+	/// @name Prefetching
+	/// @{
+	void prefetchIncludesOf(const std::string& filePath, std::string_view content);
+	std::unique_ptr<MappedFile> take(const std::string& filePath);
+	void stop();
+	/// @}
+
+	/// @name Scanning
+	/// @{
+	static std::vector<std::string> findIncludes(std::string_view content);
+	/// @}
+
+private:
+	/**
+	 * File known to the prefetcher.
+	 */
+	struct PrefetchedFile
+	{
+		enum class State
+		{
+			Queued, ///< Waits for a worker
+			Reading, ///< Worker reads the file
+			Read, ///< File was read
+			Taken ///< File was handed over to the parser or the parser opened it itself
+		};
+
+		State state = State::Queued;
+		std::unique_ptr<MappedFile> file; ///< Read file, @c nullptr until it is read
+	};
+
+	void _enqueueIncludesOf(const std::string& filePath, std::string_view content);
+	void _work();
+
+	std::size_t _threads; ///< Maximal number of workers
+	std::mutex _mutex; ///< Guards the state of the files
+	std::condition_variable _queued; ///< Signals files waiting for a worker
+	std::condition_variable _read; ///< Signals files which were read
+	std::deque<std::string> _queue; ///< Absolute paths of files waiting for a worker
+	std::unordered_map<std::string, PrefetchedFile> _files; ///< Files indexed by their absolute paths
+	std::vector<std::thread> _workers; ///< Worker threads, started with the first queued file
+	bool _stopping = false; ///< Workers are asked to finish
+};
+
+} // namespace yaramod
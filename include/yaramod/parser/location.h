@@ -7,12 +7,22 @@
 #pragma once
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
+#include <limits>
 #include <sstream>
+#include <string>
 
 namespace yaramod {
 
+/**
+ * Class representing the range in a source file. Every token carries its location so it is kept small,
+ * the file path is stored only once in the process-wide table of file paths and the location refers to it
+ * by its index. Paths are never removed from the table, so it grows with the number of distinct paths
+ * used by the process. Lines and columns are stored in 32 bits, larger values saturate at the maximum
+ * representable value.
+ */
 class Location
 {
 public:
@@ -30,6 +40,10 @@ public:
 
 		std::size_t line;
 		std::size_t column;
+		friend bool operator<(const Position& lhs, const Position& rhs)
+		{
+			return lhs.line < rhs.line || (lhs.line == rhs.line && lhs.column < rhs.column);
+		}
 		friend std::ostream& operator<<(std::ostream& os, const Position& position)
 		{
 			os << position.getLine() << '.' << position.getColumn();
@@ -37,12 +51,12 @@ public:
 		}
 	};
 
-	Location() : Location(std::string{}) {}
+	Location() : _fileId(0), _begin{1, 0}, _end{1, 0} {}
 	Location(const std::string& filePath) : Location(filePath, 1, 0) {}
 	Location(const std::string& filePath, std::size_t line, std::size_t column)
-		: _filePath(filePath), _begin(line, column), _end(line, column) {}
+		: Location(filePath, Position{line, column}, Position{line, column}) {}
 	Location(const std::string& filePath, const Position &begin, const Position& end)
-		: _filePath(filePath), _begin(begin), _end(end) {}
+		: _fileId(registerFilePath(filePath)), _begin(compact(begin)), _end(compact(end)) {}
 	Location(const Location&) = default;
 	Location(Location&&) noexcept = default;
 
@@ -54,14 +68,20 @@ public:
 	void addLine(std::size_t count = 1)
 	{
 		std::swap(_begin, _end);
-		_end.line = _begin.line + count; // line
+		_end.line = add(_begin.line, count); // line
 		_end.column = 0; // column
 	}
 
 	void addColumn(std::size_t count)
 	{
 		_begin = _end;
-		_end.column += count;
+		_end.column = add(_end.column, count);
+	}
+
+	void shiftLines(std::ptrdiff_t count)
+	{
+		_begin.line = shift(_begin.line, count);
+		_end.line = shift(_end.line, count);
 	}
 
 	void reset()
@@ -72,22 +92,23 @@ public:
 
 	void setBegin(const Position& begin)
 	{
-		_begin.line = begin.line;
-		_begin.column = begin.column - 1;
+		_begin.line = saturate(begin.line);
+		_begin.column = begin.column > 0 ? saturate(begin.column - 1) : 0;
 	}
 	/// @}
 
 	/// @name Getters
 	/// @{
-	bool isUnnamed() const { return _filePath == "[stream]"; }
+	bool isUnnamed() const { return _fileId == StreamFileId; }
+	bool isSameFile(const Location& other) const { return _fileId == other._fileId; }
 	/**
 	 * Returns the absolute path of a file in which this rule was located.
 	 * Returns "[stream]" in case this rule was parsed from input stream and not a file,
 	 * or if this file was created with `YaraRuleBuilder`.
 	 */
-	const std::string& getFilePath() const { return _filePath; }
-	Position begin() const { return {_begin.line, _begin.column + 1}; }
-	const Position& end() const { return _end; }
+	const std::string& getFilePath() const { return lookupFilePath(_fileId); }
+	Position begin() const { return {_begin.line, _begin.column + std::size_t{1}}; }
+	Position end() const { return {_end.line, _end.column}; }
 	std::string getText() const
 	{
 		std::ostringstream ss;
@@ -109,9 +130,49 @@ public:
 	}
 
 private:
-	std::string _filePath;
-	Position _begin;
-	Position _end;
+	/**
+	 * Position stored in the location. Lines and columns of real files fit into 32 bits,
+	 * anything larger is saturated.
+	 */
+	struct CompactPosition
+	{
+		std::uint32_t line;
+		std::uint32_t column;
+	};
+
+	static constexpr std::uint32_t StreamFileId = 1; ///< Index of "[stream]" in the table of file paths
+
+	static constexpr std::uint32_t MaxPosition = std::numeric_limits<std::uint32_t>::max();
+
+	static std::uint32_t saturate(std::size_t value)
+	{
+		return static_cast<std::uint32_t>(std::min<std::size_t>(value, MaxPosition));
+	}
+
+	static std::uint32_t add(std::uint32_t value, std::size_t count)
+	{
+		return count >= MaxPosition - value ? MaxPosition : static_cast<std::uint32_t>(value + count);
+	}
+
+	static std::uint32_t shift(std::uint32_t value, std::ptrdiff_t count)
+	{
+		if (count >= 0)
+			return add(value, static_cast<std::size_t>(count));
+		auto decrease = static_cast<std::size_t>(-(count + 1)) + 1;
+		return decrease >= value ? 0 : static_cast<std::uint32_t>(value - decrease);
+	}
+
+	static CompactPosition compact(const Position& position)
+	{
+		return {saturate(position.line), saturate(position.column)};
+	}
+
+	static std::uint32_t registerFilePath(const std::string& filePath);
+	static const std::string& lookupFilePath(std::uint32_t fileId);
+
+	std::uint32_t _fileId; ///< Index of the file path in the table of file paths
+	CompactPosition _begin;
+	CompactPosition _end;
 };
 
 } //namespace yaramod
@@ -8,8 +8,11 @@
 
 #include <climits>
 #include <fstream>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <unordered_map>
+#include <vector>
 
 #define FMT_HEADER_ONLY 1
 
@@ -19,6 +22,9 @@
 #include <pog/pog.h>
 
 #include "yaramod/parser/file_context.h"
+#include "yaramod/parser/include_cache.h"
+#include "yaramod/parser/include_prefetcher.h"
+#include "yaramod/parser/parser_profile.h"
 #include "yaramod/parser/uid_generator.h"
 #include "yaramod/parser/value.h"
 #include "yaramod/types/expressions.h"
@@ -28,6 +34,7 @@
 #include "yaramod/types/symbol.h"
 #include "yaramod/types/token_stream.h"
 #include "yaramod/types/yara_file.h"
+#include "yaramod/utils/mapped_file.h"
 #include "yaramod/utils/trie.h"
 #include "yaramod/yaramod_error.h"
 
@@ -54,6 +61,25 @@ enum IncludeResult
 	Included ///< File was successfully included
 };
 
+/**
+ * Range of the input which was changed since the input was parsed last time.
+ */
+struct InputChange
+{
+	std::size_t offset; ///< Offset of the first changed byte in the new input
+	std::size_t length; ///< Number of bytes written there in the new input, 0 if the bytes were only removed
+};
+
+/**
+ * Result of parsing the changed input again.
+ */
+enum class ReparseResult
+{
+	Error, ///< Failed to parse the input
+	Incremental, ///< Only the rules affected by the changes were parsed again
+	Full ///< The whole input was parsed again
+};
+
 enum class ExpressionArrayType
 {
 	Undetermined, // If the array is just ($s0, $s1) - it's undetermined but we turn it into string set in the end
@@ -71,7 +97,19 @@ public:
 		: YaramodError(errorMsg)
 	{
 	}
+	ParserError(const std::string& errorMsg, const Location& location)
+		: YaramodError(errorMsg), _location(location)
+	{
+	}
 	ParserError(const ParserError&) = default;
+
+	const Location& getLocation() const noexcept
+	{
+		return _location;
+	}
+
+private:
+	Location _location; ///< Location of the error, default location if it is not known
 };
 
 /**
@@ -82,14 +120,43 @@ public:
  * driver.parse(input, ParserMode::Regular);
  * result = driver.getParsedFile();
  * driver.reset();
+ *
+ * When a rule callback is passed to parse, every rule is handed over to the callback
+ * right after it is parsed together with the file parsed so far, which contains the imports
+ * the rule can use. The rule gets its own token stream so its tokens are released together
+ * with the rule and the parsed file keeps only the imports and includes.
+ *
+ * When the input of already parsed file is edited, reparse parses again only the rules
+ * touched by the changes and keeps the rest of the file including its tokens as it is.
+ *
+ * When an include cache is set, included files which don't depend on the file they are
+ * included from are stored there after they are parsed and their tokens and rules are
+ * reused next time the same content is included.
+ *
+ * When error recovery is turned on, errors don't stop the parsing. Every error is collected,
+ * the rule or other item of the top-level input it occurred in is dropped and the parsing
+ * resumes at the next line starting a rule, import or include. The parsed file then contains
+ * everything that was parsed successfully. Errors are not recovered in streaming mode.
+ *
+ * When profiling is turned on, every parsing measures the time spent in its phases
+ * and counts the processed tokens, reductions, symbol lookups and files. The profile
+ * of the last parsing is available through getProfile.
+ *
+ * When arena allocation is turned on, expressions of conditions are allocated in the arena
+ * of the parsed file (see ExpressionArena) instead of the heap. It reduces the number of
+ * allocations, expressions stay reference counted as before. Any expression kept after its
+ * file is destroyed keeps all memory of the arena alive. Streamed rules get an arena of their
+ * own so the memory is released together with the rule.
  */
 class ParserDriver
 {
 public:
+	using RuleCallback = std::function<void(std::unique_ptr<Rule>&& rule, const YaraFile& file)>;
+
 	/// @name Constructors
 	/// @{
 	ParserDriver(Features features = Features::AllCurrent, const std::string& moduleDirectory = "");
-	ParserDriver(Features features, const std::shared_ptr<ModulePool>& modulePool);
+	ParserDriver(Features features, const std::shared_ptr<const ModulePool>& modulePool);
 	/// @}
 
 	/// @name Destructor
@@ -102,12 +169,59 @@ public:
 	YaraFile&& getParsedFile();
 	const YaraFile& getParsedFile() const;
 	std::map<std::string, Module*> getModules() const;
+	std::shared_ptr<const ModulePool> getModulePool() const { return _modules; }
+	const std::shared_ptr<const pog::ParserDefinition<Value>>& getParserDefinition() const { return _parser.get_definition(); }
+	/// @}
+
+	/// @name Include cache
+	/// @{
+	void setIncludeCache(const std::shared_ptr<IncludeCache>& includeCache) { _includeCache = includeCache; }
+	const std::shared_ptr<IncludeCache>& getIncludeCache() const { return _includeCache; }
+	/// @}
+
+	/// @name Error recovery
+	/// @{
+	void setErrorRecovery(bool errorRecovery) { _errorRecovery = errorRecovery; }
+	bool getErrorRecovery() const { return _errorRecovery; }
+	const std::vector<ParserError>& getErrors() const { return _errors; }
+	/// @}
+
+	/// @name Profiling
+	/// @{
+	void setProfiling(bool profiling);
+	bool getProfiling() const { return _profiling; }
+	const ParserProfile& getProfile() const { return _profile; }
+	/// @}
+
+	/// @name Arena allocation
+	/// @{
+	// Reduces the number of allocations only, an expression kept after its file keeps the whole arena alive
+	void setArenaAllocation(bool arenaAllocation) { _arenaAllocation = arenaAllocation; }
+	bool getArenaAllocation() const { return _arenaAllocation; }
+	/// @}
+
+	/// @name Include prefetching
+	/// @{
+	void setIncludePrefetchThreads(std::size_t threads) { _includePrefetchThreads = threads; }
+	std::size_t getIncludePrefetchThreads() const { return _includePrefetchThreads; }
+	/// @}
+
+	/// @name Shared grammar
+	/// @{
+	static void clearSharedParserDefinitions();
 	/// @}
 
 	/// @name Parsing methods
 	/// @{
 	bool parse(std::istream& stream, ParserMode mode = ParserMode::Regular);
+	bool parse(std::string_view input, ParserMode mode = ParserMode::Regular);
 	bool parse(const std::string& filePath, ParserMode mode = ParserMode::Regular);
+	bool parse(const char* filePath, ParserMode mode = ParserMode::Regular) { return parse(std::string{filePath}, mode); }
+	bool parse(std::istream& stream, const RuleCallback& onRule, ParserMode mode = ParserMode::Regular);
+	bool parse(std::string_view input, const RuleCallback& onRule, ParserMode mode = ParserMode::Regular);
+	bool parse(const std::string& filePath, const RuleCallback& onRule, ParserMode mode = ParserMode::Regular);
+	bool parse(const char* filePath, const RuleCallback& onRule, ParserMode mode = ParserMode::Regular) { return parse(std::string{filePath}, onRule, mode); }
+	ReparseResult reparse(YaraFile& file, std::string_view input, const std::vector<InputChange>& changes, ParserMode mode = ParserMode::Regular);
 	/// @}
 
 	/// @name Detection methods
@@ -124,7 +238,8 @@ protected:
 	/// @name Method for parsing
 	/// @{
 	void initialize();
-	bool prepareParser(ParserMode parserMode);
+	bool prepareParser(ParserMode parserMode, const RuleCallback& onRule = {});
+	bool parseInput(std::string_view input, const std::string& filePath = "[stream]");
 	bool parseImpl();
 	void reset(ParserMode parserMode);
 	/// @}
@@ -137,12 +252,65 @@ protected:
 
 	/// @name Methods for handling includes
 	/// @{
-	bool includeFile(const std::string& includePath, const std::shared_ptr<TokenStream>& tokenStream);
+	bool includeFile(const std::string& includePath, TokenIt includeToken);
 	IncludeResult includeFileImpl(const std::string& includePath, std::optional<std::shared_ptr<TokenStream>> = std::nullopt);
 	bool isAlreadyIncluded(const std::string& includePath);
 	bool includeEnd();
 	/// @}
 
+	/// @name Methods for handling cached includes
+	/// @{
+	bool cachingIncludes() const;
+	bool useCachedInclude(const std::string& filePath, const ContentHash& contentHash, TokenIt includeToken);
+	void recordDefinedSymbol(const std::string& name);
+	void recordImport(TokenIt import);
+	void recordSymbolLookup(const std::string& name, bool found);
+	void finishIncludeRecordings();
+	/// @}
+
+	/// @name Methods for error recovery
+	/// @{
+	bool recoveringErrors() const { return _errorRecovery && !streamingMode() && !_reparsing; }
+	std::optional<Value> parseRecovering();
+	void markRecoveryPoint();
+	static std::optional<std::size_t> findRecoveryPoint(std::string_view input, std::size_t begin, std::size_t errorOffset);
+	/// @}
+
+	/// @name Methods for profiling
+	/// @{
+	ParserProfile* activeProfile() { return _profiling ? &_profile : nullptr; }
+	/// @}
+
+	/// @name Methods for allocating expressions
+	/// @{
+	template <typename T, typename... Args>
+	std::shared_ptr<T> makeExpression(Args&&... args)
+	{
+		if (const auto& arena = _file.getExpressionArena(); _arenaAllocation && arena)
+			return arena->make<T>(std::forward<Args>(args)...);
+		return std::make_shared<T>(std::forward<Args>(args)...);
+	}
+	/**
+	 * Creates logical operation which continues the chain of its left operand
+	 * if there is one, otherwise creates plain binary operation. Operations
+	 * created over the chain later on are allocated in the same arena.
+	 */
+	template <typename T>
+	std::shared_ptr<T> makeChainedExpression(Expression::Ptr&& left, TokenIt op, Expression::Ptr&& right, std::uint64_t uid)
+	{
+		if (auto chain = BinaryOpExpression::continueChain(left, expressionKindOf<T>()))
+		{
+			if (_arenaAllocation)
+				chain->setArena(_file.getExpressionArena());
+			chain->append(op, std::move(right), false, uid);
+			auto operands = chain->getOperandsCount();
+			return makeExpression<T>(currentTokenStream(), std::move(chain), operands);
+		}
+		return makeExpression<T>(std::move(left), op, std::move(right));
+	}
+	void startExpressionArena();
+	/// @}
+
 	/// @name Methods for handling rules
 	/// @{
 	bool ruleExists(const std::string& name) const;
@@ -151,6 +319,30 @@ protected:
 	void addRule(std::unique_ptr<Rule>&& rule);
 	/// @}
 
+	/// @name Methods for handling streamed rules
+	/// @{
+	bool streamingMode() const { return static_cast<bool>(_onRule); }
+	void beginStreamedRule(TokenIt firstToken);
+	void endStreamedRule(const Rule& rule);
+	/// @}
+
+	/// @name Methods for incremental parsing
+	/// @{
+	struct ReparseWindow
+	{
+		TokenIt firstToken; ///< First token of the part of the file which is parsed again
+		TokenIt endToken; ///< Token following the part of the file which is parsed again
+		std::size_t firstRule; ///< Index of the first rule parsed again
+		std::size_t endRule; ///< Index of the rule following the rules parsed again
+		std::size_t beginOffset; ///< Offset of the part in the new input
+		std::size_t endOffset; ///< Offset of the end of the part in the new input
+		std::size_t line; ///< Line the part begins at
+		std::ptrdiff_t lineShift; ///< Number of lines the rest of the file moved by
+	};
+	std::optional<ReparseWindow> findReparseWindow(const YaraFile& file, std::string_view input, const std::vector<InputChange>& changes) const;
+	bool reparseWindow(YaraFile& file, std::string_view input, const ReparseWindow& window);
+	/// @}
+
 	/// @name Methods for handling strings
 	/// @{
 	bool stringExists(const std::string& id) const;
@@ -166,8 +358,10 @@ protected:
 	void defineTokens();
 	void defineGrammar();
 	template <typename... Args> TokenIt emplace_back(Args&&... args);
+	TokenIt emplace_interned(TokenType type, std::string_view str);
 	void enter_state(const std::string& state);
 	void push_input_stream(std::istream& input) { _parser.push_input_stream(input); }
+	void push_input_stream(std::string_view input) { _parser.push_input_stream(input); }
 	/// @}
 
 	/// @name Methods for handling for loops
@@ -179,7 +373,7 @@ protected:
 
 	/// @name Methods for handling symbols
 	/// @{
-	std::shared_ptr<Symbol> findSymbol(const std::string& name) const;
+	std::shared_ptr<Symbol> findSymbol(const std::string& name);
 	bool addLocalSymbol(const std::shared_ptr<Symbol>& symbol);
 	void removeLocalSymbol(const std::string& name);
 	/// @}
@@ -238,12 +432,13 @@ private:
 	ParserMode _mode; ///< Parser mode.
 
 	Features _features; ///< Used to determine whether to include Avast-specific or VirusTotal-specific symbols or to skip them
-	std::shared_ptr<ModulePool> _modules; ///< Storage of all modules used by this ParserDriver
+	std::shared_ptr<const ModulePool> _modules; ///< Storage of all modules used by this ParserDriver
 
 	std::vector<FileContext> _fileContexts;
 	std::vector<TokenIt> _comments; ///< Tokens of parsed comments
 
-	std::vector<std::shared_ptr<std::istream>> _includedFiles; ///< Stack of included files
+	std::string _streamInput; ///< Content of the parsed input stream
+	std::vector<std::unique_ptr<MappedFile>> _includedFiles; ///< Stack of included files
 	std::unordered_set<std::string> _includedFilesCache; ///< Cache of already included files
 
 	bool _valid; ///< Validity
@@ -261,6 +456,43 @@ private:
 	std::vector<std::string> _deferredIncludes; ///< Paths of included files when deferred includes are turned on.
 
 	std::vector<ExpressionArrayType> _expressionArrayStack; ///< Indicates type of currently parsed expression array (..., ...)
+
+	RuleCallback _onRule; ///< Receives parsed rules in streaming mode
+	std::shared_ptr<TokenStream> _outerTokenStream; ///< Token stream the currently streamed rule was taken out of
+	std::unordered_map<std::string, std::shared_ptr<Symbol>> _streamedRules; ///< Symbols of rules already handed over to the callback
+
+	bool _reparsing = false; ///< Set while only a part of the file is parsed again
+	std::optional<Location::Position> _reparseEnd; ///< Position of the first token following the part of the file which is parsed again
+	std::unordered_map<std::string, std::shared_ptr<Symbol>> _reparsedRules; ///< Symbols of the rules which are parsed again
+
+	/**
+	 * Included file which is being parsed and will be stored in the include cache.
+	 */
+	struct IncludeRecording
+	{
+		std::string filePath; ///< Absolute path to the file
+		ContentHash contentHash; ///< Hash of the content of the file
+		std::size_t fileContextDepth; ///< Number of file contexts while the file is parsed
+		std::size_t firstRule; ///< Index of the first rule of the file in the parsed file
+		std::shared_ptr<ParsedInclude> include; ///< Parsed include collected so far
+		std::unordered_set<std::string> definedSymbols; ///< Rules and modules defined by the file
+		bool ended = false; ///< End of the file was reached but its last item might not be parsed yet
+		bool cacheable = true; ///< Parsing of the file doesn't depend on the file it is included from
+	};
+	std::shared_ptr<IncludeCache> _includeCache; ///< Cache of parsed includes, @c nullptr if disabled
+	std::vector<IncludeRecording> _includeRecordings; ///< Stack of included files being parsed for the include cache
+	bool _errorRecovery = false; ///< Errors are collected and parsing continues after them
+	std::vector<ParserError> _errors; ///< Errors collected while recovering from them
+	std::optional<TokenIt> _lastRecoveredToken; ///< Last token of the items of the top-level input parsed so far, none if there is no such token
+	std::size_t _recoveredRules = 0; ///< Number of rules in the parsed file when the last item of the top-level input was finished
+	std::size_t _recoveredImports = 0; ///< Number of imports in the parsed file when the last item of the top-level input was finished
+	std::unordered_set<std::string> _recoveredIncludedFiles; ///< Included files when the last item of the top-level input was finished
+	std::size_t _includePrefetchThreads = 0; ///< Number of threads reading included files ahead of the parser, 0 if disabled
+	std::unique_ptr<IncludePrefetcher> _includePrefetcher; ///< Prefetcher of included files for the current parsing
+	bool _profiling = false; ///< Phases of parsing are measured
+	ParserProfile _profile; ///< Profile of the last parsing
+	std::unique_ptr<pog::ParserListener> _profileListener; ///< Passes the phases of the parser into the profile, created when profiling is turned on
+	bool _arenaAllocation = false; ///< Expressions are allocated in the arena of the parsed file
 };
 
 } // namespace yaramod
@@ -0,0 +1,109 @@
+/**
+ * @file src/parser/parser_profile.h
+ * @brief Declaration of class ParserProfile.
+ * @copyright (c) 2026 Avast Software, licensed under the MIT license
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace yaramod {
+
+/**
+ * Phases of parsing measured by the parser profile.
+ */
+enum class ParserPhase
+{
+	Parsing, ///< Work of the parser which doesn't belong to any other phase
+	Tokenizing, ///< Matching of tokens and tokenizer actions
+	Actions, ///< Grammar actions building rules and expressions
+	SymbolLookup, ///< Lookup of symbols referenced in conditions
+	ModuleLoading, ///< Loading of imported modules
+	IncludeLoading, ///< Opening and reading of included files
+	FileConstruction, ///< Adding of parsed rules into the parsed file
+	Count ///< Number of phases, not a phase
+};
+
+/**
+ * Time spent in each phase of parsing together with counts of the processed items.
+ *
+ * Phases are nested, for example an included file is loaded from the tokenizer action
+ * and symbols are looked up from grammar actions. Time of every phase is exclusive,
+ * the enclosing phase is paused while the nested one runs, so times of all phases
+ * add up to the total time of parsing.
+ */
+class ParserProfile
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	/**
+	 * Measures the phase for its lifetime. Nothing is measured if there is no profile.
+	 */
+	class Scope
+	{
+	public:
+		Scope(ParserProfile* profile, ParserPhase phase) : _profile(profile)
+		{
+			if (_profile)
+				_profile->enter(phase);
+		}
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+		~Scope()
+		{
+			if (_profile)
+				_profile->leave();
+		}
+
+	private:
+		ParserProfile* _profile;
+	};
+
+	/// @name Measuring
+	/// @{
+	void clear();
+	void enter(ParserPhase phase);
+	void leave();
+	/// @}
+
+	/// @name Counting
+	/// @{
+	void addToken() { ++_tokens; }
+	void addReduction() { ++_reductions; }
+	void addSymbolLookup() { ++_symbolLookups; }
+	void addImport() { ++_imports; }
+	void addIncludedFile() { ++_includedFiles; }
+	void addBytesRead(std::uint64_t bytes) { _bytesRead += bytes; }
+	/// @}
+
+	/// @name Getter methods
+	/// @{
+	std::chrono::nanoseconds getTime(ParserPhase phase) const { return _times[static_cast<std::size_t>(phase)]; }
+	std::chrono::nanoseconds getTotalTime() const;
+	std::uint64_t getTokens() const { return _tokens; }
+	std::uint64_t getReductions() const { return _reductions; }
+	std::uint64_t getSymbolLookups() const { return _symbolLookups; }
+	std::uint64_t getImports() const { return _imports; }
+	std::uint64_t getIncludedFiles() const { return _includedFiles; }
+	std::uint64_t getBytesRead() const { return _bytesRead; }
+	/// @}
+
+private:
+	std::array<std::chrono::nanoseconds, static_cast<std::size_t>(ParserPhase::Count)> _times = {}; ///< Exclusive time of every phase
+	std::vector<ParserPhase> _phases; ///< Stack of the entered phases
+	Clock::time_point _phaseStart; ///< Time when the phase on top of the stack was entered or resumed
+	std::uint64_t _tokens = 0; ///< Number of tokens the parser received from the tokenizer
+	std::uint64_t _reductions = 0; ///< Number of reductions by grammar rules
+	std::uint64_t _symbolLookups = 0; ///< Number of symbol lookups
+	std::uint64_t _imports = 0; ///< Number of parsed imports
+	std::uint64_t _includedFiles = 0; ///< Number of opened included files
+	std::uint64_t _bytesRead = 0; ///< Size of the parsed input and all opened included files
+};
+
+} // namespace yaramod
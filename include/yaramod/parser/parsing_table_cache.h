@@ -0,0 +1,55 @@
+/**
+ * @file src/parser/parsing_table_cache.h
+ * @brief Declaration of class ParsingTableCache.
+ * @copyright (c) 2026 Avast Software, licensed under the MIT license
+ */
+
+#pragma once
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "yaramod/types/features.h"
+
+namespace yaramod {
+
+/**
+ * Process-wide storage of serialized LALR parsing tables used by ParserDriver.
+ *
+ * Construction of the LALR automaton is the most expensive part of ParserDriver
+ * initialization and its result depends only on the features the grammar is defined
+ * with. The first ParserDriver with given features computes the table and stores it here,
+ * every other one just loads it.
+ *
+ * When environment variable YARAMOD_PARSER_TABLE_CACHE is set to an existing directory,
+ * the tables are also persisted there so that they are available to newly started
+ * processes. Tables are validated against the grammar before they are used, so stale
+ * files left there by a different version of yaramod are ignored and overwritten.
+ */
+class ParsingTableCache
+{
+public:
+	/// @name Access to the instance
+	/// @{
+	static ParsingTableCache& instance();
+	/// @}
+
+	/// @name Cache manipulation
+	/// @{
+	std::optional<std::string> find(Features features);
+	void store(Features features, const std::string& table);
+	void clear();
+	/// @}
+
+private:
+	ParsingTableCache() = default;
+
+	std::optional<std::string> _cacheFilePath(Features features) const;
+
+	std::mutex _mutex; ///< Guards access to the stored tables
+	std::unordered_map<int, std::string> _tables; ///< Serialized tables indexed by features
+};
+
+} // namespace yaramod
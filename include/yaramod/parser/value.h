@@ -5,6 +5,8 @@
  */
 
 #include <cstdint>
+#include <memory>
+#include <type_traits>
 #include <optional>
 #include <utility>
 #include <variant>
@@ -15,6 +17,7 @@
 #include "yaramod/types/regexp.h"
 #include "yaramod/types/token_stream.h"
 #include "yaramod/types/sections_summary.h"
+#include "yaramod/utils/utils.h"
 
 #pragma once
 
@@ -27,21 +30,30 @@ using OfLocationSpec = std::optional<std::tuple<TokenIt, Expression::Ptr>>;
 
 /**
  * Value is the type of all tokens produced by POG parser. Both token and rule actions return Value. The rule action parameters are also Values.
+ *
+ * Values are kept on the parser stack so they need to stay small. Alternatives larger than std::string are
+ * stored on the heap and Value owns them exclusively, which makes it movable but not copyable.
  */
 class Value
 {
+	template <typename T>
+	using Boxed = std::unique_ptr<T>;
+
+	template <typename T>
+	static constexpr bool isBoxed = isAnyOf<std::decay_t<T>, Rule, Literal, RegexpClassRecord>::value;
+
 public:
 	using Variant = std::variant<
 		std::string, //0
 		int,
 		bool, //2
 		std::optional<TokenIt>,
-		Rule, //4
+		Boxed<Rule>, //4
 		std::vector<Meta>,
 		std::shared_ptr<Rule::StringsTrie>, //6
 		std::shared_ptr<StringModifier>,
 		StringModifiers, //8
-		Literal,
+		Boxed<Literal>,
 		Expression::Ptr, //10
 		std::vector<Expression::Ptr>,
 		std::vector<TokenIt>, //12
@@ -53,7 +65,7 @@ public:
 		std::vector<std::shared_ptr<RegexpUnit>>, //18
 		TokenIt,
 		RegexpRangePair, //20
-		RegexpClassRecord,
+		Boxed<RegexpClassRecord>,
 		std::vector<Variable>, //22
 		std::shared_ptr<SectionsSummary>,
 		OfLocationSpec
@@ -61,12 +73,14 @@ public:
 
 	/// @name Constructors
 	/// @{
-	template <typename T>
+	template <typename T, typename = std::enable_if_t<!std::is_same_v<std::decay_t<T>, Value>>>
 	Value(T&& v)
-		: _value(std::forward<T>(v))
+		: _value(box(std::forward<T>(v)))
 	{
 	}
 	Value() = default;
+	Value(Value&&) noexcept = default;
+	Value& operator=(Value&&) noexcept = default;
 	/// @}
 
 	/// @name Getter methods
@@ -98,7 +112,7 @@ public:
 
 	const Rule& getRule() const
 	{
-		return getValue<Rule>();
+		return *getValue<Boxed<Rule>>();
 	}
 
 	std::vector<Meta>&& getMetas()
@@ -133,14 +147,19 @@ public:
 
 	const Literal& getLiteral() const
 	{
-		return getValue<Literal>();
+		return *getValue<Boxed<Literal>>();
 	}
 
-	Expression::Ptr getExpression() const
+	const Expression::Ptr& getExpression() const
 	{
 		return getValue<Expression::Ptr>();
 	}
 
+	Expression::Ptr&& moveExpression()
+	{
+		return std::move(moveValue<Expression::Ptr>());
+	}
+
 	std::vector<Expression::Ptr>&& getMultipleExpressions()
 	{
 		return std::move(moveValue<std::vector<Expression::Ptr>>());
@@ -188,7 +207,7 @@ public:
 
 	RegexpClassRecord&& getRegexpClassRecord()
 	{
-		return std::move(moveValue<RegexpClassRecord>());
+		return std::move(*moveValue<Boxed<RegexpClassRecord>>());
 	}
 
 	OfLocationSpec&& getOfLocationSpec()
@@ -230,6 +249,15 @@ protected:
 	}
 
 private:
+	template <typename T>
+	static decltype(auto) box(T&& v)
+	{
+		if constexpr (isBoxed<T>)
+			return std::make_unique<std::decay_t<T>>(std::forward<T>(v));
+		else
+			return std::forward<T>(v);
+	}
+
 	Variant _value;
 };
 
@@ -14,6 +14,7 @@
 
 #include "yaramod/utils/visitor_result.h"
 #include "yaramod/types/token_stream.h"
+#include "yaramod/types/expression_kind.h"
 #include "yaramod/types/expression_type.h"
 
 namespace yaramod {
@@ -58,6 +59,7 @@ public:
 	/// @name Getter methods
 	/// @{
 	std::uint64_t getUid() const { return _uid; }
+	ExpressionKind getKind() const { return _kind; }
 	Expression::Type getType() const { return _type; }
 	std::string getTypeString() const
 	{
@@ -107,11 +109,34 @@ public:
 
 	/// @name Caster method
 	/// @{
+	/**
+	 * Expressions of yaramod are recognized by their kind in constant time,
+	 * RTTI is used only for the other classes.
+	 */
 	template <typename T>
-	T* as() noexcept { return dynamic_cast<T*>(this); }
+	bool is() const noexcept
+	{
+		if constexpr (ExpressionKindRange<T>::Known)
+		{
+			if (_kind != ExpressionKind::Unknown)
+				return ExpressionKindRange<T>::contains(_kind);
+		}
+		return dynamic_cast<const T*>(this) != nullptr;
+	}
 
 	template <typename T>
-	const T* as() const noexcept { return dynamic_cast<const T*>(this); }
+	T* as() noexcept
+	{
+		if constexpr (ExpressionKindRange<T>::Known)
+		{
+			if (_kind != ExpressionKind::Unknown)
+				return ExpressionKindRange<T>::contains(_kind) ? static_cast<T*>(this) : nullptr;
+		}
+		return dynamic_cast<T*>(this);
+	}
+
+	template <typename T>
+	const T* as() const noexcept { return const_cast<Expression*>(this)->as<T>(); }
 	/// @}
 
 	/*
@@ -157,9 +182,12 @@ public:
 	}
 
 protected:
+	void setKind(ExpressionKind kind) { _kind = kind; }
+
 	std::shared_ptr<TokenStream> _tokenStream;
 
 private:
+	ExpressionKind _kind = ExpressionKind::Unknown; ///< Class of the expression
 	Type _type; ///< Type of the expression
 	std::uint64_t _uid = 0;
 };
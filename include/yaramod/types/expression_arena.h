@@ -0,0 +1,123 @@
+/**
+ * @file src/types/expression_arena.h
+ * @brief Declaration of class ExpressionArena.
+ * @copyright (c) 2026 Avast Software, licensed under the MIT license
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace yaramod {
+
+/**
+ * Arena which allocates expressions of conditions together with their reference counts
+ * by bumping a pointer in large chunks of memory. Nodes of a condition therefore end up
+ * next to each other and their allocation costs no call to the system allocator.
+ * Chunks are taken from the process-wide BlockPool, so chunks of released arenas are
+ * reused by the next ones.
+ *
+ * The arena only reduces the number of allocations. Expressions are still reference counted
+ * by @c std::shared_ptr, with the control block placed next to the node, and every node keeps
+ * its own reference to its token stream, so building, cloning and visiting of expressions
+ * updates atomic reference counts the same way as with expressions allocated on the heap.
+ * The arena takes its own references in batches of @c ReferenceBatch, so an allocation
+ * doesn't touch the atomic reference count of the arena.
+ *
+ * Every expression keeps the whole arena alive, the memory of the arena is released at once
+ * when both the arena and the last of its expressions are destroyed. A single expression
+ * which outlives its file therefore pins all chunks of the arena. Memory of a destroyed
+ * expression is not reused either, so expressions replaced by modifications occupy the arena
+ * until the whole arena is released.
+ *
+ * Arena is not thread-safe, make() can be called only while no other thread allocates in the arena.
+ * Expressions created on demand once the parsing is over are allocated by makeConcurrent()
+ * which can be called from several threads at once. Releasing of the expressions is safe
+ * from any thread.
+ */
+class ExpressionArena
+{
+public:
+	/**
+	 * Standard allocator passed to @c std::allocate_shared which allocates out of the arena.
+	 */
+	template <typename T>
+	class Allocator
+	{
+	public:
+		using value_type = T;
+
+		Allocator(ExpressionArena* arena) noexcept : _arena(arena) {}
+		template <typename U> Allocator(const Allocator<U>& other) noexcept : _arena(other._arena) {}
+
+		T* allocate(std::size_t n) { return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T))); }
+		void deallocate(T*, std::size_t) noexcept { _arena->deallocate(); }
+
+		template <typename U> bool operator==(const Allocator<U>& other) const noexcept { return _arena == other._arena; }
+		template <typename U> bool operator!=(const Allocator<U>& other) const noexcept { return _arena != other._arena; }
+
+	private:
+		template <typename U> friend class Allocator;
+
+		ExpressionArena* _arena; ///< Arena the memory is allocated from
+	};
+
+	/// @name Constructors
+	/// @{
+	static std::shared_ptr<ExpressionArena> create();
+	ExpressionArena(const ExpressionArena&) = delete;
+	ExpressionArena& operator=(const ExpressionArena&) = delete;
+	/// @}
+
+	/// @name Allocation
+	/// @{
+	template <typename T, typename... Args>
+	std::shared_ptr<T> make(Args&&... args)
+	{
+		++_objects;
+		return std::allocate_shared<T>(Allocator<T>(this), std::forward<Args>(args)...);
+	}
+	template <typename T, typename... Args>
+	std::shared_ptr<T> makeConcurrent(Args&&... args)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return make<T>(std::forward<Args>(args)...);
+	}
+
+	void* allocate(std::size_t size, std::size_t alignment);
+	void deallocate() noexcept;
+	void release() noexcept;
+	/// @}
+
+	/// @name Statistics
+	/// @{
+	std::size_t getObjectsCount() const { return _objects; }
+	std::size_t getUsedBytes() const { return _usedBytes; }
+	std::size_t getAllocatedBytes() const { return _allocatedBytes; }
+	/// @}
+
+	static constexpr std::size_t ChunkSize = 32 * 1024;
+	static constexpr std::size_t ReferenceBatch = 1024;
+
+private:
+	ExpressionArena() = default;
+	~ExpressionArena();
+
+	std::atomic<std::size_t> _references = 1; ///< Number of allocations which are alive, reserved references and one for the owner of the arena
+	std::size_t _reservedReferences = 0; ///< References taken in advance for the next allocations
+	std::vector<void*> _chunks; ///< Chunks of memory, the last one is being filled
+	std::vector<std::unique_ptr<unsigned char[]>> _largeObjects; ///< Objects which don't fit into a chunk
+	unsigned char* _next = nullptr; ///< Next free byte of the last chunk
+	std::size_t _remaining = 0; ///< Number of free bytes in the last chunk
+	std::size_t _objects = 0; ///< Number of objects allocated in the arena
+	std::size_t _usedBytes = 0; ///< Bytes given to the objects including padding
+	std::size_t _allocatedBytes = 0; ///< Size of all chunks and large objects in bytes
+	std::mutex _mutex; ///< Guards allocations of makeConcurrent()
+};
+
+} // namespace yaramod
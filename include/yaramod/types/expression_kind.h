@@ -0,0 +1,208 @@
+/**
+ * @file src/types/expression_kind.h
+ * @brief Declaration of enum ExpressionKind.
+ * @copyright (c) 2026 Avast Software, licensed under the MIT license
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace yaramod {
+
+/**
+ * Class of the expression node. Kinds of subclasses of the same abstract expression
+ * follow each other, so each abstract expression covers a continuous range of kinds.
+ */
+enum class ExpressionKind : std::uint8_t
+{
+	Unknown, ///< Expression defined outside of yaramod
+	String,
+	StringWildcard,
+	StringAt,
+	StringInRange,
+	StringCount,
+	StringOffset,
+	StringLength,
+	// UnaryOpExpression
+	Not,
+	Percentual,
+	Defined,
+	UnaryMinus,
+	BitwiseNot,
+	// BinaryOpExpression
+	And,
+	Or,
+	Lt,
+	Gt,
+	Le,
+	Ge,
+	Eq,
+	Neq,
+	Contains,
+	Icontains,
+	Matches,
+	StartsWith,
+	IstartsWith,
+	EndsWith,
+	IendsWith,
+	Iequals,
+	Plus,
+	Minus,
+	Multiply,
+	Divide,
+	Modulo,
+	BitwiseXor,
+	BitwiseAnd,
+	BitwiseOr,
+	ShiftLeft,
+	ShiftRight,
+	// ForExpression
+	ForDict,
+	ForArray,
+	ForString,
+	Of,
+	Iterable,
+	Set,
+	Range,
+	// IdExpression
+	Id,
+	StructAccess,
+	ArrayAccess,
+	FunctionCall,
+	IdWildcard,
+	BoolLiteral,
+	StringLiteral,
+	IntLiteral,
+	DoubleLiteral,
+	// KeywordExpression
+	Filesize,
+	Entrypoint,
+	All,
+	Any,
+	None,
+	Them,
+	Parentheses,
+	IntFunction,
+	Regexp,
+	VariableDef,
+	With
+};
+
+/**
+ * Range of kinds of the expression class and all its subclasses. Only expressions
+ * of yaramod have their range, other classes are recognized by RTTI.
+ */
+template <typename T>
+struct ExpressionKindRange
+{
+	static constexpr bool Known = false;
+};
+
+template <ExpressionKind FirstKind, ExpressionKind LastKind = FirstKind>
+struct ExpressionKindRangeOf
+{
+	static constexpr bool Known = true;
+	static constexpr ExpressionKind First = FirstKind;
+	static constexpr ExpressionKind Last = LastKind;
+
+	static constexpr bool contains(ExpressionKind kind)
+	{
+		return static_cast<unsigned>(kind) - static_cast<unsigned>(First) <= static_cast<unsigned>(Last) - static_cast<unsigned>(First);
+	}
+};
+
+#define YARAMOD_EXPRESSION_KIND_RANGE(ExpressionClass, ...) \
+	class ExpressionClass; \
+	template <> struct ExpressionKindRange<ExpressionClass> : ExpressionKindRangeOf<__VA_ARGS__> {};
+
+YARAMOD_EXPRESSION_KIND_RANGE(StringExpression, ExpressionKind::String)
+YARAMOD_EXPRESSION_KIND_RANGE(StringWildcardExpression, ExpressionKind::StringWildcard)
+YARAMOD_EXPRESSION_KIND_RANGE(StringAtExpression, ExpressionKind::StringAt)
+YARAMOD_EXPRESSION_KIND_RANGE(StringInRangeExpression, ExpressionKind::StringInRange)
+YARAMOD_EXPRESSION_KIND_RANGE(StringCountExpression, ExpressionKind::StringCount)
+YARAMOD_EXPRESSION_KIND_RANGE(StringOffsetExpression, ExpressionKind::StringOffset)
+YARAMOD_EXPRESSION_KIND_RANGE(StringLengthExpression, ExpressionKind::StringLength)
+YARAMOD_EXPRESSION_KIND_RANGE(UnaryOpExpression, ExpressionKind::Not, ExpressionKind::BitwiseNot)
+YARAMOD_EXPRESSION_KIND_RANGE(NotExpression, ExpressionKind::Not)
+YARAMOD_EXPRESSION_KIND_RANGE(PercentualExpression, ExpressionKind::Percentual)
+YARAMOD_EXPRESSION_KIND_RANGE(DefinedExpression, ExpressionKind::Defined)
+YARAMOD_EXPRESSION_KIND_RANGE(UnaryMinusExpression, ExpressionKind::UnaryMinus)
+YARAMOD_EXPRESSION_KIND_RANGE(BitwiseNotExpression, ExpressionKind::BitwiseNot)
+YARAMOD_EXPRESSION_KIND_RANGE(BinaryOpExpression, ExpressionKind::And, ExpressionKind::ShiftRight)
+YARAMOD_EXPRESSION_KIND_RANGE(AndExpression, ExpressionKind::And)
+YARAMOD_EXPRESSION_KIND_RANGE(OrExpression, ExpressionKind::Or)
+YARAMOD_EXPRESSION_KIND_RANGE(LtExpression, ExpressionKind::Lt)
+YARAMOD_EXPRESSION_KIND_RANGE(GtExpression, ExpressionKind::Gt)
+YARAMOD_EXPRESSION_KIND_RANGE(LeExpression, ExpressionKind::Le)
+YARAMOD_EXPRESSION_KIND_RANGE(GeExpression, ExpressionKind::Ge)
+YARAMOD_EXPRESSION_KIND_RANGE(EqExpression, ExpressionKind::Eq)
+YARAMOD_EXPRESSION_KIND_RANGE(NeqExpression, ExpressionKind::Neq)
+YARAMOD_EXPRESSION_KIND_RANGE(ContainsExpression, ExpressionKind::Contains)
+YARAMOD_EXPRESSION_KIND_RANGE(IcontainsExpression, ExpressionKind::Icontains)
+YARAMOD_EXPRESSION_KIND_RANGE(MatchesExpression, ExpressionKind::Matches)
+YARAMOD_EXPRESSION_KIND_RANGE(StartsWithExpression, ExpressionKind::StartsWith)
+YARAMOD_EXPRESSION_KIND_RANGE(IstartsWithExpression, ExpressionKind::IstartsWith)
+YARAMOD_EXPRESSION_KIND_RANGE(EndsWithExpression, ExpressionKind::EndsWith)
+YARAMOD_EXPRESSION_KIND_RANGE(IendsWithExpression, ExpressionKind::IendsWith)
+YARAMOD_EXPRESSION_KIND_RANGE(IequalsExpression, ExpressionKind::Iequals)
+YARAMOD_EXPRESSION_KIND_RANGE(PlusExpression, ExpressionKind::Plus)
+YARAMOD_EXPRESSION_KIND_RANGE(MinusExpression, ExpressionKind::Minus)
+YARAMOD_EXPRESSION_KIND_RANGE(MultiplyExpression, ExpressionKind::Multiply)
+YARAMOD_EXPRESSION_KIND_RANGE(DivideExpression, ExpressionKind::Divide)
+YARAMOD_EXPRESSION_KIND_RANGE(ModuloExpression, ExpressionKind::Modulo)
+YARAMOD_EXPRESSION_KIND_RANGE(BitwiseXorExpression, ExpressionKind::BitwiseXor)
+YARAMOD_EXPRESSION_KIND_RANGE(BitwiseAndExpression, ExpressionKind::BitwiseAnd)
+YARAMOD_EXPRESSION_KIND_RANGE(BitwiseOrExpression, ExpressionKind::BitwiseOr)
+YARAMOD_EXPRESSION_KIND_RANGE(ShiftLeftExpression, ExpressionKind::ShiftLeft)
+YARAMOD_EXPRESSION_KIND_RANGE(ShiftRightExpression, ExpressionKind::ShiftRight)
+YARAMOD_EXPRESSION_KIND_RANGE(ForExpression, ExpressionKind::ForDict, ExpressionKind::Of)
+YARAMOD_EXPRESSION_KIND_RANGE(ForDictExpression, ExpressionKind::ForDict)
+YARAMOD_EXPRESSION_KIND_RANGE(ForArrayExpression, ExpressionKind::ForArray)
+YARAMOD_EXPRESSION_KIND_RANGE(ForStringExpression, ExpressionKind::ForString)
+YARAMOD_EXPRESSION_KIND_RANGE(OfExpression, ExpressionKind::Of)
+YARAMOD_EXPRESSION_KIND_RANGE(IterableExpression, ExpressionKind::Iterable)
+YARAMOD_EXPRESSION_KIND_RANGE(SetExpression, ExpressionKind::Set)
+YARAMOD_EXPRESSION_KIND_RANGE(RangeExpression, ExpressionKind::Range)
+YARAMOD_EXPRESSION_KIND_RANGE(IdExpression, ExpressionKind::Id, ExpressionKind::FunctionCall)
+YARAMOD_EXPRESSION_KIND_RANGE(StructAccessExpression, ExpressionKind::StructAccess)
+YARAMOD_EXPRESSION_KIND_RANGE(ArrayAccessExpression, ExpressionKind::ArrayAccess)
+YARAMOD_EXPRESSION_KIND_RANGE(FunctionCallExpression, ExpressionKind::FunctionCall)
+YARAMOD_EXPRESSION_KIND_RANGE(IdWildcardExpression, ExpressionKind::IdWildcard)
+YARAMOD_EXPRESSION_KIND_RANGE(BoolLiteralExpression, ExpressionKind::BoolLiteral)
+YARAMOD_EXPRESSION_KIND_RANGE(StringLiteralExpression, ExpressionKind::StringLiteral)
+YARAMOD_EXPRESSION_KIND_RANGE(IntLiteralExpression, ExpressionKind::IntLiteral)
+YARAMOD_EXPRESSION_KIND_RANGE(DoubleLiteralExpression, ExpressionKind::DoubleLiteral)
+YARAMOD_EXPRESSION_KIND_RANGE(KeywordExpression, ExpressionKind::Filesize, ExpressionKind::Them)
+YARAMOD_EXPRESSION_KIND_RANGE(FilesizeExpression, ExpressionKind::Filesize)
+YARAMOD_EXPRESSION_KIND_RANGE(EntrypointExpression, ExpressionKind::Entrypoint)
+YARAMOD_EXPRESSION_KIND_RANGE(AllExpression, ExpressionKind::All)
+YARAMOD_EXPRESSION_KIND_RANGE(AnyExpression, ExpressionKind::Any)
+YARAMOD_EXPRESSION_KIND_RANGE(NoneExpression, ExpressionKind::None)
+YARAMOD_EXPRESSION_KIND_RANGE(ThemExpression, ExpressionKind::Them)
+YARAMOD_EXPRESSION_KIND_RANGE(ParenthesesExpression, ExpressionKind::Parentheses)
+YARAMOD_EXPRESSION_KIND_RANGE(IntFunctionExpression, ExpressionKind::IntFunction)
+YARAMOD_EXPRESSION_KIND_RANGE(RegexpExpression, ExpressionKind::Regexp)
+YARAMOD_EXPRESSION_KIND_RANGE(VariableDefExpression, ExpressionKind::VariableDef)
+YARAMOD_EXPRESSION_KIND_RANGE(WithExpression, ExpressionKind::With)
+
+#undef YARAMOD_EXPRESSION_KIND_RANGE
+
+template <typename T> class LiteralExpression;
+template <> struct ExpressionKindRange<LiteralExpression<bool>> : ExpressionKindRangeOf<ExpressionKind::BoolLiteral> {};
+template <> struct ExpressionKindRange<LiteralExpression<std::string>> : ExpressionKindRangeOf<ExpressionKind::StringLiteral> {};
+template <> struct ExpressionKindRange<LiteralExpression<std::uint64_t>> : ExpressionKindRangeOf<ExpressionKind::IntLiteral> {};
+template <> struct ExpressionKindRange<LiteralExpression<double>> : ExpressionKindRangeOf<ExpressionKind::DoubleLiteral> {};
+
+/**
+ * Kind of the expression class, the class has to be a yaramod expression which is not abstract.
+ */
+template <typename T>
+constexpr ExpressionKind expressionKindOf()
+{
+	static_assert(ExpressionKindRange<T>::Known, "Not a yaramod expression");
+	return ExpressionKindRange<T>::First;
+}
+
+}
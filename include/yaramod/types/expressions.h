@@ -5,9 +5,12 @@
  */
 
 #pragma once
+#include <atomic>
+#include <mutex>
 #include <sstream>
 
 #include "yaramod/types/expression.h"
+#include "yaramod/types/expression_arena.h"
 #include "yaramod/types/regexp.h"
 #include "yaramod/types/string.h"
 #include "yaramod/types/symbol.h"
@@ -29,10 +32,10 @@ namespace yaramod {
 class StringExpression : public Expression
 {
 public:
-	StringExpression(const std::string& id) { _id = _tokenStream->emplace_back(TokenType::STRING_ID, id); }
-	StringExpression(std::string&& id) { _id = _tokenStream->emplace_back(TokenType::STRING_ID, std::move(id)); }
-	StringExpression(TokenIt id) : _id(id) {}
-	StringExpression(const std::shared_ptr<TokenStream>& ts, TokenIt id) : Expression(ts), _id(id) {}
+	StringExpression(const std::string& id) { setKind(ExpressionKind::String); _id = _tokenStream->emplace_back(TokenType::STRING_ID, id); }
+	StringExpression(std::string&& id) { setKind(ExpressionKind::String); _id = _tokenStream->emplace_back(TokenType::STRING_ID, std::move(id)); }
+	StringExpression(TokenIt id) : _id(id) { setKind(ExpressionKind::String); }
+	StringExpression(const std::shared_ptr<TokenStream>& ts, TokenIt id) : Expression(ts), _id(id) { setKind(ExpressionKind::String); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -80,10 +83,11 @@ public:
 	template <typename Str>
 	StringWildcardExpression(Str&& id)
 	{
+		setKind(ExpressionKind::StringWildcard);
 		_id = _tokenStream->emplace_back(TokenType::STRING_ID, std::forward<Str>(id));
 	}
-	StringWildcardExpression(TokenIt it) : _id(it) {}
-	StringWildcardExpression(const std::shared_ptr<TokenStream>& ts, TokenIt it) : Expression(ts), _id(it) {}
+	StringWildcardExpression(TokenIt it) : _id(it) { setKind(ExpressionKind::StringWildcard); }
+	StringWildcardExpression(const std::shared_ptr<TokenStream>& ts, TokenIt it) : Expression(ts), _id(it) { setKind(ExpressionKind::StringWildcard); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -130,6 +134,7 @@ public:
 	StringAtExpression(const std::string& id, ExpPtr&& at)
 		: _at(std::forward<ExpPtr>(at))
 	{
+		setKind(ExpressionKind::StringAt);
 		_id = _tokenStream->emplace_back(TokenType::STRING_ID, id);
 		_at_symbol = _tokenStream->emplace_back(TokenType::OP_AT, "at");
 		_tokenStream->moveAppend(_at->getTokenStream());
@@ -141,6 +146,7 @@ public:
 		, _at_symbol(at_symbol)
 		, _at(std::forward<ExpPtr>(at))
 	{
+		setKind(ExpressionKind::StringAt);
 	}
 
 	template <typename ExpPtr>
@@ -150,6 +156,7 @@ public:
 		, _at_symbol(at_symbol)
 		, _at(std::forward<ExpPtr>(at))
 	{
+		setKind(ExpressionKind::StringAt);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -205,6 +212,7 @@ public:
 	template <typename ExpPtr>
 	StringInRangeExpression(const std::string& id, ExpPtr&& range)
 	{
+		setKind(ExpressionKind::StringInRange);
 		_id = _tokenStream->emplace_back(TokenType::STRING_ID, id);
 		_in_symbol = _tokenStream->emplace_back(TokenType::OP_IN, "in");
 		_range = std::forward<ExpPtr>(range);
@@ -217,6 +225,7 @@ public:
 		, _in_symbol(in_symbol)
 		, _range(std::forward<ExpPtr>(range))
 	{
+		setKind(ExpressionKind::StringInRange);
 	}
 
 	template <typename ExpPtr>
@@ -226,6 +235,7 @@ public:
 		, _in_symbol(in_symbol)
 		, _range(std::forward<ExpPtr>(range))
 	{
+		setKind(ExpressionKind::StringInRange);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -279,12 +289,13 @@ private:
 class StringCountExpression : public Expression
 {
 public:
-	StringCountExpression(TokenIt id) : _id(id) {}
-	StringCountExpression(const std::shared_ptr<TokenStream>& ts, TokenIt id) : Expression(ts), _id(id) {}
+	StringCountExpression(TokenIt id) : _id(id) { setKind(ExpressionKind::StringCount); }
+	StringCountExpression(const std::shared_ptr<TokenStream>& ts, TokenIt id) : Expression(ts), _id(id) { setKind(ExpressionKind::StringCount); }
 
 	template <typename Str>
 	StringCountExpression(Str&& id)
 	{
+		setKind(ExpressionKind::StringCount);
 		_id = _tokenStream->emplace_back(TokenType::STRING_COUNT, std::forward<Str>(id));
 	}
 
@@ -338,6 +349,7 @@ public:
 		: _id(id)
 		, _right_bracket()
 	{
+		setKind(ExpressionKind::StringOffset);
 	}
 	template <typename ExpPtr>
 	StringOffsetExpression(TokenIt id, ExpPtr&& expr, TokenIt right_bracket)
@@ -345,10 +357,12 @@ public:
 		, _expr(std::forward<ExpPtr>(expr))
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::StringOffset);
 	}
 	template <typename Str>
 	StringOffsetExpression(Str&& id)
 	{
+		setKind(ExpressionKind::StringOffset);
 		_id = _tokenStream->emplace_back(TokenType::STRING_OFFSET, std::forward<Str>(id));
 		_right_bracket.reset();
 	}
@@ -357,6 +371,7 @@ public:
 		: _expr(std::forward<ExpPtr>(expr))
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::StringOffset);
 		_id = _tokenStream->emplace_back(TokenType::STRING_OFFSET, std::forward<Str>(id));
 	}
 	template <typename ExpPtr>
@@ -366,6 +381,7 @@ public:
 		, _expr(std::forward<ExpPtr>(expr))
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::StringOffset);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -438,6 +454,7 @@ public:
 		: _id(id)
 		, _right_bracket()
 	{
+		setKind(ExpressionKind::StringLength);
 	}
 	template <typename ExpPtr>
 	StringLengthExpression(TokenIt id, ExpPtr&& expr, TokenIt right_bracket)
@@ -445,10 +462,12 @@ public:
 		, _expr(std::forward<ExpPtr>(expr))
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::StringLength);
 	}
 	template <typename Str>
 	StringLengthExpression(Str&& id)
 	{
+		setKind(ExpressionKind::StringLength);
 		_id = _tokenStream->emplace_back(TokenType::STRING_LENGTH, std::forward<Str>(id));
 		_right_bracket.reset();
 	}
@@ -457,6 +476,7 @@ public:
 		: _expr(std::forward<ExpPtr>(expr))
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::StringLength);
 		_id = _tokenStream->emplace_back(TokenType::STRING_LENGTH, std::forward<Str>(id));
 		_tokenStream->moveAppend(_expr->getTokenStream());
 	}
@@ -467,6 +487,7 @@ public:
 		, _expr(std::forward<ExpPtr>(expr))
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::StringLength);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -640,10 +661,10 @@ class NotExpression : public UnaryOpExpression
 {
 public:
 	template <typename ExpPtr>
-	NotExpression(TokenIt op, ExpPtr&& expr) : UnaryOpExpression(op, std::forward<ExpPtr>(expr), UnaryOperatorPlacement::Left) {}
+	NotExpression(TokenIt op, ExpPtr&& expr) : UnaryOpExpression(op, std::forward<ExpPtr>(expr), UnaryOperatorPlacement::Left) { setKind(ExpressionKind::Not); }
 
 	template <typename ExpPtr>
-	NotExpression(const std::shared_ptr<TokenStream>& ts, TokenIt op, ExpPtr&& expr) : UnaryOpExpression(ts, op, std::forward<ExpPtr>(expr), UnaryOperatorPlacement::Left) {}
+	NotExpression(const std::shared_ptr<TokenStream>& ts, TokenIt op, ExpPtr&& expr) : UnaryOpExpression(ts, op, std::forward<ExpPtr>(expr), UnaryOperatorPlacement::Left) { setKind(ExpressionKind::Not); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -668,10 +689,10 @@ class PercentualExpression : public UnaryOpExpression
 {
 public:
 	template <typename ExpPtr>
-	PercentualExpression(TokenIt op, ExpPtr&& expr) : UnaryOpExpression(op, std::forward<ExpPtr>(expr), UnaryOperatorPlacement::Right) {}
+	PercentualExpression(TokenIt op, ExpPtr&& expr) : UnaryOpExpression(op, std::forward<ExpPtr>(expr), UnaryOperatorPlacement::Right) { setKind(ExpressionKind::Percentual); }
 
 	template <typename ExpPtr>
-	PercentualExpression(const std::shared_ptr<TokenStream>& ts, TokenIt op, ExpPtr&& expr) : UnaryOpExpression(ts, op, std::forward<ExpPtr>(expr), UnaryOperatorPlacement::Right) {}
+	PercentualExpression(const std::shared_ptr<TokenStream>& ts, TokenIt op, ExpPtr&& expr) : UnaryOpExpression(ts, op, std::forward<ExpPtr>(expr), UnaryOperatorPlacement::Right) { setKind(ExpressionKind::Percentual); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -696,10 +717,10 @@ class DefinedExpression : public UnaryOpExpression
 {
 public:
 	template<typename ExpPtr>
-	DefinedExpression(TokenIt op, ExpPtr &&expr) : UnaryOpExpression(op, std::forward<ExpPtr>(expr), UnaryOperatorPlacement::Left) {}
+	DefinedExpression(TokenIt op, ExpPtr &&expr) : UnaryOpExpression(op, std::forward<ExpPtr>(expr), UnaryOperatorPlacement::Left) { setKind(ExpressionKind::Defined); }
 
 	template<typename ExpPtr>
-	DefinedExpression(const std::shared_ptr<TokenStream>& ts, TokenIt op, ExpPtr &&expr) : UnaryOpExpression(ts, op, std::forward<ExpPtr>(expr), UnaryOperatorPlacement::Left) {}
+	DefinedExpression(const std::shared_ptr<TokenStream>& ts, TokenIt op, ExpPtr &&expr) : UnaryOpExpression(ts, op, std::forward<ExpPtr>(expr), UnaryOperatorPlacement::Left) { setKind(ExpressionKind::Defined); }
 
 	virtual VisitResult accept(Visitor *v) override
 	{
@@ -725,10 +746,10 @@ class UnaryMinusExpression : public UnaryOpExpression
 {
 public:
 	template <typename ExpPtr>
-	UnaryMinusExpression(TokenIt op, ExpPtr&& expr) : UnaryOpExpression(op, std::forward<ExpPtr>(expr), UnaryOperatorPlacement::Left) {}
+	UnaryMinusExpression(TokenIt op, ExpPtr&& expr) : UnaryOpExpression(op, std::forward<ExpPtr>(expr), UnaryOperatorPlacement::Left) { setKind(ExpressionKind::UnaryMinus); }
 
 	template <typename ExpPtr>
-	UnaryMinusExpression(const std::shared_ptr<TokenStream>& ts, TokenIt op, ExpPtr&& expr) : UnaryOpExpression(ts, op, std::forward<ExpPtr>(expr), UnaryOperatorPlacement::Left) {}
+	UnaryMinusExpression(const std::shared_ptr<TokenStream>& ts, TokenIt op, ExpPtr&& expr) : UnaryOpExpression(ts, op, std::forward<ExpPtr>(expr), UnaryOperatorPlacement::Left) { setKind(ExpressionKind::UnaryMinus); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -754,10 +775,10 @@ class BitwiseNotExpression : public UnaryOpExpression
 {
 public:
 	template <typename ExpPtr>
-	BitwiseNotExpression(TokenIt op, ExpPtr&& expr) : UnaryOpExpression(op, std::forward<ExpPtr>(expr), UnaryOperatorPlacement::Left) {}
+	BitwiseNotExpression(TokenIt op, ExpPtr&& expr) : UnaryOpExpression(op, std::forward<ExpPtr>(expr), UnaryOperatorPlacement::Left) { setKind(ExpressionKind::BitwiseNot); }
 
 	template <typename ExpPtr>
-	BitwiseNotExpression(const std::shared_ptr<TokenStream>& ts, TokenIt op, ExpPtr&& expr) : UnaryOpExpression(ts, op, std::forward<ExpPtr>(expr), UnaryOperatorPlacement::Left) {}
+	BitwiseNotExpression(const std::shared_ptr<TokenStream>& ts, TokenIt op, ExpPtr&& expr) : UnaryOpExpression(ts, op, std::forward<ExpPtr>(expr), UnaryOperatorPlacement::Left) { setKind(ExpressionKind::BitwiseNot); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -771,27 +792,134 @@ public:
 };
 
 /**
- * Abstract class representing some binary operation.
+ * Operands and operation symbols of a chain of the same binary operation,
+ * such as `$a or $b or $c`, stored contiguously. Binary operations created
+ * over the chain cover its first operands. Operations which are created over
+ * the chain on demand are allocated in the arena of the chain if it has one.
  */
-class BinaryOpExpression : public Expression
+class BinaryOpChain
 {
 public:
-	virtual std::string getText(const std::string& indent = std::string{}) const override
+	/**
+	 * Operation symbol between two neighbouring operands.
+	 */
+	struct Link
+	{
+		TokenIt op; ///< Operation symbol
+		bool linebreak; ///< Put linebreak after operation symbol
+		std::uint64_t uid; ///< Unique ID of the operation which ends with the operand following the symbol
+	};
+
+	/// @name Constructors
+	/// @{
+	explicit BinaryOpChain(Expression::Ptr first)
+	{
+		_elements.reserve(4);
+		_elements.push_back(Element{std::move(first), Link{}});
+	}
+	BinaryOpChain(const BinaryOpChain&) = delete;
+	/// @}
+
+	/// @name Getter methods
+	/// @{
+	std::size_t getOperandsCount() const { return _elements.size(); }
+	const Expression::Ptr& getOperand(std::size_t index) const { return _elements[index].operand; }
+	const Link& getLink(std::size_t index) const { return _elements[index + 1].link; }
+	const std::shared_ptr<ExpressionArena>& getArena() const { return _arena; }
+	/// @}
+
+	/// @name Setter methods
+	/// @{
+	void setArena(const std::shared_ptr<ExpressionArena>& arena) { _arena = arena; }
+	/// @}
+
+	/**
+	 * Appends the operation symbol and the operand which follows it. The chain must not be
+	 * referenced by any operation reachable from elsewhere, BinaryOpExpression::continueChain()
+	 * copies such chains.
+	 */
+	void append(TokenIt op, Expression::Ptr operand, bool linebreak = false, std::uint64_t uid = 0)
 	{
-		return _left->getText(indent) + ' ' + _op->getString() + (_linebreak ? "\n" + indent : " ") + _right->getText(indent);
+		_elements.push_back(Element{std::move(operand), Link{op, linebreak, uid}});
 	}
 
+private:
+	friend class BinaryOpExpression;
+
+	/**
+	 * Operand together with the operation symbol in front of it.
+	 */
+	struct Element
+	{
+		Expression::Ptr operand;
+		Link link; ///< Unused for the first operand
+	};
+
+	std::vector<Element> _elements; ///< Operands of the chain
+	std::shared_ptr<ExpressionArena> _arena; ///< Arena of the operations created over the chain, @c nullptr to allocate them on the heap
+	std::mutex _mutex; ///< Guards creation of left operands of operations over the chain
+};
+
+/**
+ * Abstract class representing some binary operation.
+ *
+ * Long chains of binary operations such as machine-generated conditions with
+ * thousands of terms form trees as deep as the chain is long. Text, cloning,
+ * tokens and destruction of nested binary operations are therefore processed
+ * iteratively with an explicit stack instead of recursion.
+ *
+ * Chains of three or more logical and/or operands are built over BinaryOpChain
+ * instead, so the operation with N operands doesn't need N - 1 nested expressions.
+ * Such an operation still looks like the binary one, its left operand is an operation
+ * over the shorter part of the chain which is created once it is asked for.
+ * Until then, the operation is flat and its operands are read from the chain.
+ */
+class BinaryOpExpression : public Expression
+{
+public:
+	virtual ~BinaryOpExpression() override;
+
+	virtual std::string getText(const std::string& indent = std::string{}) const override;
+
 	TokenIt getOperator() const { return _op; }
-	const Expression::Ptr& getLeftOperand() const { return _left; }
+	const Expression::Ptr& getLeftOperand() const
+	{
+		if (_flat.load(std::memory_order_acquire))
+			createLeftOperand();
+		return _left;
+	}
 	const Expression::Ptr& getRightOperand() const { return _right; }
+	std::vector<Expression::Ptr> getOperands() const;
+	std::shared_ptr<BinaryOpChain> copyChain() const;
 
-	virtual TokenIt getFirstTokenIt() const override { return _left->getFirstTokenIt(); }
-	virtual TokenIt getLastTokenIt() const override { return _right->getLastTokenIt(); }
+	/**
+	 * Returns the chain the operation reads its operands from, or @c nullptr
+	 * if the operation isn't flat. Only the first getChainOperandsCount()
+	 * operands of the chain belong to the operation.
+	 */
+	const BinaryOpChain* getChain() const { return isFlat() ? _chain.get() : nullptr; }
+	std::size_t getChainOperandsCount() const { return _chainOperands; }
 
-	void setLeftOperand(const Expression::Ptr& left) { _left = left; }
-	void setLeftOperand(Expression::Ptr&& left) { _left = std::move(left); }
-	void setRightOperand(const Expression::Ptr& right) { _right = right; }
-	void setRightOperand(Expression::Ptr&& right) { _right = std::move(right); }
+	virtual TokenIt getFirstTokenIt() const override;
+	virtual TokenIt getLastTokenIt() const override;
+
+	void setLeftOperand(const Expression::Ptr& left) { setLeftOperand(Expression::Ptr{left}); }
+	void setLeftOperand(Expression::Ptr&& left)
+	{
+		_left = std::move(left);
+		_flat.store(false, std::memory_order_release);
+		_chain.reset();
+	}
+	void setRightOperand(const Expression::Ptr& right) { setRightOperand(Expression::Ptr{right}); }
+	void setRightOperand(Expression::Ptr&& right)
+	{
+		getLeftOperand();
+		_right = std::move(right);
+		_chain.reset();
+	}
+	void setChain(std::shared_ptr<BinaryOpChain> chain);
+
+	static std::shared_ptr<BinaryOpChain> continueChain(const Expression::Ptr& left, ExpressionKind kind);
 
 protected:
 	template <typename ExpPtr1, typename ExpPtr2>
@@ -822,16 +950,27 @@ protected:
 	{
 	}
 
+	BinaryOpExpression(const std::shared_ptr<TokenStream>& ts, std::shared_ptr<BinaryOpChain> chain, std::size_t operands)
+		: Expression(ts)
+		, _op(chain->getLink(operands - 2).op)
+		, _right(chain->getOperand(operands - 1))
+		, _chain(std::move(chain))
+		, _chainOperands(static_cast<std::uint32_t>(operands))
+		, _linebreak(_chain->getLink(operands - 2).linebreak)
+		, _flat(true)
+	{
+		setUid(_chain->getLink(operands - 2).uid);
+	}
+
 	template <typename ExpT>
 	Expression::Ptr cloneAs(const std::shared_ptr<TokenStream>& target) const
 	{
-		target->cloneAppend(getTokenStream(), getFirstTokenIt(), getLeftOperand()->getFirstTokenIt());
-		auto newLeftOperand = getLeftOperand()->clone(target);
-		target->cloneAppend(getTokenStream(), std::next(getLeftOperand()->getLastTokenIt()), getOperator());
-		auto newOp = getOperator()->clone(target.get());
-		target->cloneAppend(getTokenStream(), std::next(getOperator()), getRightOperand()->getFirstTokenIt());
-		auto newRightOperand = getRightOperand()->clone(target);
-		target->cloneAppend(getTokenStream(), std::next(getRightOperand()->getLastTokenIt()), std::next(getLastTokenIt()));
+		if (isFlat())
+			return cloneChain(target);
+
+		Expression::Ptr newLeftOperand, newRightOperand;
+		TokenIt newOp;
+		cloneOperands(target, newLeftOperand, newOp, newRightOperand);
 
 		// Not all expressions expose linebreak
 		auto result = std::make_shared<ExpT>(target, std::move(newLeftOperand), newOp, std::move(newRightOperand));
@@ -840,9 +979,22 @@ protected:
 	}
 
 private:
+	bool isFlat() const { return _flat.load(std::memory_order_acquire); }
+	const Expression* getFirstOperand() const { return isFlat() ? _chain->getOperand(0).get() : _left.get(); }
+	void createLeftOperand() const;
+	void cloneOperands(const std::shared_ptr<TokenStream>& target, Expression::Ptr& left, TokenIt& op, Expression::Ptr& right) const;
+	Expression::Ptr cloneChain(const std::shared_ptr<TokenStream>& target) const;
+	static Expression::Ptr cloneDeep(const Expression::Ptr& expr, const std::shared_ptr<TokenStream>& target);
+	static Expression::Ptr makeClone(const BinaryOpExpression* original, const std::shared_ptr<TokenStream>& target, Expression::Ptr&& left, TokenIt op, Expression::Ptr&& right);
+	static std::shared_ptr<BinaryOpExpression> makeChainOperation(ExpressionKind kind, const std::shared_ptr<TokenStream>& ts, const std::shared_ptr<BinaryOpChain>& chain, std::size_t operands);
+
 	TokenIt _op; ///< Binary operation symbol, std::string
-	Expression::Ptr _left, _right; ///< Expressions to apply operation on
+	mutable Expression::Ptr _left; ///< Expression to apply operation on, created on demand for flat operation
+	Expression::Ptr _right; ///< Expression to apply operation on
+	std::shared_ptr<BinaryOpChain> _chain; ///< Chain of the flat operation
+	std::uint32_t _chainOperands = 0; ///< Number of operands of the chain covered by the operation
 	bool _linebreak; ///< Put linebreak after operation symbol
+	mutable std::atomic<bool> _flat{false}; ///< Operands are read from the chain as the left operand wasn't created yet
 };
 
 /**
@@ -857,10 +1009,12 @@ class AndExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	AndExpression(ExpPtr1&& left, TokenIt and_op, ExpPtr2&& right, bool linebreak = false) : BinaryOpExpression(std::forward<ExpPtr1>(left), and_op, std::forward<ExpPtr2>(right), linebreak) {}
+	AndExpression(ExpPtr1&& left, TokenIt and_op, ExpPtr2&& right, bool linebreak = false) : BinaryOpExpression(std::forward<ExpPtr1>(left), and_op, std::forward<ExpPtr2>(right), linebreak) { setKind(ExpressionKind::And); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	AndExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	AndExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::And); }
+
+	AndExpression(const std::shared_ptr<TokenStream>& ts, std::shared_ptr<BinaryOpChain> chain, std::size_t operands) : BinaryOpExpression(ts, std::move(chain), operands) { setKind(ExpressionKind::And); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -885,10 +1039,12 @@ class OrExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	OrExpression(ExpPtr1&& left, TokenIt op_or, ExpPtr2&& right, bool linebreak = false) : BinaryOpExpression(std::forward<ExpPtr1>(left), op_or, std::forward<ExpPtr2>(right), linebreak) {}
+	OrExpression(ExpPtr1&& left, TokenIt op_or, ExpPtr2&& right, bool linebreak = false) : BinaryOpExpression(std::forward<ExpPtr1>(left), op_or, std::forward<ExpPtr2>(right), linebreak) { setKind(ExpressionKind::Or); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	OrExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	OrExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Or); }
+
+	OrExpression(const std::shared_ptr<TokenStream>& ts, std::shared_ptr<BinaryOpChain> chain, std::size_t operands) : BinaryOpExpression(ts, std::move(chain), operands) { setKind(ExpressionKind::Or); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -913,10 +1069,10 @@ class LtExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	LtExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	LtExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Lt); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	LtExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	LtExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Lt); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -941,10 +1097,10 @@ class GtExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	GtExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	GtExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Gt); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	GtExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	GtExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Gt); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -969,10 +1125,10 @@ class LeExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	LeExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	LeExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Le); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	LeExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	LeExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Le); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -997,10 +1153,10 @@ class GeExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	GeExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	GeExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Ge); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	GeExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	GeExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Ge); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -1025,10 +1181,10 @@ class EqExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	EqExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	EqExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Eq); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	EqExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	EqExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Eq); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -1053,10 +1209,10 @@ class NeqExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	NeqExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	NeqExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Neq); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	NeqExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	NeqExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Neq); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -1081,10 +1237,10 @@ class ContainsExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	ContainsExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	ContainsExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Contains); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	ContainsExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	ContainsExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Contains); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -1109,10 +1265,10 @@ class IcontainsExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	IcontainsExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	IcontainsExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Icontains); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	IcontainsExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	IcontainsExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Icontains); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -1137,10 +1293,10 @@ class MatchesExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	MatchesExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	MatchesExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Matches); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	MatchesExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	MatchesExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Matches); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -1165,10 +1321,10 @@ class StartsWithExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	StartsWithExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	StartsWithExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::StartsWith); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	StartsWithExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	StartsWithExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::StartsWith); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -1193,10 +1349,10 @@ class IstartsWithExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	IstartsWithExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	IstartsWithExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::IstartsWith); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	IstartsWithExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	IstartsWithExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::IstartsWith); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -1221,10 +1377,10 @@ class EndsWithExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	EndsWithExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	EndsWithExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::EndsWith); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	EndsWithExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	EndsWithExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::EndsWith); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -1249,10 +1405,10 @@ class IendsWithExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	IendsWithExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	IendsWithExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::IendsWith); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	IendsWithExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	IendsWithExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::IendsWith); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -1277,10 +1433,10 @@ class IequalsExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	IequalsExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	IequalsExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Iequals); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	IequalsExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	IequalsExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Iequals); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -1306,10 +1462,10 @@ class PlusExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	PlusExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	PlusExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Plus); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	PlusExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	PlusExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Plus); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -1335,10 +1491,10 @@ class MinusExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	MinusExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	MinusExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Minus); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	MinusExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	MinusExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Minus); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -1364,10 +1520,10 @@ class MultiplyExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	MultiplyExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	MultiplyExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Multiply); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	MultiplyExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	MultiplyExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Multiply); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -1393,10 +1549,10 @@ class DivideExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	DivideExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	DivideExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Divide); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	DivideExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	DivideExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Divide); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -1422,10 +1578,10 @@ class ModuloExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	ModuloExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	ModuloExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Modulo); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	ModuloExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	ModuloExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::Modulo); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -1451,10 +1607,10 @@ class BitwiseXorExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	BitwiseXorExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	BitwiseXorExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::BitwiseXor); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	BitwiseXorExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	BitwiseXorExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::BitwiseXor); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -1479,10 +1635,10 @@ class BitwiseAndExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	BitwiseAndExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	BitwiseAndExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::BitwiseAnd); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	BitwiseAndExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	BitwiseAndExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::BitwiseAnd); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -1507,10 +1663,10 @@ class BitwiseOrExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	BitwiseOrExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	BitwiseOrExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::BitwiseOr); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	BitwiseOrExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	BitwiseOrExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::BitwiseOr); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -1535,10 +1691,10 @@ class ShiftLeftExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	ShiftLeftExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	ShiftLeftExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::ShiftLeft); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	ShiftLeftExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	ShiftLeftExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::ShiftLeft); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -1563,10 +1719,10 @@ class ShiftRightExpression : public BinaryOpExpression
 {
 public:
 	template <typename ExpPtr1, typename ExpPtr2>
-	ShiftRightExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	ShiftRightExpression(ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::ShiftRight); }
 
 	template <typename ExpPtr1, typename ExpPtr2>
-	ShiftRightExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) {}
+	ShiftRightExpression(const std::shared_ptr<TokenStream>& ts, ExpPtr1&& left, TokenIt op, ExpPtr2&& right) : BinaryOpExpression(ts, std::forward<ExpPtr1>(left), op, std::forward<ExpPtr2>(right)) { setKind(ExpressionKind::ShiftRight); }
 
 	virtual VisitResult accept(Visitor* v) override
 	{
@@ -1666,6 +1822,7 @@ public:
 		, _left_bracket(left_bracket)
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::ForDict);
 	}
 
 	template <typename ExpPtr1, typename ExpPtr2, typename ExpPtr3>
@@ -1678,6 +1835,7 @@ public:
 		, _left_bracket(left_bracket)
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::ForDict);
 	}
 
 	const std::string& getId1() const { return _id1->getString(); }
@@ -1771,6 +1929,7 @@ public:
 		, _left_bracket(left_bracket)
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::ForArray);
 	}
 
 	template <typename ExpPtr1, typename ExpPtr2, typename ExpPtr3>
@@ -1781,6 +1940,7 @@ public:
 		, _left_bracket(left_bracket)
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::ForArray);
 	}
 
 	const std::string& getId() const { return _id->getString(); }
@@ -1865,6 +2025,7 @@ public:
 		, _left_bracket(left_bracket)
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::ForString);
 	}
 
 	template <typename ExpPtr1, typename ExpPtr2, typename ExpPtr3>
@@ -1874,6 +2035,7 @@ public:
 		, _left_bracket(left_bracket)
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::ForString);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -1959,6 +2121,7 @@ public:
 		, _location_symbol(std::nullopt)
 		, _location(nullptr)
 	{
+		setKind(ExpressionKind::Of);
 	}
 	/**
 	 * Constructor
@@ -1969,6 +2132,7 @@ public:
 		, _location_symbol(location_symbol)
 		, _location(std::forward<ExpPtr3>(location))
 	{
+		setKind(ExpressionKind::Of);
 	}
 
 	template <typename ExpPtr1, typename ExpPtr2, typename ExpPtr3>
@@ -1977,6 +2141,7 @@ public:
 		, _location_symbol(location_symbol)
 		, _location(std::forward<ExpPtr3>(location))
 	{
+		setKind(ExpressionKind::Of);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -2074,6 +2239,7 @@ public:
 		, _elements(std::forward<ExpPtrVector>(elements))
 		, _right_square_bracket(right_square_bracket)
 	{
+		setKind(ExpressionKind::Iterable);
 	}
 
 	template <typename ExpPtrVector>
@@ -2083,6 +2249,7 @@ public:
 		, _elements(std::forward<ExpPtrVector>(elements))
 		, _right_square_bracket(right_square_bracket)
 	{
+		setKind(ExpressionKind::Iterable);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -2178,6 +2345,7 @@ public:
 		, _elements(std::forward<ExpPtrVector>(elements))
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::Set);
 	}
 
 	template <typename ExpPtrVector>
@@ -2187,6 +2355,7 @@ public:
 		, _elements(std::forward<ExpPtrVector>(elements))
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::Set);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -2281,6 +2450,7 @@ public:
 		, _high(std::forward<ExpPtr2>(high))
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::Range);
 	}
 
 	template <typename ExpPtr1, typename ExpPtr2>
@@ -2292,6 +2462,7 @@ public:
 		, _high(std::forward<ExpPtr2>(high))
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::Range);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -2359,6 +2530,7 @@ public:
 		: _symbol(symbolToken->getSymbol())
 		, _symbolToken(symbolToken)
 	{
+		setKind(ExpressionKind::Id);
 	}
 
 	IdExpression(const std::shared_ptr<TokenStream>& ts, TokenIt symbolToken)
@@ -2366,6 +2538,7 @@ public:
 		, _symbol(symbolToken->getSymbol())
 		, _symbolToken(symbolToken)
 	{
+		setKind(ExpressionKind::Id);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -2410,6 +2583,7 @@ protected:
 	IdExpression(const std::shared_ptr<Symbol>& symbol)
 		: _symbol(symbol)
 	{
+		setKind(ExpressionKind::Id);
 	}
 
 	std::shared_ptr<Symbol> _symbol; ///< Symbol of the identifier
@@ -2434,10 +2608,12 @@ public:
 	 */
 	IdWildcardExpression(TokenIt id, TokenIt wildcard) : _id(id), _wildcard(wildcard)
 	{
+		setKind(ExpressionKind::IdWildcard);
 	}
 
 	IdWildcardExpression(const std::shared_ptr<TokenStream>& ts, TokenIt id, TokenIt wildcard) : Expression(ts), _id(id), _wildcard(wildcard)
 	{
+		setKind(ExpressionKind::IdWildcard);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -2492,6 +2668,7 @@ public:
 		, _structure(std::forward<ExpPtr>(structure))
 		, _dot(dot)
 	{
+		setKind(ExpressionKind::StructAccess);
 	}
 
 	template <typename ExpPtr>
@@ -2500,6 +2677,7 @@ public:
 		, _structure(std::forward<ExpPtr>(structure))
 		, _dot(dot)
 	{
+		setKind(ExpressionKind::StructAccess);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -2560,6 +2738,7 @@ public:
 		, _accessor(std::forward<ExpPtr2>(accessor))
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::ArrayAccess);
 		_symbolToken = std::static_pointer_cast<const IdExpression>(_array)->getSymbolToken();
 	}
 
@@ -2571,6 +2750,7 @@ public:
 		, _accessor(std::forward<ExpPtr2>(accessor))
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::ArrayAccess);
 	}
 
 	template <typename ExpPtr1, typename ExpPtr2>
@@ -2581,6 +2761,7 @@ public:
 		, _accessor(std::forward<ExpPtr2>(accessor))
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::ArrayAccess);
 		_symbolToken = std::static_pointer_cast<const IdExpression>(_array)->getSymbolToken();
 	}
 
@@ -2646,6 +2827,7 @@ public:
 		, _args(std::forward<ExpPtrVector>(args))
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::FunctionCall);
 	}
 
 	template <typename ExpPtr, typename ExpPtrVector>
@@ -2656,6 +2838,7 @@ public:
 		, _args(std::forward<ExpPtrVector>(args))
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::FunctionCall);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -2792,11 +2975,13 @@ public:
 	BoolLiteralExpression(TokenIt value)
 		: LiteralExpression<bool>(value)
 	{
+		setKind(ExpressionKind::BoolLiteral);
 	}
 
 	BoolLiteralExpression(bool value)
 		: LiteralExpression<bool>()
 	{
+		setKind(ExpressionKind::BoolLiteral);
 		if (value)
 			_value = _tokenStream->emplace_back(TokenType::BOOL_TRUE, value, "true");
 		else
@@ -2807,6 +2992,7 @@ public:
 	BoolLiteralExpression(const std::shared_ptr<TokenStream>& ts, TokenIt value)
 		: LiteralExpression<bool>(ts, value)
 	{
+		setKind(ExpressionKind::BoolLiteral);
 	}
 
 	virtual LiteralType getValue() const override
@@ -2840,10 +3026,12 @@ public:
 	StringLiteralExpression(TokenIt value)
 		: LiteralExpression<std::string>(value)
 	{
+		setKind(ExpressionKind::StringLiteral);
 	}
 	StringLiteralExpression(const std::shared_ptr<TokenStream>& ts, TokenIt value)
 		: LiteralExpression<std::string>(ts, value)
 	{
+		setKind(ExpressionKind::StringLiteral);
 	}
 
 	virtual LiteralType getValue() const override
@@ -2878,11 +3066,13 @@ public:
 	IntLiteralExpression(TokenIt value)
 		: LiteralExpression<uint64_t>(value)
 	{
+		setKind(ExpressionKind::IntLiteral);
 	}
 
 	IntLiteralExpression(const std::shared_ptr<TokenStream>& ts, TokenIt value)
 		: LiteralExpression<uint64_t>(ts, value)
 	{
+		setKind(ExpressionKind::IntLiteral);
 	}
 
 	virtual LiteralType getValue() const override
@@ -2917,11 +3107,13 @@ public:
 	DoubleLiteralExpression(TokenIt value)
 		: LiteralExpression<double>(value)
 	{
+		setKind(ExpressionKind::DoubleLiteral);
 	}
 
 	DoubleLiteralExpression(const std::shared_ptr<TokenStream>& ts, TokenIt value)
 		: LiteralExpression<double>(ts, value)
 	{
+		setKind(ExpressionKind::DoubleLiteral);
 	}
 
 	virtual LiteralType getValue() const override
@@ -2996,10 +3188,12 @@ public:
 	FilesizeExpression(TokenIt t)
 		: KeywordExpression(t)
 	{
+		setKind(ExpressionKind::Filesize);
 	}
 	FilesizeExpression(const std::shared_ptr<TokenStream>& ts, TokenIt t)
 		: KeywordExpression(ts, t)
 	{
+		setKind(ExpressionKind::Filesize);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -3028,10 +3222,12 @@ public:
 	EntrypointExpression(TokenIt t)
 		: KeywordExpression(t)
 	{
+		setKind(ExpressionKind::Entrypoint);
 	}
 	EntrypointExpression(const std::shared_ptr<TokenStream>& ts, TokenIt t)
 		: KeywordExpression(ts, t)
 	{
+		setKind(ExpressionKind::Entrypoint);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -3061,10 +3257,12 @@ public:
 	AllExpression(TokenIt t)
 		: KeywordExpression(t)
 	{
+		setKind(ExpressionKind::All);
 	}
 	AllExpression(const std::shared_ptr<TokenStream>& ts, TokenIt t)
 		: KeywordExpression(ts, t)
 	{
+		setKind(ExpressionKind::All);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -3094,10 +3292,12 @@ public:
 	AnyExpression(TokenIt t)
 		: KeywordExpression(t)
 	{
+		setKind(ExpressionKind::Any);
 	}
 	AnyExpression(const std::shared_ptr<TokenStream>& ts, TokenIt t)
 		: KeywordExpression(ts, t)
 	{
+		setKind(ExpressionKind::Any);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -3127,10 +3327,12 @@ public:
 	NoneExpression(TokenIt t)
 		: KeywordExpression(t)
 	{
+		setKind(ExpressionKind::None);
 	}
 	NoneExpression(const std::shared_ptr<TokenStream>& ts, TokenIt t)
 		: KeywordExpression(ts, t)
 	{
+		setKind(ExpressionKind::None);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -3160,10 +3362,12 @@ public:
 	ThemExpression(TokenIt t)
 		: KeywordExpression(t)
 	{
+		setKind(ExpressionKind::Them);
 	}
 	ThemExpression(const std::shared_ptr<TokenStream>& ts, TokenIt t)
 		: KeywordExpression(ts, t)
 	{
+		setKind(ExpressionKind::Them);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -3205,6 +3409,7 @@ public:
 		, _left_bracket(left_bracket)
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::Parentheses);
 	}
 
 	template <typename ExpPtr>
@@ -3215,6 +3420,7 @@ public:
 		, _left_bracket(left_bracket)
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::Parentheses);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -3289,6 +3495,7 @@ public:
 		, _left_bracket(left_bracket)
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::IntFunction);
 	}
 
 	template <typename ExpPtr>
@@ -3299,6 +3506,7 @@ public:
 		, _left_bracket(left_bracket)
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::IntFunction);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -3364,6 +3572,7 @@ public:
 	RegexpExpression(S&& regexp)
 		: _regexp(std::forward<S>(regexp))
 	{
+		setKind(ExpressionKind::Regexp);
 		_tokenStream = _regexp->getTokenStream();
 	}
 
@@ -3410,6 +3619,7 @@ public:
 		: _name(name)
 		, _expr(std::forward<ExpPtr>(expr))
 	{
+		setKind(ExpressionKind::VariableDef);
 	}
 
 	template <typename ExpPtr>
@@ -3418,6 +3628,7 @@ public:
 		, _name(name)
 		, _expr(std::forward<ExpPtr>(expr))
 	{
+		setKind(ExpressionKind::VariableDef);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
@@ -3476,6 +3687,7 @@ public:
 		, _body(std::forward<ExpPtr>(body))
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::With);
 	}
 
 	template <typename VarVector, typename ExpPtr>
@@ -3487,6 +3699,7 @@ public:
 		, _body(std::forward<ExpPtr>(body))
 		, _right_bracket(right_bracket)
 	{
+		setKind(ExpressionKind::With);
 	}
 
 	virtual VisitResult accept(Visitor* v) override
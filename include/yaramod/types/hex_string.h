@@ -48,6 +48,7 @@ public:
 	virtual std::size_t getLength() const = 0;
 	virtual TokenIt getFirstTokenIt() const = 0;
 	virtual TokenIt getLastTokenIt() const = 0;
+	virtual std::shared_ptr<HexStringUnit> clone(const std::shared_ptr<TokenStream>& target, TokenMap& copies) const = 0;
 	/// @}
 
 	/// @name Detection methods
@@ -91,6 +92,7 @@ public:
 	virtual std::string getPureText() const override;
 	virtual TokenIt getFirstTokenIt() const override;
 	virtual TokenIt getLastTokenIt() const override;
+	virtual std::shared_ptr<String> clone(const std::shared_ptr<TokenStream>& target, TokenMap& copies) const override;
 	/// @}
 
 	/// @name Getters
@@ -160,6 +162,11 @@ public:
 	virtual TokenIt getLastTokenIt() const override { return _value; }
 	/// @}
 
+	virtual std::shared_ptr<HexStringUnit> clone(const std::shared_ptr<TokenStream>& /*target*/, TokenMap& copies) const override
+	{
+		return std::make_shared<HexStringNibble>(copies.at(&*_value));
+	}
+
 private:
 	TokenIt _value; ///< Value of the nibble
 };
@@ -183,6 +190,10 @@ public:
 	virtual std::size_t getLength() const override { return 1; }
 	virtual TokenIt getFirstTokenIt() const override { return _value; }
 	virtual TokenIt getLastTokenIt() const override { return _value; }
+	virtual std::shared_ptr<HexStringUnit> clone(const std::shared_ptr<TokenStream>& /*target*/, TokenMap& copies) const override
+	{
+		return std::make_shared<HexStringWildcard>(copies.at(&*_value));
+	}
 	/// @}
 private:
 	TokenIt _value; ///< Value of the nibble
@@ -210,6 +221,10 @@ public:
 	virtual std::size_t getLength() const override { return 0; }
 	virtual TokenIt getFirstTokenIt() const override { return _not; }
 	virtual TokenIt getLastTokenIt() const override { return _second->getLastTokenIt(); }
+	virtual std::shared_ptr<HexStringUnit> clone(const std::shared_ptr<TokenStream>& target, TokenMap& copies) const override
+	{
+		return std::make_shared<HexStringNot>(copies.at(&*_not), _first->clone(target, copies), _second->clone(target, copies));
+	}
 	/// @}
 
 	/// @name Getters
@@ -281,6 +296,16 @@ public:
 	}
 
 	virtual std::size_t getLength() const override { return 0; }
+
+	virtual std::shared_ptr<HexStringUnit> clone(const std::shared_ptr<TokenStream>& /*target*/, TokenMap& copies) const override
+	{
+		auto result = std::make_shared<HexStringJump>(copies.at(&*_leftBracket), copies.at(&*_rightBracket));
+		if (_low)
+			result->_low = copies.at(&**_low);
+		if (_high)
+			result->_high = copies.at(&**_high);
+		return result;
+	}
 	/// @}
 
 	/// @name Getters
@@ -344,6 +369,15 @@ public:
 				return acc + substring->getLength();
 			});
 	}
+
+	virtual std::shared_ptr<HexStringUnit> clone(const std::shared_ptr<TokenStream>& target, TokenMap& copies) const override
+	{
+		std::vector<std::shared_ptr<HexString>> substrings;
+		substrings.reserve(_substrings.size());
+		for (const auto& substring : _substrings)
+			substrings.push_back(std::static_pointer_cast<HexString>(substring->clone(target, copies)));
+		return std::make_shared<HexStringOr>(std::move(substrings));
+	}
 	/// @}
 
 	/// @name Getters
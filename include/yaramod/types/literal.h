@@ -36,6 +36,7 @@ class Literal
 public:
 
 	using ReferenceType = const Literal*;
+	using InternedString = std::shared_ptr<const std::string>;
 	/// @name Costructors
 	/// @{
 	Literal() { assert(is<std::string>()); };
@@ -49,6 +50,8 @@ public:
 	explicit Literal(const std::shared_ptr<Symbol>& value);
 	explicit Literal(std::shared_ptr<Symbol>&& value);
 	explicit Literal(ReferenceType value);
+	explicit Literal(const InternedString& value);
+	explicit Literal(InternedString&& value);
 
 	Literal(Literal&& literal) = default;
 	Literal(const Literal& literal) = default;
@@ -58,7 +61,8 @@ public:
 
 	/// @name Detection methods
 	/// @{
-	bool isString() const { return is<std::string>(); }
+	bool isString() const { return is<std::string>() || is<InternedString>(); }
+	bool isInterned() const { return is<InternedString>(); }
 	bool isBool() const { return is<bool>(); }
 	bool isInt() const { return is<std::int64_t>() || is<std::uint64_t>(); }
 	bool isFloat() const { return is<double>(); }
@@ -68,7 +72,7 @@ public:
 
 	/// @name Getter methods
 	/// @{
-	const std::string& getString() const { assert(isString()); return std::get<std::string>(_value); }
+	const std::string& getString() const { assert(isString()); return is<InternedString>() ? *std::get<InternedString>(_value) : std::get<std::string>(_value); }
 	bool getBool() const { assert(isBool()); return std::get<bool>(_value); }
 	std::int64_t getInt() const { return is<std::int64_t>() ? std::get<std::int64_t>(_value) : std::get<std::uint64_t>(_value); }
 	std::uint64_t getUInt() const { return is<std::uint64_t>() ? std::get<std::uint64_t>(_value) : std::get<std::int64_t>(_value); }
@@ -97,6 +101,7 @@ public:
 	bool trimWhitespaces();
 	std::string getText(bool pure = false) const;
 	std::string getPureText() const;
+	void appendText(std::string& output, bool pure = false) const;
 	/// @}
 
 	friend std::ostream& operator<<(std::ostream& os, const Literal& literal)
@@ -109,6 +114,8 @@ public:
 			os << literal.getSymbol()->getName();
 		else if (literal.isLiteralReference())
 			os << *(literal.getLiteralReference());
+		else if (literal.isInterned())
+			os << literal.getString();
 		else
 			std::visit(
 				[&os](auto&& v)
@@ -128,7 +135,7 @@ private:
 	/// For an integral literal x there are two options:
 	/// i.  x it is unformatted: _formatted_value is empty  AND  _value contains x
 	/// ii. x it is formatted:   _formatted_value contains x's string representation  AND  _value contains pure x
-	std::variant<std::string, bool, std::int64_t, std::uint64_t, double, std::shared_ptr<Symbol>, ReferenceType> _value; ///< Value used for all literals:
+	std::variant<std::string, bool, std::int64_t, std::uint64_t, double, std::shared_ptr<Symbol>, ReferenceType, InternedString> _value; ///< Value used for all literals:
 	std::optional<std::string> _formatted_value; ///< Value used for integral literals with particular formatting
 };
 
@@ -0,0 +1,45 @@
+/**
+ * @file src/types/literal_pool.h
+ * @brief Declaration of class LiteralPool.
+ * @copyright (c) 2026 Avast Software, licensed under the MIT license
+ */
+
+#pragma once
+
+#include <string_view>
+#include <unordered_map>
+
+#include "yaramod/types/literal.h"
+
+namespace yaramod {
+
+/**
+ * Pool of interned string values of literals. Every distinct text is stored only once
+ * and all literals created out of the pool share it, so two interned literals with
+ * the same text can be compared just by the addresses of their strings.
+ *
+ * Interned strings are reference counted, they stay valid even when the pool is destroyed.
+ * Changing the value of an interned literal replaces its string, the pool is never modified.
+ */
+class LiteralPool
+{
+public:
+	/// @name Interning
+	/// @{
+	Literal::InternedString intern(std::string_view text);
+	/// @}
+
+	/// @name Statistics
+	/// @{
+	std::size_t getStringsCount() const { return _strings.size(); }
+	std::size_t getInternedCount() const { return _internedCount; }
+	std::size_t getSavedBytes() const { return _savedBytes; }
+	/// @}
+
+private:
+	std::unordered_map<std::string_view, Literal::InternedString> _strings; ///< Interned strings indexed by their text
+	std::size_t _internedCount = 0; ///< Number of requests to intern a string
+	std::size_t _savedBytes = 0; ///< Heap memory which would be needed by duplicated strings
+};
+
+} // namespace yaramod
@@ -43,6 +43,7 @@ public:
 	TokenIt getKeyTokenIt() const;
 	const Literal& getValue() const;
 	TokenIt getValueTokenIt() const;
+	Meta clone(const TokenMap& copies) const;
 	/// @}
 
 	/// @name Setter methods
@@ -10,6 +10,7 @@
 #include <string>
 
 #include "yaramod/utils/json.h"
+#include "yaramod/types/modules/module_content.h"
 #include "yaramod/types/symbols.h"
 #include "yaramod/yaramod_error.h"
 
@@ -39,6 +40,8 @@ public:
 	/// @{
 	Module(const std::string& name, const std::string& path);
 	Module(const std::string& name, nlohmann::json&& json);
+	explicit Module(ModuleContent&& content);
+	Module(const Module& other);
 	/// @}
 
 	/// @name Destructor
@@ -51,6 +54,7 @@ public:
 	bool initialize();
 	void addPath(const std::string& path);
 	void addJson(const nlohmann::json& json);
+	void addContent(ModuleContent&& content);
 	/// @}
 
 	/// @name Getter methods
@@ -67,18 +71,22 @@ public:
 	/// @}
 
 protected:
-	void _addAttributeFromJson(StructureSymbol* base, const nlohmann::json& json);
-	void _addIterable(StructureSymbol* base, const nlohmann::json& json);
-	void _addFunctions(StructureSymbol* base, const nlohmann::json& json);
-	void _addStruct(Symbol* base, const nlohmann::json& json, std::shared_ptr<StructureSymbol>* ref);
-	void _addReference(Symbol* base, const nlohmann::json& json);
-	void _addValue(StructureSymbol* base, const nlohmann::json& json);
-	void _importJson(const nlohmann::json& json);
+	// Module specification can be either nlohmann::json or BinaryJson
+	template <typename JsonT> void _addAttributeFromJson(StructureSymbol* base, const JsonT& json);
+	template <typename JsonT> void _addIterable(StructureSymbol* base, const JsonT& json);
+	template <typename JsonT> void _addFunctions(StructureSymbol* base, const JsonT& json);
+	template <typename JsonT> void _addStruct(Symbol* base, const JsonT& json, std::shared_ptr<StructureSymbol>* ref);
+	template <typename JsonT> void _addReference(Symbol* base, const JsonT& json);
+	template <typename JsonT> void _addValue(StructureSymbol* base, const JsonT& json);
+	template <typename JsonT> void _importJson(const JsonT& json);
+	template <typename JsonT> JsonT _checkContent(JsonT&& json, const ModuleContent& content) const;
 	std::shared_ptr<Symbol> _stringToSymbol (const std::shared_ptr<Symbol>& base, const std::string& str);
 	void _addObjectToBase(Symbol* base, std::shared_ptr<Symbol> newAttribute);
 
 	std::string _name; ///< Name of the module
 	std::vector<std::pair<std::string, bool>> _filePaths; ///< The custom paths to JSON files which help to determine this module. Elements: [<path>, true iff <path> was loaded]. May be empty if no private modules.
+	std::vector<ModuleContent> _contents; ///< Unprocessed contents of built-in modules. They are processed only when the module gets initialized.
+	std::vector<BinaryJson> _compiledJsons; ///< The compiled jsons of built-in modules which determine this module
 	std::vector<nlohmann::json> _jsons; ///< The jsons which determine this module
 	std::shared_ptr<StructureSymbol> _structure; ///< Structure of the module
 };
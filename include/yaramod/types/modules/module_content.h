@@ -9,25 +9,32 @@
 #include <sstream>
 #include <string>
 
+#include "yaramod/utils/binary_json.h"
 #include "yaramod/utils/json.h"
 
 namespace yaramod {
 
 /**
- * Class holding contents of importable Module.
+ * Class holding contents of importable Module. The content is either
+ * JSON text or JSON compiled into binary form at build time.
  */
 class ModuleContent
 {
 public:
 	/// @name Constructors
 	/// @{
-	explicit ModuleContent(const std::string& name)
-		: _name(name), _content()
+	explicit ModuleContent(const std::string& name, bool deprecated = false)
+		: _name(name), _content(), _compiledContent(nullptr), _deprecated(deprecated)
 	{
 	}
 
-	ModuleContent(const std::string& name, std::string&& content)
-		: _name(name), _content(std::move(content))
+	ModuleContent(const std::string& name, std::string&& content, bool deprecated = false)
+		: _name(name), _content(std::move(content)), _compiledContent(nullptr), _deprecated(deprecated)
+	{
+	}
+
+	ModuleContent(const std::string& name, const BinaryJson::Data* compiledContent, bool deprecated = false)
+		: _name(name), _content(), _compiledContent(compiledContent), _deprecated(deprecated)
 	{
 	}
 	/// @}
@@ -36,6 +43,12 @@ public:
 	/// @{
 	const std::string& getName() const { return _name; }
 	const std::string& getContent() const { return _content; }
+	const BinaryJson::Data* getCompiledContent() const { return _compiledContent; }
+	/// @}
+
+	/// @name Detection methods
+	/// @{
+	bool isDeprecated() const { return _deprecated; }
 	/// @}
 
 	/// @name Setter methods
@@ -46,6 +59,8 @@ public:
 private:
 	std::string _name; ///< Name of the module
 	std::string _content; ///< The content of the module in JSON
+	const BinaryJson::Data* _compiledContent; ///< The content of the module in binary JSON, @c nullptr if not compiled
+	bool _deprecated; ///< Whether the module is marked as deprecated
 };
 
 } //namespace yaramod
@@ -12,11 +12,17 @@
 #include "yaramod/types/modules/module.h"
 
 #include <map>
+#include <memory>
+#include <mutex>
 
 namespace yaramod {
 
 /**
  * Class maintaining importable modules.
+ *
+ * Loading of modules is thread-safe so a single pool can be used by multiple
+ * parsers running in different threads. Symbol trees of the initialized modules
+ * are never modified by the pool afterwards.
  */
 class ModulePool {
 public:
@@ -27,9 +33,45 @@ public:
 	 *
 	 * Otherwise we load all modules specified in generated ModuleList and also when directory is nonempty, we load all modules from there too.
 	 *
+	 * Lazy mode has to be requested explicitly. In lazy mode, only the built-in modules are deferred,
+	 * they are turned into symbols once they are loaded for the first time. Their specifications
+	 * are compiled and validated at build time. Modules loaded from JSON files are initialized right
+	 * away in both modes, so errors in their specifications are still reported by the constructor.
+	 *
+	 * @param directory The directory to load the modules from apart from YARAMOD_MODULE_SPEC_PATH
+	 * @param lazy Whether to initialize the built-in modules on their first load instead of right away
+	 */
+	ModulePool(Features features, const std::string& directory, bool lazy = false);
+	/**
+	 * Copy constructor which creates an overlay of the other pool.
+	 *
+	 * The overlay shares all modules with the original pool. Only when a module gets extended
+	 * using addJson(), the overlay gets its own copy of the module which is initialized again.
+	 * The original pool and everyone using it are not affected.
+	 *
+	 * @param base The pool to create overlay of
+	 */
+	ModulePool(const ModulePool& base);
+	/**
+	 * Returns the pool shared by the whole process for given features and directory.
+	 * The pool is created on the first request and then reused, together with the modules
+	 * already initialized in it. Values of YARAMOD_MODULE_SPEC_PATH and YARAMOD_MODULE_SPEC_PATH_EXCLUSIVE
+	 * are also taken into account, so a new pool is created when they change.
+	 *
+	 * The shared pool is read-only, create an overlay of it to extend it using addJson().
+	 * Shared pools are cached for the life of the process, so changes of JSON files in the directory
+	 * are picked up only by the pools created after clearShared() is called.
+	 *
+	 * @param features Determines which symbols to import
 	 * @param directory The directory to load the modules from apart from YARAMOD_MODULE_SPEC_PATH
+	 *
+	 * @return Shared pool.
+	 */
+	static std::shared_ptr<const ModulePool> getShared(Features features, const std::string& directory);
+	/**
+	 * Forgets all shared pools. Pools which are still in use are kept alive by their users.
 	 */
-	ModulePool(Features features, const std::string& directory);
+	static void clearShared();
 	/**
 	 * Loads the module based on its name from the table of known modules.
 	 *
@@ -38,20 +80,33 @@ public:
 	 *
 	 * @return Module if found, @c nullptr otherwise.
 	 */
-	std::shared_ptr<Module> load(const std::string& name);
+	std::shared_ptr<Module> load(const std::string& name) const;
 	/**
 	 *
 	 * Method returns sorted map of pointers to modules stored.
+	 * All modules which were not initialized yet get initialized.
 	 *
 	 * @return modules stored.
 	 */
 	std::map<std::string, Module*> getModules() const;
+	/**
+	 * Extends the module with the given JSON specification. If there is no such module, it is created.
+	 * The module is replaced with its own copy, so modules shared with other pools are never modified.
+	 *
+	 * @param name Name of the module to extend
+	 * @param json Specification of the module
+	 */
+	void addJson(const std::string& name, const nlohmann::json& json);
 
 private:
+	static std::mutex& _sharedPoolsMutex();
+	static std::unordered_map<std::string, std::shared_ptr<const ModulePool>>& _sharedPools();
+
 	void _init(const std::string& directory);
 	bool _processPath(fs::path path);
-	void _processModuleContent(const ModuleContent& content);
+	void _processModuleContent(ModuleContent&& content);
 	Features _features;
+	std::shared_ptr<std::mutex> _mutex; ///< Guards initialization of modules, shared with overlays because they share the modules
 	std::unordered_map<std::string, std::shared_ptr<Module>> _knownModules = {}; ///< Table of all known modules
 	modules::ModuleList _moduleList; ///< list of contents of the modules to be loaded from JSON
 };
@@ -38,6 +38,7 @@ public:
 	virtual std::string getPureText() const override;
 	virtual TokenIt getFirstTokenIt() const override;
 	virtual TokenIt getLastTokenIt() const override;
+	virtual std::shared_ptr<String> clone(const std::shared_ptr<TokenStream>& target, TokenMap& copies) const override;
 	/// @}
 
 private:
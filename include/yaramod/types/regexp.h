@@ -630,22 +630,17 @@ public:
 
 	virtual std::shared_ptr<RegexpUnit> clone(const std::shared_ptr<TokenStream>& target) const override
 	{
-		TokenIt newFirst, newSecond, newOperation;
+		std::optional<TokenIt> newFirst, newSecond;
 		auto newOperand = _operand->clone(target);
 		auto newLb = _leftBracket->clone(target.get());
-		if (_first && _first == _second)
-		{
+		if (_first)
 			newFirst = _first.value()->clone(target.get());
+		// Fixed range keeps the empty operation token too
+		auto newOperation = _operation->clone(target.get());
+		if (_first && _first == _second)
 			newSecond = newFirst;
-		}
-		else
-		{
-			if (_first)
-				newFirst = _first.value()->clone(target.get());
-			newOperation = _operation->clone(target.get());
-			if (_second)
-				newSecond = _second.value()->clone(target.get());
-		}
+		else if (_second)
+			newSecond = _second.value()->clone(target.get());
 		auto newRb = _rightBracket->clone(target.get());
 		auto newGreedy = _greedy->clone(target.get());
 		return std::make_shared<RegexpRange>(target, std::move(newOperand), newOperation, newGreedy, newLb, newFirst, newSecond, newRb);
@@ -958,6 +953,13 @@ public:
 		return std::make_shared<Regexp>(target, newLeftSlash, std::move(newUnit), newRightSlash, newSuffixMods);
 	}
 
+	virtual std::shared_ptr<String> clone(const std::shared_ptr<TokenStream>& target, TokenMap& copies) const override
+	{
+		auto result = cloneInPlace(*this, target, copies);
+		cloneProperties(*result, copies);
+		return result;
+	}
+
 private:
 	TokenIt _leftSlash; ///< right '/' token
 	std::shared_ptr<RegexpUnit> _unit; ///< Unit defining other units in regular expression
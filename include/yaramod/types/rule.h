@@ -81,6 +81,7 @@ public:
 	TokenStream* getTokenStream() const { return _tokenStream.get(); }
 	TokenIt getFirstTokenIt() const;
 	TokenIt getLastTokenIt() const;
+	std::shared_ptr<Rule> clone(const std::shared_ptr<TokenStream>& target, TokenMap& copies) const;
 	/// @}
 
 	/// @name Setter methods
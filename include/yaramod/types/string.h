@@ -164,6 +164,12 @@ public:
 	virtual TokenIt getLastTokenIt() const = 0;
 	/// @}
 
+	/**
+	 * Returns the copy of the string which refers to the copies of its tokens in the target stream.
+	 * The tokens have to be already copied by TokenStream::copy().
+	 */
+	virtual std::shared_ptr<String> clone(const std::shared_ptr<TokenStream>& target, TokenMap& copies) const = 0;
+
 	/// @name Setter methods
 	/// @{
 	void setIdentifier(std::string&& id)
@@ -292,6 +298,16 @@ public:
 	/// @}
 
 protected:
+	void cloneProperties(String& copy, const TokenMap& copies) const
+	{
+		if (_id)
+			copy._id = copies.at(&**_id);
+		if (_assignToken)
+			copy._assignToken = copies.at(&**_assignToken);
+		for (const auto& [type, mod] : _mods)
+			copy._mods.emplace(type, mod->clone(copies));
+	}
+
 	std::shared_ptr<TokenStream> _tokenStream; ///< shared_pointer to the TokenStream in which the data is stored
 	Type _type; ///< Type of string //no need to store type of string in tokenstream - we just store the '"' or '/' characters
 	std::optional<TokenIt> _id; ///< Optional TokenIt pointing to identifier in strings section
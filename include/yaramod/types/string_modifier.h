@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <memory>
 #include <optional>
 #include <string>
 #include <variant>
@@ -58,6 +59,20 @@ public:
 
 	virtual std::string getText() const = 0;
 
+	/**
+	 * Returns the copy of the modifier which refers to the copies of its tokens.
+	 */
+	virtual std::shared_ptr<StringModifier> clone(const TokenMap& copies) const = 0;
+
+protected:
+	template <typename T>
+	std::shared_ptr<StringModifier> cloneAs(const TokenMap& copies) const
+	{
+		std::shared_ptr<StringModifier> result = std::make_shared<T>(static_cast<const T&>(*this));
+		result->_tokens = {copies.at(&*_tokens.first), copies.at(&*_tokens.second)};
+		return result;
+	}
+
 private:
 	Type _type;
 	std::string _name;
@@ -70,6 +85,7 @@ public:
 	AsciiStringModifier(TokenIt token) : StringModifier(Type::Ascii, "ascii", token, token) {}
 
 	virtual std::string getText() const override { return getName(); }
+	virtual std::shared_ptr<StringModifier> clone(const TokenMap& copies) const override { return cloneAs<AsciiStringModifier>(copies); }
 };
 
 class WideStringModifier : public StringModifier
@@ -78,6 +94,7 @@ public:
 	WideStringModifier(TokenIt token) : StringModifier(Type::Wide, "wide", token, token) {}
 
 	virtual std::string getText() const override { return getName(); }
+	virtual std::shared_ptr<StringModifier> clone(const TokenMap& copies) const override { return cloneAs<WideStringModifier>(copies); }
 };
 
 class NocaseStringModifier : public StringModifier
@@ -86,6 +103,7 @@ public:
 	NocaseStringModifier(TokenIt token) : StringModifier(Type::Nocase, "nocase", token, token) {}
 
 	virtual std::string getText() const override { return getName(); }
+	virtual std::shared_ptr<StringModifier> clone(const TokenMap& copies) const override { return cloneAs<NocaseStringModifier>(copies); }
 };
 
 class FullwordStringModifier : public StringModifier
@@ -94,6 +112,7 @@ public:
 	FullwordStringModifier(TokenIt token) : StringModifier(Type::Fullword, "fullword", token, token) {}
 
 	virtual std::string getText() const override { return getName(); }
+	virtual std::shared_ptr<StringModifier> clone(const TokenMap& copies) const override { return cloneAs<FullwordStringModifier>(copies); }
 };
 
 class PrivateStringModifier : public StringModifier
@@ -102,6 +121,7 @@ public:
 	PrivateStringModifier(TokenIt token) : StringModifier(Type::Private, "private", token, token) {}
 
 	virtual std::string getText() const override { return getName(); }
+	virtual std::shared_ptr<StringModifier> clone(const TokenMap& copies) const override { return cloneAs<PrivateStringModifier>(copies); }
 };
 
 class XorStringModifier : public StringModifier
@@ -144,6 +164,8 @@ public:
 			return getName();
 	}
 
+	virtual std::shared_ptr<StringModifier> clone(const TokenMap& copies) const override { return cloneAs<XorStringModifier>(copies); }
+
 private:
 	std::optional<std::uint32_t> _low, _high;
 };
@@ -174,6 +196,8 @@ public:
 			return getName();
 	}
 
+	virtual std::shared_ptr<StringModifier> clone(const TokenMap& copies) const override { return cloneAs<Base64StringModifier>(copies); }
+
 private:
 	std::optional<std::string> _alphabet;
 };
@@ -204,6 +228,8 @@ public:
 			return getName();
 	}
 
+	virtual std::shared_ptr<StringModifier> clone(const TokenMap& copies) const override { return cloneAs<Base64WideStringModifier>(copies); }
+
 private:
 	std::optional<std::string> _alphabet;
 };
@@ -7,19 +7,25 @@
 #pragma once
 
 #include <list>
+#include <unordered_map>
 
 #include "yaramod/parser/location.h"
 #include "yaramod/types/literal.h"
 #include "yaramod/types/token_type.h"
+#include "yaramod/utils/pool_allocator.h"
 #include "yaramod/yaramod_error.h"
 
 namespace yaramod {
 
 class Token;
-using TokenIt = std::list<Token>::iterator;
-using TokenConstIt = std::list<Token>::const_iterator;
+// Tokens and their literals are allocated from pools so tokens of the same stream lie close to each other
+using TokenList = std::list<Token, PoolAllocator<Token>>;
+using TokenIt = TokenList::iterator;
+using TokenConstIt = TokenList::const_iterator;
 using TokenItReversed = std::reverse_iterator<TokenIt>;
 using TokenConstItReversed = std::reverse_iterator<TokenConstIt>;
+// Copies of tokens indexed by the tokens they were copied from (see TokenStream::copy())
+using TokenMap = std::unordered_map<const Token*, TokenIt>;
 
 class TokenStream;
 
@@ -31,7 +37,7 @@ class Token
 public:
 	Token(TokenType type, const Literal& value)
 		: _type(type)
-		, _value(std::make_shared<Literal>(value))
+		, _value(std::allocate_shared<Literal>(PoolAllocator<Literal>{}, value))
 		, _location()
 		, _wanted_column(0)
 	{
@@ -41,7 +47,7 @@ public:
 
 	Token(TokenType type, Literal&& value)
 		: _type(type)
-		, _value(std::make_shared<Literal>(std::move(value)))
+		, _value(std::allocate_shared<Literal>(PoolAllocator<Literal>{}, std::move(value)))
 		, _location()
 		, _wanted_column(0)
 	{
@@ -57,11 +63,12 @@ public:
 	/// @{
 	std::string getText(bool pure = false) const;
 	std::string getPureText() const;
+	void appendText(std::string& output, bool pure = false) const;
 	/// @}
 
 	/// @name Setter methods
 	/// @{
-	void setValue(const Literal& new_value) { _value = std::make_shared<Literal>(new_value); }
+	void setValue(const Literal& new_value) { _value = std::allocate_shared<Literal>(PoolAllocator<Literal>{}, new_value); }
 
 	void setValue(const std::string& value) { _value->setValue(value); }
 	void setValue(std::string&& value) { _value->setValue(std::move(value)); }
@@ -164,6 +171,7 @@ public:
 	/// @{
 	const std::shared_ptr<TokenStream>& getSubTokenStream() const;
 	const std::shared_ptr<TokenStream>& initializeSubTokenStream();
+	void setSubTokenStream(const std::shared_ptr<TokenStream>& subTokenStream);
 	/// @}
 
 	TokenIt clone(TokenStream* target) const;
@@ -7,6 +7,8 @@
 #pragma once
 
 #include <list>
+#include <memory>
+#include <ostream>
 #include <set>
 #include <vector>
 
@@ -20,27 +22,6 @@ namespace yaramod {
 class TokenStream
 {
 public:
-	/**
-	 * Class serves as a context storage for printing TokenStream and determining comment alignment.
-	 */
-	class PrintHelper
-	{
-	public:
-		std::size_t getCurrentLine() const { return lineCounter; }
-		const std::vector<TokenIt>& getCommentPool() const { return commentPool; }
-
-		std::size_t insertIntoStream(std::stringstream* ss, char what);
-		std::size_t insertIntoStream(std::stringstream* ss, const std::string& what, std::size_t length = 0);
-		std::size_t insertIntoStream(std::stringstream* ss, TokenStream* ts, TokenIt what);
-		std::size_t printComment(std::stringstream* ss, TokenStream* ts, TokenIt it, size_t currentLineTabs, bool alignComment, bool ignoreUserIndent);
-	private:
-		std::size_t lineCounter = 0;
-		std::size_t columnCounter = 0;
-		bool commentOnThisLine = false;
-		std::size_t maximalCommentColumn = 0;
-		std::vector<TokenIt> commentPool;
-	};
-
 	TokenStream() = default;
 	TokenStream(const TokenStream &ts) = delete;
 
@@ -108,13 +89,15 @@ public:
 	void swapTokens(TokenIt local_first, TokenIt local_last, TokenStream* other, TokenIt other_first, TokenIt other_last);
 	// Clone only data in [first, last) from donor and append it at the end.
 	void cloneAppend(TokenStream* donor, TokenIt first, TokenIt last);
+	// Copy all data including literals and tokens of included files into a new stream, copies receives the copy of every token.
+	std::shared_ptr<TokenStream> copy(TokenMap& copies) const;
 	/// @}
 
 	/// @name Element access
 	/// @{
 	const Token& front() const { return _tokens.front(); }
 	const Token& back() const { return _tokens.back(); }
-	const std::list<Token>& getTokens() const { return _tokens; }
+	const TokenList& getTokens() const { return _tokens; }
 	std::pair<TokenIt, TokenIt> findBounds(TokenIt embedded, TokenType leftType, TokenType rightType) const;
 	/// @}
 
@@ -150,8 +133,10 @@ public:
 
 	/// @name Text representation
 	/// @{
-	friend std::ostream& operator<<(std::ostream& os, TokenStream& ts) { return os << ts.getText(false); }
+	friend std::ostream& operator<<(std::ostream& os, TokenStream& ts) { ts.writeText(os); return os; }
 	std::string getText(bool withIncludes = false, bool alignComments = true);
+	void writeText(std::string& output, bool withIncludes = false, bool alignComments = true);
+	void writeText(std::ostream& output, bool withIncludes = false, bool alignComments = true);
 	std::vector<std::string> getTokensAsText() const;
 	std::string getTokensAsString() const;
 	/// @}
@@ -166,7 +151,9 @@ public:
 	void clear();
 	/// @}
 protected:
-	void getTextProcedure(PrintHelper& helper, std::stringstream* os, bool withIncludes, bool alignComments);
+	class TextFormatter;
+
+	void writeTextProcedure(TextFormatter& formatter, bool withIncludes);
 	void autoformat();
 	bool determineNewlineSectors();
 	void removeRedundantDoubleNewlines();
@@ -174,9 +161,50 @@ protected:
 
 	std::optional<TokenIt> predecessor(TokenIt it);
 private:
-	std::list<Token> _tokens; ///< All tokens off the rule
+	TokenList _tokens; ///< All tokens off the rule
 	bool _formatted = false; ///< The flag is set once autoformat has been called
 	std::string _new_line_style = "\n"; ///< The character used for line endings: usually '\n' on Unix or '\r' on MacOs or '\r\n' on Windows
 };
 
+/**
+ * Clones the object whose tokens were already copied into the target stream (see TokenStream::copy()).
+ * The object is cloned by its method clone() which appends new tokens at the end of the target stream.
+ * These tokens then replace the copies, so the clone ends up at the position of the original object.
+ * Tokens of the clone are paired with the original ones by their position, so the clone needs to consist
+ * of the same number of tokens as the original object.
+ *
+ * @param object Object to clone.
+ * @param target Copy of the token stream of the object.
+ * @param copies Copies of the tokens, updated to refer to the tokens of the clone.
+ *
+ * @return Clone of the object.
+ */
+template <typename T>
+auto cloneInPlace(const T& object, const std::shared_ptr<TokenStream>& target, TokenMap& copies)
+{
+	auto first = copies.at(&*object.getFirstTokenIt());
+	auto end = std::next(copies.at(&*object.getLastTokenIt()));
+	auto last = std::prev(target->end());
+	auto clone = object.clone(target);
+
+	auto cloneFirst = std::next(last);
+	auto original = object.getFirstTokenIt();
+	if (std::distance(cloneFirst, target->end()) != std::distance(original, std::next(object.getLastTokenIt())))
+	{
+		target->erase(cloneFirst, target->end());
+		throw YaramodError("Error: Clone of '" + object.getText() + "' does not consist of the same tokens as the original");
+	}
+
+	// Cloned tokens share the literals with the original ones
+	for (auto itr = cloneFirst; itr != target->end(); ++itr, ++original)
+	{
+		itr->setValue(itr->getLiteral());
+		copies[&*original] = itr;
+	}
+
+	target->moveAppend(first, target.get(), cloneFirst, target->end());
+	target->erase(first, end);
+	return clone;
+}
+
 } //namespace yaramod
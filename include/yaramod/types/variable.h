@@ -43,6 +43,7 @@ public:
 	const std::string& getKey() const;
 	TokenIt getKeyTokenIt() const;
 	const Expression::Ptr& getValue() const;
+	Variable clone(const std::shared_ptr<TokenStream>& target, TokenMap& copies) const;
 	/// @}
 
 	/// @name Setter methods
@@ -8,7 +8,9 @@
 
 #include <vector>
 
+#include "yaramod/types/expression_arena.h"
 #include "yaramod/types/features.h"
+#include "yaramod/types/literal_pool.h"
 #include "yaramod/types/modules/module_pool.h"
 #include "yaramod/types/rule.h"
 
@@ -34,18 +36,21 @@ public:
 	/// @{
 	std::string getText() const;
 	std::string getTextFormatted(bool withIncludes = false) const;
+	void writeTextFormatted(std::string& output, bool withIncludes = false) const;
+	void writeTextFormatted(std::ostream& output, bool withIncludes = false) const;
 	/// @}
 
 	/// @name Addition methods
 	/// @{
-	bool addImport(TokenIt import, ModulePool& modules);
-	bool addImports(const std::vector<TokenIt>& imports, ModulePool& modules);
+	bool addImport(TokenIt import, const ModulePool& modules);
+	bool addImports(const std::vector<TokenIt>& imports, const ModulePool& modules);
 	void addRule(Rule&& rule, bool extractTokens = false);
 	void addRule(std::unique_ptr<Rule>&& rule, bool extractTokens = false);
 	void addRule(const std::shared_ptr<Rule>& rule, bool extractTokens = false);
 	void addRules(const std::vector<std::shared_ptr<Rule>>& rules, bool extractTokens = false);
 	void insertRule(std::size_t position, std::unique_ptr<Rule>&& rule);
 	void insertRule(std::size_t position, const std::shared_ptr<Rule>& rule);
+	void attachRules(std::size_t position, std::vector<std::shared_ptr<Rule>>&& rules);
 	/// @}
 
 	/// @name Getter methods
@@ -53,6 +58,15 @@ public:
 	const std::vector<std::shared_ptr<Module>>& getImports() const;
 	const std::vector<std::shared_ptr<Rule>>& getRules() const;
 	TokenStream* getTokenStream() const;
+	const std::shared_ptr<TokenStream>& getTokenStreamSharedPtr() const;
+	LiteralPool& getLiteralPool();
+	const LiteralPool& getLiteralPool() const;
+	const std::shared_ptr<ExpressionArena>& getExpressionArena() const;
+	/// @}
+
+	/// @name Setter methods
+	/// @{
+	void setExpressionArena(const std::shared_ptr<ExpressionArena>& expressionArena);
 	/// @}
 
 	/// @name Removing methods
@@ -90,11 +104,14 @@ public:
 		}
 		_rules.erase(itr, _rules.end());
 	}
+	std::vector<std::shared_ptr<Rule>> detachRules(std::size_t first, std::size_t last);
+	void detachImports(std::size_t first);
 	/// @}
 
 	/// @name Symbol methods
 	/// @{
 	std::shared_ptr<Symbol> findSymbol(const std::string& name) const;
+	Rule* findRule(const std::string& name) const;
 	/// @}
 
 	/// @name Detection methods
@@ -126,6 +143,8 @@ private:
 	Features _Features; ///< Determines which symbols are needed
 	std::vector<std::shared_ptr<Symbol>> _vtSymbols; ///< Virust Total symbols
 	std::vector<std::string> _deferredIncludes;
+	LiteralPool _literalPool; ///< Strings shared by the literals of tokens
+	std::shared_ptr<ExpressionArena> _expressionArena; ///< Arena of the expressions of conditions, @c nullptr if they are allocated on the heap
 };
 
 }
@@ -0,0 +1,81 @@
+/**
+ * @file include/yaramod/utils/binary_json.h
+ * @brief Declaration of class BinaryJson.
+ * @copyright (c) 2026 Avast Software, licensed under the MIT license
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace yaramod {
+
+/**
+ * Read-only view of JSON document which was compiled into compact binary form
+ * by scripts/json_to_array.py. It supports only strings, objects and arrays,
+ * which is everything module specifications consist of.
+ *
+ * Document consists of table of unique strings and array of 32-bit values.
+ * Every value has its kind stored in the upper two bits and the rest is either
+ * index into the string table or offset of the object or array in the value array.
+ * Object is stored as number of its items followed by pairs of key string index and value.
+ * Array is stored as number of its elements followed by the elements.
+ * The root of the document is always the object at offset 0.
+ */
+class BinaryJson
+{
+public:
+	/**
+	 * Tables of the compiled document. They are generated as static constant data.
+	 */
+	struct Data
+	{
+		const std::string_view* strings;
+		const std::uint32_t* values;
+	};
+
+	enum class Kind : std::uint32_t
+	{
+		String = 1,
+		Object = 2,
+		Array = 3
+	};
+
+	static constexpr std::uint32_t KindShift = 30;
+	static constexpr std::uint32_t IndexMask = (1u << KindShift) - 1;
+
+	/// @name Constructors
+	/// @{
+	explicit BinaryJson(const Data* data) : BinaryJson(data, static_cast<std::uint32_t>(Kind::Object) << KindShift) {}
+	BinaryJson(const Data* data, std::uint32_t value) : _data(data), _value(value) {}
+	/// @}
+
+	/// @name Detection methods
+	/// @{
+	bool isString() const { return _kind() == Kind::String; }
+	bool isObject() const { return _kind() == Kind::Object; }
+	bool isArray() const { return _kind() == Kind::Array; }
+	bool contains(std::string_view key) const;
+	/// @}
+
+	/// @name Getter methods
+	/// @{
+	std::string_view getString() const;
+	BinaryJson get(std::string_view key) const;
+	std::vector<BinaryJson> getElements() const;
+	std::vector<std::string_view> getKeys() const;
+	/// @}
+
+private:
+	Kind _kind() const { return static_cast<Kind>(_value >> KindShift); }
+	std::uint32_t _index() const { return _value & IndexMask; }
+	const std::uint32_t* _find(std::string_view key) const;
+
+	const Data* _data; ///< Tables of the document
+	std::uint32_t _value; ///< Encoded value this view points to
+};
+
+} // namespace yaramod
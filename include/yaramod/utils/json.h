@@ -8,6 +8,8 @@
 
 #include <json/json.hpp>
 
+#include "yaramod/utils/binary_json.h"
+
 namespace yaramod {
 
 nlohmann::json readJsonFile(const std::string& filePath);
@@ -19,4 +21,8 @@ std::string accessJsonString(const nlohmann::json& json, const std::string& key)
 std::vector<nlohmann::json> accessJsonArray(const nlohmann::json& json, const std::string& key);
 nlohmann::json accessJsonSubjson(const nlohmann::json& json, const std::string& key);
 
+std::string accessJsonString(const BinaryJson& json, const std::string& key);
+std::vector<BinaryJson> accessJsonArray(const BinaryJson& json, const std::string& key);
+BinaryJson accessJsonSubjson(const BinaryJson& json, const std::string& key);
+
 }
@@ -0,0 +1,66 @@
+/**
+ * @file src/utils/mapped_file.h
+ * @brief Declaration of class MappedFile.
+ * @copyright (c) 2026 Avast Software, licensed under the MIT license
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace yaramod {
+
+/**
+ * Read-only view of the whole file content. The file is mapped into memory
+ * so its content is never copied. If the file can't be mapped (for example
+ * because it is not a regular file), its content is read into memory instead.
+ */
+class MappedFile
+{
+public:
+	/// @name Constructors
+	/// @{
+	explicit MappedFile(const std::string& filePath);
+	MappedFile(const MappedFile&) = delete;
+	MappedFile(MappedFile&&) = delete;
+	/// @}
+
+	/// @name Destructor
+	/// @{
+	~MappedFile();
+	/// @}
+
+	/// @name Assignment
+	/// @{
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile& operator=(MappedFile&&) = delete;
+	/// @}
+
+	/// @name Getter methods
+	/// @{
+	std::string_view getContent() const { return _content; }
+	/// @}
+
+	/// @name Reading methods
+	/// @{
+	void prefault() const;
+	/// @}
+
+	/// @name Detection methods
+	/// @{
+	bool isOpen() const { return _open; }
+	bool isMapped() const { return _mapping != nullptr; }
+	/// @}
+
+private:
+	bool _map(const std::string& filePath);
+	bool _read(const std::string& filePath);
+
+	bool _open = false; ///< File was successfully opened
+	void* _mapping = nullptr; ///< Start of the mapped memory or @c nullptr if not mapped
+	std::string _buffer; ///< Content of the file if it couldn't be mapped
+	std::string_view _content; ///< Content of the file
+};
+
+} // namespace yaramod
@@ -72,6 +72,13 @@ private:
  * defaultHandler() and passing it the current expression together with results from visited child nodes.
  * Not every type of expression has defaultHandler() and you will get compilation error if you
  * try to call one if it does not exist.
+ *
+ * Chain of logical operations of the same kind such as `$a or $b or $c` is visited as nested
+ * binary operations by default, the same way it was parsed. Visitors which are constructed with
+ * flat chains visit the chain once as a single operation. Its default visit() then visits all
+ * operands of the chain (see BinaryOpExpression::getOperands) and keeps, replaces or deletes them
+ * the same way defaultHandler() would do it for the nested operations of the chain, without
+ * recursing once per operation or creating the nested operations.
  */
 class ModifyingVisitor : public Visitor
 {
@@ -172,12 +179,12 @@ public:
 
 	virtual VisitResult visit(AndExpression* expr) override
 	{
-		return _handleBinaryOperation(expr);
+		return _flatChains ? _handleLogicalOperation(expr) : _handleBinaryOperation(expr);
 	}
 
 	virtual VisitResult visit(OrExpression* expr) override
 	{
-		return _handleBinaryOperation(expr);
+		return _flatChains ? _handleLogicalOperation(expr) : _handleBinaryOperation(expr);
 	}
 
 	virtual VisitResult visit(LtExpression* expr) override
@@ -918,7 +925,12 @@ public:
 	}
 
 protected:
-	ModifyingVisitor() = default;
+	/**
+	 * Constructor.
+	 *
+	 * @param flatChains Whether to visit chains of logical operations as a single operation.
+	 */
+	ModifyingVisitor(bool flatChains = false) : _flatChains(flatChains) {}
 
 private:
 	template <typename T>
@@ -938,6 +950,78 @@ private:
 		auto rightOperand = expr->getRightOperand()->accept(this);
 		return defaultHandler(context, expr, leftOperand, rightOperand);
 	}
+
+	template <typename T>
+	VisitResult _handleLogicalOperation(T* expr)
+	{
+		if (!expr->getChain() && expr->getLeftOperand()->getKind() != expr->getKind())
+			return _handleBinaryOperation(expr);
+
+		TokenStreamContext context{expr};
+		auto chain = expr->copyChain();
+		auto count = chain->getOperandsCount();
+		std::vector<VisitResult> results;
+		results.reserve(count);
+		std::size_t keptCount = 0;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			results.push_back(chain->getOperand(i)->accept(this));
+			if (std::holds_alternative<Expression::Ptr>(results.back()))
+				++keptCount;
+		}
+
+		if (keptCount == 0)
+			return VisitAction::Delete;
+		else if (keptCount == 1)
+		{
+			// The only remaining operand replaces the whole chain
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				if (auto result = std::get_if<Expression::Ptr>(&results[i]))
+				{
+					auto output = YaraExpressionBuilder{*result ? *result : chain->getOperand(i)}.get();
+					cleanUpTokenStreams(context, output.get());
+					return output;
+				}
+			}
+		}
+
+		const auto& tokenStream = context.oldTokenStream();
+		std::shared_ptr<BinaryOpChain> kept;
+		bool modified = keptCount != count;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			const auto& operand = chain->getOperand(i);
+			auto result = std::get_if<Expression::Ptr>(&results[i]);
+			if (!result)
+			{
+				// Deleted operand is removed together with the operation symbol in front of it
+				if (kept)
+					tokenStream->erase(std::next(kept->getOperand(kept->getOperandsCount() - 1)->getLastTokenIt()), std::next(operand->getLastTokenIt()));
+				continue;
+			}
+
+			modified = modified || *result;
+			const auto& newOperand = *result ? *result : operand;
+			if (!kept)
+			{
+				// Deleted operands in front of the first remaining one are removed together with the operation symbols behind them
+				tokenStream->erase(std::next(context.oldBeforeFirst()), newOperand->getFirstTokenIt());
+				kept = std::make_shared<BinaryOpChain>(newOperand);
+			}
+			else
+			{
+				const auto& link = chain->getLink(i - 1);
+				kept->append(link.op, newOperand, link.linebreak, link.uid);
+			}
+		}
+
+		if (modified)
+			expr->setChain(std::move(kept));
+		return {};
+	}
+
+	bool _flatChains; ///< Chains of logical operations are visited as a single operation
 };
 
 } // namespace yaramod
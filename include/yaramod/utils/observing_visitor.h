@@ -19,6 +19,12 @@ namespace yaramod {
  * used to pass around information when collecting data, not directly for modification
  * of AST. If you implement all the logic of modification youself, you can do that but there
  * is no reason to do it on your own and not use ModifyingVisitor.
+ *
+ * Chain of logical operations of the same kind such as `$a or $b or $c` is visited as nested
+ * binary operations by default, the same way it was parsed. Visitors which are constructed
+ * with flat chains visit the chain once as a single operation with all its operands
+ * (see BinaryOpExpression::getOperands), so the chain neither recurses once per operation
+ * nor creates its nested operations.
  */
 class ObservingVisitor : public Visitor
 {
@@ -98,6 +104,13 @@ public:
 
 	virtual VisitResult visit(AndExpression* expr) override
 	{
+		if (_flatChains)
+		{
+			for (const auto& operand : expr->getOperands())
+				operand->accept(this);
+			return {};
+		}
+
 		expr->getLeftOperand()->accept(this);
 		expr->getRightOperand()->accept(this);
 		return {};
@@ -105,6 +118,13 @@ public:
 
 	virtual VisitResult visit(OrExpression* expr) override
 	{
+		if (_flatChains)
+		{
+			for (const auto& operand : expr->getOperands())
+				operand->accept(this);
+			return {};
+		}
+
 		expr->getLeftOperand()->accept(this);
 		expr->getRightOperand()->accept(this);
 		return {};
@@ -400,7 +420,15 @@ public:
 	/// @}
 
 protected:
-	ObservingVisitor() = default;
+	/**
+	 * Constructor.
+	 *
+	 * @param flatChains Whether to visit chains of logical operations as a single operation.
+	 */
+	ObservingVisitor(bool flatChains = false) : _flatChains(flatChains) {}
+
+private:
+	bool _flatChains; ///< Chains of logical operations are visited as a single operation
 };
 
 /**
@@ -0,0 +1,347 @@
+/**
+ * @file src/utils/pool_allocator.h
+ * @brief Declaration of class PoolAllocator.
+ * @copyright (c) 2026 Avast Software, licensed under the MIT license
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace yaramod {
+
+/**
+ * Process-wide pool of fixed-size memory blocks. Blocks are carved out of large chunks
+ * so that objects allocated one after another end up next to each other in the memory
+ * and a single allocation from the system serves thousands of them.
+ *
+ * Every thread allocates from its own free list so no locking is needed on the hot path.
+ * A block can be released by any thread, it is then cached by the releasing thread. The cache
+ * of each thread is bounded, blocks over the limit are spilled to the global free list and
+ * threads refill their caches from it in batches, so blocks allocated by one thread and released
+ * by another one flow back to the allocating thread. Free blocks of a finished thread are handed
+ * over to the global free list. Chunks whose all blocks are in the global free list can be
+ * returned to the system using releaseFreeChunks().
+ */
+template <std::size_t BlockSize>
+class BlockPool
+{
+	static_assert(BlockSize >= sizeof(void*), "Block has to be able to hold a pointer");
+
+	static constexpr std::size_t ChunkSize = 64 * 1024;
+	static constexpr std::size_t BlocksPerChunk = ChunkSize / BlockSize > 0 ? ChunkSize / BlockSize : 1;
+	static constexpr std::size_t BatchSize = BlocksPerChunk;
+	static constexpr std::size_t CacheLimit = 2 * BatchSize;
+
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	struct Global
+	{
+		std::mutex mutex;
+		std::vector<std::unique_ptr<unsigned char[]>> chunks;
+		FreeBlock* freeList = nullptr;
+		std::size_t allocatedBytes = 0;
+	};
+
+	struct ThreadCache
+	{
+		FreeBlock* freeList = nullptr;
+		std::size_t count = 0;
+		bool finished = false;
+	};
+
+	/**
+	 * Hands over free blocks of the finishing thread to the global free list. Blocks might still
+	 * be in use by other threads so they can't be freed. Since destructors of static objects can
+	 * still release blocks after this, the cache itself stays trivially destructible and any later
+	 * request goes directly to the global free list.
+	 */
+	struct ThreadCacheGuard
+	{
+		~ThreadCacheGuard()
+		{
+			auto& cache = threadCache();
+			cache.finished = true;
+			flush(cache);
+		}
+	};
+
+public:
+	/**
+	 * Allocates a single block.
+	 *
+	 * @return Pointer to the uninitialized block.
+	 */
+	static void* allocate()
+	{
+		auto& cache = threadCache();
+		if (!cache.freeList)
+		{
+			if (cache.finished)
+				return allocateGlobal();
+			refill(cache);
+		}
+
+		auto* block = cache.freeList;
+		cache.freeList = block->next;
+		--cache.count;
+		return block;
+	}
+
+	/**
+	 * Returns the block back to the pool.
+	 *
+	 * @param ptr Block returned by allocate().
+	 */
+	static void deallocate(void* ptr)
+	{
+		auto& cache = threadCache();
+		auto* block = static_cast<FreeBlock*>(ptr);
+		if (cache.finished)
+		{
+			auto& g = global();
+			std::lock_guard<std::mutex> lock(g.mutex);
+			block->next = g.freeList;
+			g.freeList = block;
+			return;
+		}
+
+		if (!cache.freeList)
+			registerThread();
+
+		block->next = cache.freeList;
+		cache.freeList = block;
+		if (++cache.count > CacheLimit)
+			spill(cache);
+	}
+
+	/**
+	 * Returns chunks whose all blocks are free back to the system. Free blocks cached
+	 * by the calling thread are handed over to the global free list first, blocks cached
+	 * by other threads keep their chunks alive.
+	 *
+	 * @return Number of bytes returned to the system.
+	 */
+	static std::size_t releaseFreeChunks()
+	{
+		auto& cache = threadCache();
+		flush(cache);
+
+		auto& g = global();
+		std::lock_guard<std::mutex> lock(g.mutex);
+
+		// Chunks sorted by their addresses together with the number of their free blocks
+		std::vector<std::pair<unsigned char*, std::size_t>> chunks;
+		chunks.reserve(g.chunks.size());
+		for (const auto& chunk : g.chunks)
+			chunks.emplace_back(chunk.get(), 0);
+		std::sort(chunks.begin(), chunks.end());
+
+		auto findChunk = [&](FreeBlock* block) {
+			auto address = reinterpret_cast<unsigned char*>(block);
+			auto itr = std::upper_bound(chunks.begin(), chunks.end(), address, [](unsigned char* a, const auto& chunk) {
+				return std::less<unsigned char*>{}(a, chunk.first);
+			});
+			return std::prev(itr);
+		};
+
+		for (auto* block = g.freeList; block; block = block->next)
+			++findChunk(block)->second;
+
+		// Unlink blocks of the chunks which are going to be released
+		FreeBlock** link = &g.freeList;
+		while (*link)
+		{
+			if (findChunk(*link)->second == BlocksPerChunk)
+				*link = (*link)->next;
+			else
+				link = &(*link)->next;
+		}
+
+		std::size_t kept = 0;
+		for (auto& chunk : g.chunks)
+		{
+			if (findChunk(reinterpret_cast<FreeBlock*>(chunk.get()))->second != BlocksPerChunk)
+				g.chunks[kept++] = std::move(chunk);
+		}
+
+		auto releasedBytes = (g.chunks.size() - kept) * BlocksPerChunk * BlockSize;
+		g.chunks.resize(kept);
+		g.allocatedBytes -= releasedBytes;
+		return releasedBytes;
+	}
+
+	/**
+	 * Returns the number of bytes the pool has requested from the system.
+	 *
+	 * @return Size of all chunks in bytes.
+	 */
+	static std::size_t allocatedBytes()
+	{
+		auto& g = global();
+		std::lock_guard<std::mutex> lock(g.mutex);
+		return g.allocatedBytes;
+	}
+
+private:
+	static Global& global()
+	{
+		// Intentionally never destroyed because blocks can be released by destructors of other static objects
+		static auto* instance = new Global();
+		return *instance;
+	}
+
+	static ThreadCache& threadCache()
+	{
+		static thread_local ThreadCache cache;
+		return cache;
+	}
+
+	static void registerThread()
+	{
+		static thread_local ThreadCacheGuard guard;
+		(void)guard;
+	}
+
+	static void refill(ThreadCache& cache)
+	{
+		registerThread();
+
+		auto& g = global();
+		std::lock_guard<std::mutex> lock(g.mutex);
+		if (!g.freeList)
+			newChunk(g);
+
+		// Take at most one batch so the rest stays available to other threads
+		auto* last = g.freeList;
+		std::size_t count = 1;
+		for (; count < BatchSize && last->next; ++count)
+			last = last->next;
+
+		cache.freeList = g.freeList;
+		cache.count = count;
+		g.freeList = last->next;
+		last->next = nullptr;
+	}
+
+	static void spill(ThreadCache& cache)
+	{
+		// Keep one batch in the cache and hand over the rest
+		auto* last = cache.freeList;
+		for (std::size_t i = 1; i < BatchSize; ++i)
+			last = last->next;
+
+		auto* spilled = last->next;
+		last->next = nullptr;
+		auto* spilledLast = spilled;
+		while (spilledLast->next)
+			spilledLast = spilledLast->next;
+		cache.count = BatchSize;
+
+		auto& g = global();
+		std::lock_guard<std::mutex> lock(g.mutex);
+		spilledLast->next = g.freeList;
+		g.freeList = spilled;
+	}
+
+	static void flush(ThreadCache& cache)
+	{
+		if (!cache.freeList)
+			return;
+
+		auto* last = cache.freeList;
+		while (last->next)
+			last = last->next;
+
+		auto& g = global();
+		std::lock_guard<std::mutex> lock(g.mutex);
+		last->next = g.freeList;
+		g.freeList = cache.freeList;
+		cache.freeList = nullptr;
+		cache.count = 0;
+	}
+
+	static void* allocateGlobal()
+	{
+		auto& g = global();
+		std::lock_guard<std::mutex> lock(g.mutex);
+		if (!g.freeList)
+			newChunk(g);
+
+		auto* block = g.freeList;
+		g.freeList = block->next;
+		return block;
+	}
+
+	static void newChunk(Global& g)
+	{
+		auto chunk = std::make_unique<unsigned char[]>(BlocksPerChunk * BlockSize);
+		auto* begin = chunk.get();
+		// Link the blocks in the order of addresses so the consecutive allocations are adjacent
+		for (std::size_t i = 0; i < BlocksPerChunk; ++i)
+		{
+			auto* block = reinterpret_cast<FreeBlock*>(begin + i * BlockSize);
+			block->next = i + 1 < BlocksPerChunk ? reinterpret_cast<FreeBlock*>(begin + (i + 1) * BlockSize) : nullptr;
+		}
+
+		g.freeList = reinterpret_cast<FreeBlock*>(begin);
+		g.chunks.push_back(std::move(chunk));
+		g.allocatedBytes += BlocksPerChunk * BlockSize;
+	}
+};
+
+/**
+ * Standard allocator which allocates single objects out of BlockPool of the matching size.
+ * Allocations of arrays or of overaligned types are passed to the global operator new.
+ *
+ * All instances compare equal regardless of their type so containers using this allocator
+ * can freely splice their elements between each other.
+ */
+template <typename T>
+class PoolAllocator
+{
+public:
+	using value_type = T;
+
+	static constexpr std::size_t BlockAlignment = alignof(std::max_align_t);
+	static constexpr std::size_t BlockSize = (sizeof(T) + BlockAlignment - 1) / BlockAlignment * BlockAlignment;
+	static constexpr bool UsesPool = alignof(T) <= BlockAlignment;
+
+	PoolAllocator() noexcept = default;
+	template <typename U> PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+	T* allocate(std::size_t n)
+	{
+		if constexpr (UsesPool)
+		{
+			if (n == 1)
+				return static_cast<T*>(BlockPool<BlockSize>::allocate());
+		}
+		return std::allocator<T>{}.allocate(n);
+	}
+
+	void deallocate(T* ptr, std::size_t n) noexcept
+	{
+		if constexpr (UsesPool)
+		{
+			if (n == 1)
+				return BlockPool<BlockSize>::deallocate(ptr);
+		}
+		std::allocator<T>{}.deallocate(ptr, n);
+	}
+
+	template <typename U> bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+	template <typename U> bool operator!=(const PoolAllocator<U>&) const noexcept { return false; }
+};
+
+} // namespace yaramod
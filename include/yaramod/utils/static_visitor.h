@@ -0,0 +1,295 @@
+/**
+ * @file src/utils/static_visitor.h
+ * @brief Declaration of StaticObservingVisitor class.
+ * @copyright (c) 2026 Avast Software, licensed under the MIT license
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "yaramod/types/expressions.h"
+
+namespace yaramod {
+
+/**
+ * Observing visitor of condition expression with dispatch resolved at compile time.
+ * Derived class is passed as the template parameter and it hides the visit() methods
+ * of the expressions it is interested in. Visit methods are not virtual and return
+ * no VisitResult, so the whole traversal can be inlined into the derived class.
+ *
+ * Each visit() method returns whether the traversal should continue. Returning @c false
+ * terminates the whole traversal and observe() then returns @c false as well.
+ * Default visit() methods schedule all subexpressions to be observed in their order
+ * once the visit() method returns, derived class can call them to continue into
+ * subexpressions of the expressions it visits. Scheduled expressions are kept on
+ * an explicit stack, so even very deep conditions are traversed without recursion.
+ * Derived class which needs to process subexpressions before its visit() method
+ * returns can observe() them directly.
+ *
+ * For example:
+ * @code
+ * class FunctionCallFinder : public StaticObservingVisitor<FunctionCallFinder>
+ * {
+ * public:
+ *   using StaticObservingVisitor<FunctionCallFinder>::visit;
+ *
+ *   bool visit(FunctionCallExpression* expr)
+ *   {
+ *     found = expr;
+ *     return false;
+ *   }
+ *
+ *   FunctionCallExpression* found = nullptr;
+ * };
+ * @endcode
+ *
+ * Chains of logical operations of the same kind such as `$a or $b or $c` are visited as a single
+ * operation with all operands of the chain regardless of whether their nested operations
+ * were already created, same as in ObservingVisitor and ModifyingVisitor constructed with flat chains
+ * (see BinaryOpExpression::getOperands).
+ *
+ * Expressions are dispatched by their kind, so expressions defined outside of yaramod
+ * which have no kind of their own are visited as the yaramod expression they derive from.
+ * Expressions with unknown kind are skipped together with their subexpressions.
+ */
+template <typename Derived>
+class StaticObservingVisitor
+{
+public:
+	/**
+	 * Observes the specified expression and all expressions scheduled by its visit.
+	 *
+	 * @return @c false if the traversal was terminated, otherwise @c true.
+	 */
+	bool observe(const Expression::Ptr& expr)
+	{
+		return observe(expr.get());
+	}
+
+	bool observe(Expression* expr)
+	{
+		auto base = _scheduled.size();
+		_scheduled.push_back(expr);
+		while (_scheduled.size() > base)
+		{
+			auto* next = _scheduled.back();
+			_scheduled.pop_back();
+			if (!dispatch(next))
+			{
+				_scheduled.resize(base);
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/// @name Visit methods
+	/// @{
+	bool visit(StringExpression*) { return true; }
+	bool visit(StringWildcardExpression*) { return true; }
+	bool visit(StringAtExpression* expr) { return schedule(expr->getAtExpression()); }
+	bool visit(StringInRangeExpression* expr) { return schedule(expr->getRangeExpression()); }
+	bool visit(StringCountExpression*) { return true; }
+	bool visit(StringOffsetExpression* expr) { return schedule(expr->getIndexExpression()); }
+	bool visit(StringLengthExpression* expr) { return schedule(expr->getIndexExpression()); }
+
+	bool visit(NotExpression* expr) { return schedule(expr->getOperand()); }
+	bool visit(PercentualExpression* expr) { return schedule(expr->getOperand()); }
+	bool visit(DefinedExpression* expr) { return schedule(expr->getOperand()); }
+	bool visit(UnaryMinusExpression* expr) { return schedule(expr->getOperand()); }
+	bool visit(BitwiseNotExpression* expr) { return schedule(expr->getOperand()); }
+
+	bool visit(AndExpression* expr) { return scheduleLogicalOp(expr); }
+	bool visit(OrExpression* expr) { return scheduleLogicalOp(expr); }
+	bool visit(LtExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(GtExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(LeExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(GeExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(EqExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(NeqExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(ContainsExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(IcontainsExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(MatchesExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(StartsWithExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(IstartsWithExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(EndsWithExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(IendsWithExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(IequalsExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(PlusExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(MinusExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(MultiplyExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(DivideExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(ModuloExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(BitwiseXorExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(BitwiseAndExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(BitwiseOrExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(ShiftLeftExpression* expr) { return scheduleBinaryOp(expr); }
+	bool visit(ShiftRightExpression* expr) { return scheduleBinaryOp(expr); }
+
+	bool visit(ForDictExpression* expr) { return schedule(expr->getVariable(), expr->getIterable(), expr->getBody()); }
+	bool visit(ForArrayExpression* expr) { return schedule(expr->getVariable(), expr->getIterable(), expr->getBody()); }
+	bool visit(ForStringExpression* expr) { return schedule(expr->getVariable(), expr->getIterable(), expr->getBody()); }
+	bool visit(OfExpression* expr) { return schedule(expr->getVariable(), expr->getIterable(), expr->getRangeExpression()); }
+
+	bool visit(IterableExpression* expr) { return scheduleAll(expr->getElements()); }
+	bool visit(SetExpression* expr) { return scheduleAll(expr->getElements()); }
+	bool visit(RangeExpression* expr) { return schedule(expr->getLow(), expr->getHigh()); }
+
+	bool visit(IdExpression*) { return true; }
+	bool visit(IdWildcardExpression*) { return true; }
+	bool visit(StructAccessExpression* expr) { return schedule(expr->getStructure()); }
+	bool visit(ArrayAccessExpression* expr) { return schedule(expr->getArray(), expr->getAccessor()); }
+	bool visit(FunctionCallExpression* expr) { return scheduleAll(expr->getArguments()) && schedule(expr->getFunction()); }
+
+	bool visit(BoolLiteralExpression*) { return true; }
+	bool visit(StringLiteralExpression*) { return true; }
+	bool visit(IntLiteralExpression*) { return true; }
+	bool visit(DoubleLiteralExpression*) { return true; }
+	bool visit(FilesizeExpression*) { return true; }
+	bool visit(EntrypointExpression*) { return true; }
+	bool visit(AllExpression*) { return true; }
+	bool visit(AnyExpression*) { return true; }
+	bool visit(NoneExpression*) { return true; }
+	bool visit(ThemExpression*) { return true; }
+
+	bool visit(ParenthesesExpression* expr) { return schedule(expr->getEnclosedExpression()); }
+	bool visit(IntFunctionExpression* expr) { return schedule(expr->getArgument()); }
+	bool visit(RegexpExpression*) { return true; }
+	bool visit(VariableDefExpression* expr) { return schedule(expr->getExpression()); }
+	bool visit(WithExpression* expr) { return schedule(expr->getBody()) && scheduleAll(expr->getVariables()); }
+	/// @}
+
+protected:
+	StaticObservingVisitor() = default;
+
+private:
+	Derived& derived() { return static_cast<Derived&>(*this); }
+
+	bool dispatch(Expression* expr)
+	{
+		switch (expr->getKind())
+		{
+			case ExpressionKind::String: return derived().visit(static_cast<StringExpression*>(expr));
+			case ExpressionKind::StringWildcard: return derived().visit(static_cast<StringWildcardExpression*>(expr));
+			case ExpressionKind::StringAt: return derived().visit(static_cast<StringAtExpression*>(expr));
+			case ExpressionKind::StringInRange: return derived().visit(static_cast<StringInRangeExpression*>(expr));
+			case ExpressionKind::StringCount: return derived().visit(static_cast<StringCountExpression*>(expr));
+			case ExpressionKind::StringOffset: return derived().visit(static_cast<StringOffsetExpression*>(expr));
+			case ExpressionKind::StringLength: return derived().visit(static_cast<StringLengthExpression*>(expr));
+			case ExpressionKind::Not: return derived().visit(static_cast<NotExpression*>(expr));
+			case ExpressionKind::Percentual: return derived().visit(static_cast<PercentualExpression*>(expr));
+			case ExpressionKind::Defined: return derived().visit(static_cast<DefinedExpression*>(expr));
+			case ExpressionKind::UnaryMinus: return derived().visit(static_cast<UnaryMinusExpression*>(expr));
+			case ExpressionKind::BitwiseNot: return derived().visit(static_cast<BitwiseNotExpression*>(expr));
+			case ExpressionKind::And: return derived().visit(static_cast<AndExpression*>(expr));
+			case ExpressionKind::Or: return derived().visit(static_cast<OrExpression*>(expr));
+			case ExpressionKind::Lt: return derived().visit(static_cast<LtExpression*>(expr));
+			case ExpressionKind::Gt: return derived().visit(static_cast<GtExpression*>(expr));
+			case ExpressionKind::Le: return derived().visit(static_cast<LeExpression*>(expr));
+			case ExpressionKind::Ge: return derived().visit(static_cast<GeExpression*>(expr));
+			case ExpressionKind::Eq: return derived().visit(static_cast<EqExpression*>(expr));
+			case ExpressionKind::Neq: return derived().visit(static_cast<NeqExpression*>(expr));
+			case ExpressionKind::Contains: return derived().visit(static_cast<ContainsExpression*>(expr));
+			case ExpressionKind::Icontains: return derived().visit(static_cast<IcontainsExpression*>(expr));
+			case ExpressionKind::Matches: return derived().visit(static_cast<MatchesExpression*>(expr));
+			case ExpressionKind::StartsWith: return derived().visit(static_cast<StartsWithExpression*>(expr));
+			case ExpressionKind::IstartsWith: return derived().visit(static_cast<IstartsWithExpression*>(expr));
+			case ExpressionKind::EndsWith: return derived().visit(static_cast<EndsWithExpression*>(expr));
+			case ExpressionKind::IendsWith: return derived().visit(static_cast<IendsWithExpression*>(expr));
+			case ExpressionKind::Iequals: return derived().visit(static_cast<IequalsExpression*>(expr));
+			case ExpressionKind::Plus: return derived().visit(static_cast<PlusExpression*>(expr));
+			case ExpressionKind::Minus: return derived().visit(static_cast<MinusExpression*>(expr));
+			case ExpressionKind::Multiply: return derived().visit(static_cast<MultiplyExpression*>(expr));
+			case ExpressionKind::Divide: return derived().visit(static_cast<DivideExpression*>(expr));
+			case ExpressionKind::Modulo: return derived().visit(static_cast<ModuloExpression*>(expr));
+			case ExpressionKind::BitwiseXor: return derived().visit(static_cast<BitwiseXorExpression*>(expr));
+			case ExpressionKind::BitwiseAnd: return derived().visit(static_cast<BitwiseAndExpression*>(expr));
+			case ExpressionKind::BitwiseOr: return derived().visit(static_cast<BitwiseOrExpression*>(expr));
+			case ExpressionKind::ShiftLeft: return derived().visit(static_cast<ShiftLeftExpression*>(expr));
+			case ExpressionKind::ShiftRight: return derived().visit(static_cast<ShiftRightExpression*>(expr));
+			case ExpressionKind::ForDict: return derived().visit(static_cast<ForDictExpression*>(expr));
+			case ExpressionKind::ForArray: return derived().visit(static_cast<ForArrayExpression*>(expr));
+			case ExpressionKind::ForString: return derived().visit(static_cast<ForStringExpression*>(expr));
+			case ExpressionKind::Of: return derived().visit(static_cast<OfExpression*>(expr));
+			case ExpressionKind::Iterable: return derived().visit(static_cast<IterableExpression*>(expr));
+			case ExpressionKind::Set: return derived().visit(static_cast<SetExpression*>(expr));
+			case ExpressionKind::Range: return derived().visit(static_cast<RangeExpression*>(expr));
+			case ExpressionKind::Id: return derived().visit(static_cast<IdExpression*>(expr));
+			case ExpressionKind::StructAccess: return derived().visit(static_cast<StructAccessExpression*>(expr));
+			case ExpressionKind::ArrayAccess: return derived().visit(static_cast<ArrayAccessExpression*>(expr));
+			case ExpressionKind::FunctionCall: return derived().visit(static_cast<FunctionCallExpression*>(expr));
+			case ExpressionKind::IdWildcard: return derived().visit(static_cast<IdWildcardExpression*>(expr));
+			case ExpressionKind::BoolLiteral: return derived().visit(static_cast<BoolLiteralExpression*>(expr));
+			case ExpressionKind::StringLiteral: return derived().visit(static_cast<StringLiteralExpression*>(expr));
+			case ExpressionKind::IntLiteral: return derived().visit(static_cast<IntLiteralExpression*>(expr));
+			case ExpressionKind::DoubleLiteral: return derived().visit(static_cast<DoubleLiteralExpression*>(expr));
+			case ExpressionKind::Filesize: return derived().visit(static_cast<FilesizeExpression*>(expr));
+			case ExpressionKind::Entrypoint: return derived().visit(static_cast<EntrypointExpression*>(expr));
+			case ExpressionKind::All: return derived().visit(static_cast<AllExpression*>(expr));
+			case ExpressionKind::Any: return derived().visit(static_cast<AnyExpression*>(expr));
+			case ExpressionKind::None: return derived().visit(static_cast<NoneExpression*>(expr));
+			case ExpressionKind::Them: return derived().visit(static_cast<ThemExpression*>(expr));
+			case ExpressionKind::Parentheses: return derived().visit(static_cast<ParenthesesExpression*>(expr));
+			case ExpressionKind::IntFunction: return derived().visit(static_cast<IntFunctionExpression*>(expr));
+			case ExpressionKind::Regexp: return derived().visit(static_cast<RegexpExpression*>(expr));
+			case ExpressionKind::VariableDef: return derived().visit(static_cast<VariableDefExpression*>(expr));
+			case ExpressionKind::With: return derived().visit(static_cast<WithExpression*>(expr));
+			case ExpressionKind::Unknown: return true;
+		}
+
+		return true;
+	}
+
+	/**
+	 * Schedules the subexpressions to be observed in the given order.
+	 * Missing optional subexpressions are skipped.
+	 */
+	template <typename... ExpPtrs>
+	bool schedule(const ExpPtrs&... exprs)
+	{
+		// Stack is popped from the back, so the first subexpression is pushed last
+		Expression* ordered[] = { exprs.get()... };
+		for (auto i = sizeof...(ExpPtrs); i > 0; --i)
+		{
+			if (ordered[i - 1])
+				_scheduled.push_back(ordered[i - 1]);
+		}
+		return true;
+	}
+
+	bool scheduleBinaryOp(BinaryOpExpression* expr) { return schedule(expr->getLeftOperand(), expr->getRightOperand()); }
+
+	/**
+	 * Schedules all operands of the chain of logical operations at once without
+	 * creating the nested operations of the chain.
+	 */
+	bool scheduleLogicalOp(BinaryOpExpression* expr)
+	{
+		if (const auto* chain = expr->getChain())
+		{
+			for (auto i = expr->getChainOperandsCount(); i > 0; --i)
+				_scheduled.push_back(chain->getOperand(i - 1).get());
+			return true;
+		}
+		else if (expr->getLeftOperand()->getKind() != expr->getKind())
+			return scheduleBinaryOp(expr);
+
+		return scheduleAll(expr->getOperands());
+	}
+
+	/**
+	 * Schedules all expressions of the container to be observed in their order.
+	 */
+	bool scheduleAll(const std::vector<Expression::Ptr>& exprs)
+	{
+		for (auto itr = exprs.rbegin(), end = exprs.rend(); itr != end; ++itr)
+			_scheduled.push_back(itr->get());
+		return true;
+	}
+
+	std::vector<Expression*> _scheduled; ///< Expressions waiting to be observed, the last one is observed first
+};
+
+} // namespace yaramod
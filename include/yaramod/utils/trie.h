@@ -13,6 +13,8 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <type_traits>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -166,7 +168,7 @@ public:
 	friend void swap(Trie<T>& t1, Trie<T>& t2)
 	{
 		std::swap(t1._nodes, t2._nodes);
-		std::swap(t1._values, t1._values);
+		std::swap(t1._values, t2._values);
 	}
 
 	/// @name Setter operations
@@ -256,8 +258,8 @@ public:
 					return !keyNode.second->hasAnySubnodeWithValue();
 				});
 
-		// We should delete from the first node so we just clear the whole trie
-		if (delStartItr == path.begin())
+		// No values are left so we just clear the whole trie
+		if (_values.empty())
 		{
 			clear();
 			return true;
@@ -267,8 +269,9 @@ public:
 		if (delStartItr == path.end())
 			return true;
 
-		// Move one node back and remove reference to the first node which is deleted
-		(delStartItr - 1)->second->removeSubnode(delStartItr->first);
+		// Move one node back (to the root if the first node is deleted) and remove reference to the first node which is deleted
+		auto parentNode = delStartItr == path.begin() ? _nodes.front().get() : (delStartItr - 1)->second;
+		parentNode->removeSubnode(delStartItr->first);
 
 		// Filter out the nodes which should be deleted
 		std::unordered_set<NodeType*> nodesToDelete;
@@ -390,6 +393,41 @@ public:
 	}
 	/// @}
 
+	/**
+	 * Returns the trie with the same keys whose values are obtained by applying
+	 * the given function to the values of this trie. The function is applied
+	 * in the order of insertion which is also preserved in the new trie.
+	 *
+	 * @param func Function to apply.
+	 *
+	 * @return New trie.
+	 */
+	template <typename F>
+	auto transform(F&& func) const
+	{
+		Trie<std::decay_t<std::invoke_result_t<F, const ValueType&>>> result;
+		if (_nodes.empty())
+			return result;
+
+		std::unordered_map<const ValueType*, std::string> keys;
+		std::vector<std::pair<const NodeType*, std::string>> nodes = {{_nodes.front().get(), std::string{}}};
+		while (!nodes.empty())
+		{
+			auto [node, key] = std::move(nodes.back());
+			nodes.pop_back();
+
+			if (node->getValue().has_value())
+				keys.emplace(&node->getValue().value(), key);
+
+			for (auto& [ch, subnode] : node->getSubnodes())
+				nodes.emplace_back(subnode, key + ch);
+		}
+
+		for (auto valuePtr : _values)
+			result.insert(keys.at(valuePtr), func(*valuePtr));
+		return result;
+	}
+
 private:
 	const NodeType* _getNodeOfPrefix(const std::string& key) const
 	{
@@ -19,6 +19,8 @@
 #define YARA_SYNTAX_VERSION "x-0.12.0"
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "yaramod/builder/yara_file_builder.h"
 #include "yaramod/parser/parser_driver.h"
@@ -26,6 +28,18 @@
 
 namespace yaramod {
 
+/**
+ * Result of parsing of a single file by Yaramod::parseFiles.
+ */
+struct ParseResult
+{
+	std::string filePath; ///< Path to the file
+	std::unique_ptr<YaraFile> yaraFile; ///< Parsed file, @c nullptr if parsing failed
+	std::string error; ///< Description of the error if parsing failed
+	std::vector<ParserError> errors; ///< Errors the parser recovered from if error recovery is turned on
+	ParserProfile profile; ///< Profile of the parsing if profiling is turned on
+};
+
 class Yaramod
 {
 public:
@@ -35,9 +49,10 @@ public:
 	 * @param features determines iff we want to use aditional Avast-specific symbols or VirusTotal-specific symbols in the imported modules
 	 * @param moduleDirectory determines a directory for additional YARA modules to be added
 	 */
-	Yaramod(Features features = Features::AllCurrent, const std::string& moduleDirectory = "") : _driver(features, moduleDirectory)	{}
+	Yaramod(Features features = Features::AllCurrent, const std::string& moduleDirectory = "")
+		: _features(features), _moduleDirectory(moduleDirectory), _driver(features, moduleDirectory) {}
 	/**
-	 * Parses file at given path.
+	 * Parses file at given path. The file is mapped into memory and parsed without being copied.
 	 *
 	 * @param filePath Path to the file.
 	 * @param parserMode Parsing mode.
@@ -58,6 +73,149 @@ public:
 	 * @return Valid @c YaraFile instance if parsing succeeded, otherwise @c nullptr.
 	 */
 	std::unique_ptr<YaraFile> parseStream(std::istream& inputStream, ParserMode parserMode = ParserMode::Regular);
+	/**
+	 * Parses input in memory without copying it.
+	 *
+	 * @param input Content to parse.
+	 * @param parserMode Parsing mode.
+	 *   - Regular -- regular YARA parser
+	 *   - IncludeGuarded -- protection against inclusion of the same file multiple times
+	 *
+	 * @return Valid @c YaraFile instance if parsing succeeded, otherwise @c nullptr.
+	 */
+	std::unique_ptr<YaraFile> parseString(std::string_view input, ParserMode parserMode = ParserMode::Regular);
+	/**
+	 * Parses file at given path rule by rule. Every parsed rule is handed over to the callback
+	 * together with the file parsed so far, which contains only imports. Rules which are not kept
+	 * by the callback are released immediately so even very large files can be parsed with
+	 * memory needed only for the largest rule.
+	 *
+	 * @param filePath Path to the file.
+	 * @param onRule Callback receiving the parsed rules.
+	 * @param parserMode Parsing mode.
+	 *   - Regular -- regular YARA parser
+	 *   - IncludeGuarded -- protection against inclusion of the same file multiple times
+	 *
+	 * @return @c true if parsing succeeded, otherwise @c false.
+	 */
+	bool parseFile(const std::string& filePath, const ParserDriver::RuleCallback& onRule, ParserMode parserMode = ParserMode::Regular);
+	/**
+	 * Parses input stream rule by rule. Every parsed rule is handed over to the callback
+	 * together with the file parsed so far, which contains only imports.
+	 *
+	 * @param inputStream Input stream.
+	 * @param onRule Callback receiving the parsed rules.
+	 * @param parserMode Parsing mode.
+	 *   - Regular -- regular YARA parser
+	 *   - IncludeGuarded -- protection against inclusion of the same file multiple times
+	 *
+	 * @return @c true if parsing succeeded, otherwise @c false.
+	 */
+	bool parseStream(std::istream& inputStream, const ParserDriver::RuleCallback& onRule, ParserMode parserMode = ParserMode::Regular);
+	/**
+	 * Parses input in memory rule by rule. Every parsed rule is handed over to the callback
+	 * together with the file parsed so far, which contains only imports.
+	 *
+	 * @param input Content to parse.
+	 * @param onRule Callback receiving the parsed rules.
+	 * @param parserMode Parsing mode.
+	 *   - Regular -- regular YARA parser
+	 *   - IncludeGuarded -- protection against inclusion of the same file multiple times
+	 *
+	 * @return @c true if parsing succeeded, otherwise @c false.
+	 */
+	bool parseString(std::string_view input, const ParserDriver::RuleCallback& onRule, ParserMode parserMode = ParserMode::Regular);
+	/**
+	 * Parses the changed input of already parsed file again. Only the rules touched by the changes
+	 * are parsed again, the rest of the file is kept. The whole input is parsed if the changes can't
+	 * be handled this way. The file is left as it was if the parsing fails.
+	 *
+	 * @param file File parsed from the previous content of the input.
+	 * @param input New content of the input.
+	 * @param changes Changed ranges of the new content.
+	 * @param parserMode Parsing mode.
+	 *   - Regular -- regular YARA parser
+	 *   - IncludeGuarded -- protection against inclusion of the same file multiple times
+	 *
+	 * @return How the input was parsed, @c ReparseResult::Error if parsing failed.
+	 */
+	ReparseResult reparse(YaraFile& file, std::string_view input, const std::vector<InputChange>& changes, ParserMode parserMode = ParserMode::Regular);
+	/**
+	 * Parses independent files concurrently. Every thread parses files with its own driver
+	 * which is kept for later calls, all drivers share the grammar and the module pool.
+	 * The files are distributed among the threads dynamically so threads which parse
+	 * small files take more of them.
+	 * Errors in one file don't stop parsing of the others. If a thread can't be started,
+	 * the threads already started are joined and the error of starting it is thrown.
+	 *
+	 * @param filePaths Paths to the files.
+	 * @param threads Number of threads to use, 0 means the number of hardware threads.
+	 * @param parserMode Parsing mode.
+	 *   - Regular -- regular YARA parser
+	 *   - IncludeGuarded -- protection against inclusion of the same file multiple times
+	 *
+	 * @return Results in the same order as @p filePaths.
+	 */
+	std::vector<ParseResult> parseFiles(const std::vector<std::string>& filePaths, std::size_t threads = 0, ParserMode parserMode = ParserMode::Regular);
+
+	/**
+	 * Sets the cache of parsed include files used by all parsing methods. Included files
+	 * which are found in the cache with the same content are not parsed again.
+	 *
+	 * @param includeCache Cache of parsed includes, @c nullptr disables caching.
+	 */
+	void setIncludeCache(const std::shared_ptr<IncludeCache>& includeCache);
+
+	/**
+	 * Sets the number of threads which read included files ahead of the parser. Tokenization
+	 * and parsing stay in the order of the includes so the results don't change.
+	 *
+	 * @param threads Number of threads, 0 disables prefetching.
+	 */
+	void setIncludePrefetchThreads(std::size_t threads);
+
+	/**
+	 * Turns the error recovery of all parsing methods on or off. When it is on, parsing
+	 * doesn't stop at the first error. Rules with errors are left out of the parsed file
+	 * and the errors are available through getErrors.
+	 *
+	 * @param errorRecovery @c true to recover from errors.
+	 */
+	void setErrorRecovery(bool errorRecovery);
+
+	/**
+	 * Returns the errors the last parsing recovered from.
+	 *
+	 * @return Errors in the order they occurred.
+	 */
+	const std::vector<ParserError>& getErrors() const;
+
+	/**
+	 * Turns the profiling of all parsing methods on or off. When it is on, every parsing
+	 * measures the time spent in its phases and counts the processed items.
+	 *
+	 * @param profiling @c true to measure the parsing.
+	 */
+	void setProfiling(bool profiling);
+
+	/**
+	 * Returns the profile of the last parsing. Profiles of the files parsed by parseFiles
+	 * are in their results.
+	 *
+	 * @return Profile of the last parsing.
+	 */
+	const ParserProfile& getProfile() const;
+
+	/**
+	 * Turns the arena allocation of expressions of all parsing methods on or off. When it is on,
+	 * expressions of conditions are allocated in the arena of the parsed file instead of the heap.
+	 * It reduces only the number of allocations, expressions stay reference counted as before.
+	 * The memory of the arena is released only after the last expression allocated in it, so
+	 * a single expression kept after its file is destroyed keeps all memory of the arena alive.
+	 *
+	 * @param arenaAllocation @c true to allocate expressions in arenas.
+	 */
+	void setArenaAllocation(bool arenaAllocation);
 
 	const YaraFile& getParsedFile() const;
 
@@ -69,7 +227,15 @@ public:
 	std::map<std::string, Module*> getModules() const;
 
 private:
+	Features _features; ///< Features of the drivers
+	std::string _moduleDirectory; ///< Directory with additional modules
 	ParserDriver _driver;
+	std::vector<std::unique_ptr<ParserDriver>> _workerDrivers; ///< Drivers of threads used by parseFiles
+	std::shared_ptr<IncludeCache> _includeCache; ///< Cache of parsed includes shared by all drivers
+	std::size_t _includePrefetchThreads = 0; ///< Number of threads prefetching includes of every driver
+	bool _errorRecovery = false; ///< Drivers recover from errors
+	bool _profiling = false; ///< Drivers measure the parsing
+	bool _arenaAllocation = false; ///< Drivers allocate expressions in arenas
 };
 
 }
@@ -11,17 +11,75 @@ def chunked(seq, chunk_size):
         i += chunk_size
 
 
-def escapeString(s):
+class BinaryJson:
+    """
+    Compiles JSON document into the binary form read by yaramod::BinaryJson.
+    Unique strings are stored in the string table and the structure of the
+    document in the array of 32-bit values. See include/yaramod/utils/binary_json.h.
+    """
+
+    KIND_SHIFT = 30
+    KIND_STRING = 1
+    KIND_OBJECT = 2
+    KIND_ARRAY = 3
+
+    def __init__(self, data):
+        self.strings = []
+        self.string_indices = {}
+        self.values = []
+        if not isinstance(data, dict):
+            raise ValueError("Root of the module JSON must be an object")
+        self._encode(data)
+
+    def _string(self, s):
+        if s not in self.string_indices:
+            self.string_indices[s] = len(self.strings)
+            self.strings.append(s)
+        return self.string_indices[s]
+
+    def _encode(self, value):
+        if isinstance(value, str):
+            return (self.KIND_STRING << self.KIND_SHIFT) | self._string(value)
+        elif isinstance(value, dict):
+            offset = len(self.values)
+            self.values.append(len(value))
+            self.values.extend([0] * (2 * len(value)))
+            for i, (key, item) in enumerate(value.items()):
+                self.values[offset + 1 + 2 * i] = self._string(key)
+                self.values[offset + 2 + 2 * i] = self._encode(item)
+            return (self.KIND_OBJECT << self.KIND_SHIFT) | offset
+        elif isinstance(value, list):
+            offset = len(self.values)
+            self.values.append(len(value))
+            self.values.extend([0] * len(value))
+            for i, item in enumerate(value):
+                self.values[offset + 1 + i] = self._encode(item)
+            return (self.KIND_ARRAY << self.KIND_SHIFT) | offset
+        raise ValueError(f"Unsupported JSON value '{value}' in module specification")
+
+    def strings_str(self):
+        result = []
+        for s in self.strings:
+            data = s.encode("utf-8")
+            result.append(f"        std::string_view{{\"{escapeBytes(data)}\", {len(data)}}}")
+        return ',\n'.join(result)
+
+    def values_str(self):
+        return ',\n'.join(f"        {', '.join(str(v) for v in chunk)}" for chunk in chunked(self.values, 16))
+
+
+def escapeBytes(data):
     result = ""
-    for c in s:
-        if c == "\"":
+    for c in data:
+        if c == ord("\""):
             result += "\\\""
-        elif c == "\\":
+        elif c == ord("\\"):
             result += "\\\\"
-        elif not (0x20 <= ord(c) < 0x7f):
-            result += f"\\x{ord(c):02x}"
+        elif not (0x20 <= c < 0x7f):
+            # Octal escape sequences have at most 3 digits so they can't absorb following characters
+            result += f"\\{c:03o}"
         else:
-            result += c
+            result += chr(c)
     return result
 
 
@@ -62,21 +120,24 @@ def main(argv):
         if "name" not in data:
             continue
         module_name = data["name"]
+        module_deprecated = "true" if data.get("deprecated") == "true" else "false"
         module_names.append(filename)
 
-        module_content = json.dumps(data)
-        module_content_chunks = [f"\"{escapeString(chunk)}\"" for chunk in chunked(module_content, 1024)]
-        module_content_chunks_str = ',\n'.join(module_content_chunks)
+        compiled = BinaryJson(data)
 
         with open(output_file, "w") as f:
             f.write(f"""/**
  * @file modules/generated/module_{module_name}_generated.h
- * @brief Definition of {filename} written in array. Generated by json_to_array.py
+ * @brief Definition of {filename} compiled into binary JSON. Generated by json_to_array.py
  * @copyright (c) 2021 Avast Software, licensed under the MIT license
  */
  #pragma once
 
+ #include <cstdint>
+ #include <string_view>
+
  #include "yaramod/types/modules/module_content.h"
+ #include "yaramod/utils/binary_json.h"
 
  namespace yaramod {{
 
@@ -85,18 +146,16 @@ def main(argv):
  class G{filename} : public ModuleContent
  {{
  public:
-    static constexpr std::size_t module_content_size = {len(module_content) + 1};
-    static constexpr const char* module_content_parts[] = {{
-{module_content_chunks_str}
+    static constexpr std::string_view strings[] = {{
+{compiled.strings_str()}
+    }};
+    static constexpr std::uint32_t values[] = {{
+{compiled.values_str()}
     }};
+    static constexpr BinaryJson::Data data = {{strings, values}};
 
-    G{filename}() : ModuleContent("{module_name}")
+    G{filename}() : ModuleContent("{module_name}", &data, {module_deprecated})
     {{
-        std::string content;
-        content.reserve(module_content_size);
-        for (std::size_t i = 0; i < {len(module_content_chunks)}; ++i)
-            content += module_content_parts[i];
-        setContent(std::move(content));
     }}
  }};
 
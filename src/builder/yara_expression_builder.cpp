@@ -30,6 +30,47 @@ void error_handle(const std::string& msg)
 	throw YaraExpressionBuilderError(msg);
 }
 
+/**
+ * Creates logical operation which continues the chain of its left operand
+ * if there is one, otherwise creates plain binary operation.
+ */
+template <typename ExpT>
+Expression::Ptr chainedExpression(const Expression::Ptr& left, TokenIt op, const Expression::Ptr& right, bool linebreak)
+{
+	if (auto chain = BinaryOpExpression::continueChain(left, expressionKindOf<ExpT>()))
+	{
+		chain->append(op, right, linebreak);
+		auto operands = chain->getOperandsCount();
+		return std::make_shared<ExpT>(std::make_shared<TokenStream>(), std::move(chain), operands);
+	}
+	return std::make_shared<ExpT>(left, op, right, linebreak);
+}
+
+/**
+ * Creates logical operation of the left-hand side and the right-hand side. Left-hand side
+ * gives up its expression, so the chain of the expression is continued in place unless
+ * it is referenced from elsewhere.
+ */
+template <typename ExpT>
+YaraExpressionBuilder logicalOperation(YaraExpressionBuilder&& lhs, TokenType type, const std::string& symbol, const YaraExpressionBuilder& rhs, bool linebreak, const std::string* lhscomment = nullptr)
+{
+	auto ts = std::make_shared<TokenStream>();
+	ts->moveAppend(lhs.getTokenStream());
+	auto left = lhs.get();
+	// Drop the reference of the left-hand side to its expression
+	lhs = YaraExpressionBuilder(ts);
+
+	TokenIt opToken = ts->emplace_back(type, symbol);
+	if (lhscomment)
+		ts->commentBehind(*lhscomment, false, "", true);
+	else if (linebreak)
+		ts->emplace_back(TokenType::NEW_LINE, "\n");
+	ts->moveAppend(rhs.getTokenStream());
+
+	auto expression = chainedExpression<ExpT>(left, opToken, rhs.get(), linebreak);
+	return YaraExpressionBuilder(std::move(ts), std::move(expression), Expression::Type::Bool);
+}
+
 template <typename Op>
 YaraExpressionBuilder logicalFormula(std::vector<YaraExpressionBuilder> terms, const Op& op)
 {
@@ -39,7 +80,7 @@ YaraExpressionBuilder logicalFormula(std::vector<YaraExpressionBuilder> terms, c
 	if (terms.size() == 1)
 		return terms.front();
 
-	auto formula = op(terms[0], terms[1]);
+	auto formula = op(std::move(terms[0]), terms[1]);
 	for (std::size_t i = 2; i < terms.size(); ++i)
 	{
 		if (!terms[i].canBeBool())
@@ -48,7 +89,7 @@ YaraExpressionBuilder logicalFormula(std::vector<YaraExpressionBuilder> terms, c
 			error_handle("Expected boolean, got '" + expr->getText() + "' of type " + expr->getTypeString());
 		}
 		if (i >= 2)
-			formula = op(formula, terms[i]);
+			formula = op(std::move(formula), terms[i]);
 	}
 
 	formula.setType(Expression::Type::Bool);
@@ -64,7 +105,7 @@ YaraExpressionBuilder logicalFormula(std::vector<YaraExpressionBuilder> terms, s
 	if (terms.size() == 1)
 		return terms.front();
 
-	auto formula = op(terms[0], comments[0], terms[1]);
+	auto formula = op(std::move(terms[0]), comments[0], terms[1]);
 	for (std::size_t i = 2; i < terms.size(); ++i)
 	{
 		if (!terms[i].canBeBool())
@@ -73,7 +114,7 @@ YaraExpressionBuilder logicalFormula(std::vector<YaraExpressionBuilder> terms, s
 			error_handle("Expected boolean, got '" + expr->getText() + "' of type " + expr->getTypeString());
 		}
 		if (i >= 2)
-			formula = op(formula, comments[i-1], terms[i]);
+			formula = op(std::move(formula), comments[i-1], terms[i]);
 	}
 
 	formula.setType(Expression::Type::Bool);
@@ -143,7 +184,7 @@ YaraExpressionBuilder& YaraExpressionBuilder::operator&&(const YaraExpressionBui
 	TokenIt token = _tokenStream->emplace_back(TokenType::AND, "and");
 	_tokenStream->moveAppend(other.getTokenStream());
 
-	_expr = std::make_shared<AndExpression>(std::move(_expr), token, other.get());
+	_expr = chainedExpression<AndExpression>(_expr, token, other.get(), false);
 	setType(Expression::Type::Bool);
 	return *this;
 }
@@ -160,7 +201,7 @@ YaraExpressionBuilder& YaraExpressionBuilder::operator||(const YaraExpressionBui
 	TokenIt token = _tokenStream->emplace_back(TokenType::OR, "or");
 	_tokenStream->moveAppend(other.getTokenStream());
 
-	_expr = std::make_shared<OrExpression>(std::move(_expr), token, other.get());
+	_expr = chainedExpression<OrExpression>(_expr, token, other.get(), false);
 	setType(Expression::Type::Bool);
 	return *this;
 }
@@ -1329,15 +1370,7 @@ YaraExpressionBuilder conjunction(const YaraExpressionBuilder& lhs, const YaraEx
 	else if (!rhs.canBeBool())
 		error_handle(ArgType::Right, "and", "bool", lhs.get());
 
-	auto ts = std::make_shared<TokenStream>();
-	ts->moveAppend(lhs.getTokenStream());
-	TokenIt andToken = ts->emplace_back(TokenType::AND, "and");
-	if (linebreak)
-		ts->emplace_back(TokenType::NEW_LINE, "\n");
-	ts->moveAppend(rhs.getTokenStream());
-
-	auto expression = std::make_shared<AndExpression>(lhs.get(), andToken, rhs.get(), linebreak);
-	return YaraExpressionBuilder(std::move(ts), std::move(expression), Expression::Type::Bool);
+	return logicalOperation<AndExpression>(YaraExpressionBuilder(lhs), TokenType::AND, "and", rhs, linebreak);
 }
 
 /**
@@ -1356,15 +1389,7 @@ YaraExpressionBuilder disjunction(const YaraExpressionBuilder& lhs, const YaraEx
 	else if (!rhs.canBeBool())
 		error_handle(ArgType::Right, "or", "bool", rhs.get());
 
-	auto ts = std::make_shared<TokenStream>();
-	ts->moveAppend(lhs.getTokenStream());
-	TokenIt orToken = ts->emplace_back(TokenType::OR, "or");
-	if (linebreak)
-		ts->emplace_back(TokenType::NEW_LINE, "\n");
-	ts->moveAppend(rhs.getTokenStream());
-
-	auto expression = std::make_shared<OrExpression>(lhs.get(), orToken, rhs.get(), linebreak);
-	return YaraExpressionBuilder(std::move(ts), std::move(expression), Expression::Type::Bool);
+	return logicalOperation<OrExpression>(YaraExpressionBuilder(lhs), TokenType::OR, "or", rhs, linebreak);
 }
 
 /**
@@ -1383,14 +1408,7 @@ YaraExpressionBuilder conjunction(const YaraExpressionBuilder& lhs, const std::s
 	else if (!rhs.canBeBool())
 		error_handle(ArgType::Right, "and", "bool", lhs.get());
 
-	auto ts = std::make_shared<TokenStream>();
-	ts->moveAppend(lhs.getTokenStream());
-	TokenIt andToken = ts->emplace_back(TokenType::AND, "and");
-	ts->commentBehind(lhscomment, false, "", true);
-	ts->moveAppend(rhs.getTokenStream());
-
-	auto expression = std::make_shared<AndExpression>(lhs.get(), andToken, rhs.get(), true);
-	return YaraExpressionBuilder(std::move(ts), std::move(expression), Expression::Type::Bool);
+	return logicalOperation<AndExpression>(YaraExpressionBuilder(lhs), TokenType::AND, "and", rhs, true, &lhscomment);
 }
 
 /**
@@ -1409,14 +1427,7 @@ YaraExpressionBuilder disjunction(const YaraExpressionBuilder& lhs, const std::s
 	else if (!rhs.canBeBool())
 		error_handle(ArgType::Right, "or", "bool", rhs.get());
 
-	auto ts = std::make_shared<TokenStream>();
-	ts->moveAppend(lhs.getTokenStream());
-	TokenIt orToken = ts->emplace_back(TokenType::OR, "or");
-	ts->commentBehind(lhscomment, false, "", true);
-	ts->moveAppend(rhs.getTokenStream());
-
-	auto expression = std::make_shared<OrExpression>(lhs.get(), orToken, rhs.get(), true);
-	return YaraExpressionBuilder(std::move(ts), std::move(expression), Expression::Type::Bool);
+	return logicalOperation<OrExpression>(YaraExpressionBuilder(lhs), TokenType::OR, "or", rhs, true, &lhscomment);
 }
 
 /**
@@ -1432,7 +1443,9 @@ YaraExpressionBuilder conjunction(const std::vector<YaraExpressionBuilder>& term
 	for (const auto& bld : terms)
 		if (!bld.canBeBool())
 			error_handle(ArgType::Single, "and", "bool", bld.get());
-	return logicalFormula(terms, [linebreaks](YaraExpressionBuilder& term1, YaraExpressionBuilder& term2) { return conjunction(term1, term2, linebreaks); });
+	return logicalFormula(terms, [linebreaks](YaraExpressionBuilder&& term1, YaraExpressionBuilder& term2) {
+		return logicalOperation<AndExpression>(std::move(term1), TokenType::AND, "and", term2, linebreaks);
+	});
 }
 
 /**
@@ -1448,7 +1461,9 @@ YaraExpressionBuilder disjunction(const std::vector<YaraExpressionBuilder>& term
 	for (const auto& bld : terms)
 		if (!bld.canBeBool())
 			error_handle(ArgType::Single, "or", "bool", bld.get());
-	return logicalFormula(terms, [linebreaks](YaraExpressionBuilder& term1, YaraExpressionBuilder& term2) { return disjunction(term1, term2, linebreaks); });
+	return logicalFormula(terms, [linebreaks](YaraExpressionBuilder&& term1, YaraExpressionBuilder& term2) {
+		return logicalOperation<OrExpression>(std::move(term1), TokenType::OR, "or", term2, linebreaks);
+	});
 }
 
 /**
@@ -1470,8 +1485,8 @@ YaraExpressionBuilder conjunction(const std::vector<std::pair<YaraExpressionBuil
 		terms.push_back(pair.first);
 		comments.push_back(pair.second);
 	}
-	auto output = logicalFormula(terms, comments, []( YaraExpressionBuilder& term1, std::string& comment1, YaraExpressionBuilder& term2) {
-		return conjunction(term1, comment1, term2);
+	auto output = logicalFormula(terms, comments, [](YaraExpressionBuilder&& term1, std::string& comment1, YaraExpressionBuilder& term2) {
+		return logicalOperation<AndExpression>(std::move(term1), TokenType::AND, "and", term2, true, &comment1);
 	});
 
 	output.commentBehind(comments.back(), false, "", false);
@@ -1497,8 +1512,8 @@ YaraExpressionBuilder disjunction(const std::vector<std::pair<YaraExpressionBuil
 		terms.push_back(pair.first);
 		comments.push_back(pair.second);
 	}
-	auto output = logicalFormula(terms, comments, []( YaraExpressionBuilder& term1, std::string& comment1, YaraExpressionBuilder& term2) {
-		return disjunction(term1, comment1, term2);
+	auto output = logicalFormula(terms, comments, [](YaraExpressionBuilder&& term1, std::string& comment1, YaraExpressionBuilder& term2) {
+		return logicalOperation<OrExpression>(std::move(term1), TokenType::OR, "or", term2, true, &comment1);
 	});
 
 	output.commentBehind(comments.back(), false, "", false);
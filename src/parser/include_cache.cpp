@@ -0,0 +1,268 @@
+/**
+ * @file src/parser/include_cache.cpp
+ * @brief Implementation of class IncludeCache.
+ * @copyright (c) 2026 Avast Software, licensed under the MIT license
+ */
+
+#include <algorithm>
+
+#include "yaramod/parser/include_cache.h"
+#include "yaramod/utils/observing_visitor.h"
+
+namespace yaramod {
+
+namespace {
+
+std::uint64_t rotl(std::uint64_t value, int shift)
+{
+	return (value << shift) | (value >> (64 - shift));
+}
+
+std::uint64_t fmix(std::uint64_t value)
+{
+	value ^= value >> 33;
+	value *= 0xff51afd7ed558ccdULL;
+	value ^= value >> 33;
+	value *= 0xc4ceb9fe1a85ec53ULL;
+	value ^= value >> 33;
+	return value;
+}
+
+std::uint64_t load(const char* bytes, std::size_t count)
+{
+	std::uint64_t result = 0;
+	for (std::size_t i = 0; i < count; ++i)
+		result |= static_cast<std::uint64_t>(static_cast<unsigned char>(bytes[i])) << (8 * i);
+	return result;
+}
+
+/**
+ * Refers the identifiers in the copied expressions to the copies of the rule symbols.
+ */
+class SymbolRemapper : public ObservingVisitor
+{
+public:
+	SymbolRemapper(const std::unordered_map<const Symbol*, std::shared_ptr<Symbol>>& symbols) : ObservingVisitor(true), _symbols(symbols) {}
+
+	void remap(Expression* expr)
+	{
+		if (expr)
+			expr->accept(this);
+	}
+
+	virtual VisitResult visit(IdExpression* expr) override
+	{
+		if (auto itr = _symbols.find(expr->getSymbol().get()); itr != _symbols.end())
+			expr->setSymbol(itr->second);
+		return {};
+	}
+
+private:
+	const std::unordered_map<const Symbol*, std::shared_ptr<Symbol>>& _symbols;
+};
+
+} // namespace
+
+/**
+ * Returns the copy of the include which shares nothing modifiable with this include. Tokens and
+ * rules are copied, literals referring to other tokens and symbols of the rules are replaced
+ * by their copies.
+ *
+ * @return Copy of the include.
+ */
+std::shared_ptr<ParsedInclude> ParsedInclude::clone() const
+{
+	auto result = std::make_shared<ParsedInclude>();
+	result->features = features;
+	result->includedFiles = includedFiles;
+	result->undefinedSymbols = undefinedSymbols;
+
+	TokenMap copies;
+	result->tokenStream = tokenStream->copy(copies);
+
+	// Rules of the nested includes are in the token streams of their include tokens
+	std::unordered_map<const TokenStream*, std::shared_ptr<TokenStream>> streams;
+	std::vector<std::pair<const TokenStream*, std::shared_ptr<TokenStream>>> pending = {{tokenStream.get(), result->tokenStream}};
+	while (!pending.empty())
+	{
+		auto [original, copy] = std::move(pending.back());
+		pending.pop_back();
+		for (const auto& token : *original)
+		{
+			if (const auto& subTokenStream = token.getSubTokenStream())
+				pending.emplace_back(subTokenStream.get(), copies.at(&token)->getSubTokenStream());
+		}
+		streams.emplace(original, std::move(copy));
+	}
+
+	std::unordered_map<const Symbol*, std::shared_ptr<Symbol>> symbols;
+	result->rules.reserve(rules.size());
+	for (const auto& rule : rules)
+	{
+		auto copy = rule->clone(streams.at(rule->getTokenStream()), copies);
+		symbols.emplace(rule->getSymbol().get(), copy->getSymbol());
+		result->rules.push_back(std::move(copy));
+	}
+
+	// Only few literals are referenced, so the copies of just these are looked up. Copied streams
+	// keep the order of the original tokens and the tokens of the clones replaced their copies.
+	std::unordered_map<const Literal*, const Literal*> literals;
+	for (const auto& [original, stream] : streams)
+	{
+		for (auto& token : *stream)
+		{
+			if (token.isLiteralReference())
+				literals.emplace(token.getLiteralReference(), nullptr);
+			else if (token.isSymbol())
+			{
+				if (auto itr = symbols.find(token.getSymbol().get()); itr != symbols.end())
+					token.setValue(itr->second);
+			}
+		}
+	}
+
+	if (!literals.empty())
+	{
+		for (const auto& [original, stream] : streams)
+		{
+			for (const auto& token : *original)
+			{
+				if (auto itr = literals.find(&token.getLiteral()); itr != literals.end())
+					itr->second = &copies.at(&token)->getLiteral();
+			}
+		}
+
+		for (const auto& [original, stream] : streams)
+		{
+			for (auto& token : *stream)
+			{
+				if (token.isLiteralReference())
+				{
+					if (auto itr = literals.find(token.getLiteralReference()); itr != literals.end() && itr->second)
+						token.setValue(itr->second);
+				}
+			}
+		}
+	}
+
+	SymbolRemapper remapper(symbols);
+	for (const auto& rule : result->rules)
+	{
+		for (const auto& variable : rule->getVariables())
+			remapper.remap(variable.getValue().get());
+		remapper.remap(rule->getCondition().get());
+	}
+
+	result->imports.reserve(imports.size());
+	for (const auto& import : imports)
+		result->imports.push_back(copies.at(&*import));
+
+	return result;
+}
+
+/**
+ * Computes the hash of the content of an included file. It is the 128-bit
+ * MurmurHash3 (x64 variant) of the content together with its size.
+ *
+ * @param content Content of the file.
+ *
+ * @return Hash of the content.
+ */
+ContentHash IncludeCache::hashContent(std::string_view content)
+{
+	const std::uint64_t c1 = 0x87c37b91114253d5ULL;
+	const std::uint64_t c2 = 0x4cf5ad432745937fULL;
+
+	std::uint64_t h1 = 0;
+	std::uint64_t h2 = 0;
+	const auto* data = content.data();
+	const auto blocks = content.size() / 16;
+	for (std::size_t i = 0; i < blocks; ++i, data += 16)
+	{
+		auto k1 = load(data, 8);
+		auto k2 = load(data + 8, 8);
+
+		k1 *= c1; k1 = rotl(k1, 31); k1 *= c2; h1 ^= k1;
+		h1 = rotl(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+		k2 *= c2; k2 = rotl(k2, 33); k2 *= c1; h2 ^= k2;
+		h2 = rotl(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+	}
+
+	const auto tail = content.size() % 16;
+	if (tail > 8)
+	{
+		auto k2 = load(data + 8, tail - 8);
+		k2 *= c2; k2 = rotl(k2, 33); k2 *= c1; h2 ^= k2;
+	}
+	if (tail > 0)
+	{
+		auto k1 = load(data, std::min<std::size_t>(tail, 8));
+		k1 *= c1; k1 = rotl(k1, 31); k1 *= c2; h1 ^= k1;
+	}
+
+	h1 ^= content.size();
+	h2 ^= content.size();
+	h1 += h2;
+	h2 += h1;
+	h1 = fmix(h1);
+	h2 = fmix(h2);
+	h1 += h2;
+	h2 += h1;
+
+	return {content.size(), h1, h2};
+}
+
+/**
+ * Finds the parsed include file with the given content.
+ *
+ * @param filePath Absolute path to the file.
+ * @param contentHash Hash of the current content of the file.
+ *
+ * @return Parsed include if found, otherwise @c nullptr.
+ */
+std::shared_ptr<const ParsedInclude> MemoryIncludeCache::find(const std::string& filePath, const ContentHash& contentHash)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto itr = _includes.find(filePath);
+	if (itr == _includes.end() || itr->second.first != contentHash)
+		return nullptr;
+
+	return itr->second.second;
+}
+
+/**
+ * Stores the parsed include file. It replaces the include parsed from
+ * the previous content of the file.
+ *
+ * @param filePath Absolute path to the file.
+ * @param contentHash Hash of the content the include was parsed from.
+ * @param include Parsed include.
+ */
+void MemoryIncludeCache::store(const std::string& filePath, const ContentHash& contentHash, const std::shared_ptr<const ParsedInclude>& include)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_includes[filePath] = std::make_pair(contentHash, include);
+}
+
+/**
+ * Removes all stored includes.
+ */
+void MemoryIncludeCache::clear()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_includes.clear();
+}
+
+/**
+ * Returns the number of stored includes.
+ *
+ * @return Number of includes.
+ */
+std::size_t MemoryIncludeCache::size() const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _includes.size();
+}
+
+} // namespace yaramod
@@ -0,0 +1,233 @@
+/**
+ * @file src/parser/include_prefetcher.cpp
+ * @brief Implementation of class IncludePrefetcher.
+ * @copyright (c) 2026 Avast Software, licensed under the MIT license
+ */
+
+#include <cctype>
+
+#include "yaramod/parser/include_prefetcher.h"
+#include "yaramod/utils/filesystem_operations.h"
+
+namespace yaramod {
+
+namespace {
+
+bool isIdentifierChar(char c)
+{
+	return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+} // namespace
+
+/**
+ * Constructor. Workers are started only when there are files to read.
+ *
+ * @param threads Maximal number of worker threads.
+ */
+IncludePrefetcher::IncludePrefetcher(std::size_t threads) : _threads(threads)
+{
+}
+
+/**
+ * Destructor. Waits for the workers to finish.
+ */
+IncludePrefetcher::~IncludePrefetcher()
+{
+	stop();
+}
+
+/**
+ * Queues the files included by the file for reading.
+ *
+ * @param filePath Path to the file as it is used by the parser.
+ * @param content Content of the file.
+ */
+void IncludePrefetcher::prefetchIncludesOf(const std::string& filePath, std::string_view content)
+{
+	_enqueueIncludesOf(filePath, content);
+}
+
+/**
+ * Takes the read file out of the prefetcher. If the file is being read, it waits until
+ * it is finished. Nothing is returned for files which were not queued, files which
+ * were not read by any worker yet and files which can't be opened, the parser opens
+ * them itself. Every file is returned at most once.
+ *
+ * @param filePath Absolute path to the file.
+ *
+ * @return Read file or @c nullptr.
+ */
+std::unique_ptr<MappedFile> IncludePrefetcher::take(const std::string& filePath)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	auto itr = _files.find(filePath);
+	if (itr == _files.end())
+		return nullptr;
+
+	auto& entry = itr->second;
+	if (entry.state == PrefetchedFile::State::Reading)
+		_read.wait(lock, [&]() { return entry.state != PrefetchedFile::State::Reading; });
+
+	auto state = entry.state;
+	entry.state = PrefetchedFile::State::Taken;
+	if (state != PrefetchedFile::State::Read || !entry.file->isOpen())
+		return nullptr;
+
+	return std::move(entry.file);
+}
+
+/**
+ * Stops the workers and releases the files which were not taken.
+ */
+void IncludePrefetcher::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	_queued.notify_all();
+
+	for (auto& worker : _workers)
+		worker.join();
+	_workers.clear();
+	_queue.clear();
+	_files.clear();
+}
+
+/**
+ * Finds the paths in the include directives of the content. Comments and string literals
+ * are skipped. The scan doesn't need to be exact, paths it misses are not prefetched
+ * and files it finds needlessly are never taken.
+ *
+ * @param content Content of the file.
+ *
+ * @return Paths in the order of the include directives.
+ */
+std::vector<std::string> IncludePrefetcher::findIncludes(std::string_view content)
+{
+	constexpr std::string_view keyword = "include";
+
+	std::vector<std::string> result;
+	std::size_t pos = 0;
+	while (pos < content.size())
+	{
+		if (content.compare(pos, 2, "//") == 0)
+			pos = content.find('\n', pos);
+		else if (content.compare(pos, 2, "/*") == 0)
+		{
+			pos = content.find("*/", pos + 2);
+			pos = pos == std::string_view::npos ? pos : pos + 2;
+		}
+		else if (content[pos] == '"')
+		{
+			// String literals end at the end of line at the latest so a quote in a regular expression doesn't hide the rest of the file
+			for (++pos; pos < content.size() && content[pos] != '"' && content[pos] != '\n'; ++pos)
+			{
+				if (content[pos] == '\\')
+					++pos;
+			}
+			++pos;
+		}
+		else if (isIdentifierChar(content[pos]))
+		{
+			auto end = pos;
+			while (end < content.size() && isIdentifierChar(content[end]))
+				++end;
+
+			if (content.substr(pos, end - pos) == keyword)
+			{
+				auto quote = content.find_first_not_of(" \t\v\r\n", end);
+				if (quote != std::string_view::npos && content[quote] == '"')
+				{
+					auto closingQuote = content.find('"', quote + 1);
+					if (closingQuote != std::string_view::npos && closingQuote > quote + 1)
+					{
+						result.emplace_back(content.substr(quote + 1, closingQuote - quote - 1));
+						end = closingQuote + 1;
+					}
+				}
+			}
+			pos = end;
+		}
+		else
+			++pos;
+	}
+
+	return result;
+}
+
+/**
+ * Queues the files included by the file and starts the workers if needed.
+ * Paths are resolved in the same way as the parser resolves them.
+ *
+ * @param filePath Path to the file as it is used by the parser.
+ * @param content Content of the file.
+ */
+void IncludePrefetcher::_enqueueIncludesOf(const std::string& filePath, std::string_view content)
+{
+	auto includes = findIncludes(content);
+	if (includes.empty())
+		return;
+
+	for (auto& includePath : includes)
+	{
+		if (pathIsRelative(includePath))
+			includePath = joinPaths(parentPath(filePath), includePath);
+		includePath = absolutePath(includePath);
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_stopping)
+		return;
+
+	for (auto& includePath : includes)
+	{
+		if (_files.emplace(includePath, PrefetchedFile{}).second)
+			_queue.push_back(std::move(includePath));
+	}
+
+	while (_workers.size() < std::min(_threads, _queue.size()))
+		_workers.emplace_back(&IncludePrefetcher::_work, this);
+	_queued.notify_all();
+}
+
+/**
+ * Reads the queued files until the prefetcher is stopped.
+ */
+void IncludePrefetcher::_work()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	while (true)
+	{
+		_queued.wait(lock, [this]() { return _stopping || !_queue.empty(); });
+		if (_stopping)
+			return;
+
+		auto filePath = std::move(_queue.front());
+		_queue.pop_front();
+
+		// Parser might have already opened the file itself. References to the entries
+		// stay valid because entries are removed only after the workers are stopped.
+		auto& entry = _files[filePath];
+		if (entry.state != PrefetchedFile::State::Queued)
+			continue;
+
+		entry.state = PrefetchedFile::State::Reading;
+		lock.unlock();
+
+		auto file = std::make_unique<MappedFile>(filePath);
+		if (file->isOpen())
+		{
+			file->prefault();
+			_enqueueIncludesOf(filePath, file->getContent());
+		}
+
+		lock.lock();
+		entry.file = std::move(file);
+		entry.state = PrefetchedFile::State::Read;
+		_read.notify_all();
+	}
+}
+
+} // namespace yaramod
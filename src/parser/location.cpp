@@ -0,0 +1,87 @@
+/**
+ * @file src/parser/location.cpp
+ * @brief Implementation of the table of file paths used by class Location.
+ * @copyright (c) 2026 Avast Software, licensed under the MIT license
+ */
+
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "yaramod/parser/location.h"
+
+namespace yaramod {
+
+namespace {
+
+/**
+ * Process-wide table of file paths referenced by locations. Paths are never removed
+ * so their indices and references to them stay valid for the whole lifetime of the process.
+ * The table therefore grows with every distinct path, which is only a concern for long-running
+ * processes parsing huge numbers of differently named files.
+ */
+struct FilePathTable
+{
+	FilePathTable() : paths{"", "[stream]"}, ids{{paths[0], 0}, {paths[1], 1}} {}
+
+	std::shared_mutex mutex;
+	std::deque<std::string> paths;
+	std::unordered_map<std::string_view, std::uint32_t> ids;
+};
+
+FilePathTable& filePathTable()
+{
+	// Intentionally never destroyed because locations can be used by destructors of other static objects
+	static auto* table = new FilePathTable();
+	return *table;
+}
+
+} // namespace
+
+/**
+ * Returns the index of the file path in the table of file paths. The path is added if it is not there yet.
+ *
+ * @param filePath Path to the file.
+ *
+ * @return Index of the path.
+ */
+std::uint32_t Location::registerFilePath(const std::string& filePath)
+{
+	auto& table = filePathTable();
+	{
+		std::shared_lock<std::shared_mutex> lock(table.mutex);
+		if (auto itr = table.ids.find(filePath); itr != table.ids.end())
+			return itr->second;
+	}
+
+	std::unique_lock<std::shared_mutex> lock(table.mutex);
+	if (auto itr = table.ids.find(filePath); itr != table.ids.end())
+		return itr->second;
+
+	if (table.paths.size() >= std::numeric_limits<std::uint32_t>::max())
+		throw std::length_error("Too many distinct file paths in locations");
+
+	auto id = static_cast<std::uint32_t>(table.paths.size());
+	table.paths.push_back(filePath);
+	table.ids.emplace(table.paths.back(), id);
+	return id;
+}
+
+/**
+ * Returns the file path with given index in the table of file paths.
+ *
+ * @param fileId Index of the path.
+ *
+ * @return Path to the file.
+ */
+const std::string& Location::lookupFilePath(std::uint32_t fileId)
+{
+	auto& table = filePathTable();
+	std::shared_lock<std::shared_mutex> lock(table.mutex);
+	return table.paths[fileId];
+}
+
+} // namespace yaramod
@@ -4,7 +4,12 @@
  * @copyright (c) 2017 Avast Software, licensed under the MIT license
  */
 
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+
 #include "yaramod/parser/parser_driver.h"
+#include "yaramod/parser/parsing_table_cache.h"
 #include "yaramod/types/expressions.h"
 #include "yaramod/types/plain_string.h"
 #include "yaramod/types/hex_string.h"
@@ -18,21 +23,146 @@
 
 namespace yaramod {
 
-void error_handle(const Location& location, const std::string& msg)
+ParserError parser_error(const Location& location, const std::string& msg)
 {
 	std::stringstream err;
 	err << "Error at " << location << ": " << msg;
-	throw ParserError(err.str());
+	return ParserError(err.str(), location);
+}
+
+void error_handle(const Location& location, const std::string& msg)
+{
+	throw parser_error(location, msg);
+}
+
+namespace {
+
+/**
+ * Returns the number of line breaks the token spans in the input. Line breaks inside string literals
+ * and regular expressions are not counted into locations of the tokens, so no number is returned
+ * for tokens containing them because lines of the following tokens don't match the input.
+ *
+ * @param token Token.
+ *
+ * @return Number of line breaks.
+ */
+std::optional<std::size_t> lineBreaks(const Token& token)
+{
+	if (token.getType() == TokenType::NEW_LINE)
+		return 1;
+	if (!token.isString())
+		return 0;
+
+	const auto& text = token.getString();
+	auto count = static_cast<std::size_t>(std::count(text.begin(), text.end(), '\n'));
+	if (count > 0 && token.getType() != TokenType::COMMENT)
+		return std::nullopt;
+	return count;
+}
+
+/**
+ * Returns whether the token of given type starts a rule, an import or an include.
+ *
+ * @param type Type of the token.
+ *
+ * @return @c true if it starts an item of the file, otherwise @c false.
+ */
+bool startsFileItem(TokenType type)
+{
+	return type == TokenType::RULE || type == TokenType::PRIVATE || type == TokenType::GLOBAL
+		|| type == TokenType::IMPORT_KEYWORD || type == TokenType::INCLUDE_DIRECTIVE;
+}
+
+/**
+ * Moves locations of the tokens and the rules by given number of lines. Tokens which
+ * were not read from the input, such as the units of regular expressions, are kept as they are.
+ *
+ * @param fileLocation Location in the input.
+ * @param first First token to move.
+ * @param last Token after the last token to move.
+ * @param rules Rules of the file.
+ * @param firstRule Index of the first rule to move, all the following rules are moved too.
+ * @param lineShift Number of lines to move by.
+ */
+void shiftLines(const Location& fileLocation, TokenIt first, TokenIt last, const std::vector<std::shared_ptr<Rule>>& rules, std::size_t firstRule, std::ptrdiff_t lineShift)
+{
+	if (lineShift == 0)
+		return;
+
+	for (auto itr = first; itr != last; ++itr)
+	{
+		auto location = itr->getLocation();
+		if (!location.isSameFile(fileLocation))
+			continue;
+
+		location.shiftLines(lineShift);
+		itr->setLocation(location);
+	}
+
+	for (auto i = firstRule; i < rules.size(); ++i)
+	{
+		auto location = rules[i]->getLocation();
+		location.shiftLines(lineShift);
+		rules[i]->setLocation(location);
+	}
 }
 
+/**
+ * Passes the phases of the parser into the profile. Every entered phase also counts
+ * a token received from the tokenizer or a reduction by a grammar rule.
+ */
+class ProfileListener : public pog::ParserListener
+{
+public:
+	explicit ProfileListener(ParserProfile& profile) : _profile(profile) {}
+
+	virtual void enter(pog::ParsingPhase phase) override
+	{
+		if (phase == pog::ParsingPhase::Tokenizing)
+		{
+			_profile.addToken();
+			_profile.enter(ParserPhase::Tokenizing);
+		}
+		else
+		{
+			_profile.addReduction();
+			_profile.enter(ParserPhase::Actions);
+		}
+	}
+
+	virtual void leave(pog::ParsingPhase) override
+	{
+		_profile.leave();
+	}
+
+private:
+	ParserProfile& _profile;
+};
+
+} // namespace
+
 template <typename... Args>
 TokenIt ParserDriver::emplace_back(Args&&... args)
 {
-	TokenIt tokenIt = currentFileContext()->getTokenStream()->emplace_back(args...);
+	TokenIt tokenIt = currentFileContext()->getTokenStream()->emplace_back(std::forward<Args>(args)...);
 	tokenIt->setLocation(currentFileContext()->getLocation());
 	return tokenIt;
 }
 
+/**
+ * Creates new token in the current file with the value interned in the literal pool
+ * of the parsed file, so tokens with the same text share the same string.
+ *
+ * @param type Type of the token.
+ * @param str Text of the token.
+ *
+ * @return Created token.
+ */
+TokenIt ParserDriver::emplace_interned(TokenType type, std::string_view str)
+{
+	return emplace_back(type, Literal{_file.getLiteralPool().intern(str)});
+}
+
 void ParserDriver::defineTokens()
 {
 	//define global action for counting the line/character position
@@ -42,14 +172,14 @@ void ParserDriver::defineTokens()
 
 	_parser.token("\r\n").states("@default", "$meta").action([&](std::string_view) -> Value {
 		currentFileContext()->getTokenStream()->setNewLineChar("\r\n");
-		TokenIt t = emplace_back(TokenType::NEW_LINE, "\r\n");
+		TokenIt t = emplace_interned(TokenType::NEW_LINE, "\r\n");
 		_indent.clear();
 		currentFileContext()->getLocation().addLine();
 		return t;
 	});
 	_parser.token("\n").states("@default", "$meta").action([&](std::string_view) -> Value {
 		currentFileContext()->getTokenStream()->setNewLineChar("\n");
-		TokenIt t = emplace_back(TokenType::NEW_LINE, "\n");
+		TokenIt t = emplace_interned(TokenType::NEW_LINE, "\n");
 		_indent.clear();
 		currentFileContext()->getLocation().addLine();
 		return t;
@@ -59,132 +189,133 @@ void ParserDriver::defineTokens()
 		return {};
 	});
 
-	_parser.token(R"(\.\.)").symbol("RANGE").description("integer range").action([&](std::string_view str) -> Value { return emplace_back(TokenType::DOUBLE_DOT, std::string{str}); });
-	_parser.token(R"(\.)").symbol("DOT").description(".").action([&](std::string_view str) -> Value { return emplace_back(TokenType::DOT, std::string{str}); })
+	_parser.token(R"(\.\.)").symbol("RANGE").description("integer range").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::DOUBLE_DOT, str); });
+	_parser.token(R"(\.)").symbol("DOT").description(".").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::DOT, str); })
 		.precedence(15, pog::Associativity::Left);
-	_parser.token("<").symbol("LT").description("<").action([&](std::string_view str) -> Value { return emplace_back(TokenType::LT, std::string{str}); })
+	_parser.token("<").symbol("LT").description("<").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::LT, str); })
 		.precedence(10, pog::Associativity::Left);
-	_parser.token(">").symbol("GT").description(">").action([&](std::string_view str) -> Value { return emplace_back(TokenType::GT, std::string{str}); })
+	_parser.token(">").symbol("GT").description(">").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::GT, str); })
 		.precedence(10, pog::Associativity::Left);
-	_parser.token("<=").symbol("LE").description("<=").action([&](std::string_view str) -> Value { return emplace_back(TokenType::LE, std::string{str}); })
+	_parser.token("<=").symbol("LE").description("<=").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::LE, str); })
 		.precedence(10, pog::Associativity::Left);
-	_parser.token(">=").symbol("GE").description(">=").action([&](std::string_view str) -> Value { return emplace_back(TokenType::GE, std::string{str}); })
+	_parser.token(">=").symbol("GE").description(">=").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::GE, str); })
 		.precedence(10, pog::Associativity::Left);
-	_parser.token("==").symbol("EQ").description("==").action([&](std::string_view str) -> Value { return emplace_back(TokenType::EQ, std::string{str}); })
+	_parser.token("==").symbol("EQ").description("==").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::EQ, str); })
 		.precedence(9, pog::Associativity::Left);
-	_parser.token("!=").symbol("NEQ").description("!=").action([&](std::string_view str) -> Value { return emplace_back(TokenType::NEQ, std::string{str}); })
+	_parser.token("!=").symbol("NEQ").description("!=").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::NEQ, str); })
 		.precedence(9, pog::Associativity::Left);
-	_parser.token("<<").symbol("SHIFT_LEFT").description("<<").action([&](std::string_view str) -> Value { return emplace_back(TokenType::SHIFT_LEFT, std::string{str}); })
+	_parser.token("<<").symbol("SHIFT_LEFT").description("<<").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::SHIFT_LEFT, str); })
 		.precedence(11, pog::Associativity::Left);
-	_parser.token(">>").symbol("SHIFT_RIGHT").description(">>").action([&](std::string_view str) -> Value { return emplace_back(TokenType::SHIFT_RIGHT, std::string{str}); })
+	_parser.token(">>").symbol("SHIFT_RIGHT").description(">>").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::SHIFT_RIGHT, str); })
 		.precedence(11, pog::Associativity::Left);
-	_parser.token(R"(-)").symbol("MINUS").description("-").action([&](std::string_view str) -> Value { return emplace_back(TokenType::MINUS, std::string{str}); })
+	_parser.token(R"(-)").symbol("MINUS").description("-").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::MINUS, str); })
 		.precedence(12, pog::Associativity::Left);
-	_parser.token(R"(\+)").symbol("PLUS").description("+").action([&](std::string_view str) -> Value { return emplace_back(TokenType::PLUS, std::string{str}); })
+	_parser.token(R"(\+)").symbol("PLUS").description("+").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::PLUS, str); })
 		.precedence(12, pog::Associativity::Left);
-	_parser.token(R"(\*)").symbol("MULTIPLY").description("*").action([&](std::string_view str) -> Value { return emplace_back(TokenType::MULTIPLY, std::string{str}); })
+	_parser.token(R"(\*)").symbol("MULTIPLY").description("*").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::MULTIPLY, str); })
 		.precedence(13, pog::Associativity::Left);
-	_parser.token(R"(\\)").symbol("DIVIDE").description("\\").action([&](std::string_view str) -> Value { return emplace_back(TokenType::DIVIDE, std::string{str}); })
+	_parser.token(R"(\\)").symbol("DIVIDE").description("\\").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::DIVIDE, str); })
 		.precedence(13, pog::Associativity::Left);
-	_parser.token(R"(\%)").symbol("PERCENT").description("%").action([&](std::string_view str) -> Value { return emplace_back(TokenType::PERCENT, std::string{str}); })
+	_parser.token(R"(\%)").symbol("PERCENT").description("%").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::PERCENT, str); })
 		.precedence(13, pog::Associativity::Left);
-	_parser.token(R"(\^)").symbol("BITWISE_XOR").description("^").action([&](std::string_view str) -> Value { return emplace_back(TokenType::BITWISE_XOR, std::string{str}); })
+	_parser.token(R"(\^)").symbol("BITWISE_XOR").description("^").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::BITWISE_XOR, str); })
 		.precedence(7, pog::Associativity::Left);
-	_parser.token(R"(\&)").symbol("BITWISE_AND").description("&").action([&](std::string_view str) -> Value { return emplace_back(TokenType::BITWISE_AND, std::string{str}); })
+	_parser.token(R"(\&)").symbol("BITWISE_AND").description("&").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::BITWISE_AND, str); })
 		.precedence(8, pog::Associativity::Left);
-	_parser.token(R"(\|)").symbol("BITWISE_OR").description("|").action([&](std::string_view str) -> Value { return emplace_back(TokenType::BITWISE_OR, std::string{str}); })
+	_parser.token(R"(\|)").symbol("BITWISE_OR").description("|").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::BITWISE_OR, str); })
 		.precedence(6, pog::Associativity::Left);
-	_parser.token(R"(\~)").symbol("BITWISE_NOT").description("~").action([&](std::string_view str) -> Value { return emplace_back(TokenType::BITWISE_NOT, std::string{str}); })
+	_parser.token(R"(\~)").symbol("BITWISE_NOT").description("~").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::BITWISE_NOT, str); })
 		.precedence(14, pog::Associativity::Right);
-	_parser.token("\\(").symbol("LP").description("(").action([&](std::string_view str) -> Value { return emplace_back(TokenType::LP, std::string{str}); });
-	_parser.token("\\)").symbol("RP").description(")").action([&](std::string_view str) -> Value { return emplace_back(TokenType::RP, std::string{str}); })
+	_parser.token("\\(").symbol("LP").description("(").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::LP, str); });
+	_parser.token("\\)").symbol("RP").description(")").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::RP, str); })
 		.precedence(1, pog::Associativity::Left);
 	_parser.token("\\{").symbol("LCB").description("{").action([&](std::string_view str) -> Value {
 		if (sectionStrings())
 			enter_state("$hexstr");
-		return emplace_back(TokenType::LCB, std::string{str});
+		return emplace_interned(TokenType::LCB, str);
 	});
-	_parser.token("\\}").symbol("RCB").description("}").action([&](std::string_view str) -> Value { return emplace_back(TokenType::RCB, std::string{str}); });
-	_parser.token("\\[").symbol("LSQB").description("[").action([&](std::string_view str) -> Value { return emplace_back(TokenType::LSQB, std::string{str}); });
-	_parser.token("\\]").symbol("RSQB").description("]").action([&](std::string_view str) -> Value { return emplace_back(TokenType::RSQB, std::string{str}); });
-	_parser.token("=").states("@default", "$meta").symbol("ASSIGN").description("=").action([&](std::string_view str) -> Value { return emplace_back(TokenType::ASSIGN, std::string{str}); });
-	_parser.token(":").states("@default", "$meta").symbol("COLON").description(":").action([&](std::string_view str) -> Value { return emplace_back(TokenType::COLON, std::string{str}); });
-	_parser.token(",").symbol("COMMA").description(",").action([&](std::string_view str) -> Value { return emplace_back(TokenType::COMMA, std::string{str}); })
+	_parser.token("\\}").symbol("RCB").description("}").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::RCB, str); });
+	_parser.token("\\[").symbol("LSQB").description("[").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::LSQB, str); });
+	_parser.token("\\]").symbol("RSQB").description("]").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::RSQB, str); });
+	_parser.token("=").states("@default", "$meta").symbol("ASSIGN").description("=").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::ASSIGN, str); });
+	_parser.token(":").states("@default", "$meta").symbol("COLON").description(":").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::COLON, str); });
+	_parser.token(",").symbol("COMMA").description(",").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::COMMA, str); })
 		.precedence(1, pog::Associativity::Left);
 	_parser.token("/").states("@default").symbol("SLASH").description("/").action([&](std::string_view str) -> Value {
 		enter_state("$regexp");
 		return std::string{str};
 	});
-	_parser.token("global").symbol("GLOBAL").description("global").action([&](std::string_view str) -> Value { return emplace_back(TokenType::GLOBAL, std::string{str}); });
-	_parser.token("private").symbol("PRIVATE").description("private").action([&](std::string_view str) -> Value { return emplace_back(TokenType::PRIVATE, std::string{str}); });
-	_parser.token("rule").symbol("RULE").description("rule").action([&](std::string_view str) -> Value { return emplace_back(TokenType::RULE, std::string{str}); });
-	_parser.token("meta").symbol("META").description("meta").enter_state("$meta").action([&](std::string_view str) -> Value { return emplace_back(TokenType::META, std::string{str}); });
+	_parser.token("global").symbol("GLOBAL").description("global").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::GLOBAL, str); });
+	_parser.token("private").symbol("PRIVATE").description("private").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::PRIVATE, str); });
+	_parser.token("rule").symbol("RULE").description("rule").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::RULE, str); });
+	_parser.token("meta").symbol("META").description("meta").enter_state("$meta").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::META, str); });
 	if (_features & Features::AvastOnly)
-		_parser.token("variables").symbol("VARIABLES").description("variables").action([&](std::string_view str) -> Value { return emplace_back(TokenType::VARIABLES, std::string{str}); });
-	_parser.token("strings").symbol("STRINGS").description("strings").action([&](std::string_view str) -> Value { sectionStrings(true); return emplace_back(TokenType::STRINGS, std::string{str}); });
-	_parser.token("condition").symbol("CONDITION").description("condition").action([&](std::string_view str) -> Value { sectionStrings(false); return emplace_back(TokenType::CONDITION, std::string{str}); });
-	_parser.token("ascii").symbol("ASCII").description("ascii").action([&](std::string_view str) -> Value { return emplace_back(TokenType::ASCII, std::string{str}); });
-	_parser.token("nocase").symbol("NOCASE").description("nocase").action([&](std::string_view str) -> Value { return emplace_back(TokenType::NOCASE, std::string{str}); });
-	_parser.token("wide").symbol("WIDE").description("wide").action([&](std::string_view str) -> Value { return emplace_back(TokenType::WIDE, std::string{str}); });
-	_parser.token("fullword").symbol("FULLWORD").description("fullword").action([&](std::string_view str) -> Value { return emplace_back(TokenType::FULLWORD, std::string{str}); });
-	_parser.token("xor").symbol("XOR").description("xor").action([&](std::string_view str) -> Value { return emplace_back(TokenType::XOR, std::string{str}); });
-	_parser.token("base64").symbol("BASE64").description("base64").action([&](std::string_view str) -> Value { return emplace_back(TokenType::BASE64, std::string{str}); });
-	_parser.token("base64wide").symbol("BASE64WIDE").description("base64wide").action([&](std::string_view str) -> Value { return emplace_back(TokenType::BASE64WIDE, std::string{str}); });
+		_parser.token("variables").symbol("VARIABLES").description("variables").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::VARIABLES, str); });
+	_parser.token("strings").symbol("STRINGS").description("strings").action([&](std::string_view str) -> Value { sectionStrings(true); return emplace_interned(TokenType::STRINGS, str); });
+	_parser.token("condition").symbol("CONDITION").description("condition").action([&](std::string_view str) -> Value { sectionStrings(false); return emplace_interned(TokenType::CONDITION, str); });
+	_parser.token("ascii").symbol("ASCII").description("ascii").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::ASCII, str); });
+	_parser.token("nocase").symbol("NOCASE").description("nocase").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::NOCASE, str); });
+	_parser.token("wide").symbol("WIDE").description("wide").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::WIDE, str); });
+	_parser.token("fullword").symbol("FULLWORD").description("fullword").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::FULLWORD, str); });
+	_parser.token("xor").symbol("XOR").description("xor").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::XOR, str); });
+	_parser.token("base64").symbol("BASE64").description("base64").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::BASE64, str); });
+	_parser.token("base64wide").symbol("BASE64WIDE").description("base64wide").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::BASE64WIDE, str); });
 	_parser.token("true").states("@default", "$meta").symbol("BOOL_TRUE").description("true").action([&](std::string_view) -> Value { return emplace_back(TokenType::BOOL_TRUE, true); });
 	_parser.token("false").states("@default", "$meta").symbol("BOOL_FALSE").description("false").action([&](std::string_view) -> Value { return emplace_back(TokenType::BOOL_FALSE, false); });
-	_parser.token("import").symbol("IMPORT_KEYWORD").description("import").action([&](std::string_view str) -> Value { return emplace_back(TokenType::IMPORT_KEYWORD, std::string{str}); });
-	_parser.token("not").symbol("NOT").description("not").action([&](std::string_view str) -> Value { return emplace_back(TokenType::NOT, std::string{str}); })
+	_parser.token("import").symbol("IMPORT_KEYWORD").description("import").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::IMPORT_KEYWORD, str); });
+	_parser.token("not").symbol("NOT").description("not").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::NOT, str); })
 		.precedence(14, pog::Associativity::Right);
 	if (_features & Features::AvastOnly) {
 		_parser.token("defined").symbol("DEFINED").description("defined").action(
 						[&](std::string_view str) -> Value {
-							return emplace_back(TokenType::DEFINED, std::string{str});
+							return emplace_interned(TokenType::DEFINED, str);
 						})
 				.precedence(15, pog::Associativity::Right);
 	}
-	_parser.token("and").symbol("AND").description("and").action([&](std::string_view str) -> Value { return emplace_back(TokenType::AND, std::string{str}); })
+	_parser.token("and").symbol("AND").description("and").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::AND, str); })
 		.precedence(5, pog::Associativity::Left);
-	_parser.token("or").symbol("OR").description("or").action([&](std::string_view str) -> Value { return emplace_back(TokenType::OR, std::string{str}); })
+	_parser.token("or").symbol("OR").description("or").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::OR, str); })
 		.precedence(4, pog::Associativity::Left);
-	_parser.token("all").symbol("ALL").description("all").action([&](std::string_view str) -> Value { return emplace_back(TokenType::ALL, std::string{str}); });
-	_parser.token("any").symbol("ANY").description("any").action([&](std::string_view str) -> Value { return emplace_back(TokenType::ANY, std::string{str}); });
-	_parser.token("none").symbol("NONE").description("none").action([&](std::string_view str) -> Value { return emplace_back(TokenType::NONE, std::string{str}); });
-	_parser.token("of").symbol("OF").description("of").action([&](std::string_view str) -> Value { return emplace_back(TokenType::OF, std::string{str}); });
-	_parser.token("them").symbol("THEM").description("them").action([&](std::string_view str) -> Value { return emplace_back(TokenType::THEM, std::string{str}); });
-	_parser.token("for").symbol("FOR").description("for").action([&](std::string_view str) -> Value { return emplace_back(TokenType::FOR, std::string{str}); });
-	_parser.token("entrypoint").symbol("ENTRYPOINT").description("entrypoint").action([&](std::string_view str) -> Value { return emplace_back(TokenType::ENTRYPOINT, std::string{str}); });
-	_parser.token("at").symbol("AT").description("at").action([&](std::string_view str) -> Value { return emplace_back(TokenType::OP_AT, std::string{str}); });
-	_parser.token("in").symbol("IN").description("in").action([&](std::string_view str) -> Value { return emplace_back(TokenType::OP_IN, std::string{str}); });
-	_parser.token("filesize").symbol("FILESIZE").description("filesize").action([&](std::string_view str) -> Value { return emplace_back(TokenType::FILESIZE, std::string{str}); });
-	_parser.token("contains").symbol("CONTAINS").description("contains").action([&](std::string_view str) -> Value { return emplace_back(TokenType::CONTAINS, std::string{str}); });
-	_parser.token("icontains").symbol("ICONTAINS").description("icontains").action([&](std::string_view str) -> Value { return emplace_back(TokenType::ICONTAINS, std::string{str}); });
-	_parser.token("matches").symbol("MATCHES").description("matches").action([&](std::string_view str) -> Value { return emplace_back(TokenType::MATCHES, std::string{str}); });
-	_parser.token("startswith").symbol("STARTSWITH").description("startswith").action([&](std::string_view str) -> Value { return emplace_back(TokenType::STARTSWITH, std::string{str}); });
-	_parser.token("istartswith").symbol("ISTARTSWITH").description("istartswith").action([&](std::string_view str) -> Value { return emplace_back(TokenType::ISTARTSWITH, std::string{str}); });
-	_parser.token("endswith").symbol("ENDSWITH").description("endswith").action([&](std::string_view str) -> Value { return emplace_back(TokenType::ENDSWITH, std::string{str}); });
-	_parser.token("iendswith").symbol("IENDSWITH").description("iendswith").action([&](std::string_view str) -> Value { return emplace_back(TokenType::IENDSWITH, std::string{str}); });
-	_parser.token("iequals").symbol("IEQUALS").description("iequals").action([&](std::string_view str) -> Value { return emplace_back(TokenType::IEQUALS, std::string{str}); });
-	_parser.token("with").symbol("WITH").description("with").action([&](std::string_view str) -> Value { return emplace_back(TokenType::WITH, std::string{str}); });
+	_parser.token("all").symbol("ALL").description("all").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::ALL, str); });
+	_parser.token("any").symbol("ANY").description("any").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::ANY, str); });
+	_parser.token("none").symbol("NONE").description("none").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::NONE, str); });
+	_parser.token("of").symbol("OF").description("of").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::OF, str); });
+	_parser.token("them").symbol("THEM").description("them").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::THEM, str); });
+	_parser.token("for").symbol("FOR").description("for").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::FOR, str); });
+	_parser.token("entrypoint").symbol("ENTRYPOINT").description("entrypoint").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::ENTRYPOINT, str); });
+	_parser.token("at").symbol("AT").description("at").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::OP_AT, str); });
+	_parser.token("in").symbol("IN").description("in").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::OP_IN, str); });
+	_parser.token("filesize").symbol("FILESIZE").description("filesize").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::FILESIZE, str); });
+	_parser.token("contains").symbol("CONTAINS").description("contains").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::CONTAINS, str); });
+	_parser.token("icontains").symbol("ICONTAINS").description("icontains").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::ICONTAINS, str); });
+	_parser.token("matches").symbol("MATCHES").description("matches").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::MATCHES, str); });
+	_parser.token("startswith").symbol("STARTSWITH").description("startswith").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::STARTSWITH, str); });
+	_parser.token("istartswith").symbol("ISTARTSWITH").description("istartswith").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::ISTARTSWITH, str); });
+	_parser.token("endswith").symbol("ENDSWITH").description("endswith").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::ENDSWITH, str); });
+	_parser.token("iendswith").symbol("IENDSWITH").description("iendswith").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::IENDSWITH, str); });
+	_parser.token("iequals").symbol("IEQUALS").description("iequals").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::IEQUALS, str); });
+	_parser.token("with").symbol("WITH").description("with").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::WITH, str); });
 
 	// $include
 	_parser.token("include").symbol("INCLUDE_DIRECTIVE").description("include").enter_state("$include").action([&](std::string_view str) -> Value {
-		return emplace_back(TokenType::INCLUDE_DIRECTIVE, std::string{str});
+		return emplace_interned(TokenType::INCLUDE_DIRECTIVE, str);
 	});
 	_parser.token("\r\n|\n").states("$include").action([&](std::string_view str) -> Value {
 		currentFileContext()->getLocation().addLine();
 		currentFileContext()->getTokenStream()->setNewLineChar(std::string{str});
-		return emplace_back(TokenType::NEW_LINE, std::string{str});
+		return emplace_interned(TokenType::NEW_LINE, str);
 	});
 	_parser.token(R"([ \v\t])").states("$include");
 	_parser.token(R"(\")").states("$include").enter_state("$include_file");
 	//$include_file
 	_parser.token(R"([^"]+\")").symbol("INCLUDE_FILE").description("include path").states("$include_file").enter_state("@default").action([&](std::string_view str) -> Value {
 		auto filePath = std::string{str}.substr(0, str.size()-1);
+		if (_reparsing)
+			error_handle(currentFileContext()->getLocation(), "Include can't be parsed again without the rest of the file");
 		TokenIt includeToken = emplace_back(TokenType::INCLUDE_PATH, filePath);
 		if (!deferredIncludeMode())
 		{
-			const auto& ts = includeToken->initializeSubTokenStream();
-			if (!includeFile(filePath, ts))
+			if (!includeFile(filePath, includeToken))
 			{
 				if (!incompleteMode())
 					error_handle(currentFileContext()->getLocation(), "Unable to include file '" + filePath + "'");
@@ -233,10 +364,10 @@ void ParserDriver::defineTokens()
 	});
 
 	// Exit meta state when encountering section keywords or rule end
-	_parser.token("strings").states("$meta").enter_state("@default").symbol("STRINGS").description("strings").action([&](std::string_view str) -> Value { return emplace_back(TokenType::STRINGS, std::string{str}); });
-	_parser.token("condition").states("$meta").enter_state("@default").symbol("CONDITION").description("condition").action([&](std::string_view str) -> Value { return emplace_back(TokenType::CONDITION, std::string{str}); });
-	_parser.token("variables").states("$meta").enter_state("@default").symbol("VARIABLES").description("variables").action([&](std::string_view str) -> Value { return emplace_back(TokenType::VARIABLES, std::string{str}); });
-	_parser.token("\\}").states("$meta").enter_state("@default").symbol("RCB").description("}").action([&](std::string_view str) -> Value { return emplace_back(TokenType::RCB, std::string{str}); });
+	_parser.token("strings").states("$meta").enter_state("@default").symbol("STRINGS").description("strings").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::STRINGS, str); });
+	_parser.token("condition").states("$meta").enter_state("@default").symbol("CONDITION").description("condition").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::CONDITION, str); });
+	_parser.token("variables").states("$meta").enter_state("@default").symbol("VARIABLES").description("variables").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::VARIABLES, str); });
+	_parser.token("\\}").states("$meta").enter_state("@default").symbol("RCB").description("}").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::RCB, str); });
 
 	_parser.token(R"(\/\/[^\n]*)").states("@default", "$meta", "$hexstr", "@hexstr_jump").action([&](std::string_view str) -> Value {
 		auto it = emplace_back(TokenType::ONELINE_COMMENT, std::string{str}, _indent);
@@ -300,37 +431,37 @@ void ParserDriver::defineTokens()
 
 	// $str end
 
-	_parser.token("u?int(8|16|32)(be)?").symbol("INTEGER_FUNCTION").description("fixed-width integer function").action([&](std::string_view str) -> Value { return emplace_back(TokenType::INTEGER_FUNCTION, std::string{str}); });
-	_parser.token(R"(\$[0-9a-zA-Z_]*)").symbol("STRING_ID").description("string identifier").action([&](std::string_view str) -> Value { return emplace_back(TokenType::STRING_ID, std::string{str}); });
+	_parser.token("u?int(8|16|32)(be)?").symbol("INTEGER_FUNCTION").description("fixed-width integer function").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::INTEGER_FUNCTION, str); });
+	_parser.token(R"(\$[0-9a-zA-Z_]*)").symbol("STRING_ID").description("string identifier").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::STRING_ID, str); });
 
-	_parser.token(R"(\$[0-9a-zA-Z_]*\*)").symbol("STRING_ID_WILDCARD").description("string wildcard").action([&](std::string_view str) -> Value { return emplace_back(TokenType::STRING_ID_WILDCARD, std::string{str}); });
-	_parser.token(R"(\#[0-9a-zA-Z_]*)").symbol("STRING_COUNT").description("string count").action([&](std::string_view str) -> Value { return emplace_back(TokenType::STRING_COUNT, std::string{str}); });
-	_parser.token(R"(\@[0-9a-zA-Z_]*)").symbol("STRING_OFFSET").description("string offset").action([&](std::string_view str) -> Value { return emplace_back(TokenType::STRING_OFFSET, std::string{str}); });
-	_parser.token(R"(\![0-9a-zA-Z_]*)").symbol("STRING_LENGTH").description("string length").action([&](std::string_view str) -> Value { return emplace_back(TokenType::STRING_LENGTH, std::string{str}); });
-	_parser.token("[a-zA-Z_][0-9a-zA-Z_]*").states("@default", "$meta").symbol("ID").description("identifier").action([&](std::string_view str) -> Value { return emplace_back(TokenType::ID, std::string{str}); });
+	_parser.token(R"(\$[0-9a-zA-Z_]*\*)").symbol("STRING_ID_WILDCARD").description("string wildcard").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::STRING_ID_WILDCARD, str); });
+	_parser.token(R"(\#[0-9a-zA-Z_]*)").symbol("STRING_COUNT").description("string count").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::STRING_COUNT, str); });
+	_parser.token(R"(\@[0-9a-zA-Z_]*)").symbol("STRING_OFFSET").description("string offset").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::STRING_OFFSET, str); });
+	_parser.token(R"(\![0-9a-zA-Z_]*)").symbol("STRING_LENGTH").description("string length").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::STRING_LENGTH, str); });
+	_parser.token("[a-zA-Z_][0-9a-zA-Z_]*").states("@default", "$meta").symbol("ID").description("identifier").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::ID, str); });
 
 	_parser.token(R"([0-9]+\.[0-9]+)").symbol("DOUBLE").description("float").action([&](std::string_view str) -> Value { return emplace_back(TokenType::DOUBLE, std::stod(std::string(str))); });
 
 	// $hexstr
-	_parser.token(R"(\|)").states("$hexstr").symbol("HEX_OR").description("hex string |").action([&](std::string_view str) -> Value { return emplace_back(TokenType::HEX_ALT, std::string{str}); });
-	_parser.token(R"(\()").states("$hexstr").symbol("LP").description("hex string (").action([&](std::string_view str) -> Value { return emplace_back(TokenType::LP, std::string{str}); });
-	_parser.token(R"(\))").states("$hexstr").symbol("RP").description("hex string )").action([&](std::string_view str) -> Value { return emplace_back(TokenType::RP, std::string{str}); });
-	_parser.token(R"(\?)").states("$hexstr").symbol("HEX_WILDCARD").description("hex string ?").action([&](std::string_view str) -> Value { return emplace_back(TokenType::HEX_WILDCARD, std::string{str}); });
-	_parser.token(R"(\~)").states("$hexstr").symbol("HEX_NOT").description("hex string ~").action([&](std::string_view str) -> Value { return emplace_back(TokenType::HEX_NOT, std::string{str}); });
+	_parser.token(R"(\|)").states("$hexstr").symbol("HEX_OR").description("hex string |").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::HEX_ALT, str); });
+	_parser.token(R"(\()").states("$hexstr").symbol("LP").description("hex string (").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::LP, str); });
+	_parser.token(R"(\))").states("$hexstr").symbol("RP").description("hex string )").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::RP, str); });
+	_parser.token(R"(\?)").states("$hexstr").symbol("HEX_WILDCARD").description("hex string ?").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::HEX_WILDCARD, str); });
+	_parser.token(R"(\~)").states("$hexstr").symbol("HEX_NOT").description("hex string ~").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::HEX_NOT, str); });
 	_parser.token(R"(\})").states("$hexstr").enter_state("@default").symbol("RCB").description("}").action([&](std::string_view) -> Value { return emplace_back(TokenType::RCB, "}"); });
 	_parser.token("[0-9a-fA-F]").states("$hexstr").symbol("HEX_NIBBLE").description("hex string nibble").action([&](std::string_view str) -> Value {
 		std::uint8_t digit = ('A' <= std::toupper(str[0]) && std::toupper(str[0]) <= 'F') ? std::toupper(str[0]) - 'A' + 10 : str[0] - '0';
 		return emplace_back(TokenType::HEX_NIBBLE, static_cast<std::uint64_t>(digit), std::string{str});
 	});
-	_parser.token(R"(\[)").states("$hexstr").enter_state("$hexstr_jump").symbol("LSQB").description("hex string [").action([&](std::string_view str) -> Value { return emplace_back(TokenType::HEX_JUMP_LEFT_BRACKET, std::string{str}); });
+	_parser.token(R"(\[)").states("$hexstr").enter_state("$hexstr_jump").symbol("LSQB").description("hex string [").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::HEX_JUMP_LEFT_BRACKET, str); });
 	_parser.token("[0-9]*").states("$hexstr_jump").symbol("HEX_INTEGER").description("hex string integer").action([&](std::string_view str) -> Value {
 		std::string numStr = std::string{str};
 		std::uint64_t num = 0;
 		strToNum(numStr, num, std::dec);
 		return emplace_back(TokenType::INTEGER, num, numStr);
 	});
-	_parser.token(R"(\-)").states("$hexstr_jump").symbol("DASH").description("hex string -").action([&](std::string_view str) -> Value { return emplace_back(TokenType::DASH, std::string{str}); });
-	_parser.token(R"(\])").states("$hexstr_jump").symbol("RSQB").description("hex string ]").enter_state("$hexstr").action([&](std::string_view str) -> Value { return emplace_back(TokenType::HEX_JUMP_RIGHT_BRACKET, std::string{str}); });
+	_parser.token(R"(\-)").states("$hexstr_jump").symbol("DASH").description("hex string -").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::DASH, str); });
+	_parser.token(R"(\])").states("$hexstr_jump").symbol("RSQB").description("hex string ]").enter_state("$hexstr").action([&](std::string_view str) -> Value { return emplace_interned(TokenType::HEX_JUMP_RIGHT_BRACKET, str); });
 
 	// tokens are not delegated with return Value but created in grammar rules actions
 	_parser.token(R"(//[^\n]*)").states("$hexstr_jump").action([](std::string_view str) -> Value { return std::string{str}; });
@@ -460,10 +591,18 @@ void ParserDriver::defineTokens()
 
 void ParserDriver::defineGrammar()
 {
+	// Last item of an included file is finished only when the first token after the file is read
+	auto const finish_item = [&](auto&&) -> Value {
+		finishIncludeRecordings();
+		if (recoveringErrors() && _fileContexts.size() == 1)
+			markRecoveryPoint();
+		return {};
+	};
+
 	_parser.rule("rules")
-		.production("rules", "rule")
-		.production("rules", "import")
-		.production("rules", "include")
+		.production("rules", "rule", finish_item)
+		.production("rules", "import", finish_item)
+		.production("rules", "include", finish_item)
 		.production()
 		;
 
@@ -471,11 +610,18 @@ void ParserDriver::defineGrammar()
 		.production("IMPORT_KEYWORD", "STRING_LITERAL", [&](auto&& args) -> Value {
 			TokenIt import = args[1].getTokenIt();
 			import->setType(TokenType::IMPORT_MODULE);
+			if (_reparsing)
+				error_handle(import->getLocation(), "Import can't be parsed again without the rest of the file");
+			if (auto* profile = activeProfile())
+				profile->addImport();
+			ParserProfile::Scope scope(activeProfile(), ParserPhase::ModuleLoading);
 			if (!_file.addImport(import, *_modules))
 			{
 				if (!incompleteMode())
 					error_handle(import->getLocation(), "Unrecognized module '" + import->getString() + "' imported");
 			}
+			else
+				recordImport(import);
 			return {};
 		})
 		;
@@ -486,7 +632,12 @@ void ParserDriver::defineGrammar()
 		})
 		;
 
-	auto const common_last_rule = [&](auto&&) -> Value {
+	auto const common_last_rule = [&](auto&& args) -> Value {
+		if (streamingMode())
+		{
+			const auto& mods = args[0].getMultipleTokenIt();
+			beginStreamedRule(mods.empty() ? args[1].getTokenIt() : mods.front());
+		}
 		_lastRuleLocation = currentFileContext()->getLocation();
 		_lastRuleTokenStream = currentFileContext()->getTokenStream();
 		return {};
@@ -497,7 +648,10 @@ void ParserDriver::defineGrammar()
 		if (ruleExists(name_text))
 			error_handle(args[3].getTokenIt()->getLocation(), "Redefinition of rule '" + args[3].getTokenIt()->getString() + "'");
 		args[3].getTokenIt()->setType(TokenType::RULE_NAME);
-		args[3].getTokenIt()->setValue(std::make_shared<ValueSymbol>(name_text, Expression::Type::Bool));
+		if (auto itr = _reparsedRules.find(name_text); itr != _reparsedRules.end())
+			args[3].getTokenIt()->setValue(itr->second);
+		else
+			args[3].getTokenIt()->setValue(std::make_shared<ValueSymbol>(name_text, Expression::Type::Bool));
 		return {};
 	};
 
@@ -1109,7 +1263,7 @@ void ParserDriver::defineGrammar()
 
 	_parser.rule("expression") // Expression::Ptr
 		.production("boolean", [&](auto&& args) -> Value {
-			auto output = std::make_shared<BoolLiteralExpression>(currentTokenStream(), args[0].getTokenIt());
+			auto output = makeExpression<BoolLiteralExpression>(currentTokenStream(), args[0].getTokenIt());
 			output->setType(Expression::Type::Bool);
 			output->setUid(_uidGen.next());
 			return output;
@@ -1121,7 +1275,7 @@ void ParserDriver::defineGrammar()
 				error_handle(id->getLocation(), "Reference to undefined string '" + id->getString() + "'");
 			if (id->getString().size() > 1)
 				id->setValue(findStringDefinition(id->getString()));
-			auto output = std::make_shared<StringExpression>(std::move(id));
+			auto output = makeExpression<StringExpression>(std::move(id));
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1138,7 +1292,7 @@ void ParserDriver::defineGrammar()
 			Expression::Ptr expr = args[2].getExpression();
 			if (!expr->isInt())
 				error_handle(args[1].getTokenIt()->getLocation(), "Operator 'at' expects integer on the right-hand side of the expression");
-			auto output = std::make_shared<StringAtExpression>(id, op, std::move(expr));
+			auto output = makeExpression<StringAtExpression>(id, op, std::move(expr));
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1154,7 +1308,7 @@ void ParserDriver::defineGrammar()
 			TokenIt op = args[1].getTokenIt();
 			Expression::Ptr range = args[2].getExpression();
 
-			auto output = std::make_shared<StringInRangeExpression>(id, op, std::move(range));
+			auto output = makeExpression<StringInRangeExpression>(id, op, std::move(range));
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1181,7 +1335,7 @@ void ParserDriver::defineGrammar()
 				removeLocalSymbol(id->getString());
 				lp->setType(TokenType::LP_WITH_SPACE_AFTER);
 				rp->setType(TokenType::RP_WITH_SPACE_BEFORE);
-				auto output = std::make_shared<ForArrayExpression>(for_token, std::move(for_expr), id, op_in, std::move(set), lp, std::move(expr), rp);
+				auto output = makeExpression<ForArrayExpression>(for_token, std::move(for_expr), id, op_in, std::move(set), lp, std::move(expr), rp);
 				output->setType(Expression::Type::Bool);
 				output->setTokenStream(currentTokenStream());
 				output->setUid(_uidGen.next());
@@ -1237,7 +1391,7 @@ void ParserDriver::defineGrammar()
 				removeLocalSymbol(id->getString());
 				lp->setType(TokenType::LP_WITH_SPACE_AFTER);
 				rp->setType(TokenType::RP_WITH_SPACE_BEFORE);
-				auto output = std::make_shared<ForArrayExpression>(for_token, std::move(for_expr), id, op_in, std::move(array), lp, std::move(expr), rp);
+				auto output = makeExpression<ForArrayExpression>(for_token, std::move(for_expr), id, op_in, std::move(array), lp, std::move(expr), rp);
 				output->setType(Expression::Type::Bool);
 				output->setTokenStream(currentTokenStream());
 				output->setUid(_uidGen.next());
@@ -1300,7 +1454,7 @@ void ParserDriver::defineGrammar()
 				removeLocalSymbol(id2->getString());
 				lp->setType(TokenType::LP_WITH_SPACE_AFTER);
 				rp->setType(TokenType::RP_WITH_SPACE_BEFORE);
-				auto output = std::make_shared<ForDictExpression>(for_token, std::move(for_expr), id1, comma, id2, op_in, std::move(dict), lp, std::move(expr), rp);
+				auto output = makeExpression<ForDictExpression>(for_token, std::move(for_expr), id1, comma, id2, op_in, std::move(dict), lp, std::move(expr), rp);
 				output->setType(Expression::Type::Bool);
 				output->setTokenStream(currentTokenStream());
 				output->setUid(_uidGen.next());
@@ -1326,7 +1480,7 @@ void ParserDriver::defineGrammar()
 
 				lp->setType(TokenType::LP_WITH_SPACE_AFTER);
 				rp->setType(TokenType::RP_WITH_SPACE_BEFORE);
-				auto output = std::make_shared<ForStringExpression>(for_token, std::move(for_expr), of, std::move(set), lp, std::move(expr), rp);
+				auto output = makeExpression<ForStringExpression>(for_token, std::move(for_expr), of, std::move(set), lp, std::move(expr), rp);
 				output->setType(Expression::Type::Bool);
 				output->setTokenStream(currentTokenStream());
 				output->setUid(_uidGen.next());
@@ -1392,13 +1546,13 @@ void ParserDriver::defineGrammar()
 			auto of_location_spec = std::move(args[3].getOfLocationSpec());
 			Expression::Ptr output;
 			if (!of_location_spec)
-				output = std::make_shared<OfExpression>(std::move(for_expr), of, std::move(array));
+				output = makeExpression<OfExpression>(std::move(for_expr), of, std::move(array));
 			else
 			{
 				auto of_location_spec_val = std::move(of_location_spec).value();
 				auto of_location_spec_token = std::get<0>(of_location_spec_val);
 				auto of_location_spec_expr = std::get<1>(of_location_spec_val);
-				output = std::make_shared<OfExpression>(std::move(for_expr), of, std::move(array), of_location_spec_token, std::move(of_location_spec_expr));
+				output = makeExpression<OfExpression>(std::move(for_expr), of, std::move(array), of_location_spec_token, std::move(of_location_spec_expr));
 			}
 
 			output->setType(Expression::Type::Bool);
@@ -1419,11 +1573,11 @@ void ParserDriver::defineGrammar()
 					error_handle(percent->getLocation(), ss.str());
 				}
 			}
-			auto percentual_expr = std::make_shared<PercentualExpression>(percent, std::move(for_expr));
+			auto percentual_expr = makeExpression<PercentualExpression>(percent, std::move(for_expr));
 			percentual_expr->setUid(_uidGen.next());
 			TokenIt of = args[2].getTokenIt();
 			auto set = std::move(args[3].getExpression());
-			auto output = std::make_shared<OfExpression>(std::move(percentual_expr), of, std::move(set));
+			auto output = makeExpression<OfExpression>(std::move(percentual_expr), of, std::move(set));
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1432,7 +1586,7 @@ void ParserDriver::defineGrammar()
 		.production("NOT", "expression", [&](auto&& args) -> Value {
 			TokenIt not_token = args[0].getTokenIt();
 			auto expr = std::move(args[1].getExpression());
-			auto output = std::make_shared<NotExpression>(not_token, std::move(expr));
+			auto output = makeExpression<NotExpression>(not_token, std::move(expr));
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1441,37 +1595,41 @@ void ParserDriver::defineGrammar()
 		.production("DEFINED", "expression", [&](auto&& args) -> Value {
 			TokenIt not_token = args[0].getTokenIt();
 			auto expr = std::move(args[1].getExpression());
-			auto output = std::make_shared<DefinedExpression>(not_token, std::move(expr));
+			auto output = makeExpression<DefinedExpression>(not_token, std::move(expr));
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
 			return output;
 		})
 		.production("expression", "AND", "expression", [&](auto&& args) -> Value {
-			auto left = std::move(args[0].getExpression());
+			// Left operand is moved out of the value, so its chain is continued in place
+			auto left = args[0].moveExpression();
 			TokenIt and_token = args[1].getTokenIt();
-			auto right = std::move(args[2].getExpression());
-			auto output = std::make_shared<AndExpression>(std::move(left), and_token, std::move(right));
+			auto right = args[2].moveExpression();
+			auto uid = _uidGen.next();
+			auto output = makeChainedExpression<AndExpression>(std::move(left), and_token, std::move(right), uid);
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
-			output->setUid(_uidGen.next());
+			output->setUid(uid);
 			return output;
 		})
 		.production("expression", "OR", "expression", [&](auto&& args) -> Value {
-			auto left = std::move(args[0].getExpression());
+			// Left operand is moved out of the value, so its chain is continued in place
+			auto left = args[0].moveExpression();
 			TokenIt or_token = args[1].getTokenIt();
-			auto right = std::move(args[2].getExpression());
-			auto output = std::make_shared<OrExpression>(std::move(left), or_token, std::move(right));
+			auto right = args[2].moveExpression();
+			auto uid = _uidGen.next();
+			auto output = makeChainedExpression<OrExpression>(std::move(left), or_token, std::move(right), uid);
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
-			output->setUid(_uidGen.next());
+			output->setUid(uid);
 			return output;
 		})
 		.production("primary_expression", "LT", "primary_expression", [&](auto&& args) -> Value {
 			auto left = std::move(args[0].getExpression());
 			TokenIt op_token = args[1].getTokenIt();
 			auto right = std::move(args[2].getExpression());
-			auto output = std::make_shared<LtExpression>(std::move(left), op_token, std::move(right));
+			auto output = makeExpression<LtExpression>(std::move(left), op_token, std::move(right));
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1481,7 +1639,7 @@ void ParserDriver::defineGrammar()
 			auto left = std::move(args[0].getExpression());
 			TokenIt op_token = args[1].getTokenIt();
 			auto right = std::move(args[2].getExpression());
-			auto output = std::make_shared<GtExpression>(std::move(left), op_token, std::move(right));
+			auto output = makeExpression<GtExpression>(std::move(left), op_token, std::move(right));
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1491,7 +1649,7 @@ void ParserDriver::defineGrammar()
 			auto left = std::move(args[0].getExpression());
 			TokenIt op_token = args[1].getTokenIt();
 			auto right = std::move(args[2].getExpression());
-			auto output = std::make_shared<LeExpression>(std::move(left), op_token, std::move(right));
+			auto output = makeExpression<LeExpression>(std::move(left), op_token, std::move(right));
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1501,7 +1659,7 @@ void ParserDriver::defineGrammar()
 			auto left = std::move(args[0].getExpression());
 			TokenIt op_token = args[1].getTokenIt();
 			auto right = std::move(args[2].getExpression());
-			auto output = std::make_shared<GeExpression>(std::move(left), op_token, std::move(right));
+			auto output = makeExpression<GeExpression>(std::move(left), op_token, std::move(right));
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1511,7 +1669,7 @@ void ParserDriver::defineGrammar()
 			auto left = std::move(args[0].getExpression());
 			TokenIt op_token = args[1].getTokenIt();
 			auto right = std::move(args[2].getExpression());
-			auto output = std::make_shared<EqExpression>(std::move(left), op_token, std::move(right));
+			auto output = makeExpression<EqExpression>(std::move(left), op_token, std::move(right));
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1521,7 +1679,7 @@ void ParserDriver::defineGrammar()
 			auto left = std::move(args[0].getExpression());
 			TokenIt op_token = args[1].getTokenIt();
 			auto right = std::move(args[2].getExpression());
-			auto output = std::make_shared<NeqExpression>(std::move(left), op_token, std::move(right));
+			auto output = makeExpression<NeqExpression>(std::move(left), op_token, std::move(right));
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1535,7 +1693,7 @@ void ParserDriver::defineGrammar()
 				error_handle(op_token->getLocation(), "operator 'contains' expects string on the left-hand side of the expression");
 			if (!right->isString())
 				error_handle(op_token->getLocation(), "operator 'contains' expects string on the right-hand side of the expression");
-			auto output = std::make_shared<ContainsExpression>(std::move(left), op_token, std::move(right));
+			auto output = makeExpression<ContainsExpression>(std::move(left), op_token, std::move(right));
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1549,7 +1707,7 @@ void ParserDriver::defineGrammar()
 				error_handle(op_token->getLocation(), "operator 'icontains' expects string on the left-hand side of the expression");
 			if (!right->isString())
 				error_handle(op_token->getLocation(), "operator 'icontains' expects string on the right-hand side of the expression");
-			auto output = std::make_shared<IcontainsExpression>(std::move(left), op_token, std::move(right));
+			auto output = makeExpression<IcontainsExpression>(std::move(left), op_token, std::move(right));
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1561,8 +1719,8 @@ void ParserDriver::defineGrammar()
 			auto right = std::move(args[2].getYaramodString());
 			if (!left->isString())
 				error_handle(op_token->getLocation(), "operator 'matches' expects string on the left-hand side of the expression");
-			auto regexp_expression = std::make_shared<RegexpExpression>(std::static_pointer_cast<Regexp>(right));
-			auto output = std::make_shared<MatchesExpression>(std::move(left), op_token, std::move(regexp_expression));
+			auto regexp_expression = makeExpression<RegexpExpression>(std::static_pointer_cast<Regexp>(right));
+			auto output = makeExpression<MatchesExpression>(std::move(left), op_token, std::move(regexp_expression));
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1576,7 +1734,7 @@ void ParserDriver::defineGrammar()
 				error_handle(op_token->getLocation(), "operator 'startswith' expects string on the left-hand side of the expression");
 			if (!right->isString())
 				error_handle(op_token->getLocation(), "operator 'startswith' expects string on the right-hand side of the expression");
-			auto output = std::make_shared<StartsWithExpression>(std::move(left), op_token, std::move(right));
+			auto output = makeExpression<StartsWithExpression>(std::move(left), op_token, std::move(right));
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1590,7 +1748,7 @@ void ParserDriver::defineGrammar()
 				error_handle(op_token->getLocation(), "operator 'istartswith' expects string on the left-hand side of the expression");
 			if (!right->isString())
 				error_handle(op_token->getLocation(), "operator 'istartswith' expects string on the right-hand side of the expression");
-			auto output = std::make_shared<IstartsWithExpression>(std::move(left), op_token, std::move(right));
+			auto output = makeExpression<IstartsWithExpression>(std::move(left), op_token, std::move(right));
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1604,7 +1762,7 @@ void ParserDriver::defineGrammar()
 				error_handle(op_token->getLocation(), "operator 'endswith' expects string on the left-hand side of the expression");
 			if (!right->isString())
 				error_handle(op_token->getLocation(), "operator 'endswith' expects string on the right-hand side of the expression");
-			auto output = std::make_shared<EndsWithExpression>(std::move(left), op_token, std::move(right));
+			auto output = makeExpression<EndsWithExpression>(std::move(left), op_token, std::move(right));
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1618,7 +1776,7 @@ void ParserDriver::defineGrammar()
 				error_handle(op_token->getLocation(), "operator 'iendswith' expects string on the left-hand side of the expression");
 			if (!right->isString())
 				error_handle(op_token->getLocation(), "operator 'iendswith' expects string on the right-hand side of the expression");
-			auto output = std::make_shared<IendsWithExpression>(std::move(left), op_token, std::move(right));
+			auto output = makeExpression<IendsWithExpression>(std::move(left), op_token, std::move(right));
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1632,7 +1790,7 @@ void ParserDriver::defineGrammar()
 				error_handle(op_token->getLocation(), "operator 'iequals' expects string on the left-hand side of the expression");
 			if (!right->isString())
 				error_handle(op_token->getLocation(), "operator 'iequals' expects string on the right-hand side of the expression");
-			auto output = std::make_shared<IequalsExpression>(std::move(left), op_token, std::move(right));
+			auto output = makeExpression<IequalsExpression>(std::move(left), op_token, std::move(right));
 			output->setType(Expression::Type::Bool);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1644,7 +1802,7 @@ void ParserDriver::defineGrammar()
 		.production("LP", "expression", "RP", [&](auto&& args) -> Value {
 			auto expr = std::move(args[1].getExpression());
 			auto type = expr->getType();
-			auto output = std::make_shared<ParenthesesExpression>(args[0].getTokenIt(), std::move(expr), args[2].getTokenIt());
+			auto output = makeExpression<ParenthesesExpression>(args[0].getTokenIt(), std::move(expr), args[2].getTokenIt());
 			output->setType(type);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1658,7 +1816,7 @@ void ParserDriver::defineGrammar()
 			{
 				removeLocalSymbol(std::static_pointer_cast<const VariableDefExpression>(var)->getName());
 			}
-			auto output = std::make_shared<WithExpression>(args[0].getTokenIt(), std::move(vars), args[3].getTokenIt(), std::move(body), args[5].getTokenIt());
+			auto output = makeExpression<WithExpression>(args[0].getTokenIt(), std::move(vars), args[3].getTokenIt(), std::move(body), args[5].getTokenIt());
 			output->setType(type);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1668,7 +1826,7 @@ void ParserDriver::defineGrammar()
 			TokenIt id = args[0].getTokenIt();
 			if (!stringExists(id->getPureText()))
 				error_handle(id->getLocation(), "No string matched with wildcard '" + id->getPureText() + "'");
-			auto output = std::make_shared<StringWildcardExpression>(id);
+			auto output = makeExpression<StringWildcardExpression>(id);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
 			return output;
@@ -1716,7 +1874,7 @@ void ParserDriver::defineGrammar()
 				error_handle(currentFileContext()->getLocation(), "Redefinition of identifier " + name->getString());
 			}
 
-			auto output = std::make_shared<VariableDefExpression>(std::move(name), std::move(expr));
+			auto output = makeExpression<VariableDefExpression>(std::move(name), std::move(expr));
 			output->setUid(_uidGen.next());
 			return output;
 		})
@@ -1725,39 +1883,39 @@ void ParserDriver::defineGrammar()
 	_parser.rule("primary_expression") // Expression::Ptr
 		.production("LP", "primary_expression", "RP", [&](auto&& args) -> Value {
 			auto type = args[1].getExpression()->getType();
-			auto output = std::make_shared<ParenthesesExpression>(args[0].getTokenIt(), std::move(args[1].getExpression()), args[2].getTokenIt());
+			auto output = makeExpression<ParenthesesExpression>(args[0].getTokenIt(), std::move(args[1].getExpression()), args[2].getTokenIt());
 			output->setType(type);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
 			return output;
 		})
 		.production("FILESIZE", [&](auto&& args) -> Value {
-			auto output = std::make_shared<FilesizeExpression>(args[0].getTokenIt());
+			auto output = makeExpression<FilesizeExpression>(args[0].getTokenIt());
 			output->setType(Expression::Type::Int);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
 			return output;
 		})
 		.production("ENTRYPOINT", [&](auto&& args) -> Value {
-			auto output = std::make_shared<EntrypointExpression>(args[0].getTokenIt());
+			auto output = makeExpression<EntrypointExpression>(args[0].getTokenIt());
 			output->setType(Expression::Type::Int);
 			output->setUid(_uidGen.next());
 			return output;
 		})
 		.production("INTEGER", [&](auto&& args) -> Value {
-			auto output = std::make_shared<IntLiteralExpression>(currentTokenStream(), args[0].getTokenIt());
+			auto output = makeExpression<IntLiteralExpression>(currentTokenStream(), args[0].getTokenIt());
 			output->setType(Expression::Type::Int);
 			output->setUid(_uidGen.next());
 			return output;
 		})
 		.production("DOUBLE", [&](auto&& args) -> Value {
-			auto output = std::make_shared<DoubleLiteralExpression>(currentTokenStream(), args[0].getTokenIt());
+			auto output = makeExpression<DoubleLiteralExpression>(currentTokenStream(), args[0].getTokenIt());
 			output->setType(Expression::Type::Float);
 			output->setUid(_uidGen.next());
 			return output;
 		})
 		.production("STRING_LITERAL", [&](auto&& args) -> Value {
-			auto output = std::make_shared<StringLiteralExpression>(currentTokenStream(), args[0].getTokenIt());
+			auto output = makeExpression<StringLiteralExpression>(currentTokenStream(), args[0].getTokenIt());
 			output->setType(Expression::Type::String);
 			output->setUid(_uidGen.next());
 			return output;
@@ -1772,7 +1930,7 @@ void ParserDriver::defineGrammar()
 				error_handle(args[0].getTokenIt()->getLocation(), "Reference to undefined string '" + args[0].getTokenIt()->getString() + "'");
 			if (stringId.size() > 1)
 				id->setValue(findStringDefinition(stringId));
-			auto output = std::make_shared<StringCountExpression>(args[0].getTokenIt());
+			auto output = makeExpression<StringCountExpression>(args[0].getTokenIt());
 			output->setType(Expression::Type::Int);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1789,7 +1947,7 @@ void ParserDriver::defineGrammar()
 				id->setValue(findStringDefinition(stringId));
 			Expression::Ptr range = args[2].getExpression();
 
-			auto output = std::make_shared<StringInRangeExpression>(args[0].getTokenIt(), args[1].getTokenIt(), std::move(range));
+			auto output = makeExpression<StringInRangeExpression>(args[0].getTokenIt(), args[1].getTokenIt(), std::move(range));
 			output->setType(Expression::Type::Int);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1805,7 +1963,7 @@ void ParserDriver::defineGrammar()
 				error_handle(args[0].getTokenIt()->getLocation(), "Reference to undefined string '" + args[0].getTokenIt()->getString() + "'");
 			if (stringId.size() > 1)
 				id->setValue(findStringDefinition(stringId));
-			auto output = std::make_shared<StringOffsetExpression>(args[0].getTokenIt());
+			auto output = makeExpression<StringOffsetExpression>(args[0].getTokenIt());
 			output->setType(Expression::Type::Int);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1821,7 +1979,7 @@ void ParserDriver::defineGrammar()
 				error_handle(args[0].getTokenIt()->getLocation(), "Reference to undefined string '" + args[0].getTokenIt()->getString() + "'");
 			if (stringId.size() > 1)
 				id->setValue(findStringDefinition(stringId));
-			auto output = std::make_shared<StringOffsetExpression>(args[0].getTokenIt(), std::move(args[2].getExpression()), args[3].getTokenIt());
+			auto output = makeExpression<StringOffsetExpression>(args[0].getTokenIt(), std::move(args[2].getExpression()), args[3].getTokenIt());
 			output->setType(Expression::Type::Int);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1837,7 +1995,7 @@ void ParserDriver::defineGrammar()
 				error_handle(args[0].getTokenIt()->getLocation(), "Reference to undefined string '" + args[0].getTokenIt()->getString() + "'");
 			if (stringId.size() > 1)
 				id->setValue(findStringDefinition(stringId));
-			auto output = std::make_shared<StringLengthExpression>(args[0].getTokenIt());
+			auto output = makeExpression<StringLengthExpression>(args[0].getTokenIt());
 			output->setType(Expression::Type::Int);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1853,7 +2011,7 @@ void ParserDriver::defineGrammar()
 				error_handle(args[0].getTokenIt()->getLocation(), "Reference to undefined string '" + args[0].getTokenIt()->getString() + "'");
 			if (stringId.size() > 1)
 				id->setValue(findStringDefinition(stringId));
-			auto output = std::make_shared<StringLengthExpression>(args[0].getTokenIt(), std::move(args[2].getExpression()), args[3].getTokenIt());
+			auto output = makeExpression<StringLengthExpression>(args[0].getTokenIt(), std::move(args[2].getExpression()), args[3].getTokenIt());
 			output->setType(Expression::Type::Int);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1867,7 +2025,7 @@ void ParserDriver::defineGrammar()
 			}
 			auto type = right->getType();
 			args[0].getTokenIt()->setType(TokenType::UNARY_MINUS);
-			auto output = std::make_shared<UnaryMinusExpression>(args[0].getTokenIt(), std::move(right));
+			auto output = makeExpression<UnaryMinusExpression>(args[0].getTokenIt(), std::move(right));
 			output->setType(type);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1881,7 +2039,7 @@ void ParserDriver::defineGrammar()
 			if (!right->isInt() && !right->isFloat())
 				error_handle(args[1].getTokenIt()->getLocation(), "operator '+' expects integer or float on the right-hand side");
 			auto type = (left->isInt() && right->isInt()) ? Expression::Type::Int : Expression::Type::Float;
-			auto output = std::make_shared<PlusExpression>(std::move(left), args[1].getTokenIt(), std::move(right));
+			auto output = makeExpression<PlusExpression>(std::move(left), args[1].getTokenIt(), std::move(right));
 			output->setType(type);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1895,7 +2053,7 @@ void ParserDriver::defineGrammar()
 			if (!right->isInt() && !right->isFloat())
 				error_handle(args[1].getTokenIt()->getLocation(), "operator '-' expects integer or float on the right-hand side");
 			auto type = (left->isInt() && right->isInt()) ? Expression::Type::Int : Expression::Type::Float;
-			auto output = std::make_shared<MinusExpression>(std::move(left), args[1].getTokenIt(), std::move(right));
+			auto output = makeExpression<MinusExpression>(std::move(left), args[1].getTokenIt(), std::move(right));
 			output->setType(type);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1909,7 +2067,7 @@ void ParserDriver::defineGrammar()
 			if (!right->isInt() && !right->isFloat())
 				error_handle(args[1].getTokenIt()->getLocation(), "operator '*' expects integer or float on the right-hand side");
 			auto type = (left->isInt() && right->isInt()) ? Expression::Type::Int : Expression::Type::Float;
-			auto output = std::make_shared<MultiplyExpression>(std::move(left), args[1].getTokenIt(), std::move(right));
+			auto output = makeExpression<MultiplyExpression>(std::move(left), args[1].getTokenIt(), std::move(right));
 			output->setType(type);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1923,7 +2081,7 @@ void ParserDriver::defineGrammar()
 			if (!right->isInt() && !right->isFloat())
 				error_handle(args[1].getTokenIt()->getLocation(), "operator '\\' expects integer or float on the right-hand side");
 			auto type = (left->isInt() && right->isInt()) ? Expression::Type::Int : Expression::Type::Float;
-			auto output = std::make_shared<DivideExpression>(std::move(left), args[1].getTokenIt(), std::move(right));
+			auto output = makeExpression<DivideExpression>(std::move(left), args[1].getTokenIt(), std::move(right));
 			output->setType(type);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1936,7 +2094,7 @@ void ParserDriver::defineGrammar()
 				error_handle(args[1].getTokenIt()->getLocation(), "operator '%' expects integer or float on the left-hand side");
 			if (!right->isInt() && !right->isFloat())
 				error_handle(args[1].getTokenIt()->getLocation(), "operator '%' expects integer or float on the right-hand side");
-			auto output = std::make_shared<ModuloExpression>(std::move(left), args[1].getTokenIt(), std::move(right));
+			auto output = makeExpression<ModuloExpression>(std::move(left), args[1].getTokenIt(), std::move(right));
 			output->setType(Expression::Type::Int);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1949,7 +2107,7 @@ void ParserDriver::defineGrammar()
 				error_handle(args[1].getTokenIt()->getLocation(), "operator '^' expects integer or float on the left-hand side");
 			if (!right->isInt() && !right->isFloat())
 				error_handle(args[1].getTokenIt()->getLocation(), "operator '^' expects integer or float on the right-hand side");
-			auto output = std::make_shared<BitwiseXorExpression>(std::move(left), args[1].getTokenIt(), std::move(right));
+			auto output = makeExpression<BitwiseXorExpression>(std::move(left), args[1].getTokenIt(), std::move(right));
 			output->setType(Expression::Type::Int);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1962,7 +2120,7 @@ void ParserDriver::defineGrammar()
 				error_handle(args[1].getTokenIt()->getLocation(), "operator '&' expects integer or float on the left-hand side");
 			if (!right->isInt() && !right->isFloat())
 				error_handle(args[1].getTokenIt()->getLocation(), "operator '&' expects integer or float on the right-hand side");
-			auto output = std::make_shared<BitwiseAndExpression>(std::move(left), args[1].getTokenIt(), std::move(right));
+			auto output = makeExpression<BitwiseAndExpression>(std::move(left), args[1].getTokenIt(), std::move(right));
 			output->setType(Expression::Type::Int);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1975,7 +2133,7 @@ void ParserDriver::defineGrammar()
 				error_handle(args[1].getTokenIt()->getLocation(), "operator '|' expects integer or float on the left-hand side");
 			if (!right->isInt() && !right->isFloat())
 				error_handle(args[1].getTokenIt()->getLocation(), "operator '|' expects integer or float on the right-hand side");
-			auto output = std::make_shared<BitwiseOrExpression>(std::move(left), args[1].getTokenIt(), std::move(right));
+			auto output = makeExpression<BitwiseOrExpression>(std::move(left), args[1].getTokenIt(), std::move(right));
 			output->setType(Expression::Type::Int);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1985,7 +2143,7 @@ void ParserDriver::defineGrammar()
 			auto right = args[1].getExpression();
 			if (!right->isInt())
 				error_handle(args[0].getTokenIt()->getLocation(), "bitwise not expects integer");
-			auto output = std::make_shared<BitwiseNotExpression>(args[0].getTokenIt(), std::move(right));
+			auto output = makeExpression<BitwiseNotExpression>(args[0].getTokenIt(), std::move(right));
 			output->setType(Expression::Type::Int);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -1998,7 +2156,7 @@ void ParserDriver::defineGrammar()
 				error_handle(args[1].getTokenIt()->getLocation(), "operator '<<' expects integer on the left-hand side");
 			if (!right->isInt() && !right->isFloat())
 				error_handle(args[1].getTokenIt()->getLocation(), "operator '<<' expects integer on the right-hand side");
-			auto output = std::make_shared<ShiftLeftExpression>(std::move(left), args[1].getTokenIt(), std::move(right));
+			auto output = makeExpression<ShiftLeftExpression>(std::move(left), args[1].getTokenIt(), std::move(right));
 			output->setType(Expression::Type::Int);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -2011,7 +2169,7 @@ void ParserDriver::defineGrammar()
 				error_handle(args[1].getTokenIt()->getLocation(), "operator '>>' expects integer on the left-hand side");
 			if (!right->isInt() && !right->isFloat())
 				error_handle(args[1].getTokenIt()->getLocation(), "operator '>>' expects integer on the right-hand side");
-			auto output = std::make_shared<ShiftRightExpression>(std::move(left), args[1].getTokenIt(), std::move(right));
+			auto output = makeExpression<ShiftRightExpression>(std::move(left), args[1].getTokenIt(), std::move(right));
 			output->setType(Expression::Type::Int);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -2020,7 +2178,7 @@ void ParserDriver::defineGrammar()
 		.production("INTEGER_FUNCTION", "LP", "primary_expression", "RP", [&](auto&& args) -> Value {
 			if (!args[2].getExpression()->isInt())
 				error_handle(args[0].getTokenIt()->getLocation(), "operator '" + args[0].getTokenIt()->getString() + "' expects integer");
-			auto output = std::make_shared<IntFunctionExpression>(std::move(args[0].getTokenIt()), std::move(args[1].getTokenIt()), std::move(args[2].getExpression()), std::move(args[3].getTokenIt()));
+			auto output = makeExpression<IntFunctionExpression>(std::move(args[0].getTokenIt()), std::move(args[1].getTokenIt()), std::move(args[2].getExpression()), std::move(args[3].getTokenIt()));
 			output->setType(Expression::Type::Int);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -2031,7 +2189,7 @@ void ParserDriver::defineGrammar()
 		})
 		.production("regexp", [&](auto&& args) -> Value {
 			auto regexp_string = std::move(args[0].getYaramodString());
-			auto output = std::make_shared<RegexpExpression>(std::static_pointer_cast<Regexp>(regexp_string));
+			auto output = makeExpression<RegexpExpression>(std::static_pointer_cast<Regexp>(regexp_string));
 			output->setType(Expression::Type::Regexp);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -2050,14 +2208,14 @@ void ParserDriver::defineGrammar()
 				else
 				{
 					// Force add the symbol if it's module in incomplete mode so that we can successfully parse the rule
-					if (_file.addImport(args[0].getTokenIt(), *_modules))
+					if (ParserProfile::Scope scope(activeProfile(), ParserPhase::ModuleLoading); _file.addImport(args[0].getTokenIt(), *_modules))
 						symbol = findSymbol(symbol_token->getString());
 					else
 						symbol = std::make_shared<Symbol>(Symbol::Type::Undefined, symbol_token->getString(), ExpressionType::Undefined);
 				}
 			}
 			symbol_token->setValue(symbol);
-			auto output = std::make_shared<IdExpression>(symbol_token);
+			auto output = makeExpression<IdExpression>(symbol_token);
 			output->setType(symbol->getDataType());
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -2095,16 +2253,15 @@ void ParserDriver::defineGrammar()
 					error_handle(args[2].getTokenIt()->getLocation(), "Unrecognized identifier '" + symbol_token->getString() + "' referenced");
 				else
 				{
-					bool inserted = structParentSymbol->addAttribute(std::make_shared<Symbol>(Symbol::Type::Undefined, symbol_token->getString(), ExpressionType::Undefined));
-					attr = structParentSymbol->getAttribute(symbol_token->getString());
-					assert(inserted && attr);
+					// Structures of modules are shared by all drivers so the undefined attribute can't be added there
+					attr = std::make_shared<Symbol>(Symbol::Type::Undefined, symbol_token->getString(), ExpressionType::Undefined);
 				}
 			}
 
 			auto symbol = attr.value();
 			symbol_token->setValue(symbol);
 			symbol_token->setType(symbol->getTokenType());
-			auto output = std::make_shared<StructAccessExpression>(std::move(expr), args[1].getTokenIt(), symbol_token);
+			auto output = makeExpression<StructAccessExpression>(std::move(expr), args[1].getTokenIt(), symbol_token);
 			output->setType(symbol->getDataType());
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -2141,7 +2298,7 @@ void ParserDriver::defineGrammar()
 				arraySymbol = iterParentSymbol->getStructuredElementType();
 			else
 				arraySymbol = std::make_shared<ValueSymbol>(expr->getText(), iterParentSymbol->getElementType());
-			auto output = std::make_shared<ArrayAccessExpression>(arraySymbol, std::move(expr), args[1].getTokenIt(), std::move(args[2].getExpression()), args[3].getTokenIt());
+			auto output = makeExpression<ArrayAccessExpression>(arraySymbol, std::move(expr), args[1].getTokenIt(), std::move(args[2].getExpression()), args[3].getTokenIt());
 
 			output->setType(iterParentSymbol->getElementType());
 			output->setTokenStream(currentTokenStream());
@@ -2213,7 +2370,7 @@ void ParserDriver::defineGrammar()
 			auto rp = args[3].getTokenIt();
 			lp->setType(TokenType::FUNCTION_CALL_LP);
 			rp->setType(TokenType::FUNCTION_CALL_RP);
-			auto output = std::make_shared<FunctionCallExpression>(std::move(expr), std::move(lp), std::move(arguments), std::move(rp));
+			auto output = makeExpression<FunctionCallExpression>(std::move(expr), std::move(lp), std::move(arguments), std::move(rp));
 			output->setType(funcParentSymbol->getReturnType());
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
@@ -2245,7 +2402,7 @@ void ParserDriver::defineGrammar()
 				error_handle(args[2].getTokenIt()->getLocation(), "operator '..' expects integer as lower bound of the interval");
 			if (!right->isInt())
 				error_handle(args[2].getTokenIt()->getLocation(), "operator '..' expects integer as upper bound of the interval");
-			auto output = std::make_shared<RangeExpression>(args[0].getTokenIt(), std::move(left), args[2].getTokenIt(), std::move(right), args[4].getTokenIt());
+			auto output = makeExpression<RangeExpression>(args[0].getTokenIt(), std::move(left), args[2].getTokenIt(), std::move(right), args[4].getTokenIt());
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
 			return output;
@@ -2255,17 +2412,17 @@ void ParserDriver::defineGrammar()
 	_parser.rule("for_expression") // Expression::Ptr
 		.production("primary_expression", [](auto&& args) -> Value { return std::move(args[0]); })
 		.production("ALL", [&](auto&& args) -> Value {
-			auto output = std::make_shared<AllExpression>(currentTokenStream(), args[0].getTokenIt());
+			auto output = makeExpression<AllExpression>(currentTokenStream(), args[0].getTokenIt());
 			output->setUid(_uidGen.next());
 			return output;
 		})
 		.production("ANY", [&](auto&& args) -> Value { 
-			auto output = std::make_shared<AnyExpression>(currentTokenStream(), args[0].getTokenIt()); 
+			auto output = makeExpression<AnyExpression>(currentTokenStream(), args[0].getTokenIt()); 
 			output->setUid(_uidGen.next());
 			return output;
 		})
 		.production("NONE", [&](auto&& args) -> Value {
-			auto output = std::make_shared<NoneExpression>(currentTokenStream(), args[0].getTokenIt()); 
+			auto output = makeExpression<NoneExpression>(currentTokenStream(), args[0].getTokenIt()); 
 			output->setUid(_uidGen.next());
 			return output;
 		})
@@ -2277,7 +2434,7 @@ void ParserDriver::defineGrammar()
 			auto rp = args[2].getTokenIt();
 			lp->setType(TokenType::LP_ENUMERATION);
 			rp->setType(TokenType::RP_ENUMERATION);
-			auto output = std::make_shared<SetExpression>(lp, std::move(args[1].getMultipleExpressions()), rp);
+			auto output = makeExpression<SetExpression>(lp, std::move(args[1].getMultipleExpressions()), rp);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
 			return output;
@@ -2312,13 +2469,13 @@ void ParserDriver::defineGrammar()
 			lp->setType(TokenType::LP_ENUMERATION);
 			TokenIt rp = args[2].getTokenIt();
 			rp->setType(TokenType::RP_ENUMERATION);
-			auto output = std::make_shared<SetExpression>(lp, std::move(args[1].getMultipleExpressions()), rp);
+			auto output = makeExpression<SetExpression>(lp, std::move(args[1].getMultipleExpressions()), rp);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
 			return output;
 		})
 		.production("THEM", [&](auto&& args) -> Value {
-			auto output = std::make_shared<ThemExpression>(currentTokenStream(), args[0].getTokenIt());
+			auto output = makeExpression<ThemExpression>(currentTokenStream(), args[0].getTokenIt());
 			output->setUid(_uidGen.next());
 			return output;
 		})
@@ -2342,7 +2499,7 @@ void ParserDriver::defineGrammar()
 				error_handle(id->getLocation(), "Reference to undefined string '" + id->getPureText() + "'");
 			if (id->getString().size() > 1)
 				id->setValue(findStringDefinition(id->getString()));
-			auto output = std::make_shared<StringExpression>(id);
+			auto output = makeExpression<StringExpression>(id);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
 			return output;
@@ -2351,7 +2508,7 @@ void ParserDriver::defineGrammar()
 			TokenIt id = args[0].getTokenIt();
 			if (!stringExists(id->getPureText()))
 				error_handle(id->getLocation(), "No string matched with wildcard '" + id->getPureText() + "'");
-			auto output = std::make_shared<StringWildcardExpression>(id);
+			auto output = makeExpression<StringWildcardExpression>(id);
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
 			return output;
@@ -2422,7 +2579,7 @@ void ParserDriver::defineGrammar()
 
 	_parser.rule("expression_iterable") // shared_ptr<IterableExpression>
 		.production("THEM", [&](auto&& args) -> Value {
-			auto output = std::make_shared<ThemExpression>(args[0].getTokenIt());
+			auto output = makeExpression<ThemExpression>(args[0].getTokenIt());
 			output->setTokenStream(currentTokenStream());
 			output->setUid(_uidGen.next());
 			return output;
@@ -2483,13 +2640,57 @@ void ParserDriver::enter_state(const std::string& state)
 	_parser.enter_tokenizer_state(state);
 }
 
+namespace {
+
+using SharedParserDefinitions = std::unordered_map<int, std::shared_ptr<const pog::ParserDefinition<Value>>>;
+
+std::mutex& sharedParserDefinitionsMutex()
+{
+	static std::mutex mutex;
+	return mutex;
+}
+
+SharedParserDefinitions& sharedParserDefinitions()
+{
+	static SharedParserDefinitions definitions;
+	return definitions;
+}
+
+} // namespace
+
+/**
+ * Removes all parser definitions shared by drivers in this process. Drivers
+ * which already exist keep their own reference to their definition. The next
+ * driver created for each set of features prepares the grammar again.
+ */
+void ParserDriver::clearSharedParserDefinitions()
+{
+	std::lock_guard<std::mutex> lock(sharedParserDefinitionsMutex());
+	sharedParserDefinitions().clear();
+}
+
 void ParserDriver::initialize()
 {
 	defineTokens();
 	defineGrammar();
 	_parser.set_start_symbol("rules");
 
-	auto report = _parser.prepare();
+	// Grammar, tokens and parsing table depend only on the features so all drivers with the same features
+	// share them and each driver only binds its own actions. The lock is held during the preparation so that
+	// drivers created concurrently wait for the first one instead of preparing the same grammar again.
+	std::lock_guard<std::mutex> lock(sharedParserDefinitionsMutex());
+	auto& sharedDefinition = sharedParserDefinitions()[static_cast<int>(_features)];
+	if (sharedDefinition)
+	{
+		_parser.prepare(sharedDefinition);
+		_valid = true;
+		return;
+	}
+
+	// Computing the parsing table is the most expensive part so it is done only once and then reused
+	auto& tableCache = ParsingTableCache::instance();
+	auto cachedTable = tableCache.find(_features);
+	auto report = cachedTable ? _parser.prepare(std::string_view{cachedTable.value()}) : _parser.prepare();
 	// Uncomment for advanced debugging with HtmlReport:
 	// pog::HtmlReport html(_parser);
 	// html.save("html_index.html");
@@ -2500,6 +2701,10 @@ void ParserDriver::initialize()
 		throw YaramodError("Error: Parser initialization failed");
 	}
 
+	if (!_parser.is_parsing_table_loaded())
+		tableCache.store(_features, _parser.serialize_parsing_table());
+
+	sharedDefinition = _parser.get_definition();
 	_valid = true;
 }
 
@@ -2512,7 +2717,7 @@ void ParserDriver::initialize()
 ParserDriver::ParserDriver(Features features, const std::string& moduleDirectory)
 	: _strLiteral(), _indent(), _comment(), _regexpClass(), _parser(), _sectionStrings(false),
 	_escapedContent(false), _mode(ParserMode::Regular), _features(features),
-	_modules(std::make_shared<ModulePool>(features, moduleDirectory)),
+	_modules(ModulePool::getShared(features, moduleDirectory)),
 	_fileContexts(), _comments(), _includedFiles(), _includedFilesCache(), _valid(false),
 	_file(), _currentStrings(), _stringLoop(false), _localSymbols(), _lastRuleLocation(),
 	_lastRuleTokenStream(), _anonStringCounter(0), _errorLocation(), _deferredIncludes(),
@@ -2521,7 +2726,7 @@ ParserDriver::ParserDriver(Features features, const std::string& moduleDirectory
 	initialize();
 }
 
-ParserDriver::ParserDriver(Features features, const std::shared_ptr<ModulePool>& modulePool)
+ParserDriver::ParserDriver(Features features, const std::shared_ptr<const ModulePool>& modulePool)
 	: _strLiteral(), _indent(), _comment(), _regexpClass(), _parser(), _sectionStrings(false),
 	_escapedContent(false), _mode(ParserMode::Regular), _features(features), _modules(modulePool),
 	_fileContexts(), _comments(), _includedFiles(), _includedFilesCache(), _valid(false),
@@ -2562,13 +2767,78 @@ std::map<std::string, Module*> ParserDriver::getModules() const
 	return _modules->getModules();
 }
 
+/**
+ * Parses the whole content of the input stream.
+ *
+ * @param stream Input stream.
+ * @param parserMode Parsing mode.
+ *
+ * @return @c true if parsing succeeded, otherwise @c false.
+ */
 bool ParserDriver::parse(std::istream& stream, ParserMode parserMode)
 {
-	if (!prepareParser(parserMode))
+	return parse(stream, RuleCallback{}, parserMode);
+}
+
+/**
+ * Parses the whole content of the input stream and hands over every parsed rule
+ * to the callback instead of storing it in the parsed file.
+ *
+ * @param stream Input stream.
+ * @param onRule Callback receiving the parsed rules.
+ * @param parserMode Parsing mode.
+ *
+ * @return @c true if parsing succeeded, otherwise @c false.
+ */
+bool ParserDriver::parse(std::istream& stream, const RuleCallback& onRule, ParserMode parserMode)
+{
+	if (!prepareParser(parserMode, onRule))
+		return false;
+
+	_streamInput.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	return parseInput(_streamInput);
+}
+
+/**
+ * Parses the input in memory. The input is tokenized in place without being copied
+ * so it has to stay valid until the parsing is finished.
+ *
+ * @param input Content to parse.
+ * @param parserMode Parsing mode.
+ *
+ * @return @c true if parsing succeeded, otherwise @c false.
+ */
+bool ParserDriver::parse(std::string_view input, ParserMode parserMode)
+{
+	return parse(input, RuleCallback{}, parserMode);
+}
+
+/**
+ * Parses the input in memory and hands over every parsed rule to the callback
+ * instead of storing it in the parsed file. The input has to stay valid until
+ * the parsing is finished.
+ *
+ * @param input Content to parse.
+ * @param onRule Callback receiving the parsed rules.
+ * @param parserMode Parsing mode.
+ *
+ * @return @c true if parsing succeeded, otherwise @c false.
+ */
+bool ParserDriver::parse(std::string_view input, const RuleCallback& onRule, ParserMode parserMode)
+{
+	if (!prepareParser(parserMode, onRule))
 		return false;
 
-	_fileContexts.emplace_back(&stream);
+	return parseInput(input);
+}
+
+bool ParserDriver::parseInput(std::string_view input, const std::string& filePath)
+{
+	_fileContexts.emplace_back(filePath, input);
 	_file = YaraFile(currentFileContext()->getTokenStream(), _features);
+	startExpressionArena();
+	if (auto* profile = activeProfile())
+		profile->addBytesRead(input.size());
 	try {
 		auto output = parseImpl();
 		return output;
@@ -2580,21 +2850,111 @@ bool ParserDriver::parse(std::istream& stream, ParserMode parserMode)
 	}
 }
 
+/**
+ * Parses the file. The file is mapped into memory and tokenized in place.
+ *
+ * @param filePath Path to the file.
+ * @param parserMode Parsing mode.
+ *
+ * @return @c true if parsing succeeded, otherwise @c false.
+ */
 bool ParserDriver::parse(const std::string& filePath, ParserMode parserMode)
 {
-	if (!prepareParser(parserMode))
+	return parse(filePath, RuleCallback{}, parserMode);
+}
+
+/**
+ * Parses the file and hands over every parsed rule to the callback instead of storing
+ * it in the parsed file. Tokens of the rules are released together with the rules
+ * so the memory needed for parsing is given by the largest rule and not by the whole file.
+ *
+ * @param filePath Path to the file.
+ * @param onRule Callback receiving the parsed rules.
+ * @param parserMode Parsing mode.
+ *
+ * @return @c true if parsing succeeded, otherwise @c false.
+ */
+bool ParserDriver::parse(const std::string& filePath, const RuleCallback& onRule, ParserMode parserMode)
+{
+	if (!prepareParser(parserMode, onRule))
 		return false;
 
 	if (includeFileImpl(filePath) != IncludeResult::Included)
 		return false;
 
 	_file = YaraFile(currentFileContext()->getTokenStream(), _features);
+	startExpressionArena();
 	return parseImpl();
 }
 
-bool ParserDriver::prepareParser(ParserMode parserMode)
+/**
+ * Parses the changed input of already parsed file again. Only the rules touched by the changes
+ * are parsed again, the tokens and the rules of the rest of the file are kept and only their
+ * lines are moved. Symbols of the rules parsed again are preserved so the following rules can still
+ * refer to them. The whole input is parsed again if the changes touch imports or includes, remove
+ * a rule which can be referenced, or the file contains rules from included files. The whole input
+ * is also parsed when no changes are given. The file is left as it was if the parsing fails.
+ *
+ * @param file File parsed from the previous content of the input.
+ * @param input New content of the input. It has to stay valid until the parsing is finished.
+ * @param changes Changed ranges of the new content.
+ * @param parserMode Parsing mode.
+ *
+ * @return How the input was parsed, @c ReparseResult::Error if parsing failed.
+ */
+ReparseResult ParserDriver::reparse(YaraFile& file, std::string_view input, const std::vector<InputChange>& changes, ParserMode parserMode)
+{
+	// Rules in incomplete mode don't have to be finished so they can't be separated from each other
+	if (parserMode == ParserMode::Regular || parserMode == ParserMode::IncludeGuarded)
+	{
+		if (auto window = findReparseWindow(file, input, changes))
+		{
+			reset(parserMode);
+			if (reparseWindow(file, input, window.value()))
+				return ReparseResult::Incremental;
+		}
+	}
+
+	const auto* tokenStream = file.getTokenStream();
+	auto filePath = tokenStream && !tokenStream->empty() ? tokenStream->front().getLocation().getFilePath() : std::string{"[stream]"};
+	if (!prepareParser(parserMode) || !parseInput(input, filePath))
+		return ReparseResult::Error;
+
+	file = std::move(_file);
+	return ReparseResult::Full;
+}
+
+/**
+ * Turns the profiling of parsing on or off. The profile of the last parsing is kept
+ * until the next parsing starts.
+ *
+ * @param profiling @c true to measure the phases of parsing.
+ */
+void ParserDriver::setProfiling(bool profiling)
+{
+	_profiling = profiling;
+	if (_profiling && !_profileListener)
+		_profileListener = std::make_unique<ProfileListener>(_profile);
+	_parser.set_listener(_profiling ? _profileListener.get() : nullptr);
+}
+
+/**
+ * Gives the parsed file a new arena for the expressions allocated from now on
+ * if arena allocation is turned on.
+ */
+void ParserDriver::startExpressionArena()
+{
+	if (_arenaAllocation)
+		_file.setExpressionArena(ExpressionArena::create());
+}
+
+bool ParserDriver::prepareParser(ParserMode parserMode, const RuleCallback& onRule)
 {
 	reset(parserMode);
+	_onRule = onRule;
+	// Included files are not opened in the deferred mode so there is nothing to prefetch
+	if (_includePrefetchThreads > 0 && _mode != ParserMode::DeferredInclude)
+		_includePrefetcher = std::make_unique<IncludePrefetcher>(_includePrefetchThreads);
 	return true;
 }
 
@@ -2605,18 +2965,27 @@ bool ParserDriver::prepareParser(ParserMode parserMode)
  */
 bool ParserDriver::parseImpl()
 {
+	ParserProfile::Scope scope(activeProfile(), ParserPhase::Parsing);
 	try
 	{
-		auto result = _parser.parse(*currentFileContext()->getStream());
+		auto result = recoveringErrors() ? parseRecovering() : _parser.parse(currentFileContext()->getInput());
+		_includePrefetcher.reset();
 		if (!result)
 			throw YaramodError("Error: Parser failed to parse input.");
 		return result.has_value();
 	}
 	catch (const pog::SyntaxError& err)
 	{
+		_includePrefetcher.reset();
 		error_handle(!_fileContexts.empty() ? currentFileContext()->getLocation() : _errorLocation, err.what());
 		return false;
 	}
+	catch (...)
+	{
+		// Workers are not kept waiting for the next parsing
+		_includePrefetcher.reset();
+		throw;
+	}
 }
 
 void ParserDriver::reset(ParserMode parserMode)
@@ -2633,6 +3002,7 @@ void ParserDriver::reset(ParserMode parserMode)
 
 	_fileContexts.clear();
 	_comments.clear();
+	_streamInput.clear();
 	_includedFiles.clear();
 	_includedFilesCache.clear();
 	_valid = true;
@@ -2642,6 +3012,18 @@ void ParserDriver::reset(ParserMode parserMode)
 	_lastRuleLocation.reset();
 	_lastRuleTokenStream.reset();
 	_anonStringCounter = 0;
+	_onRule = nullptr;
+	_outerTokenStream.reset();
+	_streamedRules.clear();
+	_reparsing = false;
+	_reparseEnd.reset();
+	_reparsedRules.clear();
+	_includeRecordings.clear();
+	_includePrefetcher.reset();
+	_errors.clear();
+	_lastRecoveredToken.reset();
+	_recoveredRules = 0;
+	_profile.clear();
 }
 
 /**
@@ -2656,13 +3038,17 @@ bool ParserDriver::isValid() const
 
 /**
  * Includes file into input stream as it would be in place of @c include directive.
+ * If the include cache contains the file with the same content, the cached tokens
+ * and rules are used instead and the file is not parsed.
  *
  * @param includePath Path of file to include.
+ * @param includeToken Token of the include path which receives the tokens of the file.
  *
  * @return @c true if include succeeded, otherwise @c false.
  */
-bool ParserDriver::includeFile(const std::string& includePath, const std::shared_ptr<TokenStream>& tokenStream)
+bool ParserDriver::includeFile(const std::string& includePath, TokenIt includeToken)
 {
+	ParserProfile::Scope scope(activeProfile(), ParserPhase::IncludeLoading);
 	auto totalPath = includePath;
 	if (pathIsRelative(includePath))
 	{
@@ -2678,9 +3064,29 @@ bool ParserDriver::includeFile(const std::string& includePath, const std::shared
 
 	// If all the underlying mechanisms for including succeeded, push the stream on top of input stack
 	// Push input stream only if the file wasn't already included
-	auto result = includeFileImpl(totalPath, tokenStream);
+	auto result = includeFileImpl(totalPath, includeToken->initializeSubTokenStream());
 	if (result == IncludeResult::Included)
-		_parser.push_input_stream(*_includedFiles.back());
+	{
+		if (cachingIncludes())
+		{
+			auto filePath = absolutePath(totalPath);
+			auto contentHash = IncludeCache::hashContent(_includedFiles.back()->getContent());
+			if (useCachedInclude(filePath, contentHash, includeToken))
+				return true;
+
+			auto include = std::make_shared<ParsedInclude>();
+			include->features = _features;
+			include->tokenStream = currentTokenStream();
+			_includeRecordings.push_back({filePath, contentHash, _fileContexts.size(), _file.getRules().size(), std::move(include), {}});
+		}
+		_parser.push_input_stream(_includedFiles.back()->getContent());
+	}
+	else if (result == IncludeResult::AlreadyIncluded)
+	{
+		// Skipped file might not be skipped when the file including it is included from elsewhere
+		for (auto& recording : _includeRecordings)
+			recording.cacheable = false;
+	}
 
 	return result != IncludeResult::Error;
 }
@@ -2693,6 +3099,10 @@ bool ParserDriver::includeFile(const std::string& includePath, const std::shared
  */
 bool ParserDriver::includeEnd()
 {
+	auto recording = std::find_if(_includeRecordings.rbegin(), _includeRecordings.rend(), [](const auto& recording) { return !recording.ended; });
+	if (recording != _includeRecordings.rend() && recording->fileContextDepth == _fileContexts.size())
+		recording->ended = true;
+
 	_parser.pop_input_stream();
 	if (!_fileContexts.empty())
 	{
@@ -2712,7 +3122,7 @@ bool ParserDriver::includeEnd()
  */
 bool ParserDriver::ruleExists(const std::string& name) const
 {
-	return _file.hasRule(name);
+	return _file.hasRule(name) || _streamedRules.find(name) != _streamedRules.end();
 }
 
 /**
@@ -2744,12 +3154,282 @@ void ParserDriver::addRule(Rule&& rule)
  */
 void ParserDriver::addRule(std::unique_ptr<Rule>&& rule)
 {
-	rule->setLocation(_lastRuleLocation);
+	{
+		ParserProfile::Scope scope(activeProfile(), ParserPhase::FileConstruction);
+		rule->setLocation(_lastRuleLocation);
+
+		if (ruleExists(rule->getName()))
+			throw ParserError("Error: Redefinition of rule " + rule->getName());
+
+		if (!streamingMode())
+		{
+			recordDefinedSymbol(rule->getName());
+			_file.addRule(std::move(rule));
+			return;
+		}
+
+		endStreamedRule(*rule);
+	}
+
+	// Rule callback runs user code, so it doesn't count as the construction of the file
+	_onRule(std::move(rule), _file);
+}
+
+/**
+ * Moves tokens of the rule which is about to be parsed out of the token stream of the file
+ * into a new token stream owned by the rule. Comments and empty lines preceding the rule
+ * are moved together with it.
+ *
+ * @param firstToken First token of the rule.
+ */
+void ParserDriver::beginStreamedRule(TokenIt firstToken)
+{
+	auto* context = currentFileContext();
+	_outerTokenStream = context->getTokenStream();
+
+	auto first = firstToken;
+	while (first != _outerTokenStream->begin())
+	{
+		auto type = std::prev(first)->getType();
+		if (type != TokenType::NEW_LINE && type != TokenType::COMMENT && type != TokenType::ONELINE_COMMENT)
+			break;
+		--first;
+	}
+
+	auto ruleTokenStream = std::make_shared<TokenStream>();
+	ruleTokenStream->moveAppend(_outerTokenStream.get(), first, _outerTokenStream->end());
+	context->setTokenStream(ruleTokenStream);
+	startExpressionArena();
+}
+
+/**
+ * Returns tokens following the end of the rule back to the token stream of the file.
+ * The rule is handed over to the rule callback afterwards.
+ *
+ * @param rule Parsed rule.
+ */
+void ParserDriver::endStreamedRule(const Rule& rule)
+{
+	auto ruleTokenStream = std::move(_lastRuleTokenStream);
+
+	// Tokens which were read ahead of the end of the rule belong to the rest of the file
+	auto last = ruleTokenStream->findBackwards(TokenType::RULE_END);
+	_outerTokenStream->moveAppend(ruleTokenStream.get(), std::next(last), ruleTokenStream->end());
+	for (auto& context : _fileContexts)
+	{
+		if (context.getTokenStream() == ruleTokenStream)
+			context.setTokenStream(_outerTokenStream);
+	}
+	_outerTokenStream.reset();
+
+	_streamedRules.emplace(rule.getName(), rule.getSymbol());
+}
+
+/**
+ * Finds the part of the file which has to be parsed again because of the changes in the input.
+ * The part begins on a new line right after a rule, an import or an include preceding all the changes
+ * and ends right before a rule, an import or an include following all of them, the lines outside of it
+ * are the same in both old and new input. Tokens of the file are used to find out which lines were
+ * there before the changes because the old input is not available anymore.
+ *
+ * @param file File parsed from the previous content of the input.
+ * @param input New content of the input.
+ * @param changes Changed ranges of the new content.
+ *
+ * @return The part of the file to parse again, nothing if the whole input needs to be parsed.
+ */
+std::optional<ParserDriver::ReparseWindow> ParserDriver::findReparseWindow(const YaraFile& file, std::string_view input, const std::vector<InputChange>& changes) const
+{
+	const auto& tokens = file.getTokenStreamSharedPtr();
+	if (changes.empty() || !tokens || tokens->empty() || !file.hasRules())
+		return std::nullopt;
+
+	std::size_t changeBegin = input.size(), changeEnd = 0;
+	for (const auto& change : changes)
+	{
+		changeBegin = std::min(changeBegin, change.offset);
+		changeEnd = std::max(changeEnd, change.offset + change.length);
+	}
+	if (changeEnd > input.size())
+		return std::nullopt;
+	changeBegin = std::min(changeBegin, changeEnd);
+
+	std::vector<std::size_t> lineStarts{0};
+	for (auto pos = input.find('\n'); pos != std::string_view::npos; pos = input.find('\n', pos + 1))
+		lineStarts.push_back(pos + 1);
+	auto lineOf = [&](std::size_t offset) {
+		return static_cast<std::size_t>(std::upper_bound(lineStarts.begin(), lineStarts.end(), offset) - lineStarts.begin());
+	};
+	auto firstLine = lineOf(changeBegin);
+	auto lastLine = lineOf(changeEnd);
+
+	// The part begins after the last line break between items of the file which precedes the first changed line
+	auto firstToken = tokens->begin();
+	std::size_t line = 1, firstTokenLine = 1, rulesCount = 0, firstRule = 0;
+	bool betweenItems = true;
+	for (auto itr = tokens->begin(); itr != tokens->end(); ++itr)
+	{
+		auto newLines = lineBreaks(*itr);
+		if (!newLines)
+			return std::nullopt;
+
+		auto type = itr->getType();
+		if (startsFileItem(type))
+			betweenItems = false;
+		else if (type == TokenType::RULE_END || type == TokenType::IMPORT_MODULE || type == TokenType::INCLUDE_PATH)
+			betweenItems = true;
+
+		if (type == TokenType::RULE_END)
+			++rulesCount;
+
+		line += newLines.value();
+		if (betweenItems && type == TokenType::NEW_LINE && line <= firstLine)
+		{
+			firstToken = std::next(itr);
+			firstTokenLine = line;
+			firstRule = rulesCount;
+		}
+	}
+
+	// Rules of included files are not in the token stream of the file
+	if (rulesCount != file.getRules().size())
+		return std::nullopt;
+
+	// Lines following the last changed line are the same as the last lines of the old input
+	auto lineShift = static_cast<std::ptrdiff_t>(lineStarts.size()) - static_cast<std::ptrdiff_t>(line);
+	auto lastOldLine = static_cast<std::ptrdiff_t>(lastLine) - lineShift;
+
+	auto endToken = tokens->end();
+	auto endRule = firstRule;
+	line = firstTokenLine;
+	for (auto itr = firstToken; itr != tokens->end(); ++itr)
+	{
+		auto type = itr->getType();
+		if (startsFileItem(type) && static_cast<std::ptrdiff_t>(line) > lastOldLine)
+		{
+			endToken = itr;
+			break;
+		}
+
+		// Imports and includes change the whole file
+		if (type == TokenType::IMPORT_KEYWORD || type == TokenType::INCLUDE_DIRECTIVE)
+			return std::nullopt;
+
+		if (type == TokenType::RULE_END)
+			++endRule;
+		line += lineBreaks(*itr).value();
+	}
+
+	auto endOffset = input.size();
+	if (endToken != tokens->end())
+	{
+		auto position = endToken->getLocation().begin();
+		auto endLine = static_cast<std::ptrdiff_t>(position.getLine()) + lineShift;
+		if (position.getLine() != line || endLine < 1 || static_cast<std::size_t>(endLine) > lineStarts.size())
+			return std::nullopt;
+
+		endOffset = lineStarts[endLine - 1] + position.getColumn() - 1;
+		if (endOffset < changeEnd || input.compare(std::min(endOffset, input.size()), endToken->getString().size(), endToken->getString()) != 0)
+			return std::nullopt;
+	}
+
+	auto beginOffset = lineStarts[firstTokenLine - 1];
+	if (beginOffset > changeBegin)
+		return std::nullopt;
+
+	return ReparseWindow{firstToken, endToken, firstRule, endRule, beginOffset, endOffset, firstTokenLine, lineShift};
+}
+
+/**
+ * Parses the part of the input again and replaces the old tokens and rules of the part
+ * with the new ones. Lines of the tokens and rules following the part are moved accordingly.
+ * Nothing is changed if the part can't be parsed on its own.
+ *
+ * @param file File parsed from the previous content of the input.
+ * @param input New content of the input.
+ * @param window Part of the input to parse again.
+ *
+ * @return @c true if the part was parsed, otherwise @c false.
+ */
+bool ParserDriver::reparseWindow(YaraFile& file, std::string_view input, const ReparseWindow& window)
+{
+	_file = std::move(file);
+	auto tokenStream = _file.getTokenStreamSharedPtr();
+	auto fileLocation = tokenStream->front().getLocation();
+	auto filePath = fileLocation.getFilePath();
+
+	// Rules parsed again take over the symbols of the old ones so the references from the following rules stay valid
+	auto oldRules = _file.detachRules(window.firstRule, window.endRule);
+	for (const auto& rule : oldRules)
+		_reparsedRules.emplace(rule->getName(), rule->getSymbol());
+
+	shiftLines(fileLocation, window.endToken, tokenStream->end(), _file.getRules(), window.firstRule, window.lineShift);
+	if (window.endToken != tokenStream->end())
+		_reparseEnd = window.endToken->getLocation().begin();
+
+	_reparsing = true;
+	auto rulesCount = _file.getRules().size();
+	auto lastOldToken = std::prev(tokenStream->end());
+	auto windowInput = input.substr(window.beginOffset, window.endOffset - window.beginOffset);
+	bool parsed = false;
+	try
+	{
+		_fileContexts.emplace_back(filePath, windowInput, tokenStream);
+		currentFileContext()->getLocation() = Location(filePath, window.line, 0);
+		parsed = parseImpl();
+	}
+	catch (const YaramodError&)
+	{
+		parsed = false;
+	}
+
+	auto newRules = _file.detachRules(rulesCount, _file.getRules().size());
+	auto firstNewToken = std::next(lastOldToken);
+	if (parsed)
+	{
+		// All lines of the part have to be counted so the lines of the following tokens stay in sync with the input
+		std::size_t newLines = 0;
+		for (auto itr = firstNewToken; parsed && itr != tokenStream->end(); ++itr)
+		{
+			auto tokenNewLines = lineBreaks(*itr);
+			parsed = tokenNewLines.has_value();
+			newLines += tokenNewLines.value_or(0);
+		}
+		parsed = parsed && newLines == static_cast<std::size_t>(std::count(windowInput.begin(), windowInput.end(), '\n'));
+
+		// Removed rules might be referenced by the following rules
+		for (const auto& rule : oldRules)
+		{
+			parsed = parsed && std::any_of(newRules.begin(), newRules.end(), [&](const auto& newRule) {
+				return newRule->getName() == rule->getName();
+			});
+		}
+	}
 
-	if (ruleExists(rule->getName()))
-		throw ParserError("Error: Redefinition of rule " + rule->getName());
+	if (parsed)
+	{
+		// New tokens were appended to the end so they already follow the old ones if the part is at the end of the file
+		if (window.endToken != tokenStream->end())
+		{
+			tokenStream->erase(window.firstToken, window.endToken);
+			tokenStream->moveAppend(window.endToken, tokenStream.get(), firstNewToken, tokenStream->end());
+		}
+		else if (window.firstToken != tokenStream->end())
+			tokenStream->erase(window.firstToken, firstNewToken);
+		_file.attachRules(window.firstRule, std::move(newRules));
+	}
+	else
+	{
+		tokenStream->erase(firstNewToken, tokenStream->end());
+		shiftLines(fileLocation, window.endToken, tokenStream->end(), _file.getRules(), window.firstRule, -window.lineShift);
+		_file.attachRules(window.firstRule, std::move(oldRules));
+	}
 
-	_file.addRule(std::move(rule));
+	_reparsing = false;
+	_reparseEnd.reset();
+	_reparsedRules.clear();
+	file = std::move(_file);
+	return parsed;
 }
 
 /**
@@ -2837,13 +3517,30 @@ void ParserDriver::stringLoopLeave()
  *
  * @return Valid symbol if found, @c nullptr otherwise.
  */
-std::shared_ptr<Symbol> ParserDriver::findSymbol(const std::string& name) const
+std::shared_ptr<Symbol> ParserDriver::findSymbol(const std::string& name)
 {
+	auto* profile = activeProfile();
+	if (profile)
+		profile->addSymbolLookup();
+	ParserProfile::Scope scope(profile, ParserPhase::SymbolLookup);
+
 	auto itr = _localSymbols.find(name);
 	if (itr != _localSymbols.end())
 		return itr->second;
 
-	return _file.findSymbol(name);
+	if (auto streamedItr = _streamedRules.find(name); streamedItr != _streamedRules.end())
+		return streamedItr->second;
+
+	// Rules following the part of the file which is parsed again are not defined yet at this point
+	if (_reparseEnd)
+	{
+		if (const auto* rule = _file.findRule(name); rule && !(rule->getLocation().begin() < _reparseEnd.value()))
+			return nullptr;
+	}
+
+	auto symbol = _file.findSymbol(name);
+	recordSymbolLookup(name, symbol != nullptr);
+	return symbol;
 }
 
 /**
@@ -2910,25 +3607,332 @@ bool ParserDriver::isAlreadyIncluded(const std::string& includePath)
 
 IncludeResult ParserDriver::includeFileImpl(const std::string& includePath, std::optional<std::shared_ptr<TokenStream>> tokenStream)
 {
+	ParserProfile::Scope scope(activeProfile(), ParserPhase::IncludeLoading);
 	if (_mode == ParserMode::IncludeGuarded && isAlreadyIncluded(includePath))
 		return IncludeResult::AlreadyIncluded;
 
-	// We need to allocate ifstreams dynamically because they are not copyable and we need to store them
-	// in vector to prolong their lifetime because of flex.
-	auto fileStream = std::make_shared<std::ifstream>(includePath, std::ios::binary);
-	if (!fileStream->is_open())
-		return IncludeResult::Error;
+	// Files are mapped into memory and tokenized in place so they have to be kept
+	// until the end of their include is reached.
+	std::unique_ptr<MappedFile> file;
+	if (_includePrefetcher)
+		file = _includePrefetcher->take(absolutePath(includePath));
+
+	if (!file)
+	{
+		file = std::make_unique<MappedFile>(includePath);
+		if (!file->isOpen())
+			return IncludeResult::Error;
+
+		// Includes of prefetched files were already queued by the prefetcher
+		if (_includePrefetcher)
+			_includePrefetcher->prefetchIncludesOf(includePath, file->getContent());
+	}
+
+	if (auto* profile = activeProfile())
+	{
+		// The file parsed by parse(filePath) is opened in the same way as the included files
+		if (!_fileContexts.empty())
+			profile->addIncludedFile();
+		profile->addBytesRead(file->getContent().size());
+	}
 
-	_includedFiles.push_back(std::move(fileStream));
+	_includedFiles.push_back(std::move(file));
 	if (tokenStream)
-		_fileContexts.emplace_back(includePath, _includedFiles.back().get(), tokenStream.value());
+		_fileContexts.emplace_back(includePath, _includedFiles.back()->getContent(), tokenStream.value());
 	else
-		_fileContexts.emplace_back(includePath, _includedFiles.back().get());
+		_fileContexts.emplace_back(includePath, _includedFiles.back()->getContent());
 	_includedFilesCache.emplace(absolutePath(includePath));
 
 	return IncludeResult::Included;
 }
 
+/**
+ * Returns whether included files are looked up in the include cache and stored there.
+ * Includes are not cached in incomplete modes, in streaming mode and while parsing only
+ * a part of the file again.
+ *
+ * @return @c true if includes are cached, otherwise @c false.
+ */
+bool ParserDriver::cachingIncludes() const
+{
+	return _includeCache && !streamingMode() && !_reparsing
+		&& (_mode == ParserMode::Regular || _mode == ParserMode::IncludeGuarded);
+}
+
+/**
+ * Uses the cached tokens and rules of the included file in place of parsing it.
+ * The cached include is used only if its nested includes are unchanged and it would
+ * be parsed in the same way at the current point of the parsed file.
+ *
+ * @param filePath Absolute path to the included file.
+ * @param contentHash Hash of the content of the included file.
+ * @param includeToken Token of the include path which receives the tokens of the file.
+ *
+ * @return @c true if the cached include was used, otherwise @c false.
+ */
+bool ParserDriver::useCachedInclude(const std::string& filePath, const ContentHash& contentHash, TokenIt includeToken)
+{
+	auto cached = _includeCache->find(filePath, contentHash);
+	if (!cached || cached->features != _features)
+		return false;
+
+	for (const auto& [nestedPath, nestedHash] : cached->includedFiles)
+	{
+		if (_mode == ParserMode::IncludeGuarded && isAlreadyIncluded(nestedPath))
+			return false;
+
+		MappedFile nestedFile(nestedPath);
+		if (!nestedFile.isOpen() || IncludeCache::hashContent(nestedFile.getContent()) != nestedHash)
+			return false;
+	}
+
+	// Symbols which were not defined when the file was parsed can't be defined now
+	for (const auto& name : cached->undefinedSymbols)
+	{
+		if (_file.findSymbol(name))
+			return false;
+	}
+
+	// Redefinitions need to be reported by parsing the file
+	for (const auto& rule : cached->rules)
+	{
+		if (ruleExists(rule->getName()))
+			return false;
+	}
+
+	// The file gets its own tokens and rules, so it can be modified independently of the cache
+	auto include = cached->clone();
+	popFileContext();
+	_includedFiles.pop_back();
+	includeToken->setSubTokenStream(include->tokenStream);
+	for (const auto& nested : include->includedFiles)
+		_includedFilesCache.emplace(nested.first);
+
+	for (const auto& import : include->imports)
+	{
+		_file.addImport(import, *_modules);
+		recordImport(import);
+	}
+
+	for (const auto& rule : include->rules)
+	{
+		recordDefinedSymbol(rule->getName());
+		_file.addRule(rule);
+	}
+
+	for (auto& recording : _includeRecordings)
+		recording.include->undefinedSymbols.insert(include->undefinedSymbols.begin(), include->undefinedSymbols.end());
+
+	if (!_includeRecordings.empty())
+	{
+		auto& parent = _includeRecordings.back().include;
+		parent->includedFiles.emplace_back(filePath, contentHash);
+		parent->includedFiles.insert(parent->includedFiles.end(), include->includedFiles.begin(), include->includedFiles.end());
+	}
+
+	return true;
+}
+
+/**
+ * Records the rule or the module defined by the included files being parsed.
+ *
+ * @param name Name of the rule or the module.
+ */
+void ParserDriver::recordDefinedSymbol(const std::string& name)
+{
+	for (auto& recording : _includeRecordings)
+		recording.definedSymbols.insert(name);
+}
+
+/**
+ * Records the import of the included files being parsed.
+ *
+ * @param import Token of the imported module.
+ */
+void ParserDriver::recordImport(TokenIt import)
+{
+	for (auto& recording : _includeRecordings)
+	{
+		recording.definedSymbols.insert(import->getPureText());
+		recording.include->imports.push_back(import);
+	}
+}
+
+/**
+ * Records the lookup of the global symbol by the included files being parsed.
+ * Files which use a symbol they didn't define themselves can't be cached.
+ *
+ * @param name Name of the symbol.
+ * @param found @c true if the symbol was found.
+ */
+void ParserDriver::recordSymbolLookup(const std::string& name, bool found)
+{
+	for (auto& recording : _includeRecordings)
+	{
+		if (!found)
+			recording.include->undefinedSymbols.insert(name);
+		else if (recording.definedSymbols.find(name) == recording.definedSymbols.end())
+			recording.cacheable = false;
+	}
+}
+
+/**
+ * Stores the included files whose end was reached into the include cache.
+ * It has to be called after their last item is parsed.
+ */
+void ParserDriver::finishIncludeRecordings()
+{
+	while (!_includeRecordings.empty() && _includeRecordings.back().ended)
+	{
+		auto recording = std::move(_includeRecordings.back());
+		_includeRecordings.pop_back();
+
+		const auto& rules = _file.getRules();
+		recording.include->rules.assign(rules.begin() + recording.firstRule, rules.end());
+		if (recording.cacheable)
+			_includeCache->store(recording.filePath, recording.contentHash, recording.include->clone());
+
+		if (!_includeRecordings.empty())
+		{
+			auto& parent = _includeRecordings.back().include;
+			parent->includedFiles.emplace_back(recording.filePath, recording.contentHash);
+			parent->includedFiles.insert(parent->includedFiles.end(), recording.include->includedFiles.begin(), recording.include->includedFiles.end());
+		}
+	}
+}
+
+/**
+ * Parses the top-level input and recovers from the errors in it. After an error, the tokens and rules
+ * of the item the error occurred in are dropped and the parsing starts again at the next line which
+ * begins a rule, an import or an include. Errors in included files are recovered from in the top-level
+ * input, so the whole include is dropped including its imports and the files it included. Items parsed
+ * before the error are kept together with their symbols so the following rules can still refer to them.
+ *
+ * @return Result of the last parsing of the input.
+ */
+std::optional<Value> ParserDriver::parseRecovering()
+{
+	auto input = currentFileContext()->getInput();
+	auto filePath = currentFileContext()->getLocation().getFilePath();
+	auto tokenStream = currentFileContext()->getTokenStream();
+	auto includedFiles = _includedFiles.size();
+
+	std::size_t begin = 0;
+	while (true)
+	{
+		_lastRecoveredToken = tokenStream->empty() ? std::nullopt : std::make_optional(std::prev(tokenStream->end()));
+		_recoveredRules = _file.getRules().size();
+		_recoveredImports = _file.getImports().size();
+		_recoveredIncludedFiles = _includedFilesCache;
+		try
+		{
+			return _parser.parse(currentFileContext()->getInput());
+		}
+		catch (const pog::SyntaxError& err)
+		{
+			_errors.push_back(parser_error(!_fileContexts.empty() ? currentFileContext()->getLocation() : _errorLocation, err.what()));
+		}
+		catch (const ParserError& err)
+		{
+			_errors.push_back(err);
+		}
+
+		auto remainingInput = _parser.get_remaining_input(0);
+		auto errorOffset = remainingInput ? static_cast<std::size_t>(remainingInput.value().data() - input.data()) : input.size();
+		auto resumeOffset = findRecoveryPoint(input, begin, errorOffset).value_or(input.size());
+
+		tokenStream->erase(_lastRecoveredToken ? std::next(_lastRecoveredToken.value()) : tokenStream->begin(), tokenStream->end());
+		_file.detachRules(_recoveredRules, _file.getRules().size());
+		_file.detachImports(_recoveredImports);
+		_includedFilesCache = _recoveredIncludedFiles;
+
+		_strLiteral.clear();
+		_indent.clear();
+		_comment.clear();
+		_regexpClass.clear();
+		_sectionStrings = false;
+		_currentStrings = std::weak_ptr<Rule::StringsTrie>();
+		_stringLoop = false;
+		_localSymbols.clear();
+		_expressionArrayStack.clear();
+		_includeRecordings.clear();
+		_includedFiles.resize(includedFiles);
+
+		// Rest of the input is parsed as if it was the whole input
+		auto line = static_cast<std::size_t>(std::count(input.begin(), input.begin() + resumeOffset, '\n'));
+		_fileContexts.clear();
+		_fileContexts.emplace_back(filePath, input.substr(resumeOffset), tokenStream);
+		currentFileContext()->getLocation() = Location(filePath, line + 1, 0);
+		begin = resumeOffset;
+	}
+}
+
+/**
+ * Remembers the tokens and rules of the top-level input parsed so far, which are kept when an error
+ * occurs in the following item. Item is finished when the first token of the next item was already read.
+ */
+void ParserDriver::markRecoveryPoint()
+{
+	const auto& tokenStream = currentTokenStream();
+	if (tokenStream->empty())
+		return;
+
+	auto nextItemToken = std::prev(tokenStream->end());
+	_lastRecoveredToken = nextItemToken == tokenStream->begin() ? std::nullopt : std::make_optional(std::prev(nextItemToken));
+	_recoveredRules = _file.getRules().size();
+	_recoveredImports = _file.getImports().size();
+	// Included files are only added while parsing, so the same size means the same files
+	if (_recoveredIncludedFiles.size() != _includedFilesCache.size())
+		_recoveredIncludedFiles = _includedFilesCache;
+}
+
+/**
+ * Finds the line to resume the parsing at after an error. It is the first line following the beginning
+ * of the failed parsing which begins a rule, an import or an include. The line of the error is used only
+ * if the error occurred at its first token, otherwise it belongs to the item which failed.
+ *
+ * @param input Top-level input.
+ * @param begin Offset of the input the failed parsing began at.
+ * @param errorOffset Offset of the input right after the token the error occurred at.
+ *
+ * @return Offset of the line if found.
+ */
+std::optional<std::size_t> ParserDriver::findRecoveryPoint(std::string_view input, std::size_t begin, std::size_t errorOffset)
+{
+	constexpr std::string_view blanks = " \t\v\r";
+	auto keywordAt = [&](std::size_t pos, std::string_view keyword) {
+		auto end = pos + keyword.size();
+		return input.compare(pos, keyword.size(), keyword) == 0 && end < input.size()
+			&& !std::isalnum(static_cast<unsigned char>(input[end])) && input[end] != '_';
+	};
+
+	errorOffset = std::min(errorOffset, input.size());
+	auto lineStart = errorOffset == 0 ? std::string_view::npos : input.rfind('\n', errorOffset - 1);
+	lineStart = lineStart == std::string_view::npos ? 0 : lineStart + 1;
+	while (lineStart < input.size())
+	{
+		auto pos = input.find_first_not_of(blanks, lineStart);
+		if (lineStart > begin && pos != std::string_view::npos)
+		{
+			auto firstTokenEnd = input.find_first_of(" \t\v\r\n\"", pos);
+			auto beginsItem = keywordAt(pos, "import") || keywordAt(pos, "include");
+			while (!beginsItem && pos != std::string_view::npos && (keywordAt(pos, "private") || keywordAt(pos, "global")))
+				pos = input.find_first_not_of(blanks, input.find_first_of(blanks, pos));
+			beginsItem = beginsItem || (pos != std::string_view::npos && keywordAt(pos, "rule"));
+
+			if (beginsItem && (lineStart > errorOffset || errorOffset <= firstTokenEnd))
+				return lineStart;
+		}
+
+		lineStart = input.find('\n', lineStart);
+		if (lineStart == std::string_view::npos)
+			break;
+		++lineStart;
+	}
+
+	return std::nullopt;
+}
+
 void ParserDriver::checkStringModifier(const std::vector<std::shared_ptr<StringModifier>>& previousMods, const std::shared_ptr<StringModifier>& newMod)
 {
 	using T = StringModifier::Type;
@@ -3031,9 +4035,9 @@ void ParserDriver::handleExpressionArrayItem(const Expression::Ptr& expr)
 Expression::Ptr ParserDriver::handleExpressionArrayEnd(TokenIt lb, std::vector<Expression::Ptr>&& exprs, TokenIt rb)
 {
 	if (isCurrentExpressionArrayUndetermined() || isCurrentExpressionArrayStringSet())
-		return std::make_shared<SetExpression>(lb, std::move(exprs), rb);
+		return makeExpression<SetExpression>(lb, std::move(exprs), rb);
 	else
-		return std::make_shared<IterableExpression>(lb, std::move(exprs), rb);
+		return makeExpression<IterableExpression>(lb, std::move(exprs), rb);
 }
 
 void ParserDriver::enterExpressionArray()
@@ -0,0 +1,60 @@
+/**
+ * @file src/parser/parser_profile.cpp
+ * @brief Implementation of class ParserProfile.
+ * @copyright (c) 2026 Avast Software, licensed under the MIT license
+ */
+
+#include <numeric>
+
+#include "yaramod/parser/parser_profile.h"
+
+namespace yaramod {
+
+/**
+ * Clears all measured times and counts.
+ */
+void ParserProfile::clear()
+{
+	*this = ParserProfile{};
+}
+
+/**
+ * Enters the phase. The phase which was entered before is paused until the phase is left.
+ *
+ * @param phase Entered phase.
+ */
+void ParserProfile::enter(ParserPhase phase)
+{
+	auto now = Clock::now();
+	if (!_phases.empty())
+		_times[static_cast<std::size_t>(_phases.back())] += now - _phaseStart;
+
+	_phases.push_back(phase);
+	_phaseStart = now;
+}
+
+/**
+ * Leaves the phase which was entered last and resumes the phase entered before it.
+ */
+void ParserProfile::leave()
+{
+	if (_phases.empty())
+		return;
+
+	auto now = Clock::now();
+	_times[static_cast<std::size_t>(_phases.back())] += now - _phaseStart;
+	_phases.pop_back();
+	_phaseStart = now;
+}
+
+/**
+ * Returns the total time of all phases.
+ *
+ * @return Total time.
+ */
+std::chrono::nanoseconds ParserProfile::getTotalTime() const
+{
+	return std::accumulate(_times.begin(), _times.end(), std::chrono::nanoseconds{0});
+}
+
+} // namespace yaramod
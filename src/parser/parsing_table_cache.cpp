@@ -0,0 +1,118 @@
+/**
+ * @file src/parser/parsing_table_cache.cpp
+ * @brief Implementation of class ParsingTableCache.
+ * @copyright (c) 2026 Avast Software, licensed under the MIT license
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#include "yaramod/parser/parsing_table_cache.h"
+#include "yaramod/utils/filesystem.h"
+
+namespace yaramod {
+
+/**
+ * Returns the process-wide instance of the cache.
+ *
+ * @return Cache instance.
+ */
+ParsingTableCache& ParsingTableCache::instance()
+{
+	static ParsingTableCache cache;
+	return cache;
+}
+
+/**
+ * Finds serialized parsing table for the grammar with given features. The table is first
+ * searched in memory and then in the directory specified by YARAMOD_PARSER_TABLE_CACHE.
+ * The returned table might not belong to the current grammar, it needs to be validated by the parser.
+ *
+ * @param features Features of the grammar.
+ *
+ * @return Serialized table if found, otherwise @c std::nullopt.
+ */
+std::optional<std::string> ParsingTableCache::find(Features features)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (auto itr = _tables.find(static_cast<int>(features)); itr != _tables.end())
+		return itr->second;
+
+	auto path = _cacheFilePath(features);
+	if (!path)
+		return std::nullopt;
+
+	std::ifstream file(path.value(), std::ios::binary);
+	if (!file.is_open())
+		return std::nullopt;
+
+	std::ostringstream content;
+	content << file.rdbuf();
+	// Table read from the file is remembered even though it is not validated yet. If it turns out
+	// to be invalid, the caller computes the table on its own and replaces it using store().
+	auto& table = _tables[static_cast<int>(features)];
+	table = content.str();
+	return table;
+}
+
+/**
+ * Stores serialized parsing table for the grammar with given features. If the cache directory
+ * is specified, the table is also written there. Failures to write the file are ignored because
+ * the cache is only an optimization.
+ *
+ * @param features Features of the grammar.
+ * @param table Serialized table.
+ */
+void ParsingTableCache::store(Features features, const std::string& table)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_tables[static_cast<int>(features)] = table;
+
+	auto path = _cacheFilePath(features);
+	if (!path)
+		return;
+
+	// Write into temporary file first and then rename it so other processes never see incomplete table
+	auto tmpPath = path.value() + ".tmp" + std::to_string(std::random_device{}());
+	bool written = false;
+	{
+		std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+			return;
+		file.write(table.data(), table.size());
+		file.close();
+		written = file.good();
+	}
+
+	std::error_code ec;
+	if (written)
+		fs::rename(tmpPath, path.value(), ec);
+	if (!written || ec)
+		fs::remove(tmpPath, ec);
+}
+
+/**
+ * Removes all tables stored in memory. Files in the cache directory are kept.
+ */
+void ParsingTableCache::clear()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_tables.clear();
+}
+
+std::optional<std::string> ParsingTableCache::_cacheFilePath(Features features) const
+{
+	const char* directory = std::getenv("YARAMOD_PARSER_TABLE_CACHE");
+	if (!directory || !*directory)
+		return std::nullopt;
+
+	std::error_code ec;
+	if (!fs::is_directory(directory, ec))
+		return std::nullopt;
+
+	return (fs::path(directory) / ("parsing_table_" + std::to_string(static_cast<int>(features)) + ".bin")).string();
+}
+
+} // namespace yaramod
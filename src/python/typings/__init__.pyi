@@ -47,6 +47,8 @@ class BinaryOpExpression(Expression):
     left_operand: Expression
     right_operand: Expression
     def __init__(self, *args, **kwargs) -> None: ...
+    @property
+    def operands(self) -> List[Expression]: ...
 
 class BitwiseAndExpression(BinaryOpExpression):
     def __init__(self, *args, **kwargs) -> None: ...
@@ -234,6 +236,10 @@ class IequalsExpression(BinaryOpExpression):
 class IstartsWithExpression(BinaryOpExpression):
     def __init__(self, *args, **kwargs) -> None: ...
 
+class IncludeCache:
+    def __init__(self, *args, **kwargs) -> None: ...
+    def clear(self) -> None: ...
+
 class IntFunctionEndianness:
     __members__: ClassVar[dict] = ...  # read-only
     Big: ClassVar[IntFunctionEndianness] = ...
@@ -359,6 +365,11 @@ class Meta:
     @property
     def token_value(self) -> Token: ...
 
+class MemoryIncludeCache(IncludeCache):
+    def __init__(self) -> None: ...
+    @property
+    def size(self) -> int: ...
+
 class MinusExpression(BinaryOpExpression):
     def __init__(self, *args, **kwargs) -> None: ...
 
@@ -656,7 +667,21 @@ class ParenthesesExpression(Expression):
     enclosed_expr: Expression
     def __init__(self, *args, **kwargs) -> None: ...
 
-class ParserError(Exception): ...
+class ParseResult:
+    def __init__(self, *args, **kwargs) -> None: ...
+    @property
+    def error(self) -> str: ...
+    @property
+    def errors(self) -> List[ParserError]: ...
+    @property
+    def file_path(self) -> str: ...
+    @property
+    def profile(self) -> ParserProfile: ...
+    @property
+    def yara_file(self) -> Optional[YaraFile]: ...
+
+class ParserError(Exception):
+    location: Location
 
 class ParserMode:
     __members__: ClassVar[dict] = ...  # read-only
@@ -678,6 +703,47 @@ class ParserMode:
     @property
     def value(self) -> int: ...
 
+class ParserPhase:
+    __members__: ClassVar[dict] = ...  # read-only
+    Actions: ClassVar[ParserPhase] = ...
+    FileConstruction: ClassVar[ParserPhase] = ...
+    IncludeLoading: ClassVar[ParserPhase] = ...
+    ModuleLoading: ClassVar[ParserPhase] = ...
+    Parsing: ClassVar[ParserPhase] = ...
+    SymbolLookup: ClassVar[ParserPhase] = ...
+    Tokenizing: ClassVar[ParserPhase] = ...
+    __entries: ClassVar[dict] = ...
+    def __init__(self, value: int) -> None: ...
+    def __eq__(self, other: object) -> bool: ...
+    def __getstate__(self) -> int: ...
+    def __hash__(self) -> int: ...
+    def __index__(self) -> int: ...
+    def __int__(self) -> int: ...
+    def __ne__(self, other: object) -> bool: ...
+    def __setstate__(self, state: int) -> None: ...
+    @property
+    def name(self) -> str: ...
+    @property
+    def value(self) -> int: ...
+
+class ParserProfile:
+    def __init__(self, *args, **kwargs) -> None: ...
+    def time(self, phase: ParserPhase) -> float: ...
+    @property
+    def bytes_read(self) -> int: ...
+    @property
+    def imports(self) -> int: ...
+    @property
+    def included_files(self) -> int: ...
+    @property
+    def reductions(self) -> int: ...
+    @property
+    def symbol_lookups(self) -> int: ...
+    @property
+    def tokens(self) -> int: ...
+    @property
+    def total_time(self) -> float: ...
+
 class PercentualExpression(UnaryOpExpression):
     def __init__(self, *args, **kwargs) -> None: ...
 
@@ -1548,11 +1614,27 @@ class YaraRuleBuilder:
 
 class Yaramod:
     def __init__(self, import_features: Features = ..., modules_directory: str = ...) -> None: ...
+    @overload
     def parse_file(self, file_path: str, parser_mode: ParserMode = ...) -> YaraFile: ...
+    @overload
+    def parse_file(self, file_path: str, on_rule: Callable[[Rule, YaraFile], None], parser_mode: ParserMode = ...) -> bool: ...
+    def parse_files(self, file_paths: List[str], threads: int = ..., parser_mode: ParserMode = ...) -> List[ParseResult]: ...
+    @overload
     def parse_string(self, str: str, parser_mode: ParserMode = ...) -> YaraFile: ...
+    @overload
+    def parse_string(self, str: str, on_rule: Callable[[Rule, YaraFile], None], parser_mode: ParserMode = ...) -> bool: ...
+    def set_include_cache(self, include_cache: Optional[IncludeCache]) -> None: ...
+    def set_include_prefetch_threads(self, threads: int) -> None: ...
+    def set_error_recovery(self, error_recovery: bool) -> None: ...
+    def set_profiling(self, profiling: bool) -> None: ...
+    def set_arena_allocation(self, arena_allocation: bool) -> None: ...
+    @property
+    def errors(self) -> List[ParserError]: ...
     @property
     def modules(self) -> Dict[str,Module]: ...
     @property
+    def profile(self) -> ParserProfile: ...
+    @property
     def yara_file(self) -> YaraFile: ...
 
 class _BoolLiteralExpression(Expression):
@@ -5,6 +5,7 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <iterator>
 
 #include <pybind11/pybind11.h>
@@ -53,6 +54,23 @@ decltype(auto) binaryOpClass(py::module& module, const std::string& name)
 	return exprClass<ExprType, BinaryOpExpression>(module, name);
 }
 
+// Errors are instances of ParserError exception with the location of the error
+py::object parserError(const py::object& errorType, const ParserError& err)
+{
+	auto error = errorType(err.getErrorMessage());
+	error.attr("location") = err.getLocation();
+	return error;
+}
+
+py::list parserErrors(const std::vector<ParserError>& errors)
+{
+	auto errorType = py::module::import("yaramod").attr("ParserError");
+	py::list result;
+	for (const auto& err : errors)
+		result.append(parserError(errorType, err));
+	return result;
+}
+
 void addVersionVariables(py::module& module)
 {
 	module.attr("YARAMOD_VERSION_MAJOR") = YARAMOD_VERSION_MAJOR;
@@ -70,6 +88,15 @@ void addEnums(py::module& module)
 		.value("Incomplete", ParserMode::Incomplete)
 		.value("DeferredInclude", ParserMode::DeferredInclude);
 
+	py::enum_<ParserPhase>(module, "ParserPhase")
+		.value("Parsing", ParserPhase::Parsing)
+		.value("Tokenizing", ParserPhase::Tokenizing)
+		.value("Actions", ParserPhase::Actions)
+		.value("SymbolLookup", ParserPhase::SymbolLookup)
+		.value("ModuleLoading", ParserPhase::ModuleLoading)
+		.value("IncludeLoading", ParserPhase::IncludeLoading)
+		.value("FileConstruction", ParserPhase::FileConstruction);
+
 	py::enum_<Features>(module, "Features", py::arithmetic())
 		.value("Basic", Features::Basic)
 		.value("AvastOnly", Features::AvastOnly)
@@ -404,7 +431,7 @@ void addBasicClasses(py::module& module)
 	py::class_<PlainString, String, std::shared_ptr<PlainString>>(module, "PlainString");
 	py::class_<HexString, String, std::shared_ptr<HexString>>(module, "HexString");
 	py::class_<Regexp, String, std::shared_ptr<Regexp>>(module, "Regexp")
-		.def("clone", &Regexp::clone)
+		.def("clone", py::overload_cast<const std::shared_ptr<TokenStream>&>(&Regexp::clone, py::const_))
 		.def_property("unit",
 				&Regexp::getUnit,
 				py::overload_cast<const std::shared_ptr<RegexpUnit>&>(&Regexp::setUnit))
@@ -658,7 +685,8 @@ void addExpressionClasses(py::module& module)
 				py::overload_cast<const Expression::Ptr&>(&BinaryOpExpression::setLeftOperand))
 		.def_property("right_operand",
 				&BinaryOpExpression::getRightOperand,
-				py::overload_cast<const Expression::Ptr&>(&BinaryOpExpression::setRightOperand));
+				py::overload_cast<const Expression::Ptr&>(&BinaryOpExpression::setRightOperand))
+		.def_property_readonly("operands", &BinaryOpExpression::getOperands);
 	binaryOpClass<AndExpression>(module, "AndExpression");
 	binaryOpClass<OrExpression>(module, "OrExpression");
 	binaryOpClass<LtExpression>(module, "LtExpression");
@@ -1027,13 +1055,60 @@ void addBuilderClasses(py::module& module)
 
 void addMainClass(py::module& module)
 {
+	py::class_<IncludeCache, std::shared_ptr<IncludeCache>>(module, "IncludeCache")
+		.def("clear", &IncludeCache::clear);
+
+	py::class_<MemoryIncludeCache, IncludeCache, std::shared_ptr<MemoryIncludeCache>>(module, "MemoryIncludeCache")
+		.def(py::init<>())
+		.def_property_readonly("size", &MemoryIncludeCache::size);
+
+	// Times are in seconds
+	py::class_<ParserProfile>(module, "ParserProfile")
+		.def("time", [](const ParserProfile& self, ParserPhase phase) {
+				return std::chrono::duration<double>(self.getTime(phase)).count();
+			}, py::arg("phase"))
+		.def_property_readonly("total_time", [](const ParserProfile& self) {
+				return std::chrono::duration<double>(self.getTotalTime()).count();
+			})
+		.def_property_readonly("tokens", &ParserProfile::getTokens)
+		.def_property_readonly("reductions", &ParserProfile::getReductions)
+		.def_property_readonly("symbol_lookups", &ParserProfile::getSymbolLookups)
+		.def_property_readonly("imports", &ParserProfile::getImports)
+		.def_property_readonly("included_files", &ParserProfile::getIncludedFiles)
+		.def_property_readonly("bytes_read", &ParserProfile::getBytesRead);
+
+	py::class_<ParseResult>(module, "ParseResult")
+		.def_readonly("file_path", &ParseResult::filePath)
+		.def_property_readonly("yara_file", [](const ParseResult& self) { return self.yaraFile.get(); }, py::return_value_policy::reference_internal)
+		.def_readonly("error", &ParseResult::error)
+		.def_property_readonly("errors", [](const ParseResult& self) { return parserErrors(self.errors); })
+		.def_readonly("profile", &ParseResult::profile);
+
 	py::class_<Yaramod>(module, "Yaramod")
 		.def(py::init<Features, const std::string&>(), py::arg("import_features") = Features::AllCurrent, py::arg("modules_directory") = "")
-		.def("parse_file", &Yaramod::parseFile, py::arg("file_path"), py::arg("parser_mode") = ParserMode::Regular)
+		.def("parse_file", py::overload_cast<const std::string&, ParserMode>(&Yaramod::parseFile), py::arg("file_path"), py::arg("parser_mode") = ParserMode::Regular)
+		.def("parse_file", [](Yaramod& self, const std::string& filePath, const py::function& onRule, ParserMode parserMode) {
+				return self.parseFile(filePath, [&](std::unique_ptr<Rule>&& rule, const YaraFile& file) {
+					onRule(std::shared_ptr<Rule>(std::move(rule)), py::cast(file, py::return_value_policy::reference));
+				}, parserMode);
+			}, py::arg("file_path"), py::arg("on_rule"), py::arg("parser_mode") = ParserMode::Regular)
 		.def("parse_string", [](Yaramod& self, const std::string& str, ParserMode parserMode) {
-				std::istringstream stream(str);
-				return self.parseStream(stream, parserMode);
+				return self.parseString(str, parserMode);
 			}, py::arg("str"), py::arg("parser_mode") = ParserMode::Regular)
+		.def("parse_string", [](Yaramod& self, const std::string& str, const py::function& onRule, ParserMode parserMode) {
+				return self.parseString(str, [&](std::unique_ptr<Rule>&& rule, const YaraFile& file) {
+					onRule(std::shared_ptr<Rule>(std::move(rule)), py::cast(file, py::return_value_policy::reference));
+				}, parserMode);
+			}, py::arg("str"), py::arg("on_rule"), py::arg("parser_mode") = ParserMode::Regular)
+		.def("parse_files", &Yaramod::parseFiles, py::arg("file_paths"), py::arg("threads") = 0, py::arg("parser_mode") = ParserMode::Regular,
+			py::call_guard<py::gil_scoped_release>())
+		.def("set_include_cache", &Yaramod::setIncludeCache, py::arg("include_cache"))
+		.def("set_include_prefetch_threads", &Yaramod::setIncludePrefetchThreads, py::arg("threads"))
+		.def("set_error_recovery", &Yaramod::setErrorRecovery, py::arg("error_recovery"))
+		.def_property_readonly("errors", [](const Yaramod& self) { return parserErrors(self.getErrors()); })
+		.def("set_profiling", &Yaramod::setProfiling, py::arg("profiling"))
+		.def_property_readonly("profile", &Yaramod::getProfile)
+		.def("set_arena_allocation", &Yaramod::setArenaAllocation, py::arg("arena_allocation"))
 		.def_property_readonly("yara_file", &Yaramod::getParsedFile)
 		.def_property_readonly("modules", &Yaramod::getModules);
 }
@@ -1050,7 +1125,7 @@ PYBIND11_MODULE(yaramod, module)
 			}
 			catch (const ParserError& err)
 			{
-				exception(err.what());
+				PyErr_SetObject(exception.ptr(), parserError(exception, err).ptr());
 			}
 		});
 
@@ -0,0 +1,101 @@
+/**
+ * @file src/types/expression_arena.cpp
+ * @brief Implementation of class ExpressionArena.
+ * @copyright (c) 2026 Avast Software, licensed under the MIT license
+ */
+
+#include <cstdint>
+
+#include "yaramod/types/expression_arena.h"
+#include "yaramod/utils/pool_allocator.h"
+
+namespace yaramod {
+
+using ChunkPool = BlockPool<ExpressionArena::ChunkSize>;
+
+/**
+ * Creates new arena. Destroying the returned pointer releases the arena once
+ * all expressions allocated in it are destroyed.
+ *
+ * @return The arena.
+ */
+std::shared_ptr<ExpressionArena> ExpressionArena::create()
+{
+	return std::shared_ptr<ExpressionArena>(new ExpressionArena(), [](ExpressionArena* arena) { arena->release(); });
+}
+
+ExpressionArena::~ExpressionArena()
+{
+	for (auto* chunk : _chunks)
+		ChunkPool::deallocate(chunk);
+}
+
+/**
+ * Allocates memory out of the last chunk. When the memory doesn't fit, new chunk is taken,
+ * memory which is too large for a chunk is allocated on its own. The reference of the allocation
+ * is taken out of the references reserved by the arena, new batch is reserved only when they run out.
+ *
+ * @param size Size of the memory in bytes.
+ * @param alignment Required alignment of the memory.
+ *
+ * @return Pointer to the uninitialized memory.
+ */
+void* ExpressionArena::allocate(std::size_t size, std::size_t alignment)
+{
+	if (_reservedReferences == 0)
+	{
+		_references.fetch_add(ReferenceBatch, std::memory_order_relaxed);
+		_reservedReferences = ReferenceBatch;
+	}
+	--_reservedReferences;
+
+	_usedBytes += size;
+	if (size + alignment > ChunkSize / 4)
+	{
+		_largeObjects.emplace_back(new unsigned char[size + alignment]);
+		_allocatedBytes += size + alignment;
+		auto* memory = _largeObjects.back().get();
+		return memory + (alignment - reinterpret_cast<std::uintptr_t>(memory) % alignment) % alignment;
+	}
+
+	auto padding = (alignment - reinterpret_cast<std::uintptr_t>(_next) % alignment) % alignment;
+	if (!_next || padding + size > _remaining)
+	{
+		_chunks.push_back(ChunkPool::allocate());
+		_next = static_cast<unsigned char*>(_chunks.back());
+		_remaining = ChunkSize;
+		_allocatedBytes += ChunkSize;
+		padding = (alignment - reinterpret_cast<std::uintptr_t>(_next) % alignment) % alignment;
+	}
+
+	auto* result = _next + padding;
+	_next += padding + size;
+	_remaining -= padding + size;
+	_usedBytes += padding;
+	return result;
+}
+
+/**
+ * Releases the reference of one allocation. The arena is destroyed once there
+ * are no references left.
+ */
+void ExpressionArena::deallocate() noexcept
+{
+	if (_references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		delete this;
+}
+
+/**
+ * Releases the reference of the owner of the arena together with the references
+ * reserved for allocations which will never happen. The arena is destroyed once
+ * there are no references left.
+ */
+void ExpressionArena::release() noexcept
+{
+	auto references = _reservedReferences + 1;
+	_reservedReferences = 0;
+	if (_references.fetch_sub(references, std::memory_order_acq_rel) == references)
+		delete this;
+}
+
+} // namespace yaramod
@@ -0,0 +1,514 @@
+/**
+ * @file src/types/expressions.cpp
+ * @brief Implementation of iterative operations on chains of binary operations.
+ * @copyright (c) 2026 Avast Software, licensed under the MIT license
+ */
+
+#include <algorithm>
+#include <typeinfo>
+#include <vector>
+
+#include "yaramod/types/expressions.h"
+
+namespace yaramod {
+
+namespace {
+
+/**
+ * Depth of nested binary operations up to which they are destroyed recursively.
+ */
+constexpr std::size_t MaxDestructionDepth = 1024;
+
+/**
+ * Returns whether the expression is a binary operation of yaramod which is processed iteratively.
+ * Classes derived from the binary operations outside of yaramod may override their virtual
+ * methods, so only the exact class of the kind of the expression is processed iteratively.
+ */
+bool isChained(const Expression* expr)
+{
+	switch (expr->getKind())
+	{
+		case ExpressionKind::And: return typeid(*expr) == typeid(AndExpression);
+		case ExpressionKind::Or: return typeid(*expr) == typeid(OrExpression);
+		case ExpressionKind::Lt: return typeid(*expr) == typeid(LtExpression);
+		case ExpressionKind::Gt: return typeid(*expr) == typeid(GtExpression);
+		case ExpressionKind::Le: return typeid(*expr) == typeid(LeExpression);
+		case ExpressionKind::Ge: return typeid(*expr) == typeid(GeExpression);
+		case ExpressionKind::Eq: return typeid(*expr) == typeid(EqExpression);
+		case ExpressionKind::Neq: return typeid(*expr) == typeid(NeqExpression);
+		case ExpressionKind::Contains: return typeid(*expr) == typeid(ContainsExpression);
+		case ExpressionKind::Icontains: return typeid(*expr) == typeid(IcontainsExpression);
+		case ExpressionKind::Matches: return typeid(*expr) == typeid(MatchesExpression);
+		case ExpressionKind::StartsWith: return typeid(*expr) == typeid(StartsWithExpression);
+		case ExpressionKind::IstartsWith: return typeid(*expr) == typeid(IstartsWithExpression);
+		case ExpressionKind::EndsWith: return typeid(*expr) == typeid(EndsWithExpression);
+		case ExpressionKind::IendsWith: return typeid(*expr) == typeid(IendsWithExpression);
+		case ExpressionKind::Iequals: return typeid(*expr) == typeid(IequalsExpression);
+		case ExpressionKind::Plus: return typeid(*expr) == typeid(PlusExpression);
+		case ExpressionKind::Minus: return typeid(*expr) == typeid(MinusExpression);
+		case ExpressionKind::Multiply: return typeid(*expr) == typeid(MultiplyExpression);
+		case ExpressionKind::Divide: return typeid(*expr) == typeid(DivideExpression);
+		case ExpressionKind::Modulo: return typeid(*expr) == typeid(ModuloExpression);
+		case ExpressionKind::BitwiseXor: return typeid(*expr) == typeid(BitwiseXorExpression);
+		case ExpressionKind::BitwiseAnd: return typeid(*expr) == typeid(BitwiseAndExpression);
+		case ExpressionKind::BitwiseOr: return typeid(*expr) == typeid(BitwiseOrExpression);
+		case ExpressionKind::ShiftLeft: return typeid(*expr) == typeid(ShiftLeftExpression);
+		case ExpressionKind::ShiftRight: return typeid(*expr) == typeid(ShiftRightExpression);
+		default: return false;
+	}
+}
+
+/**
+ * Appends the operation symbol to the text.
+ */
+void appendOperator(std::string& result, TokenIt op, bool linebreak, const std::string& indent)
+{
+	result += ' ';
+	result += op->getString();
+	if (linebreak)
+	{
+		result += '\n';
+		result += indent;
+	}
+	else
+		result += ' ';
+}
+
+/**
+ * Creates the flat operation over the first operands of the chain in the arena of the chain
+ * if it has one. Operations over the chain are created on demand by any thread.
+ */
+template <typename T>
+std::shared_ptr<T> makeOverChain(const std::shared_ptr<TokenStream>& ts, const std::shared_ptr<BinaryOpChain>& chain, std::size_t operands)
+{
+	if (const auto& arena = chain->getArena())
+		return arena->makeConcurrent<T>(ts, chain, operands);
+	return std::make_shared<T>(ts, chain, operands);
+}
+
+} // namespace
+
+/**
+ * Destructor. Operands of shallow binary operations are destroyed recursively. Deeper
+ * nested binary operations which are not referenced elsewhere are destroyed one by one
+ * so the destruction of a deep chain doesn't recurse.
+ */
+BinaryOpExpression::~BinaryOpExpression()
+{
+	thread_local std::size_t depth = 0;
+	if (depth < MaxDestructionDepth)
+	{
+		++depth;
+		_left.reset();
+		_right.reset();
+		_chain.reset();
+		--depth;
+		return;
+	}
+
+	std::vector<Expression::Ptr> pending;
+	auto release = [&pending](Expression::Ptr& operand) {
+		if (operand && operand.use_count() == 1 && isChained(operand.get()))
+			pending.push_back(std::move(operand));
+	};
+	auto releaseChain = [&release](std::shared_ptr<BinaryOpChain>& chain) {
+		if (chain && chain.use_count() == 1)
+		{
+			for (auto& element : chain->_elements)
+				release(element.operand);
+		}
+		chain.reset();
+	};
+
+	release(_left);
+	release(_right);
+	releaseChain(_chain);
+	while (!pending.empty())
+	{
+		auto expr = std::move(pending.back());
+		pending.pop_back();
+		auto* binaryOp = static_cast<BinaryOpExpression*>(expr.get());
+		release(binaryOp->_left);
+		release(binaryOp->_right);
+		releaseChain(binaryOp->_chain);
+	}
+}
+
+/**
+ * Returns the text of the binary operation. Nested binary operations and operands
+ * of flat operations are written in order using an explicit stack.
+ *
+ * @param indent Indentation used after the operation symbol if it's followed by linebreak.
+ *
+ * @return Text of the expression.
+ */
+std::string BinaryOpExpression::getText(const std::string& indent) const
+{
+	if (isFlat())
+	{
+		const auto& elements = _chain->_elements;
+		if (std::none_of(elements.begin(), elements.begin() + _chainOperands, [](const auto& element) { return isChained(element.operand.get()); }))
+		{
+			auto result = elements[0].operand->getText(indent);
+			for (std::size_t i = 1; i < _chainOperands; ++i)
+			{
+				appendOperator(result, elements[i].link.op, elements[i].link.linebreak, indent);
+				result += elements[i].operand->getText(indent);
+			}
+			return result;
+		}
+	}
+	else if (!isChained(_left.get()) && !isChained(_right.get()))
+		return _left->getText(indent) + ' ' + _op->getString() + (_linebreak ? "\n" + indent : " ") + _right->getText(indent);
+
+	// Operation symbols are the parts without expression
+	struct Part
+	{
+		const Expression* expr;
+		TokenIt op;
+		bool linebreak;
+	};
+
+	std::vector<Part> stack;
+	auto pushOperands = [&stack](const BinaryOpExpression* binaryOp) {
+		if (binaryOp->isFlat())
+		{
+			const auto& chain = *binaryOp->_chain;
+			for (auto i = binaryOp->_chainOperands - 1; i > 0; --i)
+			{
+				stack.push_back(Part{chain.getOperand(i).get(), TokenIt{}, false});
+				stack.push_back(Part{nullptr, chain.getLink(i - 1).op, chain.getLink(i - 1).linebreak});
+			}
+			stack.push_back(Part{chain.getOperand(0).get(), TokenIt{}, false});
+		}
+		else
+		{
+			stack.push_back(Part{binaryOp->_right.get(), TokenIt{}, false});
+			stack.push_back(Part{nullptr, binaryOp->_op, binaryOp->_linebreak});
+			stack.push_back(Part{binaryOp->_left.get(), TokenIt{}, false});
+		}
+	};
+
+	std::string result;
+	pushOperands(this);
+	while (!stack.empty())
+	{
+		auto part = stack.back();
+		stack.pop_back();
+		if (!part.expr)
+			appendOperator(result, part.op, part.linebreak, indent);
+		else if (isChained(part.expr))
+			pushOperands(static_cast<const BinaryOpExpression*>(part.expr));
+		else
+			result += part.expr->getText(indent);
+	}
+
+	return result;
+}
+
+/**
+ * Returns all operands of the chain of operations of the same kind which ends with this
+ * operation, in order of their tokens. For example `$a or $b or $c` has three operands
+ * regardless of whether its left operand `$a or $b` was already created.
+ *
+ * @return Operands of the chain.
+ */
+std::vector<Expression::Ptr> BinaryOpExpression::getOperands() const
+{
+	auto chain = copyChain();
+	std::vector<Expression::Ptr> result;
+	result.reserve(chain->getOperandsCount());
+	for (auto& element : chain->_elements)
+		result.push_back(std::move(element.operand));
+	return result;
+}
+
+/**
+ * Returns new chain with all operands and operation symbols of the chain of operations
+ * of the same kind which ends with this operation. Nested operations of classes derived
+ * outside of yaramod are operands of the chain.
+ *
+ * @return Copy of the chain.
+ */
+std::shared_ptr<BinaryOpChain> BinaryOpExpression::copyChain() const
+{
+	std::vector<const BinaryOpExpression*> nested;
+	const auto* binaryOp = this;
+	while (!binaryOp->isFlat() && binaryOp->_left->getKind() == getKind() && isChained(binaryOp->_left.get()))
+	{
+		nested.push_back(binaryOp);
+		binaryOp = static_cast<const BinaryOpExpression*>(binaryOp->_left.get());
+	}
+
+	std::shared_ptr<BinaryOpChain> chain;
+	if (binaryOp->isFlat())
+	{
+		const auto& elements = binaryOp->_chain->_elements;
+		chain = std::make_shared<BinaryOpChain>(elements[0].operand);
+		chain->_elements.insert(chain->_elements.end(), elements.begin() + 1, elements.begin() + binaryOp->_chainOperands);
+	}
+	else
+	{
+		chain = std::make_shared<BinaryOpChain>(binaryOp->_left);
+		chain->append(binaryOp->_op, binaryOp->_right, binaryOp->_linebreak, binaryOp->getUid());
+	}
+
+	for (auto itr = nested.rbegin(), end = nested.rend(); itr != end; ++itr)
+		chain->append((*itr)->_op, (*itr)->_right, (*itr)->_linebreak, (*itr)->getUid());
+	return chain;
+}
+
+/**
+ * Makes the operation flat over all operands of the chain. Nested operations of the previous
+ * operands are released, the operation keeps its unique ID.
+ *
+ * @param chain Chain with at least two operands.
+ */
+void BinaryOpExpression::setChain(std::shared_ptr<BinaryOpChain> chain)
+{
+	auto operands = chain->getOperandsCount();
+	const auto& link = chain->getLink(operands - 2);
+	_op = link.op;
+	_linebreak = link.linebreak;
+	_right = chain->getOperand(operands - 1);
+	_left.reset();
+	_chain = std::move(chain);
+	_chainOperands = static_cast<std::uint32_t>(operands);
+	_flat.store(true, std::memory_order_release);
+}
+
+/**
+ * Returns the chain which the operation of the specified kind with the given left operand
+ * continues. Chain of the flat operation of the same kind is continued in place only if
+ * the operation covers all of its operands and neither the operation nor the chain is
+ * referenced by anything else than @p left, otherwise its operands are copied into a new
+ * chain, so appending to the chain never changes operands other code can read. New chain
+ * is started with operands of the plain binary operation of the same kind unless its left
+ * operand is of the same kind too. Operations of classes derived outside of yaramod are
+ * never continued.
+ *
+ * @param left Left operand of the operation.
+ * @param kind Kind of the operation.
+ *
+ * @return Chain to append the operation symbol and the right operand to,
+ *         or @c nullptr if the plain binary operation should be created.
+ */
+std::shared_ptr<BinaryOpChain> BinaryOpExpression::continueChain(const Expression::Ptr& left, ExpressionKind kind)
+{
+	if (left->getKind() != kind || !isChained(left.get()))
+		return nullptr;
+
+	const auto* binaryOp = static_cast<const BinaryOpExpression*>(left.get());
+	if (binaryOp->isFlat())
+	{
+		if (binaryOp->_chainOperands == binaryOp->_chain->getOperandsCount() && left.use_count() == 1 && binaryOp->_chain.use_count() == 1)
+			return binaryOp->_chain;
+
+		auto chain = binaryOp->copyChain();
+		chain->setArena(binaryOp->_chain->getArena());
+		return chain;
+	}
+
+	if (binaryOp->_left->getKind() == kind)
+		return nullptr;
+
+	auto chain = std::make_shared<BinaryOpChain>(binaryOp->_left);
+	chain->append(binaryOp->_op, binaryOp->_right, binaryOp->_linebreak, binaryOp->getUid());
+	return chain;
+}
+
+/**
+ * Creates the left operand of the flat operation, which is either the first operand
+ * of the chain or the operation of the same kind over the shorter part of the chain.
+ */
+void BinaryOpExpression::createLeftOperand() const
+{
+	std::lock_guard<std::mutex> lock(_chain->_mutex);
+	if (!_flat.load(std::memory_order_relaxed))
+		return;
+
+	if (_chainOperands == 2)
+		_left = _chain->getOperand(0);
+	else
+	{
+		auto left = makeChainOperation(getKind(), getTokenStreamSharedPtr(), _chain, _chainOperands - 1);
+		left->setType(getType());
+		_left = std::move(left);
+	}
+	_flat.store(false, std::memory_order_release);
+}
+
+TokenIt BinaryOpExpression::getFirstTokenIt() const
+{
+	const Expression* expr = getFirstOperand();
+	while (isChained(expr))
+		expr = static_cast<const BinaryOpExpression*>(expr)->getFirstOperand();
+	return expr->getFirstTokenIt();
+}
+
+TokenIt BinaryOpExpression::getLastTokenIt() const
+{
+	const Expression* expr = _right.get();
+	while (isChained(expr))
+		expr = static_cast<const BinaryOpExpression*>(expr)->_right.get();
+	return expr->getLastTokenIt();
+}
+
+/**
+ * Clones both operands and the operation symbol into the target token stream.
+ * Tokens before the first and after the last token of the operation belong
+ * to the operands, so only tokens around the operation symbol are cloned here.
+ *
+ * @param target Token stream the tokens are cloned into.
+ * @param left Cloned left operand.
+ * @param op Cloned operation symbol.
+ * @param right Cloned right operand.
+ */
+void BinaryOpExpression::cloneOperands(const std::shared_ptr<TokenStream>& target, Expression::Ptr& left, TokenIt& op, Expression::Ptr& right) const
+{
+	left = cloneDeep(_left, target);
+	target->cloneAppend(getTokenStream(), std::next(_left->getLastTokenIt()), _op);
+	op = _op->clone(target.get());
+	target->cloneAppend(getTokenStream(), std::next(_op), _right->getFirstTokenIt());
+	right = cloneDeep(_right, target);
+}
+
+/**
+ * Clones all operands and operation symbols of the flat operation into the new chain.
+ *
+ * @param target Token stream the tokens are cloned into.
+ *
+ * @return Cloned flat operation.
+ */
+Expression::Ptr BinaryOpExpression::cloneChain(const std::shared_ptr<TokenStream>& target) const
+{
+	auto chain = std::make_shared<BinaryOpChain>(cloneDeep(_chain->getOperand(0), target));
+	chain->_elements.reserve(_chainOperands);
+	for (std::size_t i = 1; i < _chainOperands; ++i)
+	{
+		const auto& link = _chain->getLink(i - 1);
+		const auto& right = _chain->getOperand(i);
+		target->cloneAppend(getTokenStream(), std::next(_chain->getOperand(i - 1)->getLastTokenIt()), link.op);
+		auto op = link.op->clone(target.get());
+		target->cloneAppend(getTokenStream(), std::next(link.op), right->getFirstTokenIt());
+		chain->append(op, cloneDeep(right, target), link.linebreak);
+	}
+
+	return makeChainOperation(getKind(), target, chain, _chainOperands);
+}
+
+/**
+ * Clones the expression. Nested binary operations are cloned in order of their tokens
+ * using an explicit stack, flat operations are cloned by cloneChain() and other
+ * expressions are cloned by their clone() method.
+ *
+ * @param expr Cloned expression.
+ * @param target Token stream the tokens are cloned into.
+ *
+ * @return Cloned expression.
+ */
+Expression::Ptr BinaryOpExpression::cloneDeep(const Expression::Ptr& expr, const std::shared_ptr<TokenStream>& target)
+{
+	struct Frame
+	{
+		const BinaryOpExpression* binaryOp;
+		Expression::Ptr left;
+		TokenIt op;
+	};
+
+	std::vector<Frame> stack;
+	const Expression::Ptr* next = &expr;
+	while (true)
+	{
+		while (isChained(next->get()))
+		{
+			const auto* binaryOp = static_cast<const BinaryOpExpression*>(next->get());
+			if (binaryOp->isFlat())
+				break;
+
+			stack.push_back(Frame{binaryOp, nullptr, TokenIt{}});
+			next = &binaryOp->_left;
+		}
+
+		auto result = isChained(next->get())
+			? static_cast<const BinaryOpExpression*>(next->get())->cloneChain(target)
+			: (*next)->clone(target);
+		while (true)
+		{
+			if (stack.empty())
+				return result;
+
+			auto& frame = stack.back();
+			if (!frame.left)
+			{
+				const auto* binaryOp = frame.binaryOp;
+				frame.left = std::move(result);
+				target->cloneAppend(binaryOp->getTokenStream(), std::next(binaryOp->_left->getLastTokenIt()), binaryOp->_op);
+				frame.op = binaryOp->_op->clone(target.get());
+				target->cloneAppend(binaryOp->getTokenStream(), std::next(binaryOp->_op), binaryOp->_right->getFirstTokenIt());
+				next = &binaryOp->_right;
+				break;
+			}
+
+			result = makeClone(frame.binaryOp, target, std::move(frame.left), frame.op, std::move(result));
+			stack.pop_back();
+		}
+	}
+}
+
+/**
+ * Creates the clone of the binary operation of the same class out of the cloned operands.
+ */
+Expression::Ptr BinaryOpExpression::makeClone(const BinaryOpExpression* original, const std::shared_ptr<TokenStream>& target, Expression::Ptr&& left, TokenIt op, Expression::Ptr&& right)
+{
+	std::shared_ptr<BinaryOpExpression> result;
+	switch (original->getKind())
+	{
+		case ExpressionKind::And: result = std::make_shared<AndExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::Or: result = std::make_shared<OrExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::Lt: result = std::make_shared<LtExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::Gt: result = std::make_shared<GtExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::Le: result = std::make_shared<LeExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::Ge: result = std::make_shared<GeExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::Eq: result = std::make_shared<EqExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::Neq: result = std::make_shared<NeqExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::Contains: result = std::make_shared<ContainsExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::Icontains: result = std::make_shared<IcontainsExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::Matches: result = std::make_shared<MatchesExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::StartsWith: result = std::make_shared<StartsWithExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::IstartsWith: result = std::make_shared<IstartsWithExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::EndsWith: result = std::make_shared<EndsWithExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::IendsWith: result = std::make_shared<IendsWithExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::Iequals: result = std::make_shared<IequalsExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::Plus: result = std::make_shared<PlusExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::Minus: result = std::make_shared<MinusExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::Multiply: result = std::make_shared<MultiplyExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::Divide: result = std::make_shared<DivideExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::Modulo: result = std::make_shared<ModuloExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::BitwiseXor: result = std::make_shared<BitwiseXorExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::BitwiseAnd: result = std::make_shared<BitwiseAndExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::BitwiseOr: result = std::make_shared<BitwiseOrExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::ShiftLeft: result = std::make_shared<ShiftLeftExpression>(target, std::move(left), op, std::move(right)); break;
+		case ExpressionKind::ShiftRight: result = std::make_shared<ShiftRightExpression>(target, std::move(left), op, std::move(right)); break;
+		default: assert(false && "Not a binary operation"); return nullptr;
+	}
+
+	result->_linebreak = original->_linebreak;
+	return result;
+}
+
+/**
+ * Creates the flat operation of the specified kind over the first operands of the chain
+ * in the arena of the chain if it has one.
+ */
+std::shared_ptr<BinaryOpExpression> BinaryOpExpression::makeChainOperation(ExpressionKind kind, const std::shared_ptr<TokenStream>& ts, const std::shared_ptr<BinaryOpChain>& chain, std::size_t operands)
+{
+	switch (kind)
+	{
+		case ExpressionKind::And: return makeOverChain<AndExpression>(ts, chain, operands);
+		case ExpressionKind::Or: return makeOverChain<OrExpression>(ts, chain, operands);
+		default: assert(false && "Not a chained operation"); return nullptr;
+	}
+}
+
+} // namespace yaramod
@@ -110,6 +110,28 @@ TokenIt HexString::getLastTokenIt() const
 		return _units.back()->getLastTokenIt();
 }
 
+/**
+ * Returns the copy of the hex string which refers to the copies of its tokens.
+ *
+ * @param target Token stream with the copies of the tokens.
+ * @param copies Copies of the tokens.
+ *
+ * @return Copy of the hex string.
+ */
+std::shared_ptr<String> HexString::clone(const std::shared_ptr<TokenStream>& target, TokenMap& copies) const
+{
+	std::vector<std::shared_ptr<HexStringUnit>> units;
+	units.reserve(_units.size());
+	for (const auto& unit : _units)
+		units.push_back(unit->clone(target, copies));
+
+	auto result = _leftBracket && _rightBracket
+		? std::make_shared<HexString>(target, copies.at(&**_leftBracket), std::move(units), copies.at(&**_rightBracket))
+		: std::make_shared<HexString>(target, std::move(units));
+	cloneProperties(*result, copies);
+	return result;
+}
+
 /**
  * Returns the length of the hex string as the number of nibbles.
  * Jumps and wildcards are not counted towards the length.
@@ -127,6 +127,26 @@ Literal::Literal(ReferenceType value)
 {
 }
 
+/**
+ * Constructor.
+ *
+ * @param value String shared with other literals.
+ */
+Literal::Literal(const InternedString& value)
+	: _value(value)
+{
+}
+
+/**
+ * Constructor.
+ *
+ * @param value String shared with other literals.
+ */
+Literal::Literal(InternedString&& value)
+	: _value(std::move(value))
+{
+}
+
 /**
  * Setter methods
  *
@@ -289,4 +309,31 @@ std::string Literal::getPureText() const
 	return getText(true);
 }
 
+/**
+ * Appends the same text as getText returns to the output. Strings, formatted values
+ * and symbol names are appended without creating a temporary string.
+ *
+ * @param output String to append the text to.
+ * @param pure @c true to append the string in the exact form it was written in.
+ */
+void Literal::appendText(std::string& output, bool pure/* = false*/) const
+{
+	if (isString() && !(pure && _escaped))
+	{
+		if (!pure)
+			output += '"';
+		output += getString();
+		if (!pure)
+			output += '"';
+	}
+	else if ((isBool() || isInt() || isFloat()) && _formatted_value.has_value())
+		output += _formatted_value.value();
+	else if (isSymbol())
+		output += getSymbol()->getName();
+	else if (isLiteralReference())
+		getLiteralReference()->appendText(output, pure);
+	else
+		output += getText(pure);
+}
+
 } //namespace yaramod
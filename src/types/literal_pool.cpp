@@ -0,0 +1,36 @@
+/**
+ * @file src/types/literal_pool.cpp
+ * @brief Implementation of class LiteralPool.
+ * @copyright (c) 2026 Avast Software, licensed under the MIT license
+ */
+
+#include "yaramod/types/literal_pool.h"
+
+namespace yaramod {
+
+/**
+ * Returns the interned string with given text. The string is created if the pool doesn't contain it yet.
+ * When it already exists, the heap memory that its separate copy would need is counted as saved.
+ * Strings short enough to fit into std::string itself don't need any heap memory so they don't
+ * save any, their literals only share the storage.
+ *
+ * @param text Text of the string.
+ *
+ * @return Interned string.
+ */
+Literal::InternedString LiteralPool::intern(std::string_view text)
+{
+	++_internedCount;
+	if (auto itr = _strings.find(text); itr != _strings.end())
+	{
+		if (text.size() > std::string{}.capacity())
+			_savedBytes += text.size() + 1;
+		return itr->second;
+	}
+
+	auto str = std::make_shared<const std::string>(text);
+	_strings.emplace(std::string_view{*str}, str);
+	return str;
+}
+
+} // namespace yaramod
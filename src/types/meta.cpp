@@ -38,6 +38,18 @@ TokenIt Meta::getKeyTokenIt() const
 	return _key;
 }
 
+/**
+ * Returns the copy of the meta information which refers to the copies of its tokens.
+ *
+ * @param copies Copies of the tokens.
+ *
+ * @return Copy.
+ */
+Meta Meta::clone(const TokenMap& copies) const
+{
+	return Meta(copies.at(&*_key), copies.at(&*_value));
+}
+
 /**
  * Returns the value of a single meta information.
  *
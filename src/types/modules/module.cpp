@@ -88,6 +88,29 @@ Module::Module(const std::string& name, nlohmann::json&& json)
 	addJson(json);
 }
 
+/**
+ * Constructor.
+ *
+ * @param content Unparsed module content
+ */
+Module::Module(ModuleContent&& content)
+	: _name(content.getName())
+{
+	addContent(std::move(content));
+}
+
+/**
+ * Copy constructor. Only the specification of the module is copied, the copy
+ * has its own structure built once it gets initialized.
+ *
+ * @param other Module to copy
+ */
+Module::Module(const Module& other)
+	: _name(other._name), _filePaths(other._filePaths), _contents(other._contents),
+	_compiledJsons(other._compiledJsons), _jsons(other._jsons), _structure()
+{
+}
+
 /**
  * Destructor.
  */
@@ -103,6 +126,14 @@ void Module::addJson(const nlohmann::json& json)
 	_jsons.push_back(json);
 }
 
+/**
+ * Add unparsed source json to this module. It is parsed only when the module gets initialized.
+ */
+void Module::addContent(ModuleContent&& content)
+{
+	_contents.push_back(std::move(content));
+}
+
 /**
  * Add path to this module. The json located on path will be read and added to module.
  */
@@ -176,7 +207,8 @@ bool Module::isInitialized() const
  * @param json structure supplied in json to be created ("kind" must be "array" or "dictionary")
  * @param base already existing Structure which gets the new dictionary as its attribute. Must not be nullptr.
  */
-void Module::_addIterable(StructureSymbol* base, const Json& json)
+template <typename JsonT>
+void Module::_addIterable(StructureSymbol* base, const JsonT& json)
 {
 	assert(base);
 
@@ -275,7 +307,8 @@ void Module::_addIterable(StructureSymbol* base, const Json& json)
  * @param json structure supplied in json to be created ("kind": "function")
  * @param base already existing Structure which gets the new function as its attribute
  */
-void Module::_addFunctions(StructureSymbol* base, const Json& json)
+template <typename JsonT>
+void Module::_addFunctions(StructureSymbol* base, const JsonT& json)
 {
 	assert(accessJsonString(json, "kind") == "function");
 	assert(base);
@@ -323,7 +356,8 @@ void Module::_addFunctions(StructureSymbol* base, const Json& json)
  * @param json structure supplied in json to be created ("kind": "struct")
  * @param base already existing Structure or Iterable which gets the new structure as its attribute. Can be nullptr.
  */
-void Module::_addStruct(Symbol* base, const Json& json, std::shared_ptr<StructureSymbol>* ref)
+template <typename JsonT>
+void Module::_addStruct(Symbol* base, const JsonT& json, std::shared_ptr<StructureSymbol>* ref)
 {
 	assert(accessJsonString(json, "kind") == "struct");
 
@@ -370,7 +404,8 @@ void Module::_addStruct(Symbol* base, const Json& json, std::shared_ptr<Structur
  * @param json reference supplied in json to be created ("kind": "reference")
  * @param base already existing Structure or Iterable which gets the new reference as its attribute. Can't be nullptr
  */
-void Module::_addReference(Symbol* base, const Json& json)
+template <typename JsonT>
+void Module::_addReference(Symbol* base, const JsonT& json)
 {
 	assert(accessJsonString(json, "kind") == "reference");
 
@@ -405,7 +440,8 @@ void Module::_addReference(Symbol* base, const Json& json)
  * @param json structure supplied in json to be created ("kind": "value")
  * @param base already existing Structure which gets the new value as its attribute. Must not be nullptr
  */
-void Module::_addValue(StructureSymbol* base, const Json& json)
+template <typename JsonT>
+void Module::_addValue(StructureSymbol* base, const JsonT& json)
 {
 	assert(accessJsonString(json, "kind") == "value");
 	assert(base);
@@ -440,7 +476,8 @@ void Module::_addValue(StructureSymbol* base, const Json& json)
  * @param json structure to be parsed
  * @param structure to be modified by adding attribute built according to the json content
  */
-void Module::_addAttributeFromJson(StructureSymbol* base, const Json& json)
+template <typename JsonT>
+void Module::_addAttributeFromJson(StructureSymbol* base, const JsonT& json)
 {
 	auto kind = accessJsonString(json, "kind");
 	if (kind == "function")
@@ -464,9 +501,18 @@ void Module::_addAttributeFromJson(StructureSymbol* base, const Json& json)
  */
 bool Module::initialize()
 {
-	if (_filePaths.empty() && _jsons.empty())
+	if (_filePaths.empty() && _jsons.empty() && _contents.empty())
 		throw ModuleError("No .json file supplied to initialize a module.");
 
+	for (auto& content : _contents)
+	{
+		if (const auto* compiledContent = content.getCompiledContent())
+			_compiledJsons.push_back(_checkContent(BinaryJson(compiledContent), content));
+		else
+			_jsons.push_back(_checkContent(readJsonString(content.getContent()), content));
+	}
+	_contents.clear();
+
 	for (auto& filePath : _filePaths)
 	{
 		if (!filePath.second)
@@ -476,13 +522,16 @@ bool Module::initialize()
 		}
 	}
 
+	for (const auto& json : _compiledJsons)
+		_importJson(json);
 	for (const auto& json : _jsons)
 		_importJson(json);
 
 	return true;
 }
 
-void Module::_importJson(const Json& json)
+template <typename JsonT>
+void Module::_importJson(const JsonT& json)
 {
 	auto name = accessJsonString(json, "name");
 
@@ -500,6 +549,27 @@ void Module::_importJson(const Json& json)
 	}
 }
 
+/**
+ * Checks that the content of built-in module really describes this module.
+ *
+ * @param json Parsed or compiled content
+ * @param content Original module content
+ *
+ * @return Checked json.
+ */
+template <typename JsonT>
+JsonT Module::_checkContent(JsonT&& json, const ModuleContent& content) const
+{
+	if (!json.contains("kind") || accessJsonString(json, "kind") != "struct")
+		throw ModuleError("Invalid json module: expected \"kind\": \"struct\"");
+
+	auto name = accessJsonString(json, "name");
+	if (content.getName() != name)
+		throw ModuleError("Invalid json module: expected '" + name + "' got '" + content.getName() + "'.");
+
+	return std::move(json);
+}
+
 /**
  * A mapping converting a given string to corresponding Symbol.
  */
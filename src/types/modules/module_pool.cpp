@@ -14,18 +14,54 @@ namespace yaramod {
 
 using Json = nlohmann::json;
 
-ModulePool::ModulePool(Features features, const std::string& directory)
-	: _features(features)
+ModulePool::ModulePool(Features features, const std::string& directory, bool lazy)
+	: _features(features), _mutex(std::make_shared<std::mutex>())
 {
 	_init(directory);
 
-	// Initializes all modules
+	// Initializes all modules, lazy mode defers only the built-in ones
 	for (auto itr = _knownModules.begin(); itr != _knownModules.end(); ++itr)
-		itr->second->initialize();
+	{
+		if (!lazy || !itr->second->getPaths().empty())
+			itr->second->initialize();
+	}
+}
+
+ModulePool::ModulePool(const ModulePool& base)
+	: _features(base._features), _mutex(base._mutex)
+{
+	std::lock_guard<std::mutex> lock(*_mutex);
+	_knownModules = base._knownModules;
+}
+
+std::shared_ptr<const ModulePool> ModulePool::getShared(Features features, const std::string& directory)
+{
+	auto envValue = [](const char* name) {
+		const char* value = std::getenv(name);
+		return value ? std::string{value} : std::string{};
+	};
+
+	std::ostringstream key;
+	key << static_cast<int>(features) << '\0' << directory
+		<< '\0' << envValue("YARAMOD_MODULE_SPEC_PATH")
+		<< '\0' << envValue("YARAMOD_MODULE_SPEC_PATH_EXCLUSIVE");
+
+	std::lock_guard<std::mutex> lock(_sharedPoolsMutex());
+	auto& pool = _sharedPools()[key.str()];
+	if (!pool)
+		pool = std::make_shared<ModulePool>(features, directory, true);
+	return pool;
+}
+
+void ModulePool::clearShared()
+{
+	std::lock_guard<std::mutex> lock(_sharedPoolsMutex());
+	_sharedPools().clear();
 }
 
-std::shared_ptr<Module> ModulePool::load(const std::string& name)
+std::shared_ptr<Module> ModulePool::load(const std::string& name) const
 {
+	std::lock_guard<std::mutex> lock(*_mutex);
 	auto itr = _knownModules.find(name);
 	// Check that the module exists
 	if (itr == _knownModules.end())
@@ -40,14 +76,45 @@ std::shared_ptr<Module> ModulePool::load(const std::string& name)
 
 std::map<std::string, Module*> ModulePool::getModules() const
 {
+	std::lock_guard<std::mutex> lock(*_mutex);
 	std::map<std::string, Module*> m;
 	for (const auto& item : _knownModules)
 	{
+		if (!item.second->isInitialized())
+			item.second->initialize();
 		m.insert(std::pair(item.first, item.second.get()));
 	}
 	return m;
 }
 
+void ModulePool::addJson(const std::string& name, const nlohmann::json& json)
+{
+	std::lock_guard<std::mutex> lock(*_mutex);
+	auto itr = _knownModules.find(name);
+	if (itr == _knownModules.end())
+	{
+		_knownModules.emplace(name, std::make_shared<Module>(name, nlohmann::json(json)));
+		return;
+	}
+
+	// Copy only the specification, the structure of the copy is built again once it is loaded
+	auto module = std::make_shared<Module>(*itr->second);
+	module->addJson(json);
+	itr->second = std::move(module);
+}
+
+std::mutex& ModulePool::_sharedPoolsMutex()
+{
+	static std::mutex mutex;
+	return mutex;
+}
+
+std::unordered_map<std::string, std::shared_ptr<const ModulePool>>& ModulePool::_sharedPools()
+{
+	static std::unordered_map<std::string, std::shared_ptr<const ModulePool>> pools;
+	return pools;
+}
+
 bool ModulePool::_processPath(fs::path p)
 {
 	if (p.extension() != ".cpp" && p.extension() != ".json")
@@ -76,28 +143,22 @@ bool ModulePool::_processPath(fs::path p)
 	return true;
 }
 
-void ModulePool::_processModuleContent(const ModuleContent& content)
+void ModulePool::_processModuleContent(ModuleContent&& content)
 {
-	auto json = readJsonString(content.getContent());
-	if (!json.contains("kind") || accessJsonString(json, "kind") != "struct")
-		throw ModuleError("Invalid json module: expected \"kind\": \"struct\"");
-
 	if (! (_features & Features::Deprecated))
-		if (json.contains("deprecated") && accessJsonString(json, "deprecated") == "true")
+		if (content.isDeprecated())
 			return;
 
-	auto name = accessJsonString(json, "name");
-	if (content.getName() != name)
-		throw ModuleError("Invalid json module: expected '" + name + "' got '" + content.getName() + "'.");
-
+	// The content is parsed only when the module is initialized
+	auto name = content.getName();
 	auto itr = _knownModules.find(name);
 	if (itr == _knownModules.end())
 	{
-		auto module = std::make_shared<Module>(name, std::move(json));
+		auto module = std::make_shared<Module>(std::move(content));
 		_knownModules.emplace(std::make_pair(name, std::move(module)));
 	}
 	else
-		itr->second->addJson(std::move(json));
+		itr->second->addContent(std::move(content));
 }
 
 void ModulePool::_init(const std::string& directory)
@@ -134,8 +195,8 @@ void ModulePool::_init(const std::string& directory)
 			if (!foundModules)
 				throw ModuleError("Directory '" + directory + "' does not contain single valid module. If you want to use public modules, set directory=\"\".");
 		}
-		for (const auto& content : _moduleList.list)
-			_processModuleContent(content);
+		for (auto& content : _moduleList.list)
+			_processModuleContent(std::move(content));
 	}
 }
 
@@ -81,4 +81,19 @@ TokenIt PlainString::getLastTokenIt() const
 	return _text;
 }
 
+/**
+ * Returns the copy of the plain string which refers to the copies of its tokens.
+ *
+ * @param target Token stream with the copies of the tokens.
+ * @param copies Copies of the tokens.
+ *
+ * @return Copy of the plain string.
+ */
+std::shared_ptr<String> PlainString::clone(const std::shared_ptr<TokenStream>& target, TokenMap& copies) const
+{
+	auto result = std::make_shared<PlainString>(target, copies.at(&*_text));
+	cloneProperties(*result, copies);
+	return result;
+}
+
 }
@@ -290,6 +290,58 @@ TokenIt Rule::getLastTokenIt() const
 	return _tokenStream->find(TokenType::RULE_END, _name);
 }
 
+/**
+ * Returns the copy of the rule which refers to the copies of its tokens in the target stream.
+ * The tokens have to be already copied by TokenStream::copy(). Copies of the tokens of the condition
+ * and the variables are replaced by the tokens of their clones. The copy gets its own symbol.
+ *
+ * @param target Token stream with the copies of the tokens.
+ * @param copies Copies of the tokens.
+ *
+ * @return Copy of the rule.
+ */
+std::shared_ptr<Rule> Rule::clone(const std::shared_ptr<TokenStream>& target, TokenMap& copies) const
+{
+	auto copyTokens = [&](const std::vector<TokenIt>& tokens) {
+		std::vector<TokenIt> result;
+		result.reserve(tokens.size());
+		for (const auto& token : tokens)
+			result.push_back(copies.at(&*token));
+		return result;
+	};
+
+	auto name = copies.at(&*_name);
+	if (_name->isSymbol())
+	{
+		const auto& symbol = _name->getSymbol();
+		name->setValue(std::make_shared<ValueSymbol>(symbol->getName(), symbol->getDataType(), symbol->getDocumentation()));
+	}
+
+	std::vector<Meta> metas;
+	metas.reserve(_metas.size());
+	for (const auto& meta : _metas)
+		metas.push_back(meta.clone(copies));
+
+	std::shared_ptr<StringsTrie> strings;
+	if (_strings)
+		strings = std::make_shared<StringsTrie>(_strings->transform([&](const std::shared_ptr<String>& string) {
+			return string->clone(target, copies);
+		}));
+
+	std::vector<Variable> variables;
+	variables.reserve(_variables.size());
+	for (const auto& variable : _variables)
+		variables.push_back(variable.clone(target, copies));
+
+	Expression::Ptr condition;
+	if (_condition)
+		condition = cloneInPlace(*_condition, target, copies);
+
+	auto result = std::make_shared<Rule>(target, name, copyTokens(_modifiers), std::move(metas), std::move(strings), std::move(variables), std::move(condition), copyTokens(_tags));
+	result->setLocation(_location);
+	return result;
+}
+
 /**
  * Sets the name of the rule.
  *
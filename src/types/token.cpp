@@ -41,6 +41,35 @@ std::string Token::getPureText() const
 	return getText(true);
 }
 
+/**
+ * Appends the same text as getText returns to the output without creating
+ * a temporary string.
+ *
+ * @param output String to append the text to.
+ * @param pure @c true to append the text in the form it was written in.
+ */
+void Token::appendText(std::string& output, bool pure) const
+{
+	auto start = output.size();
+	_value->appendText(output, pure);
+	size_t changed_index = start + (pure ? 0 : 1);
+	if (_type == TokenType::STRING_LENGTH)
+	{
+		assert(output.size() > changed_index);
+		output[changed_index] = '!';
+	}
+	else if (_type == TokenType::STRING_OFFSET)
+	{
+		assert(output.size() > changed_index);
+		output[changed_index] = '@';
+	}
+	else if (_type == TokenType::STRING_COUNT)
+	{
+		assert(output.size() > changed_index);
+		output[changed_index] = '#';
+	}
+}
+
 const Literal& Token::getLiteral() const
 {
 	assert("Literal is not nullptr" && _value);
@@ -95,6 +124,11 @@ const std::shared_ptr<TokenStream>& Token::initializeSubTokenStream()
 	return getSubTokenStream();
 }
 
+void Token::setSubTokenStream(const std::shared_ptr<TokenStream>& subTokenStream)
+{
+	_subTokenStream = subTokenStream;
+}
+
 TokenIt Token::clone(TokenStream* target) const
 {
 	return target->push_back(Token{*this});
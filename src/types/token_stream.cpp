@@ -5,7 +5,10 @@
  */
 
 #include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstring>
+#include <optional>
 #include <sstream>
 #include <stack>
 
@@ -235,6 +238,22 @@ void TokenStream::cloneAppend(TokenStream* /*donor*/, TokenIt first, TokenIt las
 	}
 }
 
+std::shared_ptr<TokenStream> TokenStream::copy(TokenMap& copies) const
+{
+	auto result = std::make_shared<TokenStream>();
+	result->_new_line_style = _new_line_style;
+	copies.reserve(copies.size() + _tokens.size());
+	for (const auto& token : _tokens)
+	{
+		auto copy = result->push_back(token);
+		copy->setValue(token.getLiteral());
+		if (const auto& subTokenStream = token.getSubTokenStream())
+			copy->setSubTokenStream(subTokenStream->copy(copies));
+		copies.emplace(&token, copy);
+	}
+	return result;
+}
+
 TokenIt TokenStream::begin()
 {
 	return _tokens.begin();
@@ -689,128 +708,314 @@ void TokenStream::autoformat()
 	_formatted = true;
 }
 
-std::size_t TokenStream::PrintHelper::insertIntoStream(std::stringstream* ss, char what)
+/**
+ * Writes the formatted text of the token stream in a single pass.
+ *
+ * Comments at the ends of lines are aligned to the longest line of the block of lines
+ * they belong to, which is known only once the whole block has been written. Position
+ * of every such comment is therefore remembered and the padding is inserted in front of
+ * it once its alignment is determined. The text is written in chunks to the output stream
+ * if there is one, a chunk is written only when it has no comment waiting for its padding.
+ */
+class TokenStream::TextFormatter
 {
-	columnCounter += 1;
-	if (ss)
-		*ss << what;
-	return columnCounter;
+public:
+	TextFormatter(TokenStream* ts, std::string& output, std::ostream* sink, bool alignComments)
+		: _ts(ts), _out(output), _sink(sink), _alignComments(alignComments) {}
+
+	void insert(char what, std::size_t count = 1, std::size_t width = 1);
+	void insert(TokenIt what);
+	void insertComment(TokenIt it, std::size_t currentLineTabs, bool ignoreUserIndent);
+	void insertSubText(TokenStream* ts, bool withIncludes);
+	void finish();
+
+private:
+	/**
+	 * Comment which is waiting for the padding in front of it.
+	 */
+	struct Fixup
+	{
+		std::size_t offset; ///< Offset in the output where the padding belongs
+		TokenIt comment; ///< The comment
+		std::size_t column; ///< Column of the comment
+		std::size_t line; ///< Line of the comment
+		std::size_t padding; ///< Computed padding
+	};
+
+	bool isAfterColon(TokenIt it) const;
+	std::size_t getPadding(const Fixup& fixup, std::size_t firstLineColumn) const;
+	void flushComments();
+	void resolveFixups(std::size_t from);
+	void flushToSink(std::size_t minimalSize);
+
+	static constexpr std::size_t sinkChunkSize = 64 * 1024;
+
+	TokenStream* _ts; ///< Formatted token stream
+	std::string& _out; ///< Output buffer
+	std::ostream* _sink; ///< Stream the output buffer is written to, if any
+	bool _alignComments; ///< Set if comments should be aligned
+	std::size_t _line = 0; ///< Current line
+	std::size_t _column = 0; ///< Current column
+	bool _commentOnThisLine = false; ///< Set if there is a comment at the end of the current line
+	std::size_t _maximalCommentColumn = 0; ///< Longest line of the current block of comments
+	std::vector<TokenIt> _commentPool; ///< Comments of the current block
+	std::vector<Fixup> _fixups; ///< Comments waiting for the padding, ordered by offset
+	std::size_t _firstLineFixups = 0; ///< Number of fixups on the first line
+	std::array<std::optional<std::size_t>, 2> _lineEnds; ///< End of the last token on the first two lines
+	bool _firstNewLineAfterColon = false; ///< Set if the first new line follows colon
+};
+
+bool TokenStream::TextFormatter::isAfterColon(TokenIt it) const
+{
+	auto prevIt = _ts->predecessor(it);
+	return prevIt && (*prevIt)->getType() == TokenType::COLON;
 }
 
-std::size_t TokenStream::PrintHelper::insertIntoStream(std::stringstream* ss, const std::string& what, std::size_t length)
+/**
+ * Returns the number of spaces which align the comment to its indentation. Columns of the first
+ * line are offset by the column where the text ended when the comments were aligned by printing
+ * the text twice, the padding is kept the same as it was back then.
+ */
+std::size_t TokenStream::TextFormatter::getPadding(const Fixup& fixup, std::size_t firstLineColumn) const
 {
-	if (length != 0)
-		columnCounter += length;
-	else
-		columnCounter += what.length();
-	if (ss)
-		*ss << what;
-	return columnCounter;
+	auto indentation = fixup.comment->getIndentation() + 1;
+	auto column = fixup.line == 0 ? fixup.column + firstLineColumn : fixup.column;
+	return column < indentation ? indentation - column : 0;
 }
 
-// NEW_LINE, returns current column
-std::size_t TokenStream::PrintHelper::insertIntoStream(std::stringstream* ss, TokenStream* ts, TokenIt what)
+void TokenStream::TextFormatter::insert(char what, std::size_t count, std::size_t width)
+{
+	_out.append(count, what);
+	_column += width;
+}
+
+void TokenStream::TextFormatter::insert(TokenIt what)
 {
-	std::stringstream tmp;
-	tmp << *what;
-	const std::string& appendee = tmp.str();
 	assert(what->getType() != TokenType::ONELINE_COMMENT);
-	auto prevIt = ts->predecessor(what);
 	if (what->getType() == TokenType::NEW_LINE)
 	{
-		if (!commentOnThisLine || (prevIt && (*prevIt)->getType() == TokenType::COLON))
-		{
-			if (commentPool.size() >= 2)
-				for (auto comment : commentPool)
-					comment->setIndentation(maximalCommentColumn);
-			commentPool.clear();
-			maximalCommentColumn = 0;
-		}
-		++lineCounter;
-		commentOnThisLine = false;
-		columnCounter = 0;
+		auto afterColon = isAfterColon(what);
+		if (!_commentOnThisLine || afterColon)
+			flushComments();
+		if (_line == 0)
+			_firstNewLineAfterColon = afterColon;
+		++_line;
+		_commentOnThisLine = false;
+		_column = 0;
+		what->appendText(_out, true);
+		flushToSink(sinkChunkSize);
+		return;
 	}
-	else
+
+	auto size = _out.size();
+	switch (what->getType())
 	{
-		columnCounter += appendee.length();
-		if (columnCounter > maximalCommentColumn)
-			maximalCommentColumn = columnCounter;
+		case TokenType::META_VALUE:
+		case TokenType::STRING_LITERAL:
+		case TokenType::IMPORT_MODULE:
+		case TokenType::INCLUDE_PATH:
+			what->appendText(_out);
+			break;
+		default:
+			what->appendText(_out, true);
+			break;
 	}
-
-	if (ss)
-		*ss << appendee;
-	return columnCounter;
+	_column += _out.size() - size;
+	_maximalCommentColumn = std::max(_maximalCommentColumn, _column);
+	if (_line < _lineEnds.size())
+		_lineEnds[_line] = std::max(_lineEnds[_line].value_or(0), _column);
 }
 
 /**
- * Prints comment.
+ * Inserts comment.
  *
- * @param ts The associated tokenstream used only for predecessor access.
- * @param ss The stream to be filled with the text.
  * @param it The comment.
  * @param currentLineTabs The current level of indentation based obtained from the autoformatter.
- * @param alignComments Set if comments should be aligned.
- * @patam ignoreUserIndent Set whether we want to ignore the additional indentation specified in parameter it.
- *
- * @return columnCounter.
+ * @param ignoreUserIndent Set whether we want to ignore the additional indentation specified in parameter it.
  */
-std::size_t TokenStream::PrintHelper::printComment(std::stringstream* ss, TokenStream* ts, TokenIt it, size_t currentLineTabs, bool alignComment, bool ignoreUserIndent)
+void TokenStream::TextFormatter::insertComment(TokenIt it, std::size_t currentLineTabs, bool ignoreUserIndent)
 {
-	auto prevIt = ts->predecessor(it);
-	auto indentation = it->getIndentation() + 1;
+	auto prevIt = _ts->predecessor(it);
+	auto afterColon = isAfterColon(it);
 
-	const std::string& indent = it->getLiteral().getFormattedValue();
-	if (ss)
+	// Comment at a beginning of a line
+	if (!prevIt || (*prevIt)->getType() == TokenType::NEW_LINE)
+	{
+		const std::string& indent = it->getLiteral().getFormattedValue();
+		if (ignoreUserIndent || indent.length() >= currentLineTabs)
+			_out.append(currentLineTabs, '\t');
+		else
+			_out += indent;
+	}
+	else if (_alignComments && !afterColon)
 	{
-		// Comment at a beginning of a line
-		if (!prevIt || (*prevIt)->getType() == TokenType::NEW_LINE)
+		Fixup fixup{_out.size(), it, _column, _line, 0};
+		// Alignment of the comments of the current block is not known yet and the first line
+		// depends on where the whole text ends
+		if (it->getType() == TokenType::ONELINE_COMMENT || _line == 0)
 		{
-			if (ignoreUserIndent || indent.length() >= currentLineTabs)
-				*ss << std::string(currentLineTabs, '\t');
-			else
-				*ss << indent;
+			_fixups.push_back(fixup);
+			if (_line == 0)
+				++_firstLineFixups;
 		}
-		else if (alignComment && columnCounter < indentation && (!prevIt || (*prevIt)->getType() != TokenType::COLON))
-			*ss << std::string(indentation - columnCounter, ' ');
-		*ss << it->getPureText();
+		else
+			_out.append(getPadding(fixup, 0), ' ');
 	}
-	else if (it->getType() == TokenType::ONELINE_COMMENT && (!prevIt || (*prevIt)->getType() != TokenType::COLON))
+	it->appendText(_out, true);
+
+	if (_alignComments && it->getType() == TokenType::ONELINE_COMMENT && !afterColon)
 	{
-		commentOnThisLine = true;
-		commentPool.push_back(it);
+		_commentOnThisLine = true;
+		_commentPool.push_back(it);
 	}
+}
 
-	return columnCounter;
+void TokenStream::TextFormatter::insertSubText(TokenStream* ts, bool withIncludes)
+{
+	auto size = _out.size();
+	ts->writeText(_out, withIncludes);
+	_column += _out.size() - size;
+}
+
+/**
+ * Aligns the comments of the finished block and inserts the padding in front of them.
+ */
+void TokenStream::TextFormatter::flushComments()
+{
+	if (_commentPool.size() >= 2)
+		for (auto comment : _commentPool)
+			comment->setIndentation(_maximalCommentColumn);
+	_commentPool.clear();
+	_maximalCommentColumn = 0;
+
+	for (auto i = _firstLineFixups; i < _fixups.size(); ++i)
+		_fixups[i].padding = getPadding(_fixups[i], 0);
+	resolveFixups(_firstLineFixups);
+}
+
+/**
+ * Inserts the computed padding of the fixups starting at the given index. The output
+ * is expanded only once and the text after the fixups is moved from its end.
+ */
+void TokenStream::TextFormatter::resolveFixups(std::size_t from)
+{
+	std::size_t total = 0;
+	for (auto i = from; i < _fixups.size(); ++i)
+		total += _fixups[i].padding;
+
+	if (total > 0)
+	{
+		auto end = _out.size();
+		_out.resize(end + total);
+		auto target = _out.size();
+		for (auto i = _fixups.size(); i > from; --i)
+		{
+			const auto& fixup = _fixups[i - 1];
+			auto length = end - fixup.offset;
+			target -= length;
+			std::memmove(&_out[target], &_out[fixup.offset], length);
+			target -= fixup.padding;
+			std::fill_n(&_out[target], fixup.padding, ' ');
+			end = fixup.offset;
+		}
+	}
+	_fixups.resize(from);
+}
+
+void TokenStream::TextFormatter::flushToSink(std::size_t minimalSize)
+{
+	if (!_sink || !_fixups.empty() || _out.size() < minimalSize)
+		return;
+
+	_sink->write(_out.data(), static_cast<std::streamsize>(_out.size()));
+	_out.clear();
+}
+
+/**
+ * Aligns the comments of the last block and inserts the remaining padding. The comments
+ * of the last block used to be aligned when the text was printed for the second time,
+ * at the end of its first or second line, so the comments up to that line keep their
+ * previous alignment.
+ */
+void TokenStream::TextFormatter::finish()
+{
+	auto firstLineColumn = _column;
+	std::optional<std::size_t> flushLine;
+	auto maximalColumn = _maximalCommentColumn;
+	if (_lineEnds[0])
+		maximalColumn = std::max(maximalColumn, firstLineColumn + _lineEnds[0].value());
+	if (_line >= 1 && (!_commentOnThisLine || _firstNewLineAfterColon))
+		flushLine = 0;
+	else if (_line >= 2)
+	{
+		flushLine = 1;
+		maximalColumn = std::max(maximalColumn, _lineEnds[1].value_or(0));
+	}
+
+	for (auto& fixup : _fixups)
+		if (!flushLine || fixup.line <= flushLine.value())
+			fixup.padding = getPadding(fixup, firstLineColumn);
+	if (flushLine && _commentPool.size() >= 2)
+		for (auto comment : _commentPool)
+			comment->setIndentation(maximalColumn);
+	for (auto& fixup : _fixups)
+		if (flushLine && fixup.line > flushLine.value())
+			fixup.padding = getPadding(fixup, firstLineColumn);
+	resolveFixups(0);
+
+	_commentPool.clear();
+	_firstLineFixups = 0;
+	flushToSink(0);
 }
 
 std::string TokenStream::getText(bool withIncludes, bool alignComments)
+{
+	std::string text;
+	writeText(text, withIncludes, alignComments);
+	return text;
+}
+
+/**
+ * Appends the formatted text to the output.
+ *
+ * @param output String to append the text to.
+ * @param withIncludes Set if includes are also to be included.
+ * @param alignComments Set if comments should be aligned.
+ */
+void TokenStream::writeText(std::string& output, bool withIncludes, bool alignComments)
 {
 	if (!_formatted)
 		autoformat();
-	PrintHelper helper;
-	if (alignComments)
-		getTextProcedure(helper, nullptr, withIncludes, alignComments); // First call determines alignment of comments
+	TextFormatter formatter(this, output, nullptr, alignComments);
+	writeTextProcedure(formatter, withIncludes);
+	formatter.finish();
+}
 
-	std::stringstream os;
-	getTextProcedure(helper, &os, withIncludes, alignComments); // Second call constructs the text
-	return os.str();
+/**
+ * Writes the formatted text to the output stream.
+ *
+ * @param output Stream to write the text to.
+ * @param withIncludes Set if includes are also to be included.
+ * @param alignComments Set if comments should be aligned.
+ */
+void TokenStream::writeText(std::ostream& output, bool withIncludes, bool alignComments)
+{
+	if (!_formatted)
+		autoformat();
+	std::string buffer;
+	TextFormatter formatter(this, buffer, &output, alignComments);
+	writeTextProcedure(formatter, withIncludes);
+	formatter.finish();
 }
 
 /**
  * Iterates through _tokens and determines where to put whitespaces and other characters.
- * If os != nullptr, it is filled with the text.
- * At the end, each comment is assigned it's desired alignment. This happens at the end - to
- * have the comments aligned in the output, this method should be called twice, first time with
- * os == nullptr.
  *
- * @param helper The expression to enclose.
- * @param os The stream to be filled with the text.
+ * @param formatter The formatter writing the text.
  * @param withIncludes Set if includes are also to be included.
- * @param alignComments Set if comments should be aligned.
  */
-void TokenStream::getTextProcedure(PrintHelper& helper, std::stringstream* os, bool withIncludes, bool alignComments)
+void TokenStream::writeTextProcedure(TextFormatter& formatter, bool withIncludes)
 {
-	BracketStack brackets;
 	size_t current_line_tabs = 0;
 	bool inside_rule = false;
 	bool inside_hex_string = false;
@@ -833,19 +1038,18 @@ void TokenStream::getTextProcedure(PrintHelper& helper, std::stringstream* os, b
 			assert(it->isIncludeToken());
 			if (withIncludes)
 			{
-				const std::string& text = it->getSubTokenStream()->getText(withIncludes);
-				helper.insertIntoStream(os, text);
+				formatter.insertSubText(it->getSubTokenStream().get(), withIncludes);
 				continue;
 			}
 			else
-				helper.insertIntoStream(os, this, it);
+				formatter.insert(it);
 		}
 		else if (current == TokenType::ONELINE_COMMENT || current == TokenType::COMMENT)
 		{
-			helper.printComment(os, this, it, current_line_tabs, alignComments, inside_condition_section);
+			formatter.insertComment(it, current_line_tabs, inside_condition_section);
 		}
 		else
-			helper.insertIntoStream(os, this, it);
+			formatter.insert(it);
 
 		auto nextIt = std::next(it);
 		if (nextIt == end())
@@ -896,16 +1100,8 @@ void TokenStream::getTextProcedure(PrintHelper& helper, std::stringstream* os, b
 				inside_string_modifiers = false;
 		}
 
-		if (it->isLeftBracket())
-		{
-			brackets.addLeftBracket(helper.getCurrentLine(), it->getFlag());
-			if (it->getFlag())
-				++current_line_tabs;
-		}
-		if (it->isRightBracket())
-		{
-			brackets.addRightBracket();
-		}
+		if (it->isLeftBracket() && it->getFlag())
+			++current_line_tabs;
 		if (current == TokenType::NEW_LINE)
 		{
 			if (inside_rule && next != TokenType::ONELINE_COMMENT && next != TokenType::COMMENT && next != TokenType::NEW_LINE)
@@ -916,13 +1112,13 @@ void TokenStream::getTextProcedure(PrintHelper& helper, std::stringstream* os, b
 					|| next == TokenType::CONDITION)
 				{
 					inside_condition_section = next == TokenType::CONDITION;
-					helper.insertIntoStream(os, "\t", tabulator_length);
+					formatter.insert('\t', 1, tabulator_length);
 				}
 				else if (next != TokenType::RULE_END)
 				{
 					if (nextIt->isRightBracket() && nextIt->getFlag())
 						--current_line_tabs;
-					helper.insertIntoStream(os, std::string(current_line_tabs, '\t'), current_line_tabs * tabulator_length);
+					formatter.insert('\t', current_line_tabs, current_line_tabs * tabulator_length);
 				}
 			}
 		}
@@ -948,7 +1144,7 @@ void TokenStream::getTextProcedure(PrintHelper& helper, std::stringstream* os, b
 			{
 				// Force no space before not operator in hex strings
 				if (second_nibble && next != TokenType::COMMA && current != TokenType::HEX_NOT)
-					helper.insertIntoStream(os, ' ');
+					formatter.insert(' ');
 			}
 		}
 		else if (!inside_regexp && inside_enumeration_brackets == 0 && !inside_string_modifiers_arguments)
@@ -969,7 +1165,7 @@ void TokenStream::getTextProcedure(PrintHelper& helper, std::stringstream* os, b
 					break;
 				case TokenType::LP:
 					if (next == TokenType::COMMENT || next == TokenType::ONELINE_COMMENT)
-						helper.insertIntoStream(os, ' ');
+						formatter.insert(' ');
 					break;
 				default:
 					auto nextNextIt = std::next(nextIt);
@@ -992,7 +1188,7 @@ void TokenStream::getTextProcedure(PrintHelper& helper, std::stringstream* os, b
 							if (next != TokenType::LSQB || (current != TokenType::STRING_OFFSET && current != TokenType::STRING_LENGTH))
 							{
 								if (next != TokenType::PERCENT || nextNextIt == end() || nextNextIt->getType() != TokenType::OF)
-									helper.insertIntoStream(os, ' ');
+									formatter.insert(' ');
 							}
 					}
 			}
@@ -1018,11 +1214,11 @@ void TokenStream::getTextProcedure(PrintHelper& helper, std::stringstream* os, b
 				// Immediately before ) should not be a space
 				&& next != TokenType::FUNCTION_CALL_RP
 			) {
-				helper.insertIntoStream(os, ' ');
+				formatter.insert(' ');
 			}
 		}
 		else if (current == TokenType::HEX_ALT_RIGHT_BRACKET || current == TokenType::HEX_ALT_LEFT_BRACKET)
-			helper.insertIntoStream(os, ' ');
+			formatter.insert(' ');
 	}
 }
 
@@ -49,6 +49,20 @@ const Expression::Ptr& Variable::getValue() const
 	return _value;
 }
 
+/**
+ * Returns the copy of the variable which refers to the copies of its tokens.
+ *
+ * @param target Token stream with the copies of the tokens.
+ * @param copies Copies of the tokens.
+ *
+ * @return Copy.
+ */
+Variable Variable::clone(const std::shared_ptr<TokenStream>& target, TokenMap& copies) const
+{
+	auto key = copies.at(&*_key);
+	return Variable(key, cloneInPlace(*_value, target, copies));
+}
+
 /**
  * Set the key of a variable.
  *
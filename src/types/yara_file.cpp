@@ -31,6 +31,8 @@ YaraFile::YaraFile(const std::shared_ptr<TokenStream>& tokenStream, Features fea
 	, _Features(features)
 	, _vtSymbols()
 	, _deferredIncludes()
+	, _literalPool()
+	, _expressionArena()
 {
 	if (_Features & Features::VirusTotalOnly)
 		initializeVTSymbols();
@@ -46,6 +48,8 @@ YaraFile::YaraFile(YaraFile&& o) noexcept
 	, _Features(std::move(o._Features))
 	, _vtSymbols(std::move(o._vtSymbols))
 	, _deferredIncludes(std::move(o._deferredIncludes))
+	, _literalPool(std::move(o._literalPool))
+	, _expressionArena(std::move(o._expressionArena))
 {
 }
 
@@ -60,6 +64,8 @@ YaraFile& YaraFile::operator=(YaraFile&& o) noexcept
 	swap(_ruleTrie, o._ruleTrie);
 	swap(_Features, o._Features);
 	swap(_vtSymbols, o._vtSymbols);
+	swap(_literalPool, o._literalPool);
+	swap(_expressionArena, o._expressionArena);
 	return *this;
 }
 
@@ -210,6 +216,29 @@ std::string YaraFile::getTextFormatted(bool withIncludes) const
 	return getTokenStream()->getText(withIncludes);
 }
 
+/**
+ * Appends the formatted text of the whole YARA file to the output.
+ *
+ * @param output String to append the text to.
+ * @param withIncludes Set if the included files are also to be written.
+ */
+void YaraFile::writeTextFormatted(std::string& output, bool withIncludes) const
+{
+	getTokenStream()->writeText(output, withIncludes);
+}
+
+/**
+ * Writes the formatted text of the whole YARA file to the output stream.
+ * The text is written in chunks without building it whole in memory first.
+ *
+ * @param output Stream to write the text to.
+ * @param withIncludes Set if the included files are also to be written.
+ */
+void YaraFile::writeTextFormatted(std::ostream& output, bool withIncludes) const
+{
+	getTokenStream()->writeText(output, withIncludes);
+}
+
 /**
  * Adds the import of the module to the YARA file. Module needs
  * to exist and be defined in @c types/modules folder.
@@ -219,7 +248,7 @@ std::string YaraFile::getTextFormatted(bool withIncludes) const
  *
  * @return @c true if module was found, @c false otherwise.
  */
-bool YaraFile::addImport(TokenIt import, ModulePool& modules)
+bool YaraFile::addImport(TokenIt import, const ModulePool& modules)
 {
 	auto module = modules.load(import->getPureText());
 	if (!module)
@@ -243,7 +272,7 @@ bool YaraFile::addImport(TokenIt import, ModulePool& modules)
  *
  * @return @c true if modules were found, @c false otherwise.
  */
-bool YaraFile::addImports(const std::vector<TokenIt>& imports, ModulePool& modules)
+bool YaraFile::addImports(const std::vector<TokenIt>& imports, const ModulePool& modules)
 {
 	for (const TokenIt& module : imports)
 	{
@@ -357,6 +386,24 @@ void YaraFile::insertRule(std::size_t position, const std::shared_ptr<Rule>& rul
 	_ruleTrie.insert(_rules[position]->getName(), _rules[position].get());
 }
 
+/**
+ * Inserts the rules at the specified position to the YARA file. Their tokens
+ * are expected to be already in the token stream of the file.
+ *
+ * @param position Position to insert rules at.
+ * @param rules Rules to insert.
+ */
+void YaraFile::attachRules(std::size_t position, std::vector<std::shared_ptr<Rule>>&& rules)
+{
+	position = std::min(position, _rules.size());
+	for (const auto& rule : rules)
+	{
+		_ruleTable.emplace(rule->getName(), rule.get());
+		_ruleTrie.insert(rule->getName(), rule.get());
+	}
+	_rules.insert(_rules.begin() + position, std::make_move_iterator(rules.begin()), std::make_move_iterator(rules.end()));
+}
+
 /**
  * Returns all imported modules from the YARA file in order they were added.
  *
@@ -377,6 +424,57 @@ TokenStream* YaraFile::getTokenStream() const
 	return _tokenStream.get();
 }
 
+/**
+ * Returns the whole tokenStream of this file.
+ *
+ * @return _tokenStream.
+ */
+const std::shared_ptr<TokenStream>& YaraFile::getTokenStreamSharedPtr() const
+{
+	return _tokenStream;
+}
+
+/**
+ * Returns the pool of strings shared by the literals of tokens in this file.
+ *
+ * @return Literal pool.
+ */
+LiteralPool& YaraFile::getLiteralPool()
+{
+	return _literalPool;
+}
+
+/**
+ * Returns the pool of strings shared by the literals of tokens in this file.
+ *
+ * @return Literal pool.
+ */
+const LiteralPool& YaraFile::getLiteralPool() const
+{
+	return _literalPool;
+}
+
+/**
+ * Returns the arena which the parser allocates the expressions of conditions in.
+ *
+ * @return Expression arena, @c nullptr if the expressions are allocated on the heap.
+ */
+const std::shared_ptr<ExpressionArena>& YaraFile::getExpressionArena() const
+{
+	return _expressionArena;
+}
+
+/**
+ * Sets the arena which the parser allocates the expressions of conditions in.
+ * Expressions already allocated in the previous arena stay there.
+ *
+ * @param expressionArena Expression arena, @c nullptr to allocate the expressions on the heap.
+ */
+void YaraFile::setExpressionArena(const std::shared_ptr<ExpressionArena>& expressionArena)
+{
+	_expressionArena = expressionArena;
+}
+
 /**
  * Returns all rules from the YARA file in order they were added.
  *
@@ -387,6 +485,44 @@ const std::vector<std::shared_ptr<Rule>>& YaraFile::getRules() const
 	return _rules;
 }
 
+/**
+ * Removes the rules in the range [first, last) from the YARA file
+ * but leaves their tokens in the token stream of the file.
+ *
+ * @param first Position of the first rule to remove.
+ * @param last Position after the last rule to remove.
+ *
+ * @return Removed rules.
+ */
+std::vector<std::shared_ptr<Rule>> YaraFile::detachRules(std::size_t first, std::size_t last)
+{
+	last = std::min(last, _rules.size());
+	first = std::min(first, last);
+
+	std::vector<std::shared_ptr<Rule>> result(std::make_move_iterator(_rules.begin() + first), std::make_move_iterator(_rules.begin() + last));
+	_rules.erase(_rules.begin() + first, _rules.begin() + last);
+	for (const auto& rule : result)
+	{
+		_ruleTrie.remove(rule->getName());
+		_ruleTable.erase(rule->getName());
+	}
+	return result;
+}
+
+/**
+ * Removes the imports starting at the given position from the YARA file
+ * but leaves their tokens in the token stream of the file.
+ *
+ * @param first Position of the first import to remove.
+ */
+void YaraFile::detachImports(std::size_t first)
+{
+	first = std::min(first, _imports.size());
+	for (auto itr = _imports.begin() + first; itr != _imports.end(); ++itr)
+		_importTable.erase((*itr)->getName());
+	_imports.erase(_imports.begin() + first, _imports.end());
+}
+
 /**
  * Finds the symbol in the YARA file. Symbol is either rule name or module identifier.
  *
@@ -412,6 +548,19 @@ std::shared_ptr<Symbol> YaraFile::findSymbol(const std::string& name) const
 	return nullptr;
 }
 
+/**
+ * Finds the rule with the given name in the YARA file.
+ *
+ * @param name Name of the rule.
+ *
+ * @return Rule if it was found, @c nullptr otherwise.
+ */
+Rule* YaraFile::findRule(const std::string& name) const
+{
+	auto itr = _ruleTable.find(name);
+	return itr != _ruleTable.end() ? itr->second : nullptr;
+}
+
 /**
  * Returns whether the YARA file contains any imported modules.
  *
@@ -0,0 +1,103 @@
+/**
+ * @file src/utils/binary_json.cpp
+ * @brief Implementation of class BinaryJson.
+ * @copyright (c) 2026 Avast Software, licensed under the MIT license
+ */
+
+#include "yaramod/utils/binary_json.h"
+#include "yaramod/yaramod_error.h"
+
+namespace yaramod {
+
+/**
+ * Returns whether the object contains the given key.
+ *
+ * @param key Key to look for.
+ *
+ * @return @c true if the key is present, otherwise @c false.
+ */
+bool BinaryJson::contains(std::string_view key) const
+{
+	return _find(key) != nullptr;
+}
+
+/**
+ * Returns the value of the string.
+ *
+ * @return String value.
+ */
+std::string_view BinaryJson::getString() const
+{
+	if (!isString())
+		throw YaramodError("Binary JSON value is not a string");
+	return _data->strings[_index()];
+}
+
+/**
+ * Returns the value stored under the given key of the object.
+ *
+ * @param key Key of the value.
+ *
+ * @return Value under the key.
+ */
+BinaryJson BinaryJson::get(std::string_view key) const
+{
+	auto value = _find(key);
+	if (!value)
+		throw YaramodError("The key '" + std::string{key} + "' not found in binary JSON object");
+	return BinaryJson(_data, *value);
+}
+
+/**
+ * Returns all elements of the array.
+ *
+ * @return Elements of the array.
+ */
+std::vector<BinaryJson> BinaryJson::getElements() const
+{
+	if (!isArray())
+		throw YaramodError("Binary JSON value is not an array");
+
+	const auto* array = _data->values + _index();
+	std::vector<BinaryJson> result;
+	result.reserve(array[0]);
+	for (std::uint32_t i = 1; i <= array[0]; ++i)
+		result.emplace_back(_data, array[i]);
+	return result;
+}
+
+/**
+ * Returns all keys of the object in the order they were specified in.
+ *
+ * @return Keys of the object.
+ */
+std::vector<std::string_view> BinaryJson::getKeys() const
+{
+	std::vector<std::string_view> result;
+	if (!isObject())
+		return result;
+
+	const auto* object = _data->values + _index();
+	result.reserve(object[0]);
+	for (std::uint32_t i = 0; i < object[0]; ++i)
+		result.push_back(_data->strings[object[1 + 2 * i]]);
+	return result;
+}
+
+const std::uint32_t* BinaryJson::_find(std::string_view key) const
+{
+	if (!isObject())
+		return nullptr;
+
+	// Objects in module specifications have just a few keys so linear search is the fastest
+	const auto* object = _data->values + _index();
+	for (std::uint32_t i = 0; i < object[0]; ++i)
+	{
+		if (_data->strings[object[1 + 2 * i]] == key)
+			return &object[2 + 2 * i];
+	}
+
+	return nullptr;
+}
+
+} // namespace yaramod
@@ -58,4 +58,28 @@ nlohmann::json accessJsonSubjson(const nlohmann::json& json, const std::string&
 	return accessJson<nlohmann::json>(json, key);
 }
 
+BinaryJson accessJsonSubjson(const BinaryJson& json, const std::string& key)
+{
+	if (!json.contains(key))
+	{
+		std::stringstream ss;
+		ss << "The key '" << key << "' not found among provided keys ";
+		for (const auto& item : json.getKeys())
+			ss << "'" << item << "', ";
+		std::string message = ss.str();
+		throw YaramodError(message.erase(message.size()-2, 2));
+	}
+	return json.get(key);
+}
+
+std::string accessJsonString(const BinaryJson& json, const std::string& key)
+{
+	return std::string{accessJsonSubjson(json, key).getString()};
+}
+
+std::vector<BinaryJson> accessJsonArray(const BinaryJson& json, const std::string& key)
+{
+	return accessJsonSubjson(json, key).getElements();
+}
+
 }
@@ -0,0 +1,132 @@
+/**
+ * @file src/utils/mapped_file.cpp
+ * @brief Implementation of class MappedFile.
+ * @copyright (c) 2026 Avast Software, licensed under the MIT license
+ */
+
+#include <fstream>
+#include <sstream>
+
+#ifdef YARAMOD_OS_WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "yaramod/utils/mapped_file.h"
+
+namespace yaramod {
+
+/**
+ * Constructor. Maps the file into memory or reads it if mapping is not possible.
+ * Use isOpen() to find out whether the content is available.
+ *
+ * @param filePath Path to the file.
+ */
+MappedFile::MappedFile(const std::string& filePath)
+{
+	_open = _map(filePath) || _read(filePath);
+}
+
+/**
+ * Destructor. Unmaps the file.
+ */
+MappedFile::~MappedFile()
+{
+	if (!_mapping)
+		return;
+
+#ifdef YARAMOD_OS_WINDOWS
+	UnmapViewOfFile(_mapping);
+#else
+	munmap(_mapping, _content.size());
+#endif
+}
+
+#ifdef YARAMOD_OS_WINDOWS
+bool MappedFile::_map(const std::string& filePath)
+{
+	auto file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0 || GetFileType(file) != FILE_TYPE_DISK)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (!mapping)
+		return false;
+
+	// View keeps the mapping alive so the handle can be closed right away
+	_mapping = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!_mapping)
+		return false;
+
+	_content = std::string_view{static_cast<const char*>(_mapping), static_cast<std::size_t>(size.QuadPart)};
+	return true;
+}
+#else
+bool MappedFile::_map(const std::string& filePath)
+{
+	auto fd = open(filePath.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	// Empty files can't be mapped and special files like pipes have no size
+	struct stat info;
+	if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	auto size = static_cast<std::size_t>(info.st_size);
+	auto mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED)
+		return false;
+
+	_mapping = mapping;
+	_content = std::string_view{static_cast<const char*>(_mapping), size};
+	return true;
+}
+#endif
+
+/**
+ * Reads the whole content of the mapped file into memory by touching each of its pages,
+ * so that the later accesses to the content don't wait for the storage.
+ */
+void MappedFile::prefault() const
+{
+	if (!_mapping)
+		return;
+
+	constexpr std::size_t PageSize = 4096;
+	volatile char sum = 0;
+	for (std::size_t offset = 0; offset < _content.size(); offset += PageSize)
+		sum = sum + _content[offset];
+}
+
+bool MappedFile::_read(const std::string& filePath)
+{
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	std::ostringstream content;
+	content << file.rdbuf();
+	_buffer = content.str();
+	_content = _buffer;
+	return true;
+}
+
+} // namespace yaramod
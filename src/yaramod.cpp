@@ -4,6 +4,10 @@
  * @copyright (c) 2017 Avast Software, licensed under the MIT license
  */
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 #include "yaramod/yaramod.h"
 
 namespace yaramod {
@@ -32,6 +36,200 @@ std::unique_ptr<YaraFile> Yaramod::parseStream(std::istream& inputStream, Parser
 	return result;
 }
 
+std::unique_ptr<YaraFile> Yaramod::parseString(std::string_view input, ParserMode parserMode)
+{
+	if (!_driver.isValid())
+		return nullptr;
+
+	std::unique_ptr<YaraFile> result;
+	if (_driver.parse(input, parserMode))
+		result = std::make_unique<YaraFile>(std::move(_driver.getParsedFile()));
+
+	return result;
+}
+
+bool Yaramod::parseFile(const std::string& filePath, const ParserDriver::RuleCallback& onRule, ParserMode parserMode)
+{
+	if (!_driver.isValid())
+		return false;
+
+	return _driver.parse(filePath, onRule, parserMode);
+}
+
+bool Yaramod::parseStream(std::istream& inputStream, const ParserDriver::RuleCallback& onRule, ParserMode parserMode)
+{
+	if (!_driver.isValid())
+		return false;
+
+	return _driver.parse(inputStream, onRule, parserMode);
+}
+
+bool Yaramod::parseString(std::string_view input, const ParserDriver::RuleCallback& onRule, ParserMode parserMode)
+{
+	if (!_driver.isValid())
+		return false;
+
+	return _driver.parse(input, onRule, parserMode);
+}
+
+ReparseResult Yaramod::reparse(YaraFile& file, std::string_view input, const std::vector<InputChange>& changes, ParserMode parserMode)
+{
+	if (!_driver.isValid())
+		return ReparseResult::Error;
+
+	return _driver.reparse(file, input, changes, parserMode);
+}
+
+std::vector<ParseResult> Yaramod::parseFiles(const std::vector<std::string>& filePaths, std::size_t threads, ParserMode parserMode)
+{
+	std::vector<ParseResult> results(filePaths.size());
+	if (filePaths.empty())
+		return results;
+
+	if (threads == 0)
+		threads = std::max(std::thread::hardware_concurrency(), 1u);
+	threads = std::min(threads, filePaths.size());
+
+	// Drivers are kept for the next calls, they are created lazily so threads which don't get any file don't build them
+	if (_workerDrivers.size() < threads)
+		_workerDrivers.resize(threads);
+
+	std::atomic<std::size_t> nextFile = 0;
+	auto worker = [&](std::size_t workerIndex) {
+		auto& driver = _workerDrivers[workerIndex];
+		for (auto i = nextFile++; i < filePaths.size(); i = nextFile++)
+		{
+			auto& result = results[i];
+			result.filePath = filePaths[i];
+			try
+			{
+				if (!driver)
+				{
+					driver = std::make_unique<ParserDriver>(_features, _moduleDirectory);
+					driver->setIncludeCache(_includeCache);
+					driver->setIncludePrefetchThreads(_includePrefetchThreads);
+					driver->setErrorRecovery(_errorRecovery);
+					driver->setProfiling(_profiling);
+					driver->setArenaAllocation(_arenaAllocation);
+				}
+				if (!driver->isValid())
+				{
+					result.error = "Parser used for file '" + filePaths[i] + "' is not valid";
+					continue;
+				}
+
+				if (driver->parse(filePaths[i], parserMode))
+				{
+					result.yaraFile = std::make_unique<YaraFile>(std::move(driver->getParsedFile()));
+					result.errors = driver->getErrors();
+				}
+				else
+					result.error = "Unable to parse file '" + filePaths[i] + "'";
+				result.profile = driver->getProfile();
+			}
+			catch (const std::exception& err)
+			{
+				result.error = err.what();
+			}
+			catch (...)
+			{
+				result.error = "Unknown error while parsing file '" + filePaths[i] + "'";
+			}
+		}
+	};
+
+	// Threads which were started are joined on every exit path, also when starting another thread fails
+	std::vector<std::thread> workers;
+	struct JoinGuard
+	{
+		~JoinGuard() { join(); }
+
+		void join()
+		{
+			for (auto& thread : threads)
+			{
+				if (thread.joinable())
+					thread.join();
+			}
+		}
+
+		std::vector<std::thread>& threads;
+	} joinGuard{workers};
+
+	workers.reserve(threads - 1);
+	for (std::size_t i = 1; i < threads; ++i)
+		workers.emplace_back(worker, i);
+	worker(0);
+	joinGuard.join();
+
+	return results;
+}
+
+void Yaramod::setIncludeCache(const std::shared_ptr<IncludeCache>& includeCache)
+{
+	_includeCache = includeCache;
+	_driver.setIncludeCache(includeCache);
+	for (auto& driver : _workerDrivers)
+	{
+		if (driver)
+			driver->setIncludeCache(includeCache);
+	}
+}
+
+void Yaramod::setErrorRecovery(bool errorRecovery)
+{
+	_errorRecovery = errorRecovery;
+	_driver.setErrorRecovery(errorRecovery);
+	for (auto& driver : _workerDrivers)
+	{
+		if (driver)
+			driver->setErrorRecovery(errorRecovery);
+	}
+}
+
+const std::vector<ParserError>& Yaramod::getErrors() const
+{
+	return _driver.getErrors();
+}
+
+void Yaramod::setProfiling(bool profiling)
+{
+	_profiling = profiling;
+	_driver.setProfiling(profiling);
+	for (auto& driver : _workerDrivers)
+	{
+		if (driver)
+			driver->setProfiling(profiling);
+	}
+}
+
+const ParserProfile& Yaramod::getProfile() const
+{
+	return _driver.getProfile();
+}
+
+void Yaramod::setArenaAllocation(bool arenaAllocation)
+{
+	_arenaAllocation = arenaAllocation;
+	_driver.setArenaAllocation(arenaAllocation);
+	for (auto& driver : _workerDrivers)
+	{
+		if (driver)
+			driver->setArenaAllocation(arenaAllocation);
+	}
+}
+
+void Yaramod::setIncludePrefetchThreads(std::size_t threads)
+{
+	_includePrefetchThreads = threads;
+	_driver.setIncludePrefetchThreads(threads);
+	for (auto& driver : _workerDrivers)
+	{
+		if (driver)
+			driver->setIncludePrefetchThreads(threads);
+	}
+}
+
 const YaraFile& Yaramod::getParsedFile() const
 {
 	return _driver.getParsedFile();
@@ -2413,6 +2413,51 @@ WithWorks) {
 )", yaraFile->getTextFormatted());
 }
 
+TEST_F(BuilderTests,
+ConjunctionOfManyTermsIsFlat) {
+	std::vector<YaraExpressionBuilder> terms = { boolVal(true), filesize() > intVal(100), paren(entrypoint() == intVal(100)) };
+	auto cond = conjunction(terms, true).get();
+	auto andExpr = cond->as<AndExpression>();
+	ASSERT_NE(nullptr, andExpr);
+	ASSERT_NE(nullptr, andExpr->getChain());
+	EXPECT_EQ(3u, andExpr->getChainOperandsCount());
+	EXPECT_EQ("true and\nfilesize > 100 and\n(entrypoint == 100)", cond->getText());
+	EXPECT_EQ("true", cond->getFirstTokenIt()->getPureText());
+	EXPECT_EQ(")", cond->getLastTokenIt()->getPureText());
+	EXPECT_EQ("true and\nfilesize > 100", andExpr->getLeftOperand()->getText());
+
+	auto disj = (boolVal(false) || boolVal(true) || boolVal(false)).get();
+	auto orExpr = disj->as<OrExpression>();
+	ASSERT_NE(nullptr, orExpr);
+	ASSERT_NE(nullptr, orExpr->getChain());
+	EXPECT_EQ(3u, orExpr->getChainOperandsCount());
+	EXPECT_EQ("false or true or false", disj->getText());
+}
+
+TEST_F(BuilderTests,
+SharedChainIsCopiedWhenContinued) {
+	auto first = disjunction({boolVal(false), boolVal(true), boolVal(false)});
+	auto second = first;
+	second || boolVal(true);
+
+	auto firstExpr = first.get()->as<OrExpression>();
+	auto secondExpr = second.get()->as<OrExpression>();
+	ASSERT_NE(nullptr, firstExpr->getChain());
+	ASSERT_NE(nullptr, secondExpr->getChain());
+	EXPECT_NE(firstExpr->getChain(), secondExpr->getChain());
+	EXPECT_EQ(3u, firstExpr->getChain()->getOperandsCount());
+	EXPECT_EQ(4u, secondExpr->getChain()->getOperandsCount());
+	EXPECT_EQ("false or true or false", firstExpr->getText());
+	EXPECT_EQ("false or true or false or true", secondExpr->getText());
+
+	// Chain which nothing else references is continued in place
+	auto third = disjunction({boolVal(false), boolVal(true), boolVal(false)});
+	const auto* chain = third.get()->as<OrExpression>()->getChain();
+	third || boolVal(true);
+	EXPECT_EQ(chain, third.get()->as<OrExpression>()->getChain());
+	EXPECT_EQ(4u, chain->getOperandsCount());
+}
+
 TEST_F(BuilderTests,
 IterableWorks) {
 	auto cond = of(
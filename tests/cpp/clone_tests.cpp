@@ -77,6 +77,23 @@ public:
 	std::shared_ptr<TokenStream> new_ts;
 };
 
+// Expression whose clone consists of one more token than the original
+struct ExpressionWithLongerClone
+{
+	TokenIt getFirstTokenIt() const { return expression->getFirstTokenIt(); }
+	TokenIt getLastTokenIt() const { return expression->getLastTokenIt(); }
+	std::string getText() const { return expression->getText(); }
+
+	Expression::Ptr clone(const std::shared_ptr<TokenStream>& target) const
+	{
+		auto result = expression->clone(target);
+		target->emplace_back(TokenType::NEW_LINE, "\n");
+		return result;
+	}
+
+	const Expression* expression;
+};
+
 TEST_F(CloneTests,
 StringExpression) {
 	prepareInput(
@@ -2424,5 +2441,28 @@ rule test
 	ASSERT_NE(std::dynamic_pointer_cast<RegexpGroup>(regexp_content->getUnits()[0]), nullptr);
 }
 
+TEST_F(CloneTests,
+CloneInPlaceRejectsClonesWithDifferentTokens) {
+	prepareInput(
+R"(
+rule test
+{
+	condition:
+		filesize == 1
+}
+)");
+
+	EXPECT_TRUE(driver.parse(input));
+	ASSERT_EQ(1u, driver.getParsedFile().getRules().size());
+	const auto& rule = driver.getParsedFile().getRules()[0];
+
+	TokenMap copies;
+	auto target = rule->getTokenStream()->copy(copies);
+	auto size = target->size();
+	EXPECT_THROW(cloneInPlace(ExpressionWithLongerClone{rule->getCondition().get()}, target, copies), YaramodError);
+	EXPECT_EQ(size, target->size());
+	EXPECT_EQ(&*target->begin(), &*copies.at(&*rule->getTokenStream()->begin()));
+}
+
 }
 }
@@ -4,11 +4,23 @@
 * @copyright AVG Technologies s.r.o, All Rights Reserved
 */
 
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <thread>
+
 #include <gtest/gtest.h>
 
+#include "yaramod/parser/include_cache.h"
 #include "yaramod/parser/parser_driver.h"
+#include "yaramod/parser/parsing_table_cache.h"
 #include "yaramod/types/hex_string.h"
 #include "yaramod/types/plain_string.h"
+#include "yaramod/utils/filesystem.h"
+#include "yaramod/utils/static_visitor.h"
+
+#include "temporary_directory.h"
 
 
 using namespace ::testing;
@@ -9005,5 +9017,1376 @@ rule formatting_in_expression_arrays_not_broken
 )");
 }
 
+TEST_F(ParserTests,
+ParseStringViewInPlace) {
+	std::string buffer = "rule abc { condition: true }rule def { condition: false }";
+	std::string_view input{buffer.data(), buffer.find('}') + 1};
+
+	EXPECT_TRUE(driver.parse(input));
+	ASSERT_EQ(1u, driver.getParsedFile().getRules().size());
+	EXPECT_EQ("abc", driver.getParsedFile().getRules()[0]->getName());
+	EXPECT_EQ("true", driver.getParsedFile().getRules()[0]->getCondition()->getText());
+}
+
+TEST_F(ParserTests,
+ParseMappedFileWithInclude) {
+	TemporaryDirectory directory;
+	std::ofstream(directory / "included.yar") << "rule abc { condition: true }\n";
+	std::ofstream(directory / "empty.yar");
+	std::ofstream(directory / "main.yar") << "include \"included.yar\"\ninclude \"empty.yar\"\nrule def { condition: abc }\n";
+
+	EXPECT_TRUE(driver.parse((directory / "main.yar").string()));
+	ASSERT_EQ(2u, driver.getParsedFile().getRules().size());
+	EXPECT_EQ("abc", driver.getParsedFile().getRules()[0]->getName());
+	EXPECT_EQ("def", driver.getParsedFile().getRules()[1]->getName());
+}
+
+TEST_F(ParserTests,
+IdenticalTokensShareInternedLiterals) {
+	prepareInput(
+R"(
+rule abc { meta: a_rather_long_meta_key = 1 condition: filesize > 10 and true }
+rule def { meta: a_rather_long_meta_key = 2 condition: filesize > 20 and false }
+)");
+
+	EXPECT_TRUE(driver.parse(input));
+	const auto& file = driver.getParsedFile();
+
+	std::vector<const Token*> ands, names;
+	for (const auto& token : file.getTokenStream()->getTokens())
+	{
+		if (token.getType() == TokenType::AND)
+			ands.push_back(&token);
+		else if (token.isString() && token.getString() == "a_rather_long_meta_key")
+			names.push_back(&token);
+	}
+	ASSERT_EQ(2u, ands.size());
+	ASSERT_EQ(2u, names.size());
+	EXPECT_TRUE(ands[0]->getLiteral().isInterned());
+	EXPECT_EQ(&ands[0]->getString(), &ands[1]->getString());
+	EXPECT_EQ(&names[0]->getString(), &names[1]->getString());
+	EXPECT_EQ(23u, file.getLiteralPool().getSavedBytes());
+
+	const_cast<Token*>(ands[0])->setValue(std::string{"AND"});
+	EXPECT_EQ("AND", ands[0]->getString());
+	EXPECT_EQ("and", ands[1]->getString());
+}
+
+TEST_F(ParserTests,
+TokenLocationsShareFilePath) {
+	TemporaryDirectory directory;
+	auto filePath = (directory / "rule_file_with_a_long_name.yar").string();
+	std::ofstream(filePath) << "rule abc {\n\tcondition:\n\t\ttrue\n}\n";
+
+	EXPECT_TRUE(driver.parse(filePath));
+	const auto& tokens = driver.getParsedFile().getTokenStream()->getTokens();
+	ASSERT_FALSE(tokens.empty());
+	EXPECT_EQ(filePath, tokens.front().getLocation().getFilePath());
+	EXPECT_EQ(&tokens.front().getLocation().getFilePath(), &tokens.back().getLocation().getFilePath());
+	EXPECT_FALSE(tokens.front().getLocation().isUnnamed());
+
+	const auto& rule = driver.getParsedFile().getRules()[0];
+	EXPECT_EQ(filePath, rule->getLocation().getFilePath());
+	EXPECT_EQ(1u, rule->getLocation().begin().getLine());
+
+	auto trueToken = std::find_if(tokens.begin(), tokens.end(), [](const auto& token) { return token.getType() == TokenType::BOOL_TRUE; });
+	ASSERT_NE(tokens.end(), trueToken);
+	EXPECT_EQ(filePath + ":3.3-6", trueToken->getLocation().getText());
+
+	EXPECT_TRUE(Location("[stream]").isUnnamed());
+	EXPECT_EQ("", Location().getFilePath());
+}
+
+TEST_F(ParserTests,
+TokenLocationPositionsSaturate) {
+	constexpr std::size_t maxPosition = std::numeric_limits<std::uint32_t>::max();
+
+	Location location("[stream]", std::size_t{1} << 40, 3);
+	EXPECT_EQ(maxPosition, location.begin().getLine());
+	EXPECT_EQ(4u, location.begin().getColumn());
+
+	location.addColumn(std::size_t{1} << 40);
+	EXPECT_EQ(maxPosition, location.end().getColumn());
+	location.addLine(10);
+	EXPECT_EQ(maxPosition, location.end().getLine());
+
+	location.shiftLines(-static_cast<std::ptrdiff_t>(maxPosition) - 10);
+	EXPECT_EQ(0u, location.begin().getLine());
+	EXPECT_EQ(0u, location.end().getLine());
+
+	location.shiftLines(5);
+	EXPECT_EQ(5u, location.end().getLine());
+}
+
+TEST_F(ParserTests,
+RulesAreStreamedToCallback) {
+	prepareInput(
+R"(import "cuckoo"
+
+// First rule
+rule abc {
+	strings:
+		$s = "text"
+	condition:
+		$s
+}
+
+import "pe"
+
+private rule def {
+	condition:
+		pe.is_dll()
+}
+
+rule ghi {
+	condition:
+		abc and def
+}
+)");
+
+	std::vector<std::unique_ptr<Rule>> rules;
+	std::vector<std::size_t> importCounts;
+	EXPECT_TRUE(driver.parse(input, [&](std::unique_ptr<Rule>&& rule, const YaraFile& file) {
+		EXPECT_FALSE(file.hasRules());
+		importCounts.push_back(file.getImports().size());
+		rules.push_back(std::move(rule));
+	}));
+
+	ASSERT_EQ(3u, rules.size());
+	EXPECT_EQ("abc", rules[0]->getName());
+	EXPECT_EQ("def", rules[1]->getName());
+	EXPECT_EQ("ghi", rules[2]->getName());
+	EXPECT_EQ(std::vector<std::size_t>({1, 2, 2}), importCounts);
+	EXPECT_TRUE(rules[1]->isPrivate());
+	EXPECT_EQ(13u, rules[1]->getLocation().begin().getLine());
+	EXPECT_EQ("$s", rules[0]->getCondition()->getText());
+	EXPECT_EQ("abc and def", rules[2]->getCondition()->getText());
+
+	// Every rule owns its tokens together with the comments preceding it, the file keeps only the imports
+	const auto& fileTokens = driver.getParsedFile().getTokenStream()->getTokens();
+	EXPECT_EQ(0, std::count_if(fileTokens.begin(), fileTokens.end(), [](const auto& token) { return token.getType() == TokenType::RULE; }));
+	EXPECT_EQ(2, std::count_if(fileTokens.begin(), fileTokens.end(), [](const auto& token) { return token.getType() == TokenType::IMPORT_KEYWORD; }));
+	for (const auto& rule : rules)
+	{
+		EXPECT_NE(driver.getParsedFile().getTokenStream(), rule->getTokenStream());
+		EXPECT_EQ(TokenType::RULE_END, rule->getTokenStream()->back().getType());
+	}
+	const auto& ruleTokens = rules[0]->getTokenStream()->getTokens();
+	EXPECT_EQ(1, std::count_if(ruleTokens.begin(), ruleTokens.end(), [](const auto& token) { return token.getType() == TokenType::ONELINE_COMMENT; }));
+	EXPECT_EQ(R"(rule abc {
+	strings:
+		$s = "text"
+	condition:
+		$s
+})", rules[0]->getText());
+}
+
+TEST_F(ParserTests,
+StreamedRulesAreCheckedForRedefinition) {
+	prepareInput(
+R"(
+rule abc {
+	condition:
+		true
+}
+
+rule abc {
+	condition:
+		false
+}
+)");
+
+	std::size_t rulesCount = 0;
+	try
+	{
+		driver.parse(input, [&](std::unique_ptr<Rule>&&, const YaraFile&) { ++rulesCount; });
+		FAIL() << "Parser did not throw an exception.";
+	}
+	catch (const ParserError& err)
+	{
+		EXPECT_EQ(1u, rulesCount);
+		EXPECT_EQ("Error at 7.6-8: Redefinition of rule 'abc'", err.getErrorMessage());
+	}
+}
+
+void expectSameAsFullParse(const YaraFile& file, const std::string& input)
+{
+	ParserDriver fullDriver;
+	ASSERT_TRUE(fullDriver.parse(std::string_view{input}));
+	const auto& expected = fullDriver.getParsedFile();
+
+	EXPECT_EQ(expected.getText(), file.getText());
+	ASSERT_EQ(expected.getRules().size(), file.getRules().size());
+	for (std::size_t i = 0; i < expected.getRules().size(); ++i)
+	{
+		EXPECT_EQ(expected.getRules()[i]->getName(), file.getRules()[i]->getName());
+		EXPECT_EQ(expected.getRules()[i]->getLocation().getText(), file.getRules()[i]->getLocation().getText());
+	}
+
+	ASSERT_EQ(expected.getTokenStream()->size(), file.getTokenStream()->size());
+	for (auto itr = expected.getTokenStream()->begin(), actualItr = file.getTokenStream()->begin(); itr != expected.getTokenStream()->end(); ++itr, ++actualItr)
+	{
+		EXPECT_EQ(itr->getType(), actualItr->getType());
+		EXPECT_EQ(itr->getPureText(), actualItr->getPureText());
+		EXPECT_EQ(itr->getLocation().getText(), actualItr->getLocation().getText()) << "Token '" << itr->getPureText() << "'";
+	}
+}
+
+std::vector<InputChange> replaceInInput(std::string& input, const std::string& text, const std::string& replacement)
+{
+	auto offset = input.find(text);
+	input.replace(offset, text.size(), replacement);
+	return {InputChange{offset, replacement.size()}};
+}
+
+TEST_F(ParserTests,
+ReparseOfEditedRulesMatchesFullParse) {
+	std::string text =
+R"(import "cuckoo"
+
+/* First
+ * rule */
+rule abc
+{
+	strings:
+		$s = "text"
+		$h = { 01 02 }
+	condition:
+		$s and $h
+}
+
+// Second rule
+private rule def : tag
+{
+	condition:
+		abc and cuckoo.network.http_request(/abc/)
+}
+
+rule ghi
+{
+	condition:
+		def and
+		abc
+}
+)";
+	ASSERT_TRUE(driver.parse(std::string_view{text}));
+	auto file = std::move(driver.getParsedFile());
+	auto defSymbol = file.getRules()[1]->getSymbol();
+
+	// Condition of a rule referenced by the following rule
+	auto changes = replaceInInput(text, "(/abc/)", "(/abcd/) or\n\t\tcuckoo.network.http_request(/efg/)");
+	EXPECT_EQ(ReparseResult::Incremental, driver.reparse(file, text, changes));
+	expectSameAsFullParse(file, text);
+	EXPECT_EQ(defSymbol, file.getRules()[1]->getSymbol());
+
+	// New rule between two rules
+	changes = replaceInInput(text, "rule ghi", "rule new_rule\n{\n\tcondition:\n\t\tdef\n}\n\nrule ghi");
+	EXPECT_EQ(ReparseResult::Incremental, driver.reparse(file, text, changes));
+	expectSameAsFullParse(file, text);
+
+	// Removed lines of the first rule
+	changes = replaceInInput(text, "\t\t$h = { 01 02 }\n", "");
+	auto conditionChanges = replaceInInput(text, "$s and $h", "$s");
+	changes.push_back(conditionChanges.front());
+	EXPECT_EQ(ReparseResult::Incremental, driver.reparse(file, text, changes));
+	expectSameAsFullParse(file, text);
+
+	// Comment preceding the rule and the last rule of the file
+	changes = replaceInInput(text, "// Second rule", "/* Second\n   rule */");
+	auto lastChanges = replaceInInput(text, "\t\tabc\n}", "\t\tabc and\n\t\tnew_rule\n}");
+	changes.push_back(lastChanges.front());
+	EXPECT_EQ(ReparseResult::Incremental, driver.reparse(file, text, changes));
+	expectSameAsFullParse(file, text);
+	EXPECT_EQ(4u, file.getRules().size());
+	EXPECT_TRUE(file.getRules()[1]->isPrivate());
+
+	// New rule at the end of the file
+	changes = {InputChange{text.size(), 0}};
+	text += "\nrule jkl\n{\n\tcondition:\n\t\tghi\n}\n";
+	changes.front().length = text.size() - changes.front().offset;
+	EXPECT_EQ(ReparseResult::Incremental, driver.reparse(file, text, changes));
+	expectSameAsFullParse(file, text);
+	EXPECT_EQ(5u, file.getRules().size());
+}
+
+TEST_F(ParserTests,
+ReparseFallsBackToFullParse) {
+	std::string text =
+R"(import "cuckoo"
+
+rule abc
+{
+	condition:
+		true
+}
+
+rule def
+{
+	condition:
+		abc
+}
+)";
+	ASSERT_TRUE(driver.parse(std::string_view{text}));
+	auto file = std::move(driver.getParsedFile());
+
+	// Renamed rule might be referenced by the following rules
+	auto changes = replaceInInput(text, "rule def", "rule ghi");
+	EXPECT_EQ(ReparseResult::Full, driver.reparse(file, text, changes));
+	expectSameAsFullParse(file, text);
+
+	// Imports change the whole file
+	changes = replaceInInput(text, "import \"cuckoo\"", "import \"pe\"");
+	EXPECT_EQ(ReparseResult::Full, driver.reparse(file, text, changes));
+	expectSameAsFullParse(file, text);
+	EXPECT_EQ("pe", file.getImports().front()->getName());
+
+	// Reference to the following rule
+	auto previousText = text;
+	changes = replaceInInput(text, "\t\ttrue", "\t\tghi");
+	try
+	{
+		driver.reparse(file, text, changes);
+		FAIL() << "Parser did not throw an exception.";
+	}
+	catch (const ParserError& err)
+	{
+		EXPECT_EQ("Error at 6.3-5: Unrecognized identifier 'ghi' referenced", err.getErrorMessage());
+	}
+	expectSameAsFullParse(file, previousText);
+}
+
+class CountingIncludeCache : public MemoryIncludeCache
+{
+public:
+	virtual std::shared_ptr<const ParsedInclude> find(const std::string& filePath, const ContentHash& contentHash) override
+	{
+		auto include = MemoryIncludeCache::find(filePath, contentHash);
+		if (include)
+			++hits;
+		return include;
+	}
+
+	std::size_t hits = 0;
+};
+
+TEST_F(ParserTests,
+IncludeCacheReusesUnchangedIncludes) {
+	TemporaryDirectory directory;
+	std::ofstream(directory / "nested.yar") << "rule nested { condition: true }\n";
+	std::ofstream(directory / "common.yar") << "import \"pe\"\n\ninclude \"nested.yar\"\n\nrule common {\n\tcondition:\n\t\tpe.number_of_sections > 1 and nested\n}\n";
+	std::ofstream(directory / "first.yar") << "include \"common.yar\"\n\nrule first { condition: common }\n";
+	std::ofstream(directory / "second.yar") << "include \"common.yar\"\nrule second { condition: pe.is_dll() and nested }\n";
+
+	auto cache = std::make_shared<CountingIncludeCache>();
+	driver.setIncludeCache(cache);
+	ASSERT_TRUE(driver.parse((directory / "first.yar").string()));
+	auto first = std::move(driver.getParsedFile());
+	EXPECT_EQ(2u, cache->size());
+	EXPECT_EQ(0u, cache->hits);
+
+	ASSERT_TRUE(driver.parse((directory / "second.yar").string()));
+	auto second = std::move(driver.getParsedFile());
+	EXPECT_EQ(1u, cache->hits);
+	ASSERT_EQ(3u, second.getRules().size());
+	EXPECT_NE(first.getRules()[0], second.getRules()[0]);
+	EXPECT_EQ(first.getRules()[0]->getText(), second.getRules()[0]->getText());
+	EXPECT_EQ(first.getRules()[1]->getText(), second.getRules()[1]->getText());
+	EXPECT_EQ("second", second.getRules()[2]->getName());
+	EXPECT_TRUE(second.hasImports());
+
+	ParserDriver uncachedDriver;
+	ASSERT_TRUE(uncachedDriver.parse((directory / "second.yar").string()));
+	EXPECT_EQ(uncachedDriver.getParsedFile().getTextFormatted(), second.getTextFormatted());
+
+	// Changed nested include invalidates the include of the common file
+	std::ofstream(directory / "nested.yar") << "rule nested { condition: false }\n";
+	ASSERT_TRUE(driver.parse((directory / "second.yar").string()));
+	const auto& changed = driver.getParsedFile();
+	ASSERT_EQ(3u, changed.getRules().size());
+	EXPECT_NE(first.getRules()[0], changed.getRules()[0]);
+	EXPECT_EQ("false", changed.getRules()[0]->getCondition()->getText());
+}
+
+TEST_F(ParserTests,
+IncludeCacheGivesEveryFileItsOwnCopy) {
+	TemporaryDirectory directory;
+	std::ofstream(directory / "common.yar") << R"(import "pe"
+
+rule base { condition: pe.is_dll() }
+
+rule common : tag
+{
+	meta:
+		author = "me"
+	strings:
+		$a = "abc" wide
+		$h = { 01 ?? [2-4] ( 02 | 03 ) }
+		$r = /ab{2}c|d{,3}/i
+	condition:
+		base and $a and #h > 1 and
+		$r
+}
+)";
+	std::ofstream(directory / "main.yar") << "include \"common.yar\"\n\nrule main { condition: common }\n";
+
+	ParserDriver uncachedDriver;
+	ASSERT_TRUE(uncachedDriver.parse((directory / "main.yar").string()));
+	auto expected = uncachedDriver.getParsedFile().getTextFormatted(true);
+
+	auto cache = std::make_shared<CountingIncludeCache>();
+	driver.setIncludeCache(cache);
+	ASSERT_TRUE(driver.parse((directory / "main.yar").string()));
+	auto first = std::move(driver.getParsedFile());
+	ASSERT_TRUE(driver.parse((directory / "main.yar").string()));
+	auto second = std::move(driver.getParsedFile());
+	EXPECT_EQ(1u, cache->hits);
+	EXPECT_EQ(expected, first.getTextFormatted(true));
+	EXPECT_EQ(expected, second.getTextFormatted(true));
+
+	// Condition refers to the copies of the strings and the rules
+	ASSERT_EQ(3u, second.getRules().size());
+	const auto& common = second.getRules()[1];
+	const String* string = common->getStrings()[0];
+	auto condition = common->getCondition()->as<AndExpression>();
+	ASSERT_NE(nullptr, condition);
+	EXPECT_NE(first.getRules()[0]->getSymbol(), second.getRules()[0]->getSymbol());
+	EXPECT_EQ(second.getRules()[0]->getSymbol(), condition->getFirstTokenIt()->getSymbol());
+	auto stringToken = std::find_if(condition->getFirstTokenIt(), condition->getLastTokenIt(), [](const auto& token) { return token.getType() == TokenType::STRING_ID; });
+	EXPECT_EQ(string->getIdentifierTokenIt(), stringToken->getLiteralReference());
+
+	// Modifications of one file don't affect the other one nor the cache
+	second.getRules()[0]->setName("renamed");
+	common->getMetaWithName("author")->setValue(Literal("you"));
+	second.removeRules([](const auto& rule) { return rule->getName() == "main"; });
+	auto modified = second.getTextFormatted(true);
+	EXPECT_NE(std::string::npos, modified.find("rule renamed"));
+	EXPECT_EQ("renamed and $a and #h > 1 and $r", common->getCondition()->getText());
+	EXPECT_EQ("base and $a and #h > 1 and $r", first.getRules()[1]->getCondition()->getText());
+	EXPECT_NE(std::string::npos, modified.find("author = \"you\""));
+	EXPECT_EQ(std::string::npos, modified.find("rule main"));
+	EXPECT_EQ(expected, first.getTextFormatted(true));
+
+	ASSERT_TRUE(driver.parse((directory / "main.yar").string()));
+	EXPECT_EQ(2u, cache->hits);
+	EXPECT_EQ(expected, driver.getParsedFile().getTextFormatted(true));
+	EXPECT_EQ(modified, second.getTextFormatted(true));
+}
+
+TEST_F(ParserTests,
+IncludeCacheHashesContentWithSize) {
+	EXPECT_EQ(ContentHash{}, IncludeCache::hashContent(""));
+
+	auto hash = IncludeCache::hashContent("The quick brown fox jumps over the lazy dog");
+	EXPECT_EQ(43u, hash.size);
+	EXPECT_EQ(0xe34bbc7bbc071b6cULL, hash.low);
+	EXPECT_EQ(0x7a433ca9c49a9347ULL, hash.high);
+
+	EXPECT_EQ(IncludeCache::hashContent("rule abc { condition: true }"), IncludeCache::hashContent("rule abc { condition: true }"));
+	EXPECT_NE(IncludeCache::hashContent("rule abc { condition: true }"), IncludeCache::hashContent("rule abd { condition: true }"));
+	EXPECT_NE(IncludeCache::hashContent("rule abc"), IncludeCache::hashContent("rule abc\n"));
+
+	auto resized = hash;
+	resized.size = 42;
+	EXPECT_NE(hash, resized);
+}
+
+TEST_F(ParserTests,
+IncludeCacheSkipsIncludesDependingOnIncludingFile) {
+	TemporaryDirectory directory;
+	std::ofstream(directory / "guarded.yar") << "rule guarded { condition: true }\n";
+	std::ofstream(directory / "dependent.yar") << "include \"guarded.yar\"\nrule dependent { condition: base }\n";
+	std::ofstream(directory / "main.yar") << "include \"guarded.yar\"\nrule base { condition: true }\ninclude \"dependent.yar\"\n";
+	std::ofstream(directory / "other.yar") << "rule base { condition: false }\ninclude \"dependent.yar\"\n";
+
+	auto cache = std::make_shared<MemoryIncludeCache>();
+	driver.setIncludeCache(cache);
+	ASSERT_TRUE(driver.parse((directory / "main.yar").string(), ParserMode::IncludeGuarded));
+	EXPECT_EQ(1u, cache->size());
+
+	ASSERT_TRUE(driver.parse((directory / "other.yar").string(), ParserMode::IncludeGuarded));
+	const auto& other = driver.getParsedFile();
+	ASSERT_EQ(3u, other.getRules().size());
+	EXPECT_EQ("guarded", other.getRules()[1]->getName());
+	EXPECT_EQ("dependent", other.getRules()[2]->getName());
+	EXPECT_EQ(other.getRules()[0]->getSymbol(), other.getRules()[2]->getCondition()->as<IdExpression>()->getSymbol());
+
+	// Rule of the included file is already defined
+	std::ofstream(directory / "redefined.yar") << "rule guarded { condition: false }\ninclude \"guarded.yar\"\n";
+	try
+	{
+		driver.parse((directory / "redefined.yar").string());
+		FAIL() << "Parser did not throw an exception.";
+	}
+	catch (const ParserError& err)
+	{
+		EXPECT_EQ((directory / "guarded.yar").string() + ":1.6-12: Redefinition of rule 'guarded'", std::string{err.getErrorMessage()}.substr(9));
+	}
+}
+
+TEST_F(ParserTests,
+IncludePrefetchingParsesSameFile) {
+	TemporaryDirectory directory;
+	fs::create_directories(directory / "sub");
+	std::ofstream(directory / "sub" / "nested.yar") << "rule nested { condition: true }\n";
+	std::ofstream(directory / "sub" / "common.yar") << "include \"nested.yar\"\nrule common { condition: nested }\n";
+	std::ofstream(directory / "other.yar") << "// include \"missing.yar\"\nrule other { condition: common }\n";
+	std::ofstream(directory / "main.yar") << "include \"sub/common.yar\"\n/* include \"missing.yar\" */\ninclude \"other.yar\"\n"
+		"include \"sub/nested.yar\"\nrule main { strings: $s = \"include \\\"missing.yar\\\"\" condition: $s and other }\n";
+
+	ParserDriver serialDriver;
+	ASSERT_TRUE(serialDriver.parse((directory / "main.yar").string(), ParserMode::IncludeGuarded));
+
+	driver.setIncludePrefetchThreads(2);
+	ASSERT_TRUE(driver.parse((directory / "main.yar").string(), ParserMode::IncludeGuarded));
+	const auto& prefetched = driver.getParsedFile();
+	ASSERT_EQ(4u, prefetched.getRules().size());
+	EXPECT_EQ("main", prefetched.getRules()[3]->getName());
+	EXPECT_EQ(serialDriver.getParsedFile().getTextFormatted(), prefetched.getTextFormatted());
+
+	std::ofstream(directory / "broken.yar") << "include \"sub/common.yar\"\ninclude \"missing.yar\"\n";
+	EXPECT_THROW(driver.parse((directory / "broken.yar").string()), ParserError);
+}
+
+TEST_F(ParserTests,
+IncludePrefetcherFindsIncludeDirectives) {
+	auto includes = IncludePrefetcher::findIncludes(
+		"include \"a.yar\"\n"
+		"// include \"comment.yar\"\n"
+		"/* include \"block.yar\" */ include\n\t\"b.yar\"\n"
+		"rule include_rule { strings: $s = \"include \\\"string.yar\\\"\" condition: $s }\n"
+		"include \"c.yar\""
+	);
+	EXPECT_EQ((std::vector<std::string>{"a.yar", "b.yar", "c.yar"}), includes);
+}
+
+TEST_F(ParserTests,
+ErrorRecoveryCollectsAllErrors) {
+	prepareInput(
+R"(
+import "pe"
+
+rule good_1 { condition: true }
+
+rule bad_syntax {
+	condition:
+		true and
+}
+
+rule good_2 { condition: good_1 and pe.is_dll() }
+
+rule bad_symbol { condition: bad_syntax }
+
+private rule good_3 {
+	strings:
+		$s = "abc"
+	condition:
+		$s
+}
+
+rule good_1 { condition: false }
+
+rule unfinished { condition: true
+rule good_4 { condition: good_3 and good_2 }
+)");
+
+	driver.setErrorRecovery(true);
+	EXPECT_TRUE(driver.parse(input));
+	const auto& errors = driver.getErrors();
+	ASSERT_EQ(4u, errors.size());
+	EXPECT_EQ(0u, errors[0].getErrorMessage().rfind("Error at 9.1: Syntax error: Unexpected }", 0));
+	EXPECT_EQ(9u, errors[0].getLocation().begin().getLine());
+	EXPECT_EQ("Error at 13.30-39: Unrecognized identifier 'bad_syntax' referenced", errors[1].getErrorMessage());
+	EXPECT_EQ("Error at 22.6-11: Redefinition of rule 'good_1'", errors[2].getErrorMessage());
+	EXPECT_EQ(0u, errors[3].getErrorMessage().rfind("Error at 25.1-4: Syntax error: Unexpected rule", 0));
+	EXPECT_EQ(25u, errors[3].getLocation().begin().getLine());
+
+	const auto& file = driver.getParsedFile();
+	ASSERT_EQ(4u, file.getRules().size());
+	EXPECT_EQ("good_1", file.getRules()[0]->getName());
+	EXPECT_EQ("good_2", file.getRules()[1]->getName());
+	EXPECT_EQ("good_3", file.getRules()[2]->getName());
+	EXPECT_EQ("good_4", file.getRules()[3]->getName());
+	EXPECT_EQ(25u, file.getRules()[3]->getLocation().begin().getLine());
+	EXPECT_TRUE(file.hasImports());
+
+	// Recovered file contains only the valid rules
+	ParserDriver validDriver;
+	auto text = file.getTextFormatted();
+	ASSERT_TRUE(validDriver.parse(std::string_view{text}));
+	EXPECT_EQ(text, validDriver.getParsedFile().getTextFormatted());
+
+	// Without recovery the first error stops the parsing
+	prepareInput(input_text);
+	driver.setErrorRecovery(false);
+	EXPECT_THROW(driver.parse(input), ParserError);
+	EXPECT_TRUE(driver.getErrors().empty());
+}
+
+TEST_F(ParserTests,
+ErrorRecoveryDropsIncludesWithErrors) {
+	TemporaryDirectory directory;
+	std::ofstream(directory / "valid.yar") << "rule included { condition: true }\n";
+	std::ofstream(directory / "invalid.yar") << "rule included_first { condition: true }\nrule included_broken { condition: }\n";
+	std::ofstream(directory / "main.yar") << "include \"valid.yar\"\ninclude \"invalid.yar\"\ninclude \"missing.yar\"\n"
+		"rule main { condition: included and not included_first }\nrule last { condition: included }";
+
+	driver.setErrorRecovery(true);
+	EXPECT_TRUE(driver.parse((directory / "main.yar").string()));
+	const auto& errors = driver.getErrors();
+	ASSERT_EQ(3u, errors.size());
+	EXPECT_EQ((directory / "invalid.yar").string(), errors[0].getLocation().getFilePath());
+	EXPECT_EQ(2u, errors[0].getLocation().begin().getLine());
+	EXPECT_NE(std::string::npos, errors[1].getErrorMessage().find("Unable to include file 'missing.yar'"));
+	EXPECT_NE(std::string::npos, errors[2].getErrorMessage().find("Unrecognized identifier 'included_first' referenced"));
+
+	const auto& file = driver.getParsedFile();
+	ASSERT_EQ(2u, file.getRules().size());
+	EXPECT_EQ("included", file.getRules()[0]->getName());
+	EXPECT_EQ("last", file.getRules()[1]->getName());
+}
+
+TEST_F(ParserTests,
+ErrorRecoveryDropsImportsOfIncludesWithErrors) {
+	TemporaryDirectory directory;
+	std::ofstream(directory / "invalid.yar") << "import \"pe\"\nrule included_broken { condition: }\n";
+	std::ofstream(directory / "main.yar") << "include \"invalid.yar\"\n"
+		"rule main { condition: pe.number_of_sections > 1 }\nrule last { condition: true }\n";
+
+	driver.setErrorRecovery(true);
+	EXPECT_TRUE(driver.parse((directory / "main.yar").string()));
+	const auto& errors = driver.getErrors();
+	ASSERT_EQ(2u, errors.size());
+	EXPECT_EQ((directory / "invalid.yar").string(), errors[0].getLocation().getFilePath());
+	EXPECT_NE(std::string::npos, errors[1].getErrorMessage().find("Unrecognized identifier 'pe' referenced"));
+
+	const auto& file = driver.getParsedFile();
+	EXPECT_FALSE(file.hasImports());
+	ASSERT_EQ(1u, file.getRules().size());
+	EXPECT_EQ("last", file.getRules()[0]->getName());
+	EXPECT_EQ("rule last\n{\n\tcondition:\n\t\ttrue\n}\n", file.getTextFormatted(true));
+}
+
+TEST_F(ParserTests,
+ErrorRecoveryIncludesGuardedFileAgainAfterError) {
+	TemporaryDirectory directory;
+	std::ofstream(directory / "guarded.yar") << "rule guarded { condition: true }\n";
+	std::ofstream(directory / "invalid.yar") << "include \"guarded.yar\"\nrule included_broken { condition: }\n";
+	std::ofstream(directory / "main.yar") << "include \"invalid.yar\"\ninclude \"guarded.yar\"\nrule main { condition: guarded }\n";
+
+	driver.setErrorRecovery(true);
+	EXPECT_TRUE(driver.parse((directory / "main.yar").string(), ParserMode::IncludeGuarded));
+	const auto& errors = driver.getErrors();
+	ASSERT_EQ(1u, errors.size());
+	EXPECT_EQ((directory / "invalid.yar").string(), errors[0].getLocation().getFilePath());
+
+	const auto& file = driver.getParsedFile();
+	ASSERT_EQ(2u, file.getRules().size());
+	EXPECT_EQ("guarded", file.getRules()[0]->getName());
+	EXPECT_EQ("main", file.getRules()[1]->getName());
+}
+
+TEST_F(ParserTests,
+ProfilingMeasuresPhasesOfParsing) {
+	TemporaryDirectory directory;
+	std::ofstream(directory / "included.yar") << "rule included { condition: true }\n";
+	std::ofstream(directory / "main.yar") << "import \"pe\"\ninclude \"included.yar\"\nrule main { condition: included and pe.number_of_sections > 1 }\n";
+	auto filePath = (directory / "main.yar").string();
+
+	ASSERT_TRUE(driver.parse(filePath));
+	EXPECT_EQ(0u, driver.getProfile().getTokens());
+	EXPECT_EQ(0, driver.getProfile().getTotalTime().count());
+
+	driver.setProfiling(true);
+	ASSERT_TRUE(driver.parse(filePath));
+	const auto& profile = driver.getProfile();
+	EXPECT_GT(profile.getTokens(), 0u);
+	EXPECT_GT(profile.getReductions(), 0u);
+	EXPECT_GE(profile.getSymbolLookups(), 2u);
+	EXPECT_EQ(1u, profile.getImports());
+	EXPECT_EQ(1u, profile.getIncludedFiles());
+	EXPECT_EQ(fs::file_size(directory / "main.yar") + fs::file_size(directory / "included.yar"), profile.getBytesRead());
+
+	std::int64_t phasesTime = 0;
+	for (auto phase : {ParserPhase::Parsing, ParserPhase::Tokenizing, ParserPhase::Actions, ParserPhase::SymbolLookup,
+			ParserPhase::ModuleLoading, ParserPhase::IncludeLoading, ParserPhase::FileConstruction})
+	{
+		EXPECT_GT(profile.getTime(phase).count(), 0) << "Phase " << static_cast<int>(phase) << " was not measured";
+		phasesTime += profile.getTime(phase).count();
+	}
+	EXPECT_EQ(phasesTime, profile.getTotalTime().count());
+
+	driver.setProfiling(false);
+	ASSERT_TRUE(driver.parse(filePath));
+	EXPECT_EQ(0u, driver.getProfile().getTokens());
+}
+
+TEST_F(ParserTests,
+ProfilingDoesNotCountRuleCallbackAsFileConstruction) {
+	auto callbackTime = std::chrono::milliseconds(50);
+	driver.setProfiling(true);
+	ASSERT_TRUE(driver.parse(std::string_view{"rule abc { condition: true }"}, [&](std::unique_ptr<Rule>&&, const YaraFile&) {
+		std::this_thread::sleep_for(callbackTime);
+	}));
+
+	const auto& profile = driver.getProfile();
+	EXPECT_GE(profile.getTotalTime(), callbackTime);
+	EXPECT_LT(profile.getTime(ParserPhase::FileConstruction), callbackTime);
+}
+
+TEST_F(ParserTests,
+ArenaAllocationOfExpressions) {
+	prepareInput(
+R"(import "pe"
+
+rule abc
+{
+	condition:
+		pe.number_of_sections > 1 and (filesize < 100KB or pe.is_dll())
+}
+
+rule def
+{
+	condition:
+		abc and for any i in (1 .. 3) : ( i == 2 )
+}
+)");
+	std::string input_text = input.str();
+
+	ASSERT_TRUE(driver.parse(input));
+	EXPECT_EQ(nullptr, driver.getParsedFile().getExpressionArena());
+
+	auto arenaDriver = std::make_unique<ParserDriver>();
+	arenaDriver->setArenaAllocation(true);
+	ASSERT_TRUE(arenaDriver->parse(std::string_view{input_text}));
+	const auto& arena = arenaDriver->getParsedFile().getExpressionArena();
+	ASSERT_NE(nullptr, arena);
+	EXPECT_GT(arena->getObjectsCount(), 10u);
+	EXPECT_GE(arena->getAllocatedBytes(), arena->getUsedBytes());
+	EXPECT_EQ(driver.getParsedFile().getTextFormatted(), arenaDriver->getParsedFile().getTextFormatted());
+
+	// Expressions keep the arena alive after the parsed file is gone
+	auto condition = arenaDriver->getParsedFile().getRules()[0]->getCondition();
+	arenaDriver.reset();
+	EXPECT_EQ("pe.number_of_sections > 1 and (filesize < 100KB or pe.is_dll())", condition->getText());
+	ASSERT_NE(nullptr, condition->as<AndExpression>());
+
+	std::vector<Expression::Ptr> conditions;
+	ParserDriver streamingDriver;
+	streamingDriver.setArenaAllocation(true);
+	ASSERT_TRUE(streamingDriver.parse(std::string_view{input_text}, [&](std::unique_ptr<Rule>&& rule, const YaraFile&) {
+		conditions.push_back(rule->getCondition());
+	}));
+	ASSERT_EQ(2u, conditions.size());
+	EXPECT_EQ("abc and for any i in (1 .. 3) : ( i == 2 )", conditions[1]->getText());
+}
+
+TEST_F(ParserTests,
+ArenaAllocatesOperationsOfChainsCreatedOnDemand) {
+	driver.setArenaAllocation(true);
+	prepareInput("rule abc { condition: filesize == 1 or filesize == 2 or filesize == 3 or filesize == 4 }");
+	ASSERT_TRUE(driver.parse(input));
+	const auto& arena = driver.getParsedFile().getExpressionArena();
+	ASSERT_NE(nullptr, arena);
+	auto condition = driver.getParsedFile().getRules()[0]->getCondition()->as<OrExpression>();
+	ASSERT_NE(nullptr, condition->getChain());
+	EXPECT_EQ(arena, condition->getChain()->getArena());
+
+	auto objects = arena->getObjectsCount();
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 4; ++i)
+		threads.emplace_back([condition]() { condition->getLeftOperand()->as<OrExpression>()->getLeftOperand(); });
+	for (auto& thread : threads)
+		thread.join();
+	EXPECT_EQ(objects + 2, arena->getObjectsCount());
+	EXPECT_EQ("filesize == 1 or filesize == 2", condition->getLeftOperand()->as<OrExpression>()->getLeftOperand()->getText());
+}
+
+TEST_F(ParserTests,
+ArenaOutlivesBatchesOfReferences) {
+	auto arena = ExpressionArena::create();
+	std::vector<Expression::Ptr> expressions;
+	for (std::size_t i = 0; i < 2 * ExpressionArena::ReferenceBatch + 1; ++i)
+		expressions.push_back(arena->make<BoolLiteralExpression>(i % 2 == 0));
+	arena.reset();
+
+	expressions.erase(expressions.begin(), expressions.begin() + ExpressionArena::ReferenceBatch);
+	EXPECT_EQ("true", expressions.back()->getText());
+	expressions.clear();
+}
+
+TEST_F(ParserTests,
+ExpressionKindsDetermineCasts) {
+	prepareInput(
+R"(import "pe"
+
+rule abc
+{
+	condition:
+		pe.number_of_sections > 1 and (filesize < 100KB or not pe.is_dll()) and true
+}
+)");
+
+	ASSERT_TRUE(driver.parse(input));
+	auto condition = driver.getParsedFile().getRules()[0]->getCondition();
+	EXPECT_EQ(ExpressionKind::And, condition->getKind());
+	EXPECT_TRUE(condition->is<BinaryOpExpression>());
+	EXPECT_FALSE(condition->is<UnaryOpExpression>());
+	EXPECT_EQ(nullptr, condition->as<OrExpression>());
+
+	auto left = condition->as<AndExpression>()->getLeftOperand()->as<AndExpression>();
+	ASSERT_NE(nullptr, left);
+	auto gt = left->getLeftOperand()->as<GtExpression>();
+	ASSERT_NE(nullptr, gt);
+	EXPECT_EQ(ExpressionKind::StructAccess, gt->getLeftOperand()->getKind());
+	EXPECT_NE(nullptr, gt->getLeftOperand()->as<IdExpression>());
+	EXPECT_EQ(nullptr, gt->getLeftOperand()->as<FunctionCallExpression>());
+	EXPECT_NE(nullptr, gt->getRightOperand()->as<LiteralExpression<std::uint64_t>>());
+	EXPECT_EQ(nullptr, gt->getRightOperand()->as<LiteralExpression<double>>());
+
+	auto parentheses = left->getRightOperand()->as<ParenthesesExpression>();
+	ASSERT_NE(nullptr, parentheses);
+	auto disjunction = parentheses->getEnclosedExpression()->as<OrExpression>();
+	ASSERT_NE(nullptr, disjunction);
+	EXPECT_TRUE(disjunction->getLeftOperand()->as<LtExpression>()->getLeftOperand()->is<KeywordExpression>());
+	EXPECT_EQ(ExpressionKind::Not, disjunction->getRightOperand()->getKind());
+	EXPECT_TRUE(disjunction->getRightOperand()->as<UnaryOpExpression>()->getOperand()->is<FunctionCallExpression>());
+	EXPECT_EQ(ExpressionKind::BoolLiteral, condition->as<AndExpression>()->getRightOperand()->getKind());
+
+	// Expressions defined outside of yaramod are recognized by RTTI
+	class CustomExpression : public BoolLiteralExpression
+	{
+	public:
+		CustomExpression() : BoolLiteralExpression(true) {}
+	};
+	Expression::Ptr custom = std::make_shared<CustomExpression>();
+	EXPECT_EQ(ExpressionKind::BoolLiteral, custom->getKind());
+	EXPECT_NE(nullptr, custom->as<CustomExpression>());
+	EXPECT_NE(nullptr, custom->as<LiteralExpression<bool>>());
+	EXPECT_FALSE(custom->is<StringLiteralExpression>());
+}
+
+TEST_F(ParserTests,
+DeepChainsOfBinaryOperationsAreProcessedIteratively) {
+	class EqCounter : public StaticObservingVisitor<EqCounter>
+	{
+	public:
+		using StaticObservingVisitor<EqCounter>::visit;
+
+		bool visit(EqExpression* expr)
+		{
+			++count;
+			return StaticObservingVisitor<EqCounter>::visit(expr);
+		}
+
+		std::size_t count = 0;
+	};
+
+	const std::size_t terms = 100000;
+	std::string condition = "filesize == 0";
+	for (std::size_t i = 1; i < terms; ++i)
+		condition += (i % 1000 == 0 ? " and filesize == " : " or filesize == ") + std::to_string(i);
+
+	prepareInput("rule abc { condition: " + condition + " }");
+	ASSERT_TRUE(driver.parse(input));
+	auto expr = driver.getParsedFile().getRules()[0]->getCondition();
+
+	EXPECT_EQ(condition, expr->getText());
+	EXPECT_EQ("filesize", expr->getFirstTokenIt()->getString());
+	EXPECT_EQ(terms - 1, expr->getLastTokenIt()->getUInt());
+
+	auto cloned = expr->clone(std::make_shared<TokenStream>());
+	EXPECT_EQ(condition, cloned->getText());
+	EXPECT_EQ(4 * terms - 1, cloned->getTokenStream()->size());
+	EXPECT_EQ(ExpressionKind::Or, cloned->getKind());
+
+	EqCounter counter;
+	EXPECT_TRUE(counter.observe(cloned));
+	EXPECT_EQ(terms, counter.count);
+
+	cloned.reset();
+	expr.reset();
+}
+
+TEST_F(ParserTests,
+ChainsOfLogicalOperationsAreFlat) {
+	prepareInput(R"(
+rule abc {
+	condition:
+		filesize == 1 or filesize == 2 or (entrypoint == 3 and entrypoint == 4 and entrypoint == 5) or filesize == 6
+}
+)");
+	ASSERT_TRUE(driver.parse(input));
+	auto expr = driver.getParsedFile().getRules()[0]->getCondition();
+	auto orExpr = expr->as<OrExpression>();
+	ASSERT_NE(nullptr, orExpr);
+	ASSERT_NE(nullptr, orExpr->getChain());
+	EXPECT_EQ(4u, orExpr->getChainOperandsCount());
+	EXPECT_EQ("filesize == 1 or filesize == 2 or (entrypoint == 3 and entrypoint == 4 and entrypoint == 5) or filesize == 6", expr->getText());
+	EXPECT_EQ("filesize", expr->getFirstTokenIt()->getString());
+
+	auto operands = orExpr->getOperands();
+	ASSERT_EQ(4u, operands.size());
+	auto andExpr = operands[2]->as<ParenthesesExpression>()->getEnclosedExpression()->as<AndExpression>();
+	ASSERT_NE(nullptr, andExpr);
+	ASSERT_NE(nullptr, andExpr->getChain());
+	EXPECT_EQ(3u, andExpr->getChainOperandsCount());
+
+	auto cloned = expr->clone(std::make_shared<TokenStream>());
+	EXPECT_EQ(expr->getText(), cloned->getText());
+	EXPECT_NE(nullptr, cloned->as<OrExpression>()->getChain());
+
+	auto left = orExpr->getLeftOperand()->as<OrExpression>();
+	ASSERT_NE(nullptr, left);
+	EXPECT_EQ(nullptr, orExpr->getChain());
+	EXPECT_EQ(left, orExpr->getLeftOperand().get());
+	EXPECT_EQ("filesize == 1 or filesize == 2 or (entrypoint == 3 and entrypoint == 4 and entrypoint == 5)", left->getText());
+	EXPECT_EQ("filesize == 6", orExpr->getRightOperand()->getText());
+	EXPECT_EQ(Expression::Type::Bool, left->getType());
+	EXPECT_NE(0u, left->getUid());
+	EXPECT_LT(left->getUid(), expr->getUid());
+	EXPECT_EQ("filesize == 1", left->getLeftOperand()->as<OrExpression>()->getLeftOperand()->getText());
+	EXPECT_EQ(4u, orExpr->getOperands().size());
+	EXPECT_EQ(expr->getText(), cloned->getText());
+
+	left->setRightOperand(orExpr->getRightOperand());
+	EXPECT_EQ("filesize == 1 or filesize == 2 or filesize == 6 or filesize == 6", expr->getText());
+	EXPECT_EQ(operands[3], orExpr->getOperands()[2]);
+}
+
+class TaggedAndExpression : public AndExpression
+{
+public:
+	using AndExpression::AndExpression;
+
+	virtual std::string getText(const std::string& indent = std::string{}) const override
+	{
+		return "tagged(" + AndExpression::getText(indent) + ")";
+	}
+
+	virtual Expression::Ptr clone(const std::shared_ptr<TokenStream>& target) const override
+	{
+		++clones;
+		auto cloned = AndExpression::clone(target);
+		auto andExpr = cloned->as<AndExpression>();
+		return std::make_shared<TaggedAndExpression>(target, andExpr->getLeftOperand(), andExpr->getOperator(), andExpr->getRightOperand());
+	}
+
+	static inline std::size_t clones = 0;
+};
+
+TEST_F(ParserTests,
+DerivedBinaryOperationsKeepTheirOverrides) {
+	prepareInput("rule abc { condition: filesize == 1 or filesize == 2 and filesize == 3 }");
+	ASSERT_TRUE(driver.parse(input));
+	auto expr = driver.getParsedFile().getRules()[0]->getCondition();
+	auto orExpr = expr->as<OrExpression>();
+	ASSERT_NE(nullptr, orExpr);
+	auto andExpr = orExpr->getRightOperand()->as<AndExpression>();
+	ASSERT_NE(nullptr, andExpr);
+
+	auto tagged = std::make_shared<TaggedAndExpression>(expr->getTokenStreamSharedPtr(), andExpr->getLeftOperand(), andExpr->getOperator(), andExpr->getRightOperand());
+	orExpr->setRightOperand(tagged);
+	EXPECT_EQ("filesize == 1 or tagged(filesize == 2 and filesize == 3)", expr->getText());
+
+	TaggedAndExpression::clones = 0;
+	auto cloned = expr->clone(std::make_shared<TokenStream>());
+	EXPECT_EQ(1u, TaggedAndExpression::clones);
+	EXPECT_EQ("filesize == 1 or tagged(filesize == 2 and filesize == 3)", cloned->getText());
+	EXPECT_NE(nullptr, std::dynamic_pointer_cast<TaggedAndExpression>(cloned->as<OrExpression>()->getRightOperand()));
+
+	// Derived operation isn't merged into the chain of the operation which continues it
+	EXPECT_EQ(nullptr, BinaryOpExpression::continueChain(tagged, ExpressionKind::And));
+}
+
+TEST_F(ParserTests,
+TokenizerScannerMatchesRegularExpressions) {
+	const std::vector<std::string> fragments = {
+		"and", "or", "rule", "condition", "strings", "meta", "uint16be", "int8", "base64wide", "0x1F", "0o17", "10KB",
+		"3.14", "/*", "*/", "//", "\\x4a", "\\\\", "\\\"", "[^", "[]", "{2,3}", "{ 2 , }", "$a*", "#a", "..", ">=", "\r\n",
+		"a", "Z", "_", "7", " ", "\t", "\n", "\v", "!", "\"", "$", "(", "*", "-", ".", "/", "?", "[", "\\", "]", "{", "|", "}", "\xc3\xa9"
+	};
+
+	std::mt19937 random(1);
+	const auto* tokenizer = driver.getParserDefinition()->get_tokenizer_definition();
+	for (const auto& [name, state] : tokenizer->get_states())
+	{
+		ASSERT_NE(nullptr, state.scanner) << "State " << name << " is not supported by scanner";
+		for (int i = 0; i < 2000; ++i)
+		{
+			std::string input;
+			for (auto count = random() % 5; count > 0; --count)
+				input += fragments[random() % fragments.size()];
+
+			re2::StringPiece piece{input.data(), input.size()};
+			auto scanned = state.match(piece);
+			auto matched = state.match_with_regexps(piece);
+			ASSERT_EQ(matched.has_value(), scanned.has_value()) << "State " << name << ", input '" << input << "'";
+			if (matched)
+			{
+				EXPECT_EQ(matched.value().token, scanned.value().token) << "State " << name << ", input '" << input << "'";
+				EXPECT_EQ(matched.value().length, scanned.value().length) << "State " << name << ", input '" << input << "'";
+			}
+		}
+	}
+}
+
+TEST_F(ParserTests,
+TokenizerScannerRejectsUnsupportedPatterns) {
+	EXPECT_NE(nullptr, pog::Scanner::build({"[a-z_][a-z0-9_]*", "\\\\x[0-9a-f]{2}", "(?:ab|c)+", "{[0-9]+}", "$"}));
+	EXPECT_EQ(nullptr, pog::Scanner::build({"abc", "^abc"}));
+	EXPECT_EQ(nullptr, pog::Scanner::build({"abc", "a+?"}));
+	EXPECT_EQ(nullptr, pog::Scanner::build({"abc", "\\bword"}));
+	EXPECT_EQ(nullptr, pog::Scanner::build({"abc", "[[:alpha:]]"}));
+
+	auto scanner = pog::Scanner::build({"a", "[a-z]+", "[^\"]+", "$"});
+	ASSERT_NE(nullptr, scanner);
+	auto result = scanner->match("abc\"");
+	EXPECT_EQ(pog::ScanResult::Status::Matched, result.status);
+	EXPECT_EQ(1u, result.pattern);
+	EXPECT_EQ(3u, result.length);
+	result = scanner->match("a\"");
+	EXPECT_EQ(0u, result.pattern);
+	EXPECT_EQ(1u, result.length);
+	result = scanner->match("");
+	EXPECT_EQ(pog::ScanResult::Status::Matched, result.status);
+	EXPECT_EQ(3u, result.pattern);
+	EXPECT_EQ(pog::ScanResult::Status::NoMatch, scanner->match("\"").status);
+	EXPECT_EQ(pog::ScanResult::Status::Fallback, scanner->match("ab\xc3\xa9").status);
+}
+
+TEST_F(ParserTests,
+TokenizerScannerTakesLongestMatchOfPattern) {
+	auto scanner = pog::Scanner::build({"a|ab"});
+	ASSERT_NE(nullptr, scanner);
+	auto result = scanner->match("ab");
+	EXPECT_EQ(pog::ScanResult::Status::Matched, result.status);
+	EXPECT_EQ(2u, result.length);
+
+	// RE2 takes the leftmost-first match instead
+	re2::RE2 regexp("a|ab");
+	re2::StringPiece input{"ab"}, submatch;
+	ASSERT_TRUE(regexp.Match(input, 0, input.size(), re2::RE2::Anchor::ANCHOR_START, &submatch, 1));
+	EXPECT_EQ(1u, submatch.size());
+}
+
+TEST_F(ParserTests,
+ParsingTableIsCachedForFeatures) {
+	auto cachedTable = ParsingTableCache::instance().find(Features::AllCurrent);
+	ASSERT_TRUE(cachedTable.has_value());
+	EXPECT_EQ("POGT", cachedTable.value().substr(0, 4));
+
+	ParserDriver anotherDriver(Features::AllCurrent);
+	EXPECT_EQ(cachedTable, ParsingTableCache::instance().find(Features::AllCurrent));
+}
+
+TEST_F(ParserTests,
+InvalidCachedParsingTableIsRecomputed) {
+	auto validTable = ParsingTableCache::instance().find(Features::Avast);
+	ParsingTableCache::instance().store(Features::Avast, "POGT invalid table");
+	ParserDriver::clearSharedParserDefinitions();
+
+	prepareInput(
+R"(
+rule abc
+{
+	condition:
+		true and not false
+}
+)");
+
+	ParserDriver avastDriver(Features::Avast);
+	EXPECT_TRUE(avastDriver.parse(input));
+	ASSERT_EQ(1u, avastDriver.getParsedFile().getRules().size());
+	EXPECT_EQ("true and not false", avastDriver.getParsedFile().getRules()[0]->getCondition()->getText());
+
+	auto recomputedTable = ParsingTableCache::instance().find(Features::Avast);
+	ASSERT_TRUE(recomputedTable.has_value());
+	EXPECT_NE("POGT invalid table", recomputedTable.value());
+	if (validTable)
+	{
+		EXPECT_EQ(validTable, recomputedTable);
+	}
+}
+
+TEST_F(ParserTests,
+CachedParsingTableWithCorruptedStatesCountIsRecomputed) {
+	auto validTable = ParsingTableCache::instance().find(Features::Avast);
+	if (!validTable)
+	{
+		ParserDriver avastDriver(Features::Avast);
+		validTable = ParsingTableCache::instance().find(Features::Avast);
+	}
+	ASSERT_TRUE(validTable.has_value());
+
+	// Number of states follows the magic, the version and the 64-bit grammar fingerprint
+	auto corruptedTable = validTable.value();
+	corruptedTable.replace(16, 4, "\xFF\xFF\xFF\xFF");
+	ParsingTableCache::instance().store(Features::Avast, corruptedTable);
+	ParserDriver::clearSharedParserDefinitions();
+
+	prepareInput(
+R"(
+rule abc
+{
+	condition:
+		true
+}
+)");
+
+	ParserDriver avastDriver(Features::Avast);
+	EXPECT_TRUE(avastDriver.parse(input));
+	EXPECT_EQ(validTable, ParsingTableCache::instance().find(Features::Avast));
+}
+
+TEST_F(ParserTests,
+ParserDefinitionIsSharedBetweenDrivers) {
+	ParserDriver anotherDriver(Features::AllCurrent);
+	ParserDriver avastDriver(Features::Avast);
+	ASSERT_NE(nullptr, driver.getParserDefinition());
+	EXPECT_EQ(driver.getParserDefinition(), anotherDriver.getParserDefinition());
+	EXPECT_NE(driver.getParserDefinition(), avastDriver.getParserDefinition());
+
+	prepareInput(
+R"(
+rule abc
+{
+	condition:
+		filesize > 10
+}
+)");
+
+	std::istringstream anotherInput(input_text);
+	EXPECT_TRUE(anotherDriver.parse(anotherInput));
+	EXPECT_TRUE(driver.parse(input));
+	ASSERT_EQ(1u, driver.getParsedFile().getRules().size());
+	ASSERT_EQ(1u, anotherDriver.getParsedFile().getRules().size());
+	EXPECT_EQ(input_text, driver.getParsedFile().getTextFormatted());
+	EXPECT_EQ(input_text, anotherDriver.getParsedFile().getTextFormatted());
+}
+
+TEST_F(ParserTests,
+DriversWithSharedParserDefinitionParseConcurrently) {
+	const std::string inputText = R"(
+import "pe"
+
+rule abc
+{
+	strings:
+		$s = "abc" wide
+		$h = { 01 02 ?? [2-4] 03 }
+		$r = /ab+c/i
+	condition:
+		pe.number_of_sections > 2 and
+		all of them
+}
+)";
+
+	std::vector<std::string> results(8);
+	std::vector<std::thread> threads;
+	for (std::size_t i = 0; i < results.size(); ++i)
+	{
+		threads.emplace_back([&, i]() {
+			ParserDriver threadDriver(Features::AllCurrent);
+			for (int j = 0; j < 10; ++j)
+			{
+				std::istringstream threadInput(inputText);
+				if (!threadDriver.parse(threadInput))
+					return;
+			}
+			results[i] = threadDriver.getParsedFile().getTextFormatted();
+		});
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	for (const auto& result : results)
+		EXPECT_EQ(inputText, result);
+}
+
+TEST_F(ParserTests,
+LazyModulePoolProvidesSameModulesAsEagerOne) {
+	ModulePool eagerPool(Features::AllCurrent, "");
+	ModulePool lazyPool(Features::AllCurrent, "", true);
+
+	auto pe = lazyPool.load("pe");
+	ASSERT_NE(nullptr, pe);
+	EXPECT_TRUE(pe->isInitialized());
+	EXPECT_TRUE(pe->getStructure()->getAttribute("number_of_sections"));
+	EXPECT_EQ(nullptr, lazyPool.load("unknown"));
+
+	auto eagerModules = eagerPool.getModules();
+	EXPECT_FALSE(eagerModules.empty());
+	for (const auto& [name, eagerModule] : eagerModules)
+	{
+		auto lazyModule = lazyPool.load(name);
+		ASSERT_NE(nullptr, lazyModule);
+		EXPECT_TRUE(eagerModule->isInitialized());
+		EXPECT_EQ(eagerModule->getStructure()->getAttributes().size(), lazyModule->getStructure()->getAttributes().size());
+	}
+}
+
+TEST_F(ParserTests,
+LazyModulePoolSkipsDeprecatedModuleContent) {
+	ModulePool currentPool(Features::AllCurrent, "", true);
+	ModulePool everythingPool(Features::Everything, "", true);
+
+	EXPECT_FALSE(currentPool.load("cuckoo")->getStructure()->getAttribute("signature"));
+	EXPECT_TRUE(everythingPool.load("cuckoo")->getStructure()->getAttribute("signature"));
+	EXPECT_TRUE(everythingPool.load("cuckoo")->getStructure()->getAttribute("network"));
+}
+
+TEST_F(ParserTests,
+LazyModulePoolReportsInvalidModuleFromDirectoryRightAway) {
+	TemporaryDirectory directory;
+	std::ofstream(directory / "broken.json") << R"({"kind": "struct", "name": "broken", "attributes": [{"kind": "unknown", "name": "attr"}]})";
+
+	EXPECT_THROW(ModulePool(Features::AllCurrent, directory.string()), ModuleError);
+	EXPECT_THROW(ModulePool(Features::AllCurrent, directory.string(), true), ModuleError);
+}
+
+TEST_F(ParserTests,
+SharedModulePoolIsReusedForSameFeaturesAndDirectory) {
+	auto pool = ModulePool::getShared(Features::AllCurrent, "");
+	EXPECT_EQ(pool, ModulePool::getShared(Features::AllCurrent, ""));
+	EXPECT_NE(pool, ModulePool::getShared(Features::Everything, ""));
+
+	ParserDriver first(Features::AllCurrent);
+	ParserDriver second(Features::AllCurrent);
+	EXPECT_EQ(pool, first.getModulePool());
+	EXPECT_EQ(pool, second.getModulePool());
+	static_assert(std::is_same_v<std::shared_ptr<const ModulePool>, decltype(first.getModulePool())>, "Shared pool must not be modifiable through the driver");
+	static_assert(std::is_same_v<std::shared_ptr<const ModulePool>, decltype(ModulePool::getShared(Features::AllCurrent, ""))>, "Shared pool must not be modifiable by anyone");
+	EXPECT_EQ(pool->load("pe")->getStructure(), first.getModulePool()->load("pe")->getStructure());
+
+	ModulePool::clearShared();
+	EXPECT_NE(pool, ModulePool::getShared(Features::AllCurrent, ""));
+}
+
+TEST_F(ParserTests,
+SharedModulePoolLoadsModulesConcurrently) {
+	ModulePool::clearShared();
+	auto pool = ModulePool::getShared(Features::AllCurrent, "");
+
+	std::vector<std::shared_ptr<Module>> loaded(8);
+	std::vector<std::thread> threads;
+	for (std::size_t i = 0; i < loaded.size(); ++i)
+		threads.emplace_back([&, i]() { loaded[i] = pool->load(i % 2 ? "pe" : "vt"); });
+	for (auto& thread : threads)
+		thread.join();
+
+	for (std::size_t i = 0; i < loaded.size(); ++i)
+	{
+		ASSERT_NE(nullptr, loaded[i]);
+		EXPECT_TRUE(loaded[i]->isInitialized());
+		EXPECT_EQ(loaded[i % 2]->getStructure(), loaded[i]->getStructure());
+	}
+}
+
+TEST_F(ParserTests,
+ModulePoolOverlayDoesNotModifySharedModules) {
+	auto shared = ModulePool::getShared(Features::AllCurrent, "");
+	auto overlay = std::make_shared<ModulePool>(*shared);
+	overlay->addJson("math", nlohmann::json::parse(R"({
+		"kind": "struct",
+		"name": "math",
+		"attributes": [
+			{ "kind": "value", "name": "overlay_value", "documentation": "", "type": "i" }
+		]
+	})"));
+
+	EXPECT_TRUE(overlay->load("math")->getStructure()->getAttribute("overlay_value"));
+	EXPECT_TRUE(overlay->load("math")->getStructure()->getAttribute("MEAN_BYTES"));
+	EXPECT_FALSE(shared->load("math")->getStructure()->getAttribute("overlay_value"));
+	EXPECT_EQ(shared->load("pe"), overlay->load("pe"));
+
+	prepareInput(
+R"(import "math"
+
+rule abc
+{
+	condition:
+		math.overlay_value
+}
+)"
+);
+	ParserDriver overlayDriver(Features::AllCurrent, overlay);
+	EXPECT_TRUE(overlayDriver.parse(input));
+	EXPECT_EQ(input_text, overlayDriver.getParsedFile().getTextFormatted());
+
+	prepareInput(
+R"(import "math"
+
+rule abc
+{
+	condition:
+		math.overlay_value
+}
+)"
+);
+	ParserDriver sharedDriver(Features::AllCurrent);
+	EXPECT_THROW(sharedDriver.parse(input), ParserError);
+}
+
+TEST_F(ParserTests,
+IncompleteModeDoesNotModifySharedModules) {
+	prepareInput(
+R"(import "pe"
+
+rule abc
+{
+	condition:
+		pe.unknown_attribute
+}
+)"
+);
+	ParserDriver incompleteDriver(Features::AllCurrent);
+	EXPECT_TRUE(incompleteDriver.parse(input, ParserMode::Incomplete));
+	EXPECT_FALSE(incompleteDriver.getModulePool()->load("pe")->getStructure()->getAttribute("unknown_attribute"));
+}
+
+TEST_F(ParserTests,
+AutoformattingWritesTextToStreamAndString) {
+	prepareInput(
+R"(import "cuckoo" // cuckoo
+import "pe" // pe
+
+rule rule1 {
+	strings:
+		$h0 = { A1 00 01 00 00 01 E1 10 } // comment 0
+		$h1 = { B2 00 00 66 E2 02 } // comment 1
+	condition: // this condition is crucial
+		cuckoo.network.http_request(/[\w]/) or // Hello
+			pe.is_dll() // other side!
+}
+)");
+	EXPECT_TRUE(driver.parse(input));
+
+	std::string expected =
+R"(import "cuckoo" // cuckoo
+import "pe"     // pe
+
+rule rule1
+{
+	strings:
+		$h0 = { A1 00 01 00 00 01 E1 10 }      // comment 0
+		$h1 = { B2 00 00 66 E2 02 }            // comment 1
+	condition:                                     // this condition is crucial
+		cuckoo.network.http_request(/[\w]/) or // Hello
+		pe.is_dll()                            // other side!
+}
+)";
+
+	const auto& yaraFile = driver.getParsedFile();
+	std::ostringstream stream;
+	yaraFile.writeTextFormatted(stream);
+	std::string text = "prefix\n";
+	yaraFile.writeTextFormatted(text);
+
+	EXPECT_EQ(expected, yaraFile.getTextFormatted());
+	EXPECT_EQ(expected, stream.str());
+	EXPECT_EQ("prefix\n" + expected, text);
+}
+
 }
 }
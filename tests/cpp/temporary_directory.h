@@ -0,0 +1,56 @@
+/**
+* @file tests/cpp/temporary_directory.h
+* @brief Temporary directory for the tests working with files.
+* @copyright (c) 2026 Avast Software, licensed under the MIT license
+*/
+
+#pragma once
+
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "yaramod/utils/filesystem.h"
+
+namespace yaramod {
+namespace tests {
+
+/**
+ * Directory with a unique name in the temporary directory of the system. It is removed together
+ * with its content once the object goes out of scope, even when the test fails, and tests running
+ * in parallel never share it.
+ */
+class TemporaryDirectory
+{
+public:
+	TemporaryDirectory()
+	{
+		std::random_device random;
+		do
+		{
+			std::ostringstream name;
+			name << "yaramod_test_" << std::hex << random() << random();
+			_path = fs::temp_directory_path() / name.str();
+		} while (!fs::create_directory(_path));
+	}
+
+	~TemporaryDirectory()
+	{
+		std::error_code ec;
+		fs::remove_all(_path, ec);
+	}
+
+	TemporaryDirectory(const TemporaryDirectory&) = delete;
+	TemporaryDirectory& operator=(const TemporaryDirectory&) = delete;
+
+	const fs::path& getPath() const { return _path; }
+	std::string string() const { return _path.string(); }
+
+	fs::path operator/(const fs::path& name) const { return _path / name; }
+
+private:
+	fs::path _path;
+};
+
+} // namespace tests
+} // namespace yaramod
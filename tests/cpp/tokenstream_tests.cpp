@@ -6,6 +6,7 @@
 
 #include <gtest/gtest.h>
 #include <iostream>
+#include <thread>
 
 #include "yaramod/types/token_stream.h"
 #include "yaramod/types/meta.h"
@@ -356,5 +357,37 @@ TokenStreamSwapTokensWithinTheSameTokenStreamDistinctTouching2) {
 	ASSERT_TRUE(ts.empty());
 }
 
+TEST_F(TokenStreamTests,
+TokenIteratorsStayValidWhenMovedBetweenStreams) {
+	TokenStream ts1;
+	TokenIt a = ts1.emplace_back(TokenType::META_KEY, "a");
+	TokenIt b = ts1.emplace_back(TokenType::META_KEY, "b");
+
+	// Tokens of the second stream are allocated by another thread and released by this one
+	auto ts2 = std::make_unique<TokenStream>();
+	TokenIt c, d;
+	std::thread([&]() {
+		c = ts2->emplace_back(TokenType::META_KEY, "c");
+		d = ts2->emplace_back(TokenType::META_KEY, "d");
+	}).join();
+
+	ts1.moveAppend(b, ts2.get());
+	ASSERT_TRUE(ts2->empty());
+	ASSERT_EQ(ts1.getTokensAsText(), std::vector<std::string>({"a", "c", "d", "b"}));
+	ASSERT_EQ(c->getString(), "c");
+	ASSERT_EQ(d->getString(), "d");
+
+	ts2->emplace_back(TokenType::META_KEY, "e");
+	ts1.swapTokens(c, b, ts2.get(), ts2->begin(), ts2->end());
+	ASSERT_EQ(ts1.getTokensAsText(), std::vector<std::string>({"a", "e", "b"}));
+	ASSERT_EQ(ts2->getTokensAsText(), std::vector<std::string>({"c", "d"}));
+	ASSERT_EQ(a->getString(), "a");
+	ASSERT_EQ(b->getString(), "b");
+
+	ts1.erase(a);
+	ts2.reset();
+	ASSERT_EQ(ts1.getTokensAsText(), std::vector<std::string>({"e", "b"}));
+}
+
 }
 }
@@ -174,6 +174,21 @@ RemoveWithParentRemovedWorks) {
 	EXPECT_TRUE(trie.isPrefix("abc"));
 }
 
+TEST_F(TrieTests,
+RemoveKeepsOtherBranchesWorks) {
+	Trie<std::string> trie;
+
+	EXPECT_TRUE(trie.insert("abc", "value1"s));
+	EXPECT_TRUE(trie.insert("xyz", "value2"s));
+
+	trie.remove("abc");
+	const std::vector<std::string> expected = { "value2" };
+	EXPECT_EQ(expected, trie.getAllValues());
+	EXPECT_FALSE(trie.isPrefix("abc"));
+	EXPECT_TRUE(trie.isPrefix("xyz"));
+	EXPECT_FALSE(trie.empty());
+}
+
 TEST_F(TrieTests,
 RemoveClearsWorks) {
 	Trie<std::string> trie;
@@ -187,5 +202,31 @@ RemoveClearsWorks) {
 	EXPECT_TRUE(trie.empty());
 }
 
+TEST_F(TrieTests,
+TransformKeepsKeysAndOrder) {
+	Trie<std::string> trie;
+
+	EXPECT_TRUE(trie.insert("xyz", "v1"s));
+	EXPECT_TRUE(trie.insert("ab", "value2"s));
+	EXPECT_TRUE(trie.insert("abc", "val3"s));
+
+	auto lengths = trie.transform([](const std::string& value) { return value.length(); });
+
+	const std::vector<std::size_t> expected = { 2, 6, 4 };
+	EXPECT_EQ(expected, lengths.getAllValues());
+	std::size_t length = 0;
+	EXPECT_TRUE(lengths.find("ab", length));
+	EXPECT_EQ(6u, length);
+	EXPECT_TRUE(lengths.find("abc", length));
+	EXPECT_TRUE(lengths.find("xyz", length));
+	EXPECT_FALSE(lengths.find("a", length));
+
+	auto copy = trie.transform([](const std::string& value) { return value; });
+	EXPECT_EQ(trie.getAllValues(), copy.getAllValues());
+	std::string value;
+	EXPECT_TRUE(copy.find("abc", value));
+	EXPECT_EQ("val3", value);
+}
+
 }
 }
@@ -4,9 +4,20 @@
 * @copyright AVG Technologies s.r.o, All Rights Reserved
 */
 
+#include <condition_variable>
+#include <fstream>
+#include <thread>
+
 #include <gtest/gtest.h>
 
+#include "yaramod/utils/filesystem.h"
+#include "yaramod/utils/json.h"
+#include "yaramod/utils/mapped_file.h"
+#include "yaramod/utils/pool_allocator.h"
 #include "yaramod/utils/utils.h"
+#include "yaramod/yaramod_error.h"
+
+#include "temporary_directory.h"
 
 using namespace ::testing;
 
@@ -69,5 +80,113 @@ NumToStrWorks) {
 	EXPECT_EQ("0.869932552472", numToStr<double>(0.869932552472));
 }
 
+TEST_F(UtilsTests,
+BinaryJsonWorks) {
+	// {"kind": "struct", "name": "abc", "attributes": ["abc", "def"]}
+	static constexpr std::string_view strings[] = {"kind", "struct", "name", "abc", "attributes", "def"};
+	static constexpr std::uint32_t values[] = {
+		3, 0, 0x40000001, 2, 0x40000003, 4, 0xC0000007,
+		2, 0x40000003, 0x40000005
+	};
+	static constexpr BinaryJson::Data data = {strings, values};
+
+	BinaryJson json(&data);
+	EXPECT_TRUE(json.isObject());
+	EXPECT_TRUE(json.contains("kind"));
+	EXPECT_FALSE(json.contains("type"));
+	EXPECT_EQ("struct", accessJsonString(json, "kind"));
+	EXPECT_EQ("abc", accessJsonString(json, "name"));
+	EXPECT_EQ((std::vector<std::string_view>{"kind", "name", "attributes"}), json.getKeys());
+
+	auto attributes = accessJsonArray(json, "attributes");
+	ASSERT_EQ(2u, attributes.size());
+	EXPECT_EQ("abc", attributes[0].getString());
+	EXPECT_EQ("def", attributes[1].getString());
+
+	EXPECT_THROW(accessJsonString(json, "type"), YaramodError);
+	EXPECT_THROW(accessJsonString(json, "attributes"), YaramodError);
+}
+
+TEST_F(UtilsTests,
+MappedFileWorks) {
+	TemporaryDirectory directory;
+	auto filePath = (directory / "mapped_file.yar").string();
+	std::ofstream(filePath, std::ios::binary) << "rule abc { condition: true }";
+	{
+		MappedFile file(filePath);
+		EXPECT_TRUE(file.isOpen());
+		EXPECT_TRUE(file.isMapped());
+		EXPECT_EQ("rule abc { condition: true }", file.getContent());
+	}
+
+	std::ofstream(filePath, std::ios::binary | std::ios::trunc);
+	{
+		MappedFile file(filePath);
+		EXPECT_TRUE(file.isOpen());
+		EXPECT_FALSE(file.isMapped());
+		EXPECT_EQ("", file.getContent());
+	}
+
+	fs::remove(filePath);
+	EXPECT_FALSE(MappedFile(filePath).isOpen());
+}
+
+TEST_F(UtilsTests,
+BlockPoolReusesBlocksReleasedByAnotherThread) {
+	// Block size which is not used anywhere else so the pool is used only by this test
+	using Pool = BlockPool<sizeof(void*) * 37>;
+	constexpr std::size_t blocksPerRound = 1000;
+	constexpr std::size_t rounds = 100;
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::vector<void*> blocks;
+	bool finished = false;
+
+	// Blocks are allocated by this thread and released by the consumer
+	std::thread consumer([&]() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (!finished)
+		{
+			condition.wait(lock, [&]() { return !blocks.empty() || finished; });
+			for (auto* block : blocks)
+				Pool::deallocate(block);
+			blocks.clear();
+			condition.notify_all();
+		}
+	});
+
+	for (std::size_t round = 0; round < rounds; ++round)
+	{
+		std::vector<void*> allocated;
+		for (std::size_t i = 0; i < blocksPerRound; ++i)
+			allocated.push_back(Pool::allocate());
+
+		std::unique_lock<std::mutex> lock(mutex);
+		blocks = std::move(allocated);
+		condition.notify_all();
+		condition.wait(lock, [&]() { return blocks.empty(); });
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		finished = true;
+	}
+	condition.notify_all();
+	consumer.join();
+
+	EXPECT_GT(Pool::allocatedBytes(), 0u);
+	EXPECT_LE(Pool::allocatedBytes(), 4 * blocksPerRound * sizeof(void*) * 37);
+
+	// All blocks are free now so all chunks can be returned
+	auto allocatedBytes = Pool::allocatedBytes();
+	EXPECT_EQ(allocatedBytes, Pool::releaseFreeChunks());
+	EXPECT_EQ(0u, Pool::allocatedBytes());
+
+	auto* block = Pool::allocate();
+	EXPECT_GT(Pool::allocatedBytes(), 0u);
+	Pool::deallocate(block);
+}
+
 }
 }
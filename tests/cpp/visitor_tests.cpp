@@ -4,6 +4,7 @@
 * @copyright (c) 2019 Avast Software, licensed under the MIT license
 */
 
+#include <algorithm>
 #include <clocale>
 
 #include <gtest/gtest.h>
@@ -11,6 +12,8 @@
 #include "yaramod/builder/yara_expression_builder.h"
 #include "yaramod/parser/parser_driver.h"
 #include "yaramod/utils/modifying_visitor.h"
+#include "yaramod/utils/observing_visitor.h"
+#include "yaramod/utils/static_visitor.h"
 
 using namespace ::testing;
 
@@ -1518,5 +1521,236 @@ rule rule_6
 	EXPECT_EQ(expected, yara_file.getTextFormatted());
 }
 
+TEST_F(VisitorTests,
+StaticObservingVisitorTraversesAndTerminates) {
+	class IdCollector : public StaticObservingVisitor<IdCollector>
+	{
+	public:
+		using StaticObservingVisitor<IdCollector>::visit;
+
+		bool visit(IdExpression* expr)
+		{
+			ids.push_back(expr->getSymbol()->getName());
+			return true;
+		}
+
+		bool visit(StructAccessExpression* expr)
+		{
+			ids.push_back(expr->getSymbol()->getName());
+			return StaticObservingVisitor<IdCollector>::visit(expr);
+		}
+
+		bool visit(StringAtExpression*)
+		{
+			return true;
+		}
+
+		std::vector<std::string> ids;
+	};
+
+	class FunctionCallFinder : public StaticObservingVisitor<FunctionCallFinder>
+	{
+	public:
+		using StaticObservingVisitor<FunctionCallFinder>::visit;
+
+		bool visit(FunctionCallExpression* expr)
+		{
+			found = expr;
+			return false;
+		}
+
+		bool visit(IntLiteralExpression*)
+		{
+			++literals;
+			return true;
+		}
+
+		FunctionCallExpression* found = nullptr;
+		std::size_t literals = 0;
+	};
+
+	prepareInput(
+R"(
+import "pe"
+
+rule abc
+{
+	strings:
+		$a = "abc"
+	condition:
+		for all i in (0 .. pe.number_of_sections) : ( pe.sections[i].virtual_size > 1 ) and
+		$a at pe.entry_point and
+		(pe.is_dll() or pe.exports("a")) and
+		with x = 2 : ( x == 2 )
+}
+)");
+
+	ASSERT_TRUE(driver.parse(input));
+	auto condition = driver.getParsedFile().getRules()[0]->getCondition();
+
+	IdCollector collector;
+	EXPECT_TRUE(collector.observe(condition));
+	std::vector<std::string> expected = { "number_of_sections", "pe", "virtual_size", "sections", "pe", "i", "is_dll", "pe", "exports", "pe", "x" };
+	EXPECT_EQ(expected, collector.ids);
+
+	FunctionCallFinder finder;
+	EXPECT_FALSE(finder.observe(condition));
+	ASSERT_NE(nullptr, finder.found);
+	EXPECT_EQ("pe.is_dll()", finder.found->getText());
+	EXPECT_EQ(2u, finder.literals);
+}
+
+class LogicalOpCounter : public ObservingVisitor
+{
+public:
+	LogicalOpCounter(bool flatChains = false) : ObservingVisitor(flatChains) {}
+
+	virtual VisitResult visit(OrExpression* expr) override
+	{
+		++ors;
+		return ObservingVisitor::visit(expr);
+	}
+
+	virtual VisitResult visit(EqExpression* expr) override
+	{
+		++eqs;
+		return ObservingVisitor::visit(expr);
+	}
+
+	std::size_t ors = 0;
+	std::size_t eqs = 0;
+};
+
+class StaticLogicalOpCounter : public StaticObservingVisitor<StaticLogicalOpCounter>
+{
+public:
+	using StaticObservingVisitor<StaticLogicalOpCounter>::visit;
+
+	bool visit(OrExpression* expr)
+	{
+		++ors;
+		return StaticObservingVisitor<StaticLogicalOpCounter>::visit(expr);
+	}
+
+	bool visit(EqExpression* expr)
+	{
+		++eqs;
+		return StaticObservingVisitor<StaticLogicalOpCounter>::visit(expr);
+	}
+
+	std::size_t ors = 0;
+	std::size_t eqs = 0;
+};
+
+class EqDeleter : public ModifyingVisitor
+{
+public:
+	EqDeleter(std::vector<std::string> deleted, bool flatChains = false) : ModifyingVisitor(flatChains), _deleted(std::move(deleted)) {}
+
+	virtual VisitResult visit(EqExpression* expr) override
+	{
+		if (std::find(_deleted.begin(), _deleted.end(), expr->getRightOperand()->getText()) != _deleted.end())
+			return VisitAction::Delete;
+		return {};
+	}
+
+private:
+	std::vector<std::string> _deleted;
+};
+
+TEST_F(VisitorTests,
+ChainsOfLogicalOperationsAreVisitedAsBinaryOperationsByDefault) {
+	prepareInput("rule abc { condition: filesize == 1 or filesize == 2 or filesize == 3 or filesize == 4 }");
+	ASSERT_TRUE(driver.parse(input));
+	auto condition = driver.getParsedFile().getRules()[0]->getCondition();
+
+	LogicalOpCounter counter;
+	counter.observe(condition);
+	EXPECT_EQ(3u, counter.ors);
+	EXPECT_EQ(4u, counter.eqs);
+
+	// Nested operations created by the first visit are visited the same way
+	ASSERT_EQ(nullptr, condition->as<OrExpression>()->getChain());
+	LogicalOpCounter nestedCounter;
+	nestedCounter.observe(condition);
+	EXPECT_EQ(3u, nestedCounter.ors);
+	EXPECT_EQ(4u, nestedCounter.eqs);
+}
+
+TEST_F(VisitorTests,
+FlatChainsOfLogicalOperationsAreVisitedOnce) {
+	prepareInput("rule abc { condition: filesize == 1 or filesize == 2 or filesize == 3 or filesize == 4 }");
+	ASSERT_TRUE(driver.parse(input));
+	auto condition = driver.getParsedFile().getRules()[0]->getCondition();
+
+	LogicalOpCounter counter(true);
+	counter.observe(condition);
+	EXPECT_EQ(1u, counter.ors);
+	EXPECT_EQ(4u, counter.eqs);
+	StaticLogicalOpCounter staticCounter;
+	EXPECT_TRUE(staticCounter.observe(condition));
+	EXPECT_EQ(1u, staticCounter.ors);
+	EXPECT_EQ(4u, staticCounter.eqs);
+
+	// Nested operations of the chain don't change the number of visits
+	condition->as<OrExpression>()->getLeftOperand()->as<OrExpression>()->getLeftOperand();
+	ASSERT_EQ(nullptr, condition->as<OrExpression>()->getChain());
+	LogicalOpCounter nestedCounter(true);
+	nestedCounter.observe(condition);
+	EXPECT_EQ(1u, nestedCounter.ors);
+	EXPECT_EQ(4u, nestedCounter.eqs);
+	StaticLogicalOpCounter nestedStaticCounter;
+	EXPECT_TRUE(nestedStaticCounter.observe(condition));
+	EXPECT_EQ(1u, nestedStaticCounter.ors);
+	EXPECT_EQ(4u, nestedStaticCounter.eqs);
+}
+
+TEST_F(VisitorTests,
+ModifyingVisitorDeletesOperandsOfChains) {
+	auto modified = [](const std::vector<std::string>& deleted, bool flatChains) {
+		ParserDriver modifiedDriver;
+		std::istringstream modifiedInput("rule abc { condition: filesize == 1 or filesize == 2 or filesize == 3 or filesize == 4 }");
+		EXPECT_TRUE(modifiedDriver.parse(modifiedInput));
+		const auto& rule = modifiedDriver.getParsedFile().getRules()[0];
+		rule->setCondition(EqDeleter{deleted, flatChains}.modify(rule->getCondition(), boolVal(false).get()));
+		return modifiedDriver.getParsedFile().getTokenStream()->getText() + "|" + rule->getCondition()->getText();
+	};
+
+	EXPECT_EQ("rule abc\n{\n\tcondition:\n\t\tfilesize == 1 or\n\t\tfilesize == 2 or\n\t\tfilesize == 3 or\n\t\tfilesize == 4\n}\n|filesize == 1 or filesize == 2 or filesize == 3 or filesize == 4", modified({}, true));
+	EXPECT_EQ("rule abc\n{\n\tcondition:\n\t\tfilesize == 1 or\n\t\tfilesize == 3\n}\n|filesize == 1 or filesize == 3", modified({"2", "4"}, true));
+	EXPECT_EQ("rule abc\n{\n\tcondition:\n\t\tfilesize == 3 or\n\t\tfilesize == 4\n}\n|filesize == 3 or filesize == 4", modified({"1", "2"}, true));
+	EXPECT_EQ("rule abc\n{\n\tcondition:\n\t\tfilesize == 1 or\n\t\tfilesize == 4\n}\n|filesize == 1 or filesize == 4", modified({"2", "3"}, true));
+	EXPECT_EQ("rule abc\n{\n\tcondition:\n\t\tfilesize == 3\n}\n|filesize == 3", modified({"1", "2", "4"}, true));
+	EXPECT_EQ("rule abc\n{\n\tcondition:\n\t\tfalse\n}\n|false", modified({"1", "2", "3", "4"}, true));
+
+	// Deletion of the operands from nested binary operations gives the same result
+	for (const auto& deleted : std::vector<std::vector<std::string>>{{}, {"2", "4"}, {"1", "2"}, {"2", "3"}, {"1", "2", "4"}, {"1", "2", "3", "4"}})
+		EXPECT_EQ(modified(deleted, true), modified(deleted, false));
+}
+
+TEST_F(VisitorTests,
+DeepChainsOfLogicalOperationsAreVisitedWithoutRecursion) {
+	const std::size_t terms = 100000;
+	std::string condition = "filesize == 0";
+	for (std::size_t i = 1; i < terms; ++i)
+		condition += " or filesize == " + std::to_string(i);
+
+	prepareInput("rule abc { condition: " + condition + " }");
+	ASSERT_TRUE(driver.parse(input));
+	const auto& rule = driver.getParsedFile().getRules()[0];
+
+	LogicalOpCounter counter(true);
+	counter.observe(rule->getCondition());
+	EXPECT_EQ(1u, counter.ors);
+	EXPECT_EQ(terms, counter.eqs);
+
+	rule->setCondition(EqDeleter{{"0", "1"}, true}.modify(rule->getCondition()));
+	auto orExpr = rule->getCondition()->as<OrExpression>();
+	ASSERT_NE(nullptr, orExpr);
+	ASSERT_NE(nullptr, orExpr->getChain());
+	EXPECT_EQ(terms - 2, orExpr->getChainOperandsCount());
+	EXPECT_EQ(condition.substr(std::string{"filesize == 0 or filesize == 1 or "}.size()), orExpr->getText());
+}
+
 }
 }
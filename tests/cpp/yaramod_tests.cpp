@@ -4,12 +4,16 @@
 * @copyright (c) 2019 Avast Software, licensed under the MIT license
 */
 
+#include <fstream>
 #include <gtest/gtest.h>
 #include <iostream>
 
 #include "yaramod/types/plain_string.h"
+#include "yaramod/utils/filesystem.h"
 #include "yaramod/yaramod.h"
 
+#include "temporary_directory.h"
+
 using namespace ::testing;
 
 namespace yaramod {
@@ -214,5 +218,75 @@ rule rule_with_added_metas
 )", yarafile->getTextFormatted());
 }
 
+TEST_F(YaramodTests,
+ParseFilesConcurrently) {
+	TemporaryDirectory directory;
+
+	std::vector<std::string> filePaths;
+	for (int i = 0; i < 16; ++i)
+	{
+		auto filePath = (directory / ("rule_" + std::to_string(i) + ".yar")).string();
+		std::ofstream(filePath) << "import \"pe\"\nrule rule_" << i << " { condition: pe.number_of_sections > " << i << " }\n";
+		filePaths.push_back(filePath);
+	}
+	std::ofstream(filePaths[5]) << "rule invalid { condition: }\n";
+	filePaths.push_back((directory / "missing.yar").string());
+
+	yaramod::Yaramod ymod;
+	auto results = ymod.parseFiles(filePaths, 4);
+
+	ASSERT_EQ(filePaths.size(), results.size());
+	for (std::size_t i = 0; i < results.size(); ++i)
+	{
+		EXPECT_EQ(filePaths[i], results[i].filePath);
+		if (i == 5)
+		{
+			EXPECT_EQ(nullptr, results[i].yaraFile);
+			EXPECT_NE(std::string::npos, results[i].error.find("Syntax error"));
+		}
+		else if (i == 16)
+		{
+			EXPECT_EQ(nullptr, results[i].yaraFile);
+			EXPECT_FALSE(results[i].error.empty());
+		}
+		else
+		{
+			ASSERT_NE(nullptr, results[i].yaraFile);
+			EXPECT_TRUE(results[i].error.empty());
+			ASSERT_EQ(1u, results[i].yaraFile->getRules().size());
+			EXPECT_EQ("rule_" + std::to_string(i), results[i].yaraFile->getRules()[0]->getName());
+			EXPECT_EQ("pe.number_of_sections > " + std::to_string(i), results[i].yaraFile->getRules()[0]->getCondition()->getText());
+		}
+	}
+}
+
+// Cache which fails with an exception not derived from std::exception
+class ThrowingIncludeCache : public IncludeCache
+{
+public:
+	virtual std::shared_ptr<const ParsedInclude> find(const std::string&, const ContentHash&) override { throw 42; }
+	virtual void store(const std::string&, const ContentHash&, const std::shared_ptr<const ParsedInclude>&) override {}
+	virtual void clear() override {}
+};
+
+TEST_F(YaramodTests,
+ParseFilesReportsUnknownErrorsPerFile) {
+	TemporaryDirectory directory;
+	std::ofstream(directory / "included.yar") << "rule included { condition: true }\n";
+	std::ofstream(directory / "main.yar") << "include \"included.yar\"\nrule main { condition: included }\n";
+	std::ofstream(directory / "plain.yar") << "rule plain { condition: true }\n";
+
+	std::vector<std::string> filePaths = {(directory / "main.yar").string(), (directory / "plain.yar").string()};
+	yaramod::Yaramod ymod;
+	ymod.setIncludeCache(std::make_shared<ThrowingIncludeCache>());
+	auto results = ymod.parseFiles(filePaths, 2);
+
+	ASSERT_EQ(2u, results.size());
+	EXPECT_EQ(nullptr, results[0].yaraFile);
+	EXPECT_EQ("Unknown error while parsing file '" + filePaths[0] + "'", results[0].error);
+	ASSERT_NE(nullptr, results[1].yaraFile);
+	EXPECT_TRUE(results[1].error.empty());
+}
+
 }
 }
@@ -1,3 +1,5 @@
+import os
+import tempfile
 import unittest
 import yaramod
 
@@ -698,6 +700,24 @@ rule or_condition {
         self.assertTrue(isinstance(rule.condition.right_operand, yaramod.NotExpression))
         self.assertEqual(rule.condition.text, 'true or not false')
 
+    def test_chain_of_or_conditions(self):
+        yara_file = yaramod.Yaramod().parse_string('''
+rule chain_of_or_conditions {
+    condition:
+        true or false or not false or filesize > 10
+}''')
+
+        self.assertEqual(len(yara_file.rules), 1)
+
+        rule = yara_file.rules[0]
+        self.assertTrue(isinstance(rule.condition, yaramod.OrExpression))
+        self.assertEqual([operand.text for operand in rule.condition.operands], ['true', 'false', 'not false', 'filesize > 10'])
+        self.assertTrue(isinstance(rule.condition.left_operand, yaramod.OrExpression))
+        self.assertEqual(rule.condition.left_operand.text, 'true or false or not false')
+        self.assertTrue(isinstance(rule.condition.right_operand, yaramod.GtExpression))
+        self.assertEqual(len(rule.condition.operands), 4)
+        self.assertEqual(rule.condition.text, 'true or false or not false or filesize > 10')
+
     def test_less_than_condition(self):
         yara_file = yaramod.Yaramod().parse_string('''
 rule less_than_condition {
@@ -2312,3 +2332,145 @@ rule test_rule
 ''')
 
         self.assertEqual(yara_file.rules[0].condition.uid, 21)
+
+    def test_parse_files(self):
+        with tempfile.TemporaryDirectory() as directory:
+            file_paths = []
+            for i, condition in enumerate(['true', 'false', '']):
+                file_path = os.path.join(directory, 'rule_{}.yar'.format(i))
+                with open(file_path, 'w') as f:
+                    f.write('rule rule_{} {{ condition: {} }}'.format(i, condition))
+                file_paths.append(file_path)
+
+            results = yaramod.Yaramod().parse_files(file_paths, threads=2)
+
+        self.assertEqual([r.file_path for r in results], file_paths)
+        self.assertEqual(results[0].yara_file.rules[0].name, 'rule_0')
+        self.assertEqual(results[1].yara_file.rules[0].condition.text, 'false')
+        self.assertEqual(results[0].error, '')
+        self.assertIsNone(results[2].yara_file)
+        self.assertIn('Syntax error', results[2].error)
+
+    def test_include_cache(self):
+        with tempfile.TemporaryDirectory() as directory:
+            with open(os.path.join(directory, 'common.yar'), 'w') as f:
+                f.write('rule common { condition: true }')
+            file_paths = []
+            for i in range(2):
+                file_path = os.path.join(directory, 'rule_{}.yar'.format(i))
+                with open(file_path, 'w') as f:
+                    f.write('include "common.yar"\nrule rule_{} {{ condition: common }}'.format(i))
+                file_paths.append(file_path)
+
+            cache = yaramod.MemoryIncludeCache()
+            ymod = yaramod.Yaramod()
+            ymod.set_include_cache(cache)
+            yara_files = [ymod.parse_file(file_path) for file_path in file_paths]
+
+        self.assertEqual(cache.size, 1)
+        self.assertEqual([r.name for r in yara_files[1].rules], ['common', 'rule_1'])
+        cache.clear()
+        self.assertEqual(cache.size, 0)
+
+    def test_include_prefetching(self):
+        with tempfile.TemporaryDirectory() as directory:
+            with open(os.path.join(directory, 'common.yar'), 'w') as f:
+                f.write('rule common { condition: true }')
+            file_path = os.path.join(directory, 'main.yar')
+            with open(file_path, 'w') as f:
+                f.write('include "common.yar"\nrule main { condition: common }')
+
+            ymod = yaramod.Yaramod()
+            ymod.set_include_prefetch_threads(2)
+            yara_file = ymod.parse_file(file_path)
+
+        self.assertEqual([r.name for r in yara_file.rules], ['common', 'main'])
+
+    def test_error_recovery(self):
+        ymod = yaramod.Yaramod()
+        ymod.set_error_recovery(True)
+        yara_file = ymod.parse_string('''
+rule abc { condition: true }
+rule def { condition: }
+rule ghi { condition: unknown }
+rule jkl { condition: abc }
+''')
+
+        self.assertEqual([r.name for r in yara_file.rules], ['abc', 'jkl'])
+        self.assertEqual(len(ymod.errors), 2)
+        self.assertTrue(str(ymod.errors[0]).startswith('Error at 3.23: Syntax error: Unexpected }'))
+        self.assertEqual(ymod.errors[0].location.begin.line, 3)
+        self.assertEqual(str(ymod.errors[1]), "Error at 4.23-29: Unrecognized identifier 'unknown' referenced")
+
+        ymod.set_error_recovery(False)
+        with self.assertRaises(yaramod.ParserError) as context:
+            ymod.parse_string('rule abc { condition: }')
+        self.assertEqual(context.exception.location.begin.line, 1)
+
+    def test_profiling(self):
+        input_text = '''
+import "pe"
+
+rule abc { condition: pe.number_of_sections > 1 }
+rule def { condition: abc }
+'''
+        ymod = yaramod.Yaramod()
+        ymod.set_profiling(True)
+        ymod.parse_string(input_text)
+
+        profile = ymod.profile
+        self.assertGreater(profile.tokens, 0)
+        self.assertGreater(profile.reductions, 0)
+        self.assertGreaterEqual(profile.symbol_lookups, 2)
+        self.assertEqual(profile.imports, 1)
+        self.assertEqual(profile.included_files, 0)
+        self.assertEqual(profile.bytes_read, len(input_text))
+        self.assertGreater(profile.time(yaramod.ParserPhase.Tokenizing), 0.0)
+        self.assertGreaterEqual(profile.total_time, profile.time(yaramod.ParserPhase.Actions))
+
+        ymod.set_profiling(False)
+        ymod.parse_string(input_text)
+        self.assertEqual(ymod.profile.tokens, 0)
+
+    def test_arena_allocation(self):
+        input_text = '''import "pe"
+
+rule abc
+{
+	condition:
+		pe.number_of_sections > 1 and (filesize < 100KB or pe.is_dll())
+}
+'''
+        ymod = yaramod.Yaramod()
+        ymod.set_arena_allocation(True)
+        yara_file = ymod.parse_string(input_text)
+        condition = yara_file.rules[0].condition
+        del yara_file
+        del ymod
+
+        self.assertEqual(condition.text, 'pe.number_of_sections > 1 and (filesize < 100KB or pe.is_dll())')
+        self.assertTrue(isinstance(condition, yaramod.AndExpression))
+
+    def test_parse_string_with_rule_callback(self):
+        rules = []
+        ymod = yaramod.Yaramod()
+        result = ymod.parse_string('''
+import "cuckoo"
+
+rule abc {
+	condition:
+		true
+}
+
+rule def {
+	condition:
+		abc
+}
+''', lambda rule, yara_file: rules.append((rule, len(yara_file.imports))))
+
+        self.assertTrue(result)
+        self.assertEqual([r.name for r, _ in rules], ['abc', 'def'])
+        self.assertEqual([imports for _, imports in rules], [1, 1])
+        self.assertEqual(rules[1][0].condition.text, 'abc')
+        self.assertEqual(rules[0][0].text, 'rule abc {\n\tcondition:\n\t\ttrue\n}')
+        self.assertEqual(len(ymod.yara_file.rules), 0)